@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Benchmark for object pools in mmap-backed arenas.
+#
+#-------------------------------------------------
+
+QT       -= core
+
+QT       -= gui
+
+TARGET = ArenaBenchmark
+CONFIG   += console c++11 release
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../source/PPUtils
+
+SOURCES += arenabenchmark.cc \
+           ../../source/PPUtils/mappedarena.cc
+
+HEADERS += \
+    ../../source/PPUtils/mappedarena.hh \
+    ../../source/PPUtils/mappedarena_impl.hh \
+    ../../source/PPUtils/uniformobjectpool.hh \
+    ../../source/PPUtils/uniformobjectpool_impl.hh \
+    ../../source/PPUtils/pooledptr.hh \
+    ../../source/PPUtils/pooledptr_impl.hh \
+    ../../source/PPUtils/resetpolicy.hh \
+    ../../source/PPUtils/poolstatistics.hh
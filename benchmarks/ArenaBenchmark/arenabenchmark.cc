@@ -0,0 +1,257 @@
+/* ArenaBenchmark
+ * This program measures the effect of PPUtils::MappedArena on a
+ * PPUtils::UniformObjectPool holding millions of small objects.
+ *
+ * Objects are built through the pool from the heap, and from arenas on
+ * normal pages, transparent huge pages and reserved huge pages, with and
+ * without populate. The built objects are linked in random order, and the
+ * links are followed, so that nearly every hop lands on another page.
+ *
+ * Build phase is reported in ns per object and page faults per object, and
+ * the chase in ns per hop and dTLB load misses per hop, read from perf
+ * counters. Counters show "n/a" if perf events are not permitted (see
+ * /proc/sys/kernel/perf_event_paranoid). Reserve huge pages for the
+ * hugetlb rows, e.g. echo 200 > /proc/sys/vm/nr_hugepages; arena rows show
+ * the kind of pages they actually got.
+ *
+ * Usage: ArenaBenchmark [objects]. Default 2000000 objects of 64 bytes.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "mappedarena.hh"
+#include "uniformobjectpool.hh"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+
+// Pooled object of one cache line.
+struct Node : PPUtils::ArenaObject<Node>
+{
+    Node* next;
+    std::uint64_t data[7];
+};
+
+
+// Counts one perf event of the calling thread. Reads -1, if the event cannot
+// be opened.
+class PerfCounter
+{
+public:
+
+    PerfCounter(std::uint32_t type, std::uint64_t config) : fd_(-1)
+    {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = type == PERF_TYPE_HW_CACHE ? 1 : 0;
+        attr.exclude_hv = 1;
+        fd_ = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+        (void)type;
+        (void)config;
+#endif
+    }
+
+    ~PerfCounter()
+    {
+#ifdef __linux__
+        if (fd_ >= 0){
+            close(fd_);
+        }
+#endif
+    }
+
+    void start()
+    {
+#ifdef __linux__
+        if (fd_ >= 0){
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop()
+    {
+        long long count = -1;
+#ifdef __linux__
+        if (fd_ >= 0){
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &count, sizeof(count)) != sizeof(count)){
+                count = -1;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int fd_;
+};
+
+
+PerfCounter* pageFaults()
+{
+#ifdef __linux__
+    return new PerfCounter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+#else
+    return new PerfCounter(0, 0);
+#endif
+}
+
+
+PerfCounter* tlbMisses()
+{
+#ifdef __linux__
+    return new PerfCounter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                           (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+#else
+    return new PerfCounter(0, 0);
+#endif
+}
+
+
+std::string perObject(long long count, std::size_t objects)
+{
+    if (count < 0){
+        return "n/a";
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << double(count) / objects;
+    return out.str();
+}
+
+
+const char* pageName(PPUtils::ArenaPages pages)
+{
+    switch (pages){
+    case PPUtils::ARENA_PAGES_HUGETLB: return "hugetlb";
+    case PPUtils::ARENA_PAGES_TRANSPARENT: return "THP";
+    default: return "4K";
+    }
+}
+
+
+// Builds objects through a pool, chases links through them, and prints a
+// row. arena is nullptr for the heap.
+void benchmark(const std::string& name, PPUtils::MappedArena* arena, std::size_t objects)
+{
+    PPUtils::ArenaObject<Node>::setArena(arena);
+    std::unique_ptr<PerfCounter> faults(pageFaults());
+    std::unique_ptr<PerfCounter> misses(tlbMisses());
+    {
+        PPUtils::UniformObjectPool<Node> pool;
+        std::vector<std::unique_ptr<Node> > nodes(objects);
+
+        faults->start();
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < objects; ++i){
+            nodes[i] = pool.reserve();
+            nodes[i]->data[0] = i;
+        }
+        auto end = std::chrono::steady_clock::now();
+        const long long build_faults = faults->stop();
+        const double build_ns =
+                std::chrono::duration<double, std::nano>(end - start).count() / objects;
+
+        // Link in random order.
+        std::vector<std::size_t> order(objects);
+        for (std::size_t i = 0; i < objects; ++i){
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+        for (std::size_t i = 0; i < objects; ++i){
+            nodes[order[i]]->next = nodes[order[(i + 1) % objects]].get();
+        }
+
+        const std::size_t hops = 4 * objects;
+        Node* node = nodes[order[0]].get();
+        std::uint64_t sink = 0;
+        misses->start();
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < hops; ++i){
+            sink += node->data[0];
+            node = node->next;
+        }
+        end = std::chrono::steady_clock::now();
+        const long long chase_misses = misses->stop();
+        const double chase_ns =
+                std::chrono::duration<double, std::nano>(end - start).count() / hops;
+
+        std::cout << std::setw(24) << name
+                  << std::setw(9) << (arena == nullptr ? "-" : pageName(arena->pages()))
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(11) << build_ns
+                  << std::setw(11) << perObject(build_faults, objects)
+                  << std::setw(11) << chase_ns
+                  << std::setw(11) << perObject(chase_misses, hops)
+                  << (sink == 42 ? " " : "") << std::endl;
+
+        for (std::unique_ptr<Node>& n : nodes){
+            pool.release(std::move(n));
+        }
+    }
+    PPUtils::ArenaObject<Node>::setArena(nullptr);
+}
+
+
+int main(int argc, char* argv[])
+{
+    const std::size_t objects = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+    std::cout << std::setw(24) << "backend"
+              << std::setw(9) << "pages"
+              << std::setw(11) << "build ns"
+              << std::setw(11) << "faults"
+              << std::setw(11) << "chase ns"
+              << std::setw(11) << "dTLB miss" << std::endl;
+
+    benchmark("heap", nullptr, objects);
+
+    const PPUtils::ArenaPages kinds[] = {PPUtils::ARENA_PAGES_NORMAL,
+                                         PPUtils::ARENA_PAGES_TRANSPARENT,
+                                         PPUtils::ARENA_PAGES_HUGETLB};
+    for (PPUtils::ArenaPages pages : kinds){
+        for (bool populate : {false, true}){
+            PPUtils::MappedArenaOptions options;
+            options.bytes = objects * sizeof(Node);
+            options.pages = pages;
+            options.populate = populate;
+            const std::string name = std::string("arena ") + pageName(pages) +
+                    (populate ? " populate" : "");
+            try {
+                PPUtils::MappedArena arena(options);
+                benchmark(name, &arena, objects);
+            }
+            catch (const std::bad_alloc&){
+                std::cout << std::setw(24) << name << "  cannot map" << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,32 @@
+#-------------------------------------------------
+#
+# Benchmark for the object pools against new/delete.
+#
+#-------------------------------------------------
+
+QT       -= core
+
+QT       -= gui
+
+TARGET = PoolBenchmark
+CONFIG   += console c++11 release
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../source/PPUtils
+
+SOURCES += poolbenchmark.cc
+
+HEADERS += \
+    ../../source/PPUtils/basicuniformobjectpool.hh \
+    ../../source/PPUtils/basicuniformobjectpool_impl.hh \
+    ../../source/PPUtils/poolpolicies.hh \
+    ../../source/PPUtils/uniformobjectpool.hh \
+    ../../source/PPUtils/uniformobjectpool_impl.hh \
+    ../../source/PPUtils/concurrentuniformobjectpool.hh \
+    ../../source/PPUtils/concurrentuniformobjectpool_impl.hh \
+    ../../source/PPUtils/pooledptr.hh \
+    ../../source/PPUtils/pooledptr_impl.hh \
+    ../../source/PPUtils/resetpolicy.hh \
+    ../../source/PPUtils/poolstatistics.hh
@@ -0,0 +1,133 @@
+/* PoolBenchmark
+ * This program compares reserve + release of PPUtils::BasicUniformObjectPool
+ * with different policies to PPUtils::UniformObjectPool,
+ * PPUtils::ConcurrentUniformObjectPool and plain new/delete.
+ *
+ * Two access patterns are measured: reserving and releasing one object at a
+ * time, and reserving a burst of objects before releasing them all. Objects
+ * are touched once after reserve, so that new/delete pays for the memory it
+ * hands out.
+ *
+ * Build in release mode. Times are the best of several repetitions, given in
+ * nanoseconds per reserve + release pair.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include "basicuniformobjectpool.hh"
+#include "uniformobjectpool.hh"
+#include "concurrentuniformobjectpool.hh"
+
+
+// Pooled object of Bytes bytes.
+template <unsigned Bytes>
+struct Payload
+{
+    std::uint64_t data[Bytes / sizeof(std::uint64_t)];
+};
+
+
+// Adapter giving new/delete the pool interface.
+template <class T>
+class NewDelete
+{
+public:
+    std::unique_ptr<T> reserve() {return std::unique_ptr<T>(new T());}
+    void release(std::unique_ptr<T>&& object) {object.reset();}
+};
+
+
+// Returns best time of reserve + release pairs in ns. Burst objects are
+// reserved before releasing them.
+template <class Pool, class T>
+double timePool(Pool& pool, std::size_t pairs, std::size_t burst)
+{
+    std::vector<std::unique_ptr<T> > held(burst);
+    std::uint64_t sink = 0;
+    double best = 0;
+    for (unsigned r = 0; r < 5; ++r){
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < pairs; i += burst){
+            for (std::size_t k = 0; k < burst; ++k){
+                held[k] = pool.reserve();
+                held[k]->data[0] = i + k;
+            }
+            for (std::size_t k = 0; k < burst; ++k){
+                sink += held[k]->data[0];
+                pool.release(std::move(held[k]));
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (r == 0 || ns < best){
+            best = ns;
+        }
+    }
+    // Keep sink alive.
+    if (sink == 42){
+        std::cout << "";
+    }
+    return best / pairs;
+}
+
+
+template <unsigned Bytes>
+void benchmarkSize(std::size_t pairs, std::size_t burst)
+{
+    typedef Payload<Bytes> T;
+
+    NewDelete<T> new_delete;
+    PPUtils::UniformObjectPool<T> uniform;
+    PPUtils::ConcurrentUniformObjectPool<T> concurrent;
+    PPUtils::BasicUniformObjectPool<T> basic;
+    PPUtils::BasicUniformObjectPool<T, PPUtils::DefaultBuilder<T>,
+            PPUtils::FixedStorage<T, 1024> > fixed;
+    PPUtils::BasicUniformObjectPool<T, PPUtils::DefaultBuilder<T>,
+            PPUtils::VectorStorage<T>, PPUtils::SpinLock> spin;
+    PPUtils::BasicUniformObjectPool<T, PPUtils::DefaultBuilder<T>,
+            PPUtils::VectorStorage<T>, PPUtils::MutexLock> mutex;
+
+    std::cout << std::setw(6) << Bytes
+              << std::setw(7) << burst
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << timePool<NewDelete<T>, T>(new_delete, pairs, burst)
+              << std::setw(12) << timePool<PPUtils::UniformObjectPool<T>, T>(uniform, pairs, burst)
+              << std::setw(12) << timePool<PPUtils::ConcurrentUniformObjectPool<T>, T>(concurrent, pairs, burst)
+              << std::setw(12) << timePool<decltype(basic), T>(basic, pairs, burst)
+              << std::setw(12) << timePool<decltype(fixed), T>(fixed, pairs, burst)
+              << std::setw(12) << timePool<decltype(spin), T>(spin, pairs, burst)
+              << std::setw(12) << timePool<decltype(mutex), T>(mutex, pairs, burst)
+              << std::endl;
+}
+
+
+int main()
+{
+    const std::size_t pairs = 4000000;
+
+    std::cout << std::setw(6) << "bytes"
+              << std::setw(7) << "burst"
+              << std::setw(12) << "new/delete"
+              << std::setw(12) << "Uniform"
+              << std::setw(12) << "Concurrent"
+              << std::setw(12) << "Basic"
+              << std::setw(12) << "Fixed"
+              << std::setw(12) << "Spin"
+              << std::setw(12) << "Mutex" << std::endl;
+
+    for (std::size_t burst : {1, 64, 1000}){
+        benchmarkSize<64>(pairs, burst);
+        benchmarkSize<1024>(pairs, burst);
+        benchmarkSize<16384>(pairs, burst);
+    }
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Benchmark for PPUtils::StaticSearchIndex.
+#
+#-------------------------------------------------
+
+QT       -= core
+
+QT       -= gui
+
+TARGET = SearchBenchmark
+CONFIG   += console c++11 release
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../source/PPUtils
+
+SOURCES += searchbenchmark.cc \
+           ../../source/PPUtils/parallel.cc
+
+HEADERS += \
+    ../../source/PPUtils/algo.hh \
+    ../../source/PPUtils/algo_impl.hh \
+    ../../source/PPUtils/parallel.hh \
+    ../../source/PPUtils/parallel_impl.hh
@@ -0,0 +1,118 @@
+/* SearchBenchmark
+ * This program compares lookups in PPUtils::StaticSearchIndex, one query at
+ * a time and batched, to std::lower_bound in a sorted std::vector. Working
+ * sets are chosen to fit L1, L2 and L3 cache and to exceed them (DRAM).
+ * Default sizes can be replaced by giving working set sizes in KiB as 
+ * arguments, for example: SearchBenchmark 32 1024 65536 1048576
+ *
+ * Build in release mode. Times are the best of several repetitions, given in
+ * nanoseconds per query.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include "algo.hh"
+
+
+// Returns best time of repeats runs of search in ns/query.
+template <class Search>
+double timeSearch(std::size_t queries, unsigned repeats, Search search)
+{
+    double best = 0;
+    for (unsigned i=0; i<repeats; ++i){
+        auto start = std::chrono::steady_clock::now();
+        search();
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (i == 0 || ns < best){
+            best = ns;
+        }
+    }
+    return best / queries;
+}
+
+
+void benchmarkWorkingSet(const char* name, std::size_t kib)
+{
+    typedef std::uint32_t Key;
+    const std::size_t n = kib * 1024 / sizeof(Key);
+    const std::size_t queries = 1 << 20;
+    std::mt19937 gen(n);
+
+    std::vector<Key> sorted(n);
+    for (Key& k : sorted){
+        k = gen();
+    }
+    std::sort(sorted.begin(), sorted.end());
+    PPUtils::StaticSearchIndex<Key> index(sorted.begin(), sorted.end());
+
+    std::vector<Key> q(queries);
+    for (Key& k : q){
+        k = gen();
+    }
+    std::vector<std::size_t> result(queries);
+
+    // Sum of positions keeps the searches from being optimized away.
+    std::size_t check[3] = {0, 0, 0};
+    double lower_bound = timeSearch(queries, 3, [&]()
+    {
+        for (std::size_t i = 0; i < queries; ++i){
+            result[i] = std::lower_bound(sorted.begin(), sorted.end(), q[i]) 
+                    - sorted.begin();
+        }
+        check[0] = std::accumulate(result.begin(), result.end(), std::size_t(0));
+    });
+    double single = timeSearch(queries, 3, [&]()
+    {
+        for (std::size_t i = 0; i < queries; ++i){
+            result[i] = index.lowerBound(q[i]);
+        }
+        check[1] = std::accumulate(result.begin(), result.end(), std::size_t(0));
+    });
+    double batched = timeSearch(queries, 3, [&]()
+    {
+        index.lowerBound(q.begin(), q.end(), result.begin());
+        check[2] = std::accumulate(result.begin(), result.end(), std::size_t(0));
+    });
+
+    std::cout << std::setw(6) << name
+              << std::setw(12) << kib
+              << std::setw(14) << std::fixed << std::setprecision(2) << lower_bound
+              << std::setw(14) << single
+              << std::setw(14) << batched
+              << std::setw(10) << lower_bound / batched
+              << ((check[0] == check[1] && check[1] == check[2]) ? "" : "  MISMATCH")
+              << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* names[] = {"L1", "L2", "L3", "DRAM"};
+    std::size_t sizes[] = {16, 512, 64 << 10, 1 << 20};
+    for (int i = 1; i < argc && i <= 4; ++i){
+        sizes[i-1] = std::strtoul(argv[i], nullptr, 10);
+    }
+
+    std::cout << std::setw(6) << "level"
+              << std::setw(12) << "KiB"
+              << std::setw(14) << "lower_bound"
+              << std::setw(14) << "index"
+              << std::setw(14) << "batched"
+              << std::setw(10) << "speedup" << std::endl;
+
+    for (int i = 0; i < 4; ++i){
+        benchmarkWorkingSet(names[i], sizes[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Benchmark for the sorting algorithms in algo.hh.
+#
+#-------------------------------------------------
+
+QT       -= core
+
+QT       -= gui
+
+TARGET = SortBenchmark
+CONFIG   += console c++11 release
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../source/PPUtils
+
+SOURCES += sortbenchmark.cc \
+           ../../source/PPUtils/parallel.cc
+
+HEADERS += \
+    ../../source/PPUtils/algo.hh \
+    ../../source/PPUtils/algo_impl.hh \
+    ../../source/PPUtils/parallel.hh \
+    ../../source/PPUtils/parallel_impl.hh
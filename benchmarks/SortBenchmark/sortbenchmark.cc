@@ -0,0 +1,244 @@
+/* SortBenchmark
+ * This program compares the running time of PPUtils::mergeSort to
+ * std::stable_sort with different range widths and element sizes, and reports
+ * how PPUtils::parallelMergeSort scales with the number of threads. 
+ * PPUtils::adaptiveMergeSort is compared to them with sorted, reversed,
+ * sawtooth and random input. mergeSort with a limited memory budget (block
+ * and rotation merges) is compared to the buffered mergeSort.
+ *
+ * Build in release mode. Times are the best of several repetitions, given in
+ * nanoseconds per element.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <cmath>
+#include "algo.hh"
+
+
+// Sorted record of Bytes bytes. Only the key takes part in comparisons.
+template <unsigned Bytes>
+struct Record
+{
+    std::uint32_t key;
+    char payload[Bytes - sizeof(std::uint32_t)];
+
+    bool operator < (const Record& other) const {return key < other.key;}
+};
+
+template <>
+struct Record<4>
+{
+    std::uint32_t key;
+
+    bool operator < (const Record& other) const {return key < other.key;}
+};
+
+
+// Returns best time of repeats runs of sort on copies of input in ns/element.
+template <class T, class Sort>
+double timeSort(const std::vector<T>& input, unsigned repeats, Sort sort)
+{
+    double best = 0;
+    for (unsigned i=0; i<repeats; ++i){
+        std::vector<T> v(input);
+        auto start = std::chrono::steady_clock::now();
+        sort(v);
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (i == 0 || ns < best){
+            best = ns;
+        }
+    }
+    return input.empty() ? 0 : best / input.size();
+}
+
+
+template <unsigned Bytes>
+void benchmarkElementSize(const std::vector<std::size_t>& widths)
+{
+    using T = Record<Bytes>;
+    std::mt19937 gen(Bytes);
+
+    for (std::size_t n : widths){
+        std::vector<T> input(n);
+        for (T& t : input){
+            t.key = gen();
+        }
+        unsigned repeats = n < 100000 ? 20 : 3;
+
+        double merge = timeSort(input, repeats, [](std::vector<T>& v)
+        {
+            PPUtils::mergeSort(v.begin(), v.end());
+        });
+        double stable = timeSort(input, repeats, [](std::vector<T>& v)
+        {
+            std::stable_sort(v.begin(), v.end());
+        });
+
+        std::cout << std::setw(6) << Bytes
+                  << std::setw(10) << n
+                  << std::setw(14) << std::fixed << std::setprecision(2) << merge
+                  << std::setw(14) << stable
+                  << std::setw(10) << merge / stable << std::endl;
+    }
+}
+
+
+// Prints mergeSort, adaptiveMergeSort and std::stable_sort times with 
+// different input distributions.
+void benchmarkDistributions(std::size_t n)
+{
+    using T = Record<4>;
+    std::mt19937 gen(n);
+    const char* names[] = {"sorted", "reversed", "sawtooth", "random"};
+
+    std::cout << std::endl << std::setw(10) << "input"
+              << std::setw(10) << "n"
+              << std::setw(14) << "mergeSort"
+              << std::setw(14) << "adaptive"
+              << std::setw(14) << "stable_sort" << std::endl;
+
+    for (unsigned d = 0; d < 4; ++d){
+        std::vector<T> input(n);
+        for (std::size_t i = 0; i < n; ++i){
+            switch (d){
+            case 0: input[i].key = i; break;
+            case 1: input[i].key = n - i; break;
+            case 2: input[i].key = i % 1000; break;
+            default: input[i].key = gen();
+            }
+        }
+        double merge = timeSort(input, 3, [](std::vector<T>& v)
+        {
+            PPUtils::mergeSort(v.begin(), v.end());
+        });
+        double adaptive = timeSort(input, 3, [](std::vector<T>& v)
+        {
+            PPUtils::adaptiveMergeSort(v.begin(), v.end());
+        });
+        double stable = timeSort(input, 3, [](std::vector<T>& v)
+        {
+            std::stable_sort(v.begin(), v.end());
+        });
+
+        std::cout << std::setw(10) << names[d]
+                  << std::setw(10) << n
+                  << std::setw(14) << std::fixed << std::setprecision(2) << merge
+                  << std::setw(14) << adaptive
+                  << std::setw(14) << stable << std::endl;
+    }
+}
+
+
+// Prints mergeSort times with unlimited memory, a buffer of sqrt(n) and
+// sqrt(n)/4 elements, and no buffer at all.
+template <unsigned Bytes>
+void benchmarkMemoryBudget(const std::vector<std::size_t>& widths)
+{
+    using T = Record<Bytes>;
+    std::mt19937 gen(Bytes);
+
+    for (std::size_t n : widths){
+        std::vector<T> input(n);
+        for (T& t : input){
+            t.key = gen();
+        }
+        const std::size_t root = static_cast<std::size_t>(std::sqrt(n));
+        const std::size_t budgets[] = {PPUtils::MERGESORT_UNLIMITED_MEMORY,
+                                       root * sizeof(T),
+                                       root / 4 * sizeof(T), 0};
+
+        std::cout << std::setw(6) << Bytes << std::setw(10) << n;
+        double buffered = 0;
+        for (std::size_t budget : budgets){
+            double ns = timeSort(input, 3, [budget](std::vector<T>& v)
+            {
+                PPUtils::mergeSort(v.begin(), v.end(), std::less<T>(), budget);
+            });
+            if (budget == PPUtils::MERGESORT_UNLIMITED_MEMORY){
+                buffered = ns;
+            }
+            std::cout << std::setw(12) << std::fixed << std::setprecision(2)
+                      << ns << std::setw(6) << std::setprecision(2)
+                      << ns / buffered;
+        }
+        std::cout << std::endl;
+    }
+}
+
+
+// Prints parallelMergeSort times with 1 to max_threads threads.
+void benchmarkScaling(std::size_t n, unsigned max_threads)
+{
+    using T = Record<16>;
+    std::mt19937 gen(n);
+    std::vector<T> input(n);
+    for (T& t : input){
+        t.key = gen();
+    }
+
+    std::cout << std::endl << std::setw(8) << "threads"
+              << std::setw(10) << "n"
+              << std::setw(14) << "ns/element"
+              << std::setw(10) << "speedup" << std::endl;
+
+    double single = 0;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2){
+        double ns = timeSort(input, 3, [threads](std::vector<T>& v)
+        {
+            PPUtils::parallelMergeSort(v.begin(), v.end(), std::less<T>(),
+                                       threads);
+        });
+        if (threads == 1){
+            single = ns;
+        }
+        std::cout << std::setw(8) << threads
+                  << std::setw(10) << n
+                  << std::setw(14) << std::fixed << std::setprecision(2) << ns
+                  << std::setw(10) << single / ns << std::endl;
+    }
+}
+
+
+int main()
+{
+    std::vector<std::size_t> widths = {8, 16, 32, 64, 100, 1000, 10000,
+                                       100000, 1000000};
+
+    std::cout << std::setw(6) << "bytes"
+              << std::setw(10) << "n"
+              << std::setw(14) << "mergeSort"
+              << std::setw(14) << "stable_sort"
+              << std::setw(10) << "ratio" << std::endl;
+
+    benchmarkElementSize<4>(widths);
+    benchmarkElementSize<16>(widths);
+    benchmarkElementSize<64>(widths);
+    benchmarkElementSize<256>(widths);
+
+    benchmarkDistributions(1000000);
+
+    std::cout << std::endl << std::setw(6) << "bytes"
+              << std::setw(10) << "n"
+              << std::setw(18) << "buffered"
+              << std::setw(18) << "sqrt(n) buf"
+              << std::setw(18) << "sqrt(n)/4 buf"
+              << std::setw(18) << "no buffer" << std::endl;
+    std::vector<std::size_t> budget_widths = {10000, 100000, 1000000};
+    benchmarkMemoryBudget<4>(budget_widths);
+    benchmarkMemoryBudget<64>(budget_widths);
+
+    benchmarkScaling(10000000, 64);
+
+    return 0;
+}
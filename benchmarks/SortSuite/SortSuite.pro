@@ -0,0 +1,28 @@
+#-------------------------------------------------
+#
+# Benchmark suite for all sorts in algo.hh and simdsort.hh. Prints CSV.
+#
+#-------------------------------------------------
+
+QT       -= core
+
+QT       -= gui
+
+TARGET = SortSuite
+CONFIG   += console c++11 release
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../source/PPUtils
+
+SOURCES += sortsuite.cc \
+           ../../source/PPUtils/parallel.cc \
+           ../../source/PPUtils/simdsort.cc
+
+HEADERS += \
+    ../../source/PPUtils/algo.hh \
+    ../../source/PPUtils/algo_impl.hh \
+    ../../source/PPUtils/parallel.hh \
+    ../../source/PPUtils/parallel_impl.hh \
+    ../../source/PPUtils/simdsort.hh
@@ -0,0 +1,445 @@
+/* SortSuite
+ * This program measures every sort of algo.hh and simdsort.hh, and std::sort,
+ * std::stable_sort and std::list::sort for reference, over a grid of
+ * input distributions, element sizes, range widths and containers. Each
+ * result is one CSV line on standard output:
+ *
+ *  sort,container,input,bytes,n,ns_per_element,comparisons_per_element
+ *
+ * Times are the best of several repetitions. Comparisons are counted in a
+ * separate run with a counting comparator, and are left empty for sorts
+ * that do not compare elements. That run also checks that the result is
+ * sorted; failures are reported on standard error and make the exit status
+ * non-zero, so the output can be used to catch regressions.
+ *
+ * Usage: SortSuite [--max-n N] [--max-memory BYTES] [--threads T]
+ *
+ *  --max-n       Largest range width. Widths are 1e2, 1e3, ..., 1e8.
+ *  --max-memory  Widths whose inputs and copies would need more memory than
+ *                this are skipped. Default 2 GiB.
+ *  --threads     Threads of parallelMergeSort. Default: all.
+ *
+ * Build in release mode.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <list>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "algo.hh"
+#include "simdsort.hh"
+
+
+// Sorted record of Bytes bytes. Only the key takes part in comparisons.
+// 4-byte elements are plain keys, so that simdSort can sort them.
+template <unsigned Bytes>
+struct Record
+{
+    std::uint32_t key;
+    char payload[Bytes - sizeof(std::uint32_t)];
+};
+
+template <unsigned Bytes>
+struct Element
+{
+    typedef Record<Bytes> type;
+};
+
+template <>
+struct Element<4>
+{
+    typedef std::uint32_t type;
+};
+
+inline std::uint32_t keyOf(std::uint32_t k) {return k;}
+
+template <unsigned Bytes>
+std::uint32_t keyOf(const Record<Bytes>& r) {return r.key;}
+
+
+struct KeyOf
+{
+    template <class T>
+    std::uint32_t operator()(const T& t) const {return keyOf(t);}
+};
+
+struct Less
+{
+    template <class T>
+    bool operator()(const T& a, const T& b) const {return keyOf(a) < keyOf(b);}
+};
+
+// Less that counts its calls. Relaxed atomic, because parallelMergeSort
+// calls it concurrently.
+struct CountingLess
+{
+    std::atomic<unsigned long long>* count;
+
+    template <class T>
+    bool operator()(const T& a, const T& b) const
+    {
+        count->fetch_add(1, std::memory_order_relaxed);
+        return keyOf(a) < keyOf(b);
+    }
+};
+
+
+struct Options
+{
+    std::size_t max_n;
+    std::size_t max_memory;
+    unsigned threads;
+};
+
+bool failed = false;
+
+
+// Sorts. COMPARES is false for sorts that do not call the comparator.
+
+struct StdSort
+{
+    static const bool COMPARES = true;
+    static const char* name() {return "std::sort";}
+    template <class C, class CMP>
+    void operator()(C& c, const CMP& cmp, const Options&) const
+    {
+        std::sort(c.begin(), c.end(), cmp);
+    }
+};
+
+struct StdStableSort
+{
+    static const bool COMPARES = true;
+    static const char* name() {return "std::stable_sort";}
+    template <class C, class CMP>
+    void operator()(C& c, const CMP& cmp, const Options&) const
+    {
+        std::stable_sort(c.begin(), c.end(), cmp);
+    }
+};
+
+struct ListSort
+{
+    static const bool COMPARES = true;
+    static const char* name() {return "std::list::sort";}
+    template <class T, class CMP>
+    void operator()(std::list<T>& c, const CMP& cmp, const Options&) const
+    {
+        c.sort(cmp);
+    }
+};
+
+struct MergeSort
+{
+    static const bool COMPARES = true;
+    static const char* name() {return "mergeSort";}
+    template <class C, class CMP>
+    void operator()(C& c, const CMP& cmp, const Options&) const
+    {
+        PPUtils::mergeSort(c.begin(), c.end(), cmp);
+    }
+};
+
+// mergeSort with a buffer of sqrt(n) elements.
+struct BlockMergeSort
+{
+    static const bool COMPARES = true;
+    static const char* name() {return "mergeSort(sqrt budget)";}
+    template <class C, class CMP>
+    void operator()(C& c, const CMP& cmp, const Options&) const
+    {
+        const std::size_t root = static_cast<std::size_t>(std::sqrt(c.size()));
+        PPUtils::mergeSort(c.begin(), c.end(), cmp,
+                           root * sizeof(typename C::value_type));
+    }
+};
+
+struct InsertionSort
+{
+    static const bool COMPARES = true;
+    static const char* name() {return "insertionSort";}
+    template <class C, class CMP>
+    void operator()(C& c, const CMP& cmp, const Options&) const
+    {
+        PPUtils::insertionSort(c.begin(), c.end(), cmp);
+    }
+};
+
+struct ParallelMergeSort
+{
+    static const bool COMPARES = true;
+    static const char* name() {return "parallelMergeSort";}
+    template <class C, class CMP>
+    void operator()(C& c, const CMP& cmp, const Options& opt) const
+    {
+        PPUtils::parallelMergeSort(c.begin(), c.end(), cmp, opt.threads);
+    }
+};
+
+struct AdaptiveMergeSort
+{
+    static const bool COMPARES = true;
+    static const char* name() {return "adaptiveMergeSort";}
+    template <class C, class CMP>
+    void operator()(C& c, const CMP& cmp, const Options&) const
+    {
+        PPUtils::adaptiveMergeSort(c.begin(), c.end(), cmp);
+    }
+};
+
+struct SortByKey
+{
+    static const bool COMPARES = true;
+    static const char* name() {return "sortByKey";}
+    template <class C, class CMP>
+    void operator()(C& c, const CMP& cmp, const Options&) const
+    {
+        // Compare keys, not elements.
+        auto key_cmp = [&cmp](std::uint32_t a, std::uint32_t b){return cmp(a, b);};
+        PPUtils::sortByKey(c.begin(), c.end(), KeyOf(), key_cmp);
+    }
+};
+
+struct RadixSort
+{
+    static const bool COMPARES = false;
+    static const char* name() {return "radixSort";}
+    template <class C, class CMP>
+    void operator()(C& c, const CMP&, const Options&) const
+    {
+        PPUtils::radixSort(c.begin(), c.end(), KeyOf());
+    }
+};
+
+struct SimdSort
+{
+    static const bool COMPARES = false;
+    static const char* name() {return "simdSort";}
+    template <class CMP>
+    void operator()(std::vector<std::uint32_t>& c, const CMP&, const Options&) const
+    {
+        if (!c.empty()){
+            PPUtils::simdSort(c.data(), c.data() + c.size());
+        }
+    }
+};
+
+
+template <class C>
+bool isSorted(const C& c)
+{
+    return std::is_sorted(c.begin(), c.end(), Less());
+}
+
+
+// Times sort on copies of input and prints one CSV line.
+template <class C, class Sort>
+void run(const char* container, const char* distribution,
+         const std::vector<typename C::value_type>& input,
+         const Options& opt)
+{
+    const std::size_t n = input.size();
+    const Sort sort = Sort();
+    const unsigned repeats = static_cast<unsigned>(
+                std::max<std::size_t>(1, std::min<std::size_t>(10, 10000000 / n)));
+
+    double best = 0;
+    for (unsigned i = 0; i < repeats; ++i){
+        C c(input.begin(), input.end());
+        auto start = std::chrono::steady_clock::now();
+        sort(c, Less(), opt);
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (i == 0 || ns < best){
+            best = ns;
+        }
+    }
+
+    std::atomic<unsigned long long> count(0);
+    CountingLess counting;
+    counting.count = &count;
+    C c(input.begin(), input.end());
+    sort(c, counting, opt);
+    if (!isSorted(c)){
+        std::cerr << "Not sorted: " << Sort::name() << " " << container << " "
+                  << distribution << " n=" << n << std::endl;
+        failed = true;
+    }
+
+    std::cout << Sort::name() << ',' << container << ',' << distribution << ','
+              << sizeof(typename C::value_type) << ',' << n << ','
+              << best / n << ',';
+    if (Sort::COMPARES){
+        std::cout << static_cast<double>(count.load()) / n;
+    }
+    std::cout << std::endl;
+}
+
+
+// simdSort only sorts plain 32-bit keys.
+template <class T>
+void runSimd(const char*, const std::vector<T>&, const Options&)
+{
+}
+
+inline void runSimd(const char* distribution,
+                    const std::vector<std::uint32_t>& input, const Options& opt)
+{
+    run<std::vector<std::uint32_t>, SimdSort>("vector", distribution, input, opt);
+}
+
+
+template <class T>
+void benchmarkInput(const char* distribution, const std::vector<T>& input,
+                    const Options& opt)
+{
+    typedef std::vector<T> V;
+    typedef std::deque<T> D;
+    typedef std::list<T> L;
+
+    run<V, StdSort>("vector", distribution, input, opt);
+    run<V, StdStableSort>("vector", distribution, input, opt);
+    run<V, MergeSort>("vector", distribution, input, opt);
+    run<V, BlockMergeSort>("vector", distribution, input, opt);
+    run<V, ParallelMergeSort>("vector", distribution, input, opt);
+    run<V, AdaptiveMergeSort>("vector", distribution, input, opt);
+    run<V, SortByKey>("vector", distribution, input, opt);
+    run<V, RadixSort>("vector", distribution, input, opt);
+    runSimd(distribution, input, opt);
+    if (input.size() <= 10000){
+        run<V, InsertionSort>("vector", distribution, input, opt);
+    }
+
+    run<D, StdSort>("deque", distribution, input, opt);
+    run<D, StdStableSort>("deque", distribution, input, opt);
+    run<D, MergeSort>("deque", distribution, input, opt);
+    run<D, BlockMergeSort>("deque", distribution, input, opt);
+    run<D, ParallelMergeSort>("deque", distribution, input, opt);
+    run<D, AdaptiveMergeSort>("deque", distribution, input, opt);
+    run<D, RadixSort>("deque", distribution, input, opt);
+
+    run<L, ListSort>("list", distribution, input, opt);
+    run<L, MergeSort>("list", distribution, input, opt);
+    run<L, BlockMergeSort>("list", distribution, input, opt);
+}
+
+
+// Zipf-distributed ranks 0..m-1 with exponent 1, mapped to scattered keys so
+// that frequent keys are not the smallest ones.
+class ZipfKeys
+{
+public:
+    explicit ZipfKeys(std::size_t m) : cdf_(m)
+    {
+        double sum = 0;
+        for (std::size_t i = 0; i < m; ++i){
+            sum += 1.0 / (i + 1);
+            cdf_[i] = sum;
+        }
+        for (double& c : cdf_){
+            c /= sum;
+        }
+    }
+
+    template <class Gen>
+    std::uint32_t operator()(Gen& gen) const
+    {
+        const double u = std::uniform_real_distribution<double>(0, 1)(gen);
+        const std::size_t rank =
+                std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+        return static_cast<std::uint32_t>(rank * 2654435761u);
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+
+template <unsigned Bytes>
+void benchmarkElementSize(const Options& opt)
+{
+    typedef typename Element<Bytes>::type T;
+    const char* names[] = {"random", "sorted", "reversed", "few-unique",
+                           "zipf", "sawtooth"};
+
+    for (std::size_t n = 100; n <= opt.max_n; n *= 10){
+        // Input, the sorted copy and merge buffers; lists have two pointers
+        // per node.
+        const std::size_t memory = n * (sizeof(T) + 2 * sizeof(void*)) * 3;
+        if (memory > opt.max_memory){
+            break;
+        }
+        std::mt19937 gen(n + Bytes);
+        ZipfKeys zipf(std::min<std::size_t>(n, 1 << 20));
+        const std::size_t tooth = std::max<std::size_t>(1, n / 8);
+
+        for (unsigned d = 0; d < 6; ++d){
+            std::vector<T> input(n);
+            for (std::size_t i = 0; i < n; ++i){
+                std::uint32_t key = 0;
+                switch (d){
+                case 0: key = gen(); break;
+                case 1: key = i; break;
+                case 2: key = n - i; break;
+                case 3: key = gen() % 16; break;
+                case 4: key = zipf(gen); break;
+                default: key = i % tooth;
+                }
+                std::memset(&input[i], 0, sizeof(T));
+                std::memcpy(&input[i], &key, sizeof(key));
+            }
+            benchmarkInput(names[d], input, opt);
+        }
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    opt.max_n = 100000000;
+    opt.max_memory = std::size_t(2) << 30;
+    opt.threads = 0;
+
+    for (int i = 1; i < argc; i += 2){
+        if (i + 1 == argc){
+            std::cerr << "Missing value of " << argv[i] << std::endl;
+            return 2;
+        }
+        else if (std::strcmp(argv[i], "--max-n") == 0){
+            opt.max_n = std::strtoull(argv[i+1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--max-memory") == 0){
+            opt.max_memory = std::strtoull(argv[i+1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0){
+            opt.threads = std::strtoul(argv[i+1], nullptr, 10);
+        }
+        else {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            return 2;
+        }
+    }
+
+    std::cout << "sort,container,input,bytes,n,ns_per_element,"
+                 "comparisons_per_element" << std::endl;
+    benchmarkElementSize<4>(opt);
+    benchmarkElementSize<8>(opt);
+    benchmarkElementSize<16>(opt);
+    benchmarkElementSize<64>(opt);
+    benchmarkElementSize<256>(opt);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+/* ExternalSortExample
+ * This is an example program to demonstrate the PPUtils::ExternalSorter class
+ * template. Records are sorted with a memory budget that is much smaller than
+ * the data, so the sort goes through temporary run files.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <iterator>
+#include <cstdint>
+#include "../../source/PPUtils/externalsort.hh"
+
+
+struct Record
+{
+    std::uint32_t key;
+    char payload[60];
+};
+
+struct RecordLess
+{
+    bool operator()(const Record& a, const Record& b) const
+    {
+        return a.key < b.key;
+    }
+};
+
+
+int main()
+{
+    std::vector<Record> records(100000);
+    std::mt19937 gen;
+    for (Record& r : records){
+        r.key = gen() % 1000;
+    }
+
+    // 1 MiB of buffers for 6.4 MB of records. Runs are written to /tmp.
+    PPUtils::ExternalSorter<Record, RecordLess> sorter(1 << 20, "/tmp");
+
+    std::vector<Record> sorted;
+    sorter.sort(records.begin(), records.end(), std::back_inserter(sorted));
+
+    std::cout << "Sorted " << sorted.size() << " records. First keys: ";
+    for (int i=0; i<5; ++i){
+        std::cout << sorted[i].key << " ";
+    }
+    std::cout << std::endl;
+
+    return 0;
+}
+
+
+/* Expected output:
+ *
+ * Sorted 100000 records. First keys: 0 0 0 0 0
+ */
@@ -35,7 +35,7 @@ void ActiveObject::start()
     std::lock_guard<std::mutex> lock(mx_);
     if (stop_flag_){
         stop_flag_ = false;
-        thread_ = std::move(std::thread(ActiveObject::actionLoop, this));
+        thread_ = std::move(std::thread(&ActiveObject::actionLoop, this));
     }
 }
 
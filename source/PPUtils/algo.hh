@@ -2,10 +2,75 @@
 #define ALGO_HH
 
 #include <functional>
+#include <iterator>
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <array>
+#include <type_traits>
+#include "parallel.hh"
 
 namespace PPUtils
 {
-    
+
+/*!
+ * \brief Ranges not longer than this are sorted using binary insertion sort
+ *  instead of splitting them further. Merge passes start from runs of this 
+ *  length.
+ */
+const std::size_t MERGESORT_INSERTION_THRESHOLD = 32;
+
+/*!
+ * \brief Widest range the merge sorts sort with a sorting network instead of
+ *  insertion sort. See networkSort.
+ */
+const std::size_t SORTING_NETWORK_MAX_WIDTH = 32;
+
+/*!
+ * \brief parallelMergeSort gives each thread at least this many elements to
+ *  sort. Narrower ranges are sorted using fewer threads.
+ */
+const std::size_t PARALLEL_MERGESORT_MIN_CHUNK = 1 << 14;
+
+/*!
+ * \brief adaptiveMergeSort switches to galloping mode after this many
+ *  consecutive elements have been taken from the same run.
+ */
+const std::size_t ADAPTIVE_MERGESORT_MIN_GALLOP = 7;
+
+/*!
+ * \brief Default memory budget of mergeSort: the auxiliary buffer may be as
+ *  large as the sort needs.
+ */
+const std::size_t MERGESORT_UNLIMITED_MEMORY = static_cast<std::size_t>(-1);
+
+/*!
+ * \brief radixSort uses 11-bit digits instead of 8-bit digits for 32- and 
+ *  64-bit keys when the range has at least this many elements.
+ */
+const std::size_t RADIXSORT_WIDE_DIGIT_MIN_RANGE = 1 << 16;
+
+/*!
+ * \brief Number of queries StaticSearchIndex searches simultaneously in a
+ *  batched lowerBound.
+ */
+const std::size_t STATIC_SEARCH_BATCH = 16;
+
+
+static_assert(MERGESORT_INSERTION_THRESHOLD <= SORTING_NETWORK_MAX_WIDTH,
+              "Merge sort runs must fit into sorting networks.");
+
+
+/*!
+ * \brief Key extractor that returns the element itself. Default key extractor
+ *  of radixSort.
+ */
+struct IdentityKey
+{
+    template <class T>
+    const T& operator()(const T& t) const {return t;}
+};
+
 
 /*!
  * \brief The generic merge-sort algorithm.
@@ -23,6 +88,8 @@ namespace PPUtils
  * \param first Iterator to the first element in range to be sorted.
  * \param last Pass-end iterator pointing to the end of range to be sorted.
  * \param cmp The comparator that defines element's relative order.
+ * \param memory_budget Maximum size of the auxiliary element buffer in bytes.
+ *  If the buffered sort needs more, the sort is done in place (see below).
  * 
  * \pre @p first' points to a legal element before or to the same as @p last.
  *  @p last can be reached by incrementing @p first finite times.
@@ -40,14 +107,783 @@ namespace PPUtils
  *  range from @p first to @p last stay valid, but their referred object may 
  *  change.
  *  
- *  Complexity: time O(N log N), memory O(N). N is range width.
+ *  Implementation: Ranges shorter than MERGESORT_INSERTION_THRESHOLD are
+ *  sorted with binary insertion sort. For random access iterators the sort
+ *  is done bottom-up without recursion: runs of MERGESORT_INSERTION_THRESHOLD
+ *  elements are insertion sorted and then merged pairwise back and forth
+ *  between the range and one auxiliary buffer. Other iterators use top-down
+ *  recursion with the same single auxiliary buffer. The sort is stable.
+ *  Integers compared with std::less or std::greater are sorted with sorting
+ *  networks instead of insertion sort (see networkSort).
+ *
+ *  The buffered sort needs N elements of auxiliary memory for random access
+ *  iterators and N/2 for others. If that is more than @p memory_budget
+ *  allows, runs are merged in place using a buffer of at most
+ *  @p memory_budget bytes. For random access iterators, when the buffer holds
+ *  at least sqrt(N) elements, runs are merged with a block merge (as in
+ *  WikiSort): blocks of the left run are rolled through the right run in
+ *  sqrt-sized blocks and dropped where they belong, and each dropped block
+ *  is merged locally with the buffer. Narrower merges, smaller buffers and
+ *  other iterators split the merge by binary search and rotation until the
+ *  pieces fit the buffer. With @p memory_budget 0 the sort uses O(1) extra
+ *  memory.
+ *  
+ *  Complexity: time O(N log N), memory O(N) with unlimited budget. Block
+ *  merge: time O(N log N), memory O(sqrt N). Rotation merge: time
+ *  O(N log^2 N), memory O(budget). N is range width.
  *  
  * \exception std::bad_alloc, if memory allocation fails. May throw also if 
  *  FwrdIter's value type is not no-throw move-assignable and no-throw 
  *  default-constructible.
  */
-template <class FwrdIter, class CMP = std::less<typename FwrdIter::value_type> >
-void mergeSort(FwrdIter first, FwrdIter last, const CMP& cmp = CMP());
+template <class FwrdIter, 
+          class CMP = std::less<typename std::iterator_traits<FwrdIter>::value_type> >
+void mergeSort(FwrdIter first, FwrdIter last, const CMP& cmp = CMP(),
+               std::size_t memory_budget = MERGESORT_UNLIMITED_MEMORY);
+
+
+/*!
+ * \brief Stable binary insertion sort. Used by mergeSort for short ranges,
+ *  but may be used directly for ranges known to be short.
+ *  
+ *  Type arguments are the same as in mergeSort.
+ * 
+ * \param first Iterator to the first element in range to be sorted.
+ * \param last Pass-end iterator pointing to the end of range to be sorted.
+ * \param cmp The comparator that defines element's relative order.
+ * \pre Same as in mergeSort.
+ * \post Range from @p first to @p last is sorted in order defined by @p cmp.
+ *  Equal elements keep their relative order.
+ * 
+ *  Complexity: O(N log N) comparisons, O(N^2) moves, memory O(1).
+ */
+template <class FwrdIter, 
+          class CMP = std::less<typename std::iterator_traits<FwrdIter>::value_type> >
+void insertionSort(FwrdIter first, FwrdIter last, const CMP& cmp = CMP());
+
+
+
+/*!
+ * \brief Sort a fixed-size array with a sorting network.
+ *  The network is Batcher's merge exchange for N elements, generated and 
+ *  fully unrolled at compile time. It is optimal up to N = 8 and close to 
+ *  the best known networks above that (191 compare-exchanges for N = 32 
+ *  against 185). Compare-exchanges of trivially copyable types are 
+ *  branchless selects, so for numbers they compile to min/max instructions
+ *  and adjacent independent compare-exchanges can be vectorized.
+ *  
+ *  mergeSort and parallelMergeSort use networks instead of insertion sort 
+ *  for runs of at most SORTING_NETWORK_MAX_WIDTH integers compared with 
+ *  std::less or std::greater, where stability cannot be observed.
+ *  
+ *  Type arguments:
+ *  
+ *  T: Element type. Must be move-constructible and move-assignable, or 
+ *  swappable.
+ *  
+ *  CMP: Same as in mergeSort.
+ * 
+ * \param a Sorted array.
+ * \param cmp The comparator that defines element's relative order.
+ * \pre None.
+ * \post @p a is sorted in order defined by @p cmp. The sort is not stable.
+ * 
+ *  Complexity: sortingNetworkSize(N) comparisons, O(N log^2 N).
+ */
+template <class T, std::size_t N,
+          class CMP = std::less<T> >
+void networkSort(std::array<T, N>& a, const CMP& cmp = CMP());
+
+
+/*!
+ * \brief Sort N elements starting from @p first with a sorting network.
+ *  Same as above for a fixed-size range. N must be given explicitly, like in
+ *  networkSort<4>(ptr).
+ * \pre Range from @p first to @p first + N is valid.
+ * \post Range is sorted in order defined by @p cmp. The sort is not stable.
+ */
+template <std::size_t N, class RandIter,
+          class CMP = std::less<typename std::iterator_traits<RandIter>::value_type> >
+void networkSort(RandIter first, const CMP& cmp = CMP());
+
+
+/*!
+ * \brief Return the number of compare-exchanges in the sorting network 
+ *  networkSort uses for @p n elements. Usable in constant expressions.
+ */
+constexpr std::size_t sortingNetworkSize(std::size_t n);
+
+
+
+/*!
+ * \brief Parallel version of mergeSort.
+ *  The range is split into one chunk per thread, and the chunks are sorted
+ *  concurrently. Sorted chunks are then merged pairwise until one run is left.
+ *  Each pairwise merge is split into independent parts using co-rank (merge
+ *  path) partitioning, so that all threads work also in the last merges.
+ *  
+ *  Type arguments:
+ *  
+ *  RandIter: STL-compatible random access iterator. Value type requirements 
+ *  are the same as in mergeSort.
+ *  
+ *  CMP: Same as in mergeSort. @p cmp is called concurrently from several
+ *  threads, so it must be safe to do so.
+ * 
+ * \param first Iterator to the first element in range to be sorted.
+ * \param last Pass-end iterator pointing to the end of range to be sorted.
+ * \param cmp The comparator that defines element's relative order.
+ * \param threads Maximum number of threads used (calling thread included).
+ *  If 0, std::thread::hardware_concurrency() threads are used.
+ * 
+ * \pre Same as in mergeSort.
+ * \post Range from @p first to @p last is sorted in order defined by @p cmp.
+ *  The sort is stable. The result is independent of @p threads.
+ * 
+ *  Exception guarantee: Basic guarantee. If any thread throws, the first 
+ *  exception is rethrown in the calling thread after all threads are joined.
+ *  
+ *  Complexity: time O(N log N / P + P log N), memory O(N). One auxiliary
+ *  buffer of N elements is shared by all threads and merge rounds.
+ * 
+ * \exception std::bad_alloc, if memory allocation fails. std::system_error,
+ *  if threads cannot be started. Exceptions thrown by @p cmp or value type's
+ *  move-assignment.
+ */
+template <class RandIter, 
+          class CMP = std::less<typename std::iterator_traits<RandIter>::value_type> >
+void parallelMergeSort(RandIter first, RandIter last, const CMP& cmp = CMP(),
+                       unsigned threads = 0);
+
+
+
+/*!
+ * \brief Run-adaptive stable merge sort (TimSort) for partially sorted data.
+ *  Natural ascending and strictly descending runs are detected and used as
+ *  they are (descending runs are reversed). Short runs are extended with
+ *  binary insertion sort. Runs are merged using a stack based policy that
+ *  keeps merges balanced. Merges that keep taking elements from the same run
+ *  switch to galloping (exponential search), so merging skewed runs costs
+ *  about O(log N) comparisons instead of O(N).
+ *  
+ *  Type arguments:
+ *  
+ *  RandIter: STL-compatible random access iterator. Value type requirements 
+ *  are the same as in mergeSort.
+ *  
+ *  CMP: Same as in mergeSort.
+ * 
+ * \param first Iterator to the first element in range to be sorted.
+ * \param last Pass-end iterator pointing to the end of range to be sorted.
+ * \param cmp The comparator that defines element's relative order.
+ * 
+ * \pre Same as in mergeSort.
+ * \post Range from @p first to @p last is sorted in order defined by @p cmp.
+ *  The sort is stable.
+ * 
+ *  Exception guarantee: Basic guarantee.
+ *  
+ *  Complexity: time O(N log N) in the worst case and O(N) for sorted, 
+ *  reversed or otherwise few-run input. Memory O(N/2) in the worst case.
+ * 
+ * \exception std::bad_alloc, if memory allocation fails. Exceptions thrown by
+ *  @p cmp or value type's move-assignment.
+ */
+template <class RandIter, 
+          class CMP = std::less<typename std::iterator_traits<RandIter>::value_type> >
+void adaptiveMergeSort(RandIter first, RandIter last, const CMP& cmp = CMP());
+
+
+
+/*!
+ * \brief Stable LSD radix sort for numeric keys.
+ *  Keys are mapped to unsigned integers preserving their order: the sign bit
+ *  of signed integers is flipped, and IEEE floats have either all bits (if 
+ *  negative) or the sign bit (otherwise) flipped. Keys are then sorted one 
+ *  8-bit digit (11-bit for wide keys and long ranges) at a time, starting 
+ *  from the least significant digit. Histograms for all digits are counted in
+ *  one read of the range before the first pass, and passes whose digit is the
+ *  same for every element are skipped.
+ *  
+ *  Type arguments:
+ *  
+ *  RandIter: STL-compatible random access iterator. Value type must be 
+ *  default-constructible and move-assignable.
+ *  
+ *  KeyFn: Callable object that takes constant reference to RandIter's value
+ *  type and returns its sorting key. Key type must be an integral or a
+ *  floating point type (bool excluded) of at most 64 bits. The default 
+ *  IdentityKey sorts ranges of numbers by their value.
+ * 
+ * \param first Iterator to the first element in range to be sorted.
+ * \param last Pass-end iterator pointing to the end of range to be sorted.
+ * \param key Key extractor. Called several times for each element.
+ * \param threads Maximum number of threads used to count the histograms
+ *  (calling thread included). If 0, std::thread::hardware_concurrency() 
+ *  threads are used. Element moves are done in the calling thread.
+ * 
+ * \pre Same as in mergeSort. @p key returns the same key for the same 
+ *  element every time. If @p threads != 1, it must be safe to call @p key 
+ *  concurrently.
+ * \post Range from @p first to @p last is sorted to ascending key order. 
+ *  The sort is stable. Floating point keys are ordered by their bits: -0.0
+ *  precedes 0.0, negative NaNs are first and positive NaNs last.
+ * 
+ *  Exception guarantee: Basic guarantee.
+ *  
+ *  Complexity: time O(N * W / D), where W is key width and D digit width in 
+ *  bits. Memory O(N).
+ * 
+ * \exception std::bad_alloc, if memory allocation fails. std::system_error, if
+ *  threads cannot be started. Exceptions thrown by @p key or value type's 
+ *  move-assignment.
+ */
+template <class RandIter, class KeyFn = IdentityKey>
+void radixSort(RandIter first, RandIter last, const KeyFn& key = KeyFn(),
+               unsigned threads = 1);
+
+
+
+/*!
+ * \brief The LoserTree class template
+ *  Tournament tree that merges k sorted sources. Each internal node stores
+ *  the loser of the match played there, and the overall winner is kept 
+ *  separately. Popping the winner replays only the matches on the path from
+ *  its source to the root, so producing one element costs ceil(log2 k) 
+ *  comparisons. Exhausted sources act as sentinels that lose every match.
+ *  Equal elements are produced in source order, so the merge is stable.
+ *  
+ *  LoserTree is itself a Source, so trees can be stacked.
+ *  
+ *  Type arguments:
+ *  
+ *  Source: Pull-based sorted element stream. Must provide:
+ *   - typedef value_type
+ *   - bool empty() const: true, if the source is exhausted.
+ *   - const value_type& front() const: current element, if not empty.
+ *   - void pop(): advance to the next element, if not empty.
+ *   Optionally:
+ *   - value_type take(): return the current element, moved out if the
+ *     source allows it, and advance to the next one. Used by take(). 
+ *     Without it, take() copies front() and pops.
+ *  
+ *  CMP: Same as in mergeSort.
+ *  
+ *  Sources are not owned by the tree. They must outlive it and must not be
+ *  accessed by others while the tree is in use.
+ */
+template <class Source, 
+          class CMP = std::less<typename Source::value_type> >
+class LoserTree
+{
+public:
+    
+    typedef typename Source::value_type value_type;
+    
+    /*!
+     * \brief Constructor. Plays the initial tournament.
+     * \param sources Merged sources.
+     * \param cmp The comparator that defines element's relative order.
+     * \pre All pointers in @p sources are valid. Each source is sorted in
+     *  order defined by @p cmp.
+     * \post front() returns the first element of the merged sequence.
+     */
+    explicit LoserTree(const std::vector<Source*>& sources, 
+                       const CMP& cmp = CMP());
+    
+    /*!
+     * \brief Return true, if all sources are exhausted.
+     */
+    bool empty() const;
+    
+    /*!
+     * \brief Return the smallest current element of all sources.
+     * \pre !empty().
+     */
+    const value_type& front() const;
+    
+    /*!
+     * \brief Return index of the source front() belongs to.
+     * \pre !empty().
+     */
+    std::size_t source() const;
+    
+    /*!
+     * \brief Pop front() from its source and replay the tournament.
+     * \pre !empty().
+     * \post front() is the next element of the merged sequence.
+     */
+    void pop();
+    
+    /*!
+     * \brief Remove front() from its source and return it. The element is 
+     *  moved, if the source provides take() and allows moving.
+     * \pre !empty().
+     * \post front() is the next element of the merged sequence.
+     */
+    value_type take();
+    
+    
+private:
+    
+    std::vector<Source*> sources_;
+    // losers_[0] is the winner, losers_[n] the loser at internal node n.
+    std::vector<std::size_t> losers_;
+    CMP cmp_;
+    
+    // True, if source a wins source b.
+    bool beats(std::size_t a, std::size_t b) const;
+    
+    // Replays the matches of winner, whose source has advanced.
+    void replay(std::size_t winner);
+};
+
+
+/*!
+ * \brief Merge k sorted ranges into @p out using a LoserTree.
+ *  
+ *  Type arguments:
+ *  
+ *  InIter: STL-compatible input iterator.
+ *  
+ *  OutIter: Output iterator accepting InIter's value type. Elements are 
+ *  copied; use std::move_iterator as InIter to move them instead. Element
+ *  types may then be move-only.
+ *  
+ *  CMP: Same as in mergeSort.
+ * 
+ * \param ranges Begin and end iterator of each range.
+ * \param out Beginning of the destination range.
+ * \param cmp The comparator that defines element's relative order.
+ * \return Iterator past the last written element.
+ * \pre Each range is sorted in order defined by @p cmp. Destination does 
+ *  not overlap any range.
+ * \post Elements of all ranges are written to @p out in sorted order. Equal
+ *  elements keep the order of their ranges in @p ranges.
+ * 
+ *  Complexity: O(N log k) comparisons, memory O(k).
+ */
+template <class InIter, class OutIter,
+          class CMP = std::less<typename std::iterator_traits<InIter>::value_type> >
+OutIter kWayMerge(const std::vector<std::pair<InIter, InIter> >& ranges,
+                  OutIter out, const CMP& cmp = CMP());
+
+
+/*!
+ * \brief Merge k pull-based sorted sources into @p out using a LoserTree.
+ *  Source has the same requirements as in LoserTree. Elements are taken 
+ *  with LoserTree::take(), so sources providing take() may move them.
+ * 
+ * \param sources Merged sources. They are exhausted on return.
+ * \param out Beginning of the destination range.
+ * \param cmp The comparator that defines element's relative order.
+ * \return Iterator past the last written element.
+ * \pre See LoserTree.
+ * \post Elements of all sources are written to @p out in sorted order.
+ */
+template <class Source, class OutIter,
+          class CMP = std::less<typename Source::value_type> >
+OutIter kWayMerge(const std::vector<Source*>& sources,
+                  OutIter out, const CMP& cmp = CMP());
+
+
+/*!
+ * \brief Key type returned by KeyFn for the value type of Iter. Used as the
+ *  default comparator argument of sortByKey.
+ */
+template <class Iter, class KeyFn>
+struct SortKey
+{
+    typedef typename std::decay<typename std::result_of<const KeyFn&(
+            const typename std::iterator_traits<Iter>::value_type&)>::type>::type type;
+};
+
+
+/*!
+ * \brief Stable sort by cached keys (decorate-sort-undecorate).
+ *  Intended for large elements and for keys that are expensive to compute.
+ *  Each key is computed once into a compact array of (key, index) pairs,
+ *  which is sorted with mergeSort. Elements are then moved to their final 
+ *  positions by following the cycles of the permutation, so each element is
+ *  moved once (plus one extra move per cycle).
+ *  
+ *  Type arguments:
+ *  
+ *  RandIter: STL-compatible random access iterator. Value type must be
+ *  move-constructible and move-assignable.
+ *  
+ *  KeyFn: Callable object that takes constant reference to RandIter's value
+ *  type and returns its sorting key. Key type must be default-constructible
+ *  and move-assignable.
+ *  
+ *  CMP: Comparator of keys, like in mergeSort. Defaults to std::less of key
+ *  type.
+ * 
+ * \param first Iterator to the first element in range to be sorted.
+ * \param last Pass-end iterator pointing to the end of range to be sorted.
+ * \param key Key extractor. Called exactly once for each element.
+ * \param cmp The comparator that defines key's relative order.
+ * 
+ * \pre Same as in mergeSort.
+ * \post Range from @p first to @p last is sorted in order of keys defined by
+ *  @p cmp. The sort is stable.
+ * 
+ *  Exception guarantee: Basic guarantee. If @p key or @p cmp throws, the 
+ *  range is not modified.
+ *  
+ *  Complexity: time O(N log N) key comparisons and O(N) element moves,
+ *  memory O(N) keys and indices.
+ * 
+ * \exception std::bad_alloc, if memory allocation fails. Exceptions thrown by
+ *  @p key, @p cmp or value type's move operations.
+ */
+template <class RandIter, class KeyFn,
+          class CMP = std::less<typename SortKey<RandIter, KeyFn>::type> >
+void sortByKey(RandIter first, RandIter last, const KeyFn& key,
+               const CMP& cmp = CMP());
+
+
+/*!
+ * \brief Return the permutation that would stably sort a range, without 
+ *  modifying the range.
+ *  
+ *  Type arguments:
+ *  
+ *  RandIter: STL-compatible random access iterator.
+ *  
+ *  CMP: Same as in mergeSort.
+ * 
+ * \param first Iterator to the first element in range.
+ * \param last Pass-end iterator pointing to the end of range.
+ * \param cmp The comparator that defines element's relative order.
+ * \return Vector of indices, so that *(first + result[0]), 
+ *  *(first + result[1]), ... is the range in sorted order. Indices of equal
+ *  elements are in ascending order.
+ * \pre Range from @p first to @p last is valid.
+ * \post Range is not modified.
+ * 
+ *  Complexity: time O(N log N), memory O(N) indices.
+ * 
+ * \exception std::bad_alloc, if memory allocation fails. Exceptions thrown by
+ *  @p cmp.
+ */
+template <class RandIter, 
+          class CMP = std::less<typename std::iterator_traits<RandIter>::value_type> >
+std::vector<std::size_t> argsort(RandIter first, RandIter last, 
+                                 const CMP& cmp = CMP());
+
+
+/*!
+ * \brief The StreamingTopK class template
+ *  Keeps the first k elements (in order defined by CMP) of an unbounded 
+ *  stream of elements using O(k) memory. Kept elements are in a bounded heap
+ *  whose root is the last kept element. When the heap is full, an element 
+ *  that does not precede the root is rejected with one comparison; others 
+ *  replace the root in O(log k) comparisons.
+ *  
+ *  Among equal elements, the ones pushed first are kept, so the result is 
+ *  the same as the first k elements after a stable sort of the stream.
+ *  
+ *  Type arguments:
+ *  
+ *  T: Element type. Must be copy- or move-constructible and -assignable.
+ *  
+ *  CMP: Same as in mergeSort.
+ */
+template <class T, class CMP = std::less<T> >
+class StreamingTopK
+{
+public:
+    
+    typedef T value_type;
+    
+    /*!
+     * \brief Constructor.
+     * \param k Maximum number of kept elements.
+     * \param cmp The comparator that defines element's relative order.
+     * \pre None.
+     * \post size() == 0.
+     * \exception std::bad_alloc, if memory allocation fails.
+     */
+    explicit StreamingTopK(std::size_t k, const CMP& cmp = CMP());
+    
+    /*!
+     * \brief Offer an element to the accumulator.
+     * \return True, if the element was kept.
+     * \post Kept elements are the first k of all pushed elements.
+     */
+    bool push(const T& t);
+    
+    //! \overload
+    bool push(T&& t);
+    
+    /*!
+     * \brief Return true, if an element that does not precede @p t would be 
+     *  rejected. Can be used to skip creating elements that are not kept.
+     */
+    bool rejects(const T& t) const;
+    
+    /*!
+     * \brief Return the number of kept elements, at most k().
+     */
+    std::size_t size() const;
+    
+    /*!
+     * \brief Return the maximum number of kept elements.
+     */
+    std::size_t k() const;
+    
+    /*!
+     * \brief Return the last kept element. Elements that do not precede it
+     *  are rejected once size() == k().
+     * \pre size() > 0.
+     */
+    const T& threshold() const;
+    
+    /*!
+     * \brief Return kept elements in sorted order.
+     * \pre None.
+     * \post Accumulator is not modified.
+     * \exception std::bad_alloc, if memory allocation fails.
+     */
+    std::vector<T> sorted() const;
+    
+    /*!
+     * \brief Move kept elements out in sorted order.
+     * \post size() == 0. Accumulator may be reused.
+     */
+    std::vector<T> take();
+    
+    
+private:
+    
+    typedef std::pair<T, unsigned long long> Entry;
+    
+    // Orders entries by element, and equal elements by arrival.
+    struct EntryCmp
+    {
+        explicit EntryCmp(const CMP& c) : cmp(c) {}
+        bool operator()(const Entry& a, const Entry& b) const;
+        CMP cmp;
+    };
+    
+    std::size_t k_;
+    EntryCmp cmp_;
+    std::vector<Entry> heap_;
+    unsigned long long pushed_;
+    
+    template <class U>
+    bool insert(U&& t);
+};
+
+
+/*!
+ * \brief Return the first @p k elements of a range in sorted order.
+ *  Equivalent to a stable sort of the range followed by taking k first 
+ *  elements, but the range is read once and only O(k) memory is used.
+ *  
+ *  Type arguments:
+ *  
+ *  InIter: STL-compatible input iterator.
+ *  
+ *  CMP: Same as in mergeSort.
+ * 
+ * \param first Iterator to the first element in range.
+ * \param last Pass-end iterator pointing to the end of range.
+ * \param k Maximum number of returned elements.
+ * \param cmp The comparator that defines element's relative order.
+ * \return min(k, N) first elements in order defined by @p cmp. Equal
+ *  elements are in their original order.
+ * \pre Range from @p first to @p last is valid.
+ * \post Range is not modified.
+ * 
+ *  Complexity: time O(N log k) in the worst case and O(N) when most elements
+ *  are rejected. Memory O(k).
+ * 
+ * \exception std::bad_alloc, if memory allocation fails. Exceptions thrown by
+ *  @p cmp or value type's copy operations.
+ */
+template <class InIter,
+          class CMP = std::less<typename std::iterator_traits<InIter>::value_type> >
+std::vector<typename std::iterator_traits<InIter>::value_type>
+topK(InIter first, InIter last, std::size_t k, const CMP& cmp = CMP());
+
+
+/*!
+ * \brief Parallel version of topK.
+ *  The range is split into one chunk per thread. Each thread collects the
+ *  top k of its chunk with a StreamingTopK, and per-thread results are 
+ *  merged with kWayMerge. Each thread gets at least 
+ *  PARALLEL_MERGESORT_MIN_CHUNK elements.
+ * 
+ * \param first Iterator to the first element in range.
+ * \param last Pass-end iterator pointing to the end of range.
+ * \param k Maximum number of returned elements.
+ * \param cmp The comparator that defines element's relative order. It is
+ *  called concurrently from several threads.
+ * \param threads Maximum number of threads used (calling thread included).
+ *  If 0, std::thread::hardware_concurrency() threads are used.
+ * \return Same as topK, independent of @p threads.
+ * \pre Range from @p first to @p last is valid.
+ * 
+ *  Complexity: time O(N/P log k + k P log P), memory O(k P).
+ * 
+ * \exception std::bad_alloc, if memory allocation fails. std::system_error,
+ *  if threads cannot be started. Exceptions thrown by @p cmp or value type's
+ *  copy operations.
+ */
+template <class RandIter,
+          class CMP = std::less<typename std::iterator_traits<RandIter>::value_type> >
+std::vector<typename std::iterator_traits<RandIter>::value_type>
+parallelTopK(RandIter first, RandIter last, std::size_t k, 
+             const CMP& cmp = CMP(), unsigned threads = 0);
+
+
+/*!
+ * \brief Selection like std::nth_element. Rearranges the range so that
+ *  @p nth holds the element that would be there if the range was sorted,
+ *  no element before @p nth follows it and no element after @p nth precedes
+ *  it.
+ *  
+ *  Implementation: Quickselect with median-of-three pivots and a 
+ *  partitioning that splits runs of equal elements evenly. Ranges not longer
+ *  than MERGESORT_INSERTION_THRESHOLD are finished with insertion sort. If 
+ *  partitioning does not converge in 2 log2 N rounds, the rest of the range 
+ *  is sorted with mergeSort.
+ *  
+ *  Type arguments:
+ *  
+ *  RandIter: STL-compatible random access iterator. Value type must be
+ *  move-constructible and move-assignable.
+ *  
+ *  CMP: Same as in mergeSort.
+ * 
+ * \param first Iterator to the first element in range.
+ * \param nth Iterator to the selected position.
+ * \param last Pass-end iterator pointing to the end of range.
+ * \param cmp The comparator that defines element's relative order.
+ * \pre @p nth is in range from @p first to @p last. If @p nth == @p last,
+ *  nothing is done.
+ * \post See above. The selection is not stable.
+ * 
+ *  Complexity: time O(N) on average, O(N log N) in the worst case. Memory 
+ *  O(1) on average.
+ * 
+ * \exception Exceptions thrown by @p cmp or value type's move operations.
+ */
+template <class RandIter,
+          class CMP = std::less<typename std::iterator_traits<RandIter>::value_type> >
+void nthElement(RandIter first, RandIter nth, RandIter last, 
+                const CMP& cmp = CMP());
+
+
+/*!
+ * \brief The StaticSearchIndex class template
+ *  Read-only search index over a sorted range, laid out in Eytzinger (BFS)
+ *  order: the root is at index 1 and the children of node k at 2k and 2k+1.
+ *  The top levels of the tree share a few cache lines, and the 16 (for 
+ *  4-byte keys) descendants four levels below a node are in one cache line,
+ *  so a search can prefetch them while it is still comparing. Searches are 
+ *  branchless: the next node is computed from the comparison result, and the
+ *  number of iterations depends only on the size of the index.
+ *  
+ *  Batched lowerBound advances STATIC_SEARCH_BATCH independent searches one
+ *  level at a time, so the cache misses of different queries overlap.
+ *  
+ *  The index stores one copy of the keys (aligned to a cache line) and 
+ *  nothing else: positions in the sorted range are computed from the node
+ *  index.
+ *  
+ *  Type arguments:
+ *  
+ *  T: Key type. Must be default-constructible and copy-assignable.
+ *  
+ *  CMP: Same as in mergeSort. Must be the order the range is sorted in.
+ */
+template <class T, class CMP = std::less<T> >
+class StaticSearchIndex
+{
+public:
+    
+    typedef T value_type;
+    
+    /*!
+     * \brief Constructor. Builds the index from a sorted range.
+     * \param first Iterator to the first key. InIter must be at least an 
+     *  input iterator.
+     * \param last Pass-end iterator.
+     * \param cmp The comparator the range is sorted with.
+     * \pre Range from @p first to @p last is sorted in order defined by 
+     *  @p cmp.
+     * \post size() == number of keys.
+     * \exception std::bad_alloc, if memory allocation fails.
+     */
+    template <class InIter>
+    StaticSearchIndex(InIter first, InIter last, const CMP& cmp = CMP());
+    
+    //! Copy-constructor is forbidden.
+    StaticSearchIndex(const StaticSearchIndex&) = delete;
+    
+    //! Copy-assignment is forbidden.
+    StaticSearchIndex& operator = (const StaticSearchIndex&) = delete;
+    
+    //! Move-constructor.
+    StaticSearchIndex(StaticSearchIndex&&) = default;
+    
+    /*!
+     * \brief Return number of keys in the index.
+     */
+    std::size_t size() const;
+    
+    /*!
+     * \brief Return true, if the index has no keys.
+     */
+    bool empty() const;
+    
+    /*!
+     * \brief Return position of the first key in the sorted range that does
+     *  not precede @p key, like std::lower_bound. size() if there is none.
+     *  
+     *  Complexity: ceil(log2(size()+1)) comparisons.
+     */
+    std::size_t lowerBound(const T& key) const;
+    
+    /*!
+     * \brief Batched lowerBound. Writes lowerBound(q) for each query q from
+     *  @p first to @p last into @p out, in query order.
+     *  InIter must be at least an input iterator with value type convertible
+     *  to T, and OutIter an output iterator accepting std::size_t.
+     * \return Iterator past the last written position.
+     */
+    template <class InIter, class OutIter>
+    OutIter lowerBound(InIter first, InIter last, OutIter out) const;
+    
+    
+private:
+    
+    std::vector<T> storage_;
+    // Node k is tree_[k], 1 <= k <= n_.
+    T* tree_;
+    std::size_t n_;
+    // Number of complete tree levels.
+    std::size_t levels_;
+    CMP cmp_;
+    
+    // Position of node k in the sorted range.
+    std::size_t rank(std::size_t k) const;
+    
+    // Returns node where search that ended at k turned left last, converted
+    // to position in sorted range.
+    std::size_t resolve(std::size_t k) const;
+    
+    // Prefetches the cache line of the descendants of node k, which starts 
+    // at node k * stride. Clamped to node n_, so that no pointer past the 
+    // storage is formed near the leaves.
+    void prefetchDescendants(std::size_t k, std::size_t stride) const;
+    
+    template <class RandIter>
+    RandIter fill(RandIter it, std::size_t k);
+};
 
 
 } // Namespace PPUtils
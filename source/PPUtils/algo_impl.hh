@@ -1,49 +1,2049 @@
+/* algo_impl.hh
+ * This is the implementation file for the algorithms declared in algo.hh.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-June-2015
+ */
+
+#ifndef ALGO_IMPL_HH
+#define ALGO_IMPL_HH
 
 #include <iterator>
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
 
 namespace PPUtils
 {
 
+namespace detail
+{
+
+/*
+ * Binary insertion sort. Moves the inserted element into its place with
+ * insert(pos, sorted_end, next), which must make *sorted_end the element at 
+ * pos and shift [pos, sorted_end) one step forward.
+ */
+template <class FwrdIter, class CMP, class Insert>
+void binaryInsertionSort(FwrdIter first, FwrdIter last, const CMP& cmp,
+                         Insert insert)
+{
+    if (first == last){
+        return;
+    }
+    FwrdIter sorted_back = first;
+    FwrdIter sorted_end = first;
+    ++sorted_end;
+    while (sorted_end != last){
+        FwrdIter next = sorted_end;
+        ++next;
+        if (cmp(*sorted_end, *sorted_back)){
+            // Upper bound keeps equal elements in their original order.
+            FwrdIter pos = std::upper_bound(first, sorted_back, *sorted_end, cmp);
+            insert(pos, sorted_end, next);
+        }
+        sorted_back = sorted_end;
+        sorted_end = next;
+    }
+}
+
+
+template <class FwrdIter, class CMP>
+void insertionSort(FwrdIter first, FwrdIter last, const CMP& cmp,
+                   std::forward_iterator_tag)
+{
+    binaryInsertionSort(first, last, cmp, [](FwrdIter pos, FwrdIter it, FwrdIter next)
+    {
+        std::rotate(pos, it, next);
+    });
+}
+
+
+template <class BidirIter, class CMP>
+void insertionSort(BidirIter first, BidirIter last, const CMP& cmp,
+                   std::bidirectional_iterator_tag)
+{
+    binaryInsertionSort(first, last, cmp, [](BidirIter pos, BidirIter it, BidirIter next)
+    {
+        typename std::iterator_traits<BidirIter>::value_type tmp = std::move(*it);
+        std::move_backward(pos, it, next);
+        *pos = std::move(tmp);
+    });
+}
+
+
+/*
+ * Sorting networks. The compare-exchange sequence is Batcher's merge exchange
+ * (Knuth, TAOCP 5.2.2 Algorithm M), which works for any width and is optimal
+ * up to 8 elements. Template recursion below follows the loops of the
+ * algorithm at compile time, so every network is fully unrolled:
+ *  for p = topBit(n); p > 0; p /= 2:
+ *      q = topBit(n), r = 0, d = p
+ *      loop: compare-exchange (i, i+d) for all i < n-d with (i & p) == r
+ *            if q == p: break
+ *            d = q - p, q = q/2, r = p
+ */
+
+// Largest power of two less than n, or 1.
+constexpr std::size_t networkTopBit(std::size_t n, std::size_t p = 1)
+{
+    return 2 * p < n ? networkTopBit(n, 2 * p) : p;
+}
+
+constexpr std::size_t networkStageSize(std::size_t n, std::size_t p, 
+                                       std::size_t d, std::size_t r, 
+                                       std::size_t i)
+{
+    return i + d >= n ? 0 : ((i & p) == r ? 1 : 0) + 
+                            networkStageSize(n, p, d, r, i + 1);
+}
+
+constexpr std::size_t networkRoundSize(std::size_t n, std::size_t p, 
+                                       std::size_t q, std::size_t r,
+                                       std::size_t d)
+{
+    return networkStageSize(n, p, d, r, 0) + 
+            (q == p ? 0 : networkRoundSize(n, p, q / 2, p, q - p));
+}
+
+constexpr std::size_t networkSize(std::size_t n, std::size_t p)
+{
+    return p == 0 ? 0 : networkRoundSize(n, p, networkTopBit(n), 0, p) + 
+                        networkSize(n, p / 2);
+}
+
+
+// Branchless compare-exchange for trivially copyable types: the selects 
+// compile to min/max or conditional moves.
+template <class T, class CMP>
+inline void compareExchange(T& a, T& b, const CMP& cmp, std::true_type)
+{
+    const bool swap = cmp(b, a);
+    const T lo = swap ? b : a;
+    const T hi = swap ? a : b;
+    a = lo;
+    b = hi;
+}
+
+template <class T, class CMP>
+inline void compareExchange(T& a, T& b, const CMP& cmp, std::false_type)
+{
+    if (cmp(b, a)){
+        using std::swap;
+        swap(a, b);
+    }
+}
+
+
+template <std::size_t N, std::size_t P, std::size_t D, std::size_t R, 
+          std::size_t I, bool End = (I + D >= N)>
+struct NetworkStage
+{
+    template <class RandIter, class CMP>
+    static void apply(RandIter first, const CMP& cmp)
+    {
+        typedef typename std::iterator_traits<RandIter>::value_type E;
+        if ((I & P) == R){
+            compareExchange(first[I], first[I + D], cmp, 
+                            std::is_trivially_copyable<E>());
+        }
+        NetworkStage<N, P, D, R, I + 1>::apply(first, cmp);
+    }
+};
+
+template <std::size_t N, std::size_t P, std::size_t D, std::size_t R, std::size_t I>
+struct NetworkStage<N, P, D, R, I, true>
+{
+    template <class RandIter, class CMP>
+    static void apply(RandIter, const CMP&) {}
+};
+
+
+template <std::size_t N, std::size_t P, std::size_t Q, std::size_t R, 
+          std::size_t D, bool Last = (Q == P)>
+struct NetworkRound
+{
+    template <class RandIter, class CMP>
+    static void apply(RandIter first, const CMP& cmp)
+    {
+        NetworkStage<N, P, D, R, 0>::apply(first, cmp);
+        NetworkRound<N, P, Q / 2, P, Q - P>::apply(first, cmp);
+    }
+};
+
+template <std::size_t N, std::size_t P, std::size_t Q, std::size_t R, std::size_t D>
+struct NetworkRound<N, P, Q, R, D, true>
+{
+    template <class RandIter, class CMP>
+    static void apply(RandIter first, const CMP& cmp)
+    {
+        NetworkStage<N, P, D, R, 0>::apply(first, cmp);
+    }
+};
+
+
+template <std::size_t N, std::size_t P = networkTopBit(N)>
+struct Network
+{
+    template <class RandIter, class CMP>
+    static void apply(RandIter first, const CMP& cmp)
+    {
+        NetworkRound<N, P, networkTopBit(N), 0, P>::apply(first, cmp);
+        Network<N, P / 2>::apply(first, cmp);
+    }
+};
+
+template <std::size_t N>
+struct Network<N, 0>
+{
+    template <class RandIter, class CMP>
+    static void apply(RandIter, const CMP&) {}
+};
+
+
+// Sorts [first, first+n) with the network of width N if n == N, and 
+// otherwise tries the narrower networks.
+template <std::size_t N>
+struct NetworkDispatch
+{
+    template <class RandIter, class CMP>
+    static void apply(RandIter first, std::size_t n, const CMP& cmp)
+    {
+        if (n == N){
+            Network<N>::apply(first, cmp);
+        }
+        else {
+            NetworkDispatch<N - 1>::apply(first, n, cmp);
+        }
+    }
+};
+
+template <>
+struct NetworkDispatch<1>
+{
+    template <class RandIter, class CMP>
+    static void apply(RandIter, std::size_t, const CMP&) {}
+};
+
+
+// True, if sorting networks may replace insertion sort as the leaf case of
+// stable sorts: equal elements must be indistinguishable, which holds for 
+// integers compared with std::less or std::greater.
+template <class Iter, class CMP>
+struct NetworkLeaf : std::false_type {};
+
+template <class Iter, class T>
+struct NetworkLeaf<Iter, std::less<T> > : std::integral_constant<bool,
+        std::is_integral<T>::value &&
+        std::is_same<typename std::iterator_traits<Iter>::value_type, T>::value &&
+        std::is_base_of<std::random_access_iterator_tag,
+            typename std::iterator_traits<Iter>::iterator_category>::value> {};
+
+template <class Iter, class T>
+struct NetworkLeaf<Iter, std::greater<T> > : NetworkLeaf<Iter, std::less<T> > {};
+
+
+// Sorts a short range in the leaves of merge sorts.
+template <class FwrdIter, class CMP>
+void sortLeaf(FwrdIter first, FwrdIter last, const CMP& cmp, std::false_type)
+{
+    PPUtils::insertionSort(first, last, cmp);
+}
+
+template <class RandIter, class CMP>
+void sortLeaf(RandIter first, RandIter last, const CMP& cmp, std::true_type)
+{
+    const std::size_t n = last - first;
+    if (n > SORTING_NETWORK_MAX_WIDTH){
+        PPUtils::insertionSort(first, last, cmp);
+    }
+    else {
+        NetworkDispatch<SORTING_NETWORK_MAX_WIDTH>::apply(first, n, cmp);
+    }
+}
 
 template <class FwrdIter, class CMP>
-void mergeSort(FwrdIter first, FwrdIter last, 
-               const CMP& cmp = typename std::less<typename FwrdIter::value_type>())
+void sortLeaf(FwrdIter first, FwrdIter last, const CMP& cmp)
+{
+    sortLeaf(first, last, cmp, NetworkLeaf<FwrdIter, CMP>());
+}
+
+/*
+ * Merge sorted ranges [first1, last1) and [first2, last2) into out by moving
+ * the elements. Ties are taken from the first range to keep the merge stable.
+ * Returns iterator past the last written element.
+ */
+template <class InIter1, class InIter2, class OutIter, class CMP>
+OutIter moveMerge(InIter1 first1, InIter1 last1,
+                  InIter2 first2, InIter2 last2,
+                  OutIter out, const CMP& cmp)
+{
+    while (first1 != last1){
+        if (first2 == last2){
+            return std::move(first1, last1, out);
+        }
+        else if (cmp(*first2, *first1)){
+            *out++ = std::move(*first2++);
+        }
+        else{
+            *out++ = std::move(*first1++);
+        }
+    }
+    return std::move(first2, last2, out);
+}
+
+
+/*
+ * Merge adjacent runs of width elements from [first, last) into out.
+ */
+template <class RandIter, class OutIter, class CMP>
+void mergePass(RandIter first, RandIter last, OutIter out,
+               std::ptrdiff_t width, const CMP& cmp)
+{
+    while (last - first > width){
+        RandIter mid = first + width;
+        RandIter end = (last - mid > width) ? mid + width : last;
+        out = moveMerge(first, mid, mid, end, out, cmp);
+        first = end;
+    }
+    std::move(first, last, out);
+}
+
+
+// Top-down merge sort for forward and bidirectional iterators. buf must have
+// room for at least range/2 elements.
+template <class FwrdIter, class BufIter, class CMP>
+void mergeSortTopDown(FwrdIter first, FwrdIter last, std::ptrdiff_t range,
+                      BufIter buf, const CMP& cmp)
 {
     // Stopping condition.
-    int range = std::distance(first, last);
-    if (range <= 1){
+    if (range <= static_cast<std::ptrdiff_t>(MERGESORT_INSERTION_THRESHOLD)){
+        sortLeaf(first, last, cmp);
         return;
     }
-    
+
     // Sort sub-ranges.
-    FwrdIter mid = first;
-    std::advance(mid, range/2);
-    PPUtils::mergeSort(first, mid, cmp);
-    PPUtils::mergeSort(mid, last, cmp);
-    
-    // Merge
-    using E = typename FwrdIter::value_type;
-    typename std::vector<E> aux_v(range);
-    typename std::vector<E>::iterator aux_iter = aux_v.begin();
-    FwrdIter lhs_iter = first;
-    FwrdIter rhs_iter = mid;
-    
-    while (lhs_iter != mid){
-        if (rhs_iter == last){
-            std::move(lhs_iter, mid, aux_iter);
-            aux_iter = aux_v.end();
-            break;
+    FwrdIter lhs_back = first;
+    std::advance(lhs_back, range/2 - 1);
+    FwrdIter mid = lhs_back;
+    ++mid;
+    mergeSortTopDown(first, mid, range/2, buf, cmp);
+    mergeSortTopDown(mid, last, range - range/2, buf, cmp);
+
+    // Merge. Already ordered halves need no work.
+    if (!cmp(*mid, *lhs_back)){
+        return;
+    }
+    BufIter buf_end = std::move(first, mid, buf);
+    moveMerge(buf, buf_end, mid, last, first, cmp);
+}
+
+
+// Bottom-up merge sort for random access iterators. buf must have room for
+// last-first elements.
+template <class RandIter, class BufIter, class CMP>
+void mergeSortBottomUp(RandIter first, RandIter last, BufIter buf,
+                       const CMP& cmp)
+{
+    const std::ptrdiff_t range = last - first;
+    const std::ptrdiff_t run = MERGESORT_INSERTION_THRESHOLD;
+
+    for (RandIter it = first; it < last; it += std::min(run, last - it)){
+        sortLeaf(it, it + std::min(run, last - it), cmp);
+    }
+
+    bool in_buf = false;
+    for (std::ptrdiff_t width = run; width < range; width *= 2){
+        if (in_buf){
+            mergePass(buf, buf + range, first, width, cmp);
         }
-        else if (cmp(*rhs_iter, *lhs_iter)){
-            *aux_iter++ = std::move(*rhs_iter++);
+        else {
+            mergePass(first, last, buf, width, cmp);
         }
-        else{
-            *aux_iter++ = std::move(*lhs_iter++);
+        in_buf = !in_buf;
+    }
+    if (in_buf){
+        std::move(buf, buf + range, first);
+    }
+}
+
+
+// Merges [first, mid) and [mid, last) in place, when [first, mid) fits buf.
+template <class FwrdIter, class BufIter, class CMP>
+void bufferedMergeLow(FwrdIter first, FwrdIter mid, FwrdIter last,
+                      BufIter buf, const CMP& cmp)
+{
+    BufIter buf_end = std::move(first, mid, buf);
+    moveMerge(buf, buf_end, mid, last, first, cmp);
+}
+
+
+// Merges [first, mid) and [mid, last) in place backwards, when [mid, last)
+// fits buf.
+template <class BidirIter, class BufIter, class CMP>
+void bufferedMergeHigh(BidirIter first, BidirIter mid, BidirIter last,
+                       BufIter buf, const CMP& cmp)
+{
+    typedef typename std::iterator_traits<BidirIter>::value_type E;
+    BufIter buf_end = std::move(mid, last, buf);
+    // Equal elements are taken from the right run first, because the merge
+    // runs backwards.
+    auto reversed = [&cmp](const E& a, const E& b){ return cmp(b, a); };
+    moveMerge(std::reverse_iterator<BufIter>(buf_end),
+              std::reverse_iterator<BufIter>(buf),
+              std::reverse_iterator<BidirIter>(mid),
+              std::reverse_iterator<BidirIter>(first),
+              std::reverse_iterator<BidirIter>(last), reversed);
+}
+
+
+// Integer square root.
+inline std::ptrdiff_t isqrt(std::ptrdiff_t n)
+{
+    std::ptrdiff_t r = static_cast<std::ptrdiff_t>(std::sqrt(static_cast<double>(n)));
+    while (r * r > n){
+        --r;
+    }
+    while ((r + 1) * (r + 1) <= n){
+        ++r;
+    }
+    return r;
+}
+
+
+/*
+ * Block merge of [first, mid) and [mid, last) with blocks of s elements.
+ * buf must have room for s elements, and mid - first must be at least s.
+ *
+ * The left run A is split into an uneven first block and full blocks of s
+ * elements. The full blocks form a window that rolls through the right run
+ * B: while the last B block moved in front of the window is less than the
+ * smallest head of the window, the first window block is swapped with the
+ * next B block. Otherwise the smallest block is dropped in front of the B
+ * elements not less than its head, and the previously dropped block is
+ * merged with the B elements between them using buf. Rolling shuffles the
+ * window blocks, so their original order is kept in a ring of tags to
+ * break ties between equal heads.
+ */
+template <class RandIter, class BufIter, class CMP>
+void blockMerge(RandIter first, RandIter mid, RandIter last,
+                std::ptrdiff_t s, BufIter buf, const CMP& cmp)
+{
+    const std::ptrdiff_t blocks = (mid - first) / s;
+    std::vector<std::ptrdiff_t> tags(blocks);
+    for (std::ptrdiff_t i = 0; i < blocks; ++i){
+        tags[i] = i;
+    }
+    // Tag of window block j is tags[(offset + j) % blocks].
+    std::ptrdiff_t offset = 0;
+    std::ptrdiff_t count = blocks;
+    auto tag = [&](std::ptrdiff_t j) -> std::ptrdiff_t&
+    {
+        return tags[(offset + j) % blocks];
+    };
+
+    RandIter last_a = first;                        // Last dropped A block.
+    RandIter last_a_end = first + (mid - first) % s;
+    RandIter window = last_a_end;                   // First window block.
+    RandIter last_b = window;                       // B elements before window.
+    RandIter b = mid;                               // Remaining B elements.
+
+    auto findMin = [&]() -> std::ptrdiff_t
+    {
+        std::ptrdiff_t m = 0;
+        for (std::ptrdiff_t j = 1; j < count; ++j){
+            if (cmp(window[j*s], window[m*s]) ||
+                    (!cmp(window[m*s], window[j*s]) && tag(j) < tag(m))){
+                m = j;
+            }
+        }
+        return m;
+    };
+    std::ptrdiff_t min_block = findMin();
+
+    while (count > 0){
+        if (b == last ||
+                (last_b != window && !cmp(window[-1], window[min_block*s]))){
+            // Drop the smallest block after the B elements less than its head.
+            if (min_block != 0){
+                std::swap_ranges(window, window + s, window + min_block*s);
+                std::swap(tag(0), tag(min_block));
+            }
+            RandIter split = std::lower_bound(last_b, window, *window, cmp);
+            std::rotate(split, window, window + s);
+            bufferedMergeLow(last_a, last_a_end, split, buf, cmp);
+            last_a = split;
+            last_a_end = split + s;
+            last_b = last_a_end;
+            window += s;
+            offset = (offset + 1) % blocks;
+            --count;
+            min_block = findMin();
+        }
+        else if (last - b < s){
+            // Move the last, partial B block in front of the window.
+            last_b = window;
+            window += last - b;
+            std::rotate(last_b, b, last);
+            b = last;
         }
-    }   
-    std::move(aux_v.begin(), aux_iter, first);
+        else {
+            // Roll: the first window block becomes the last one.
+            std::swap_ranges(window, window + s, b);
+            if (count < blocks){
+                tag(count) = tag(0);
+            }
+            offset = (offset + 1) % blocks;
+            last_b = window;
+            window += s;
+            b += s;
+            min_block = (min_block == 0) ? count - 1 : min_block - 1;
+        }
+    }
+    bufferedMergeLow(last_a, last_a_end, last, buf, cmp);
 }
 
-} // Namespace PPUtils
+
+// In-place merge of [first, mid) and [mid, last) with len1 and len2
+// elements using buf of cap elements. Splits the merge by binary search and
+// rotation until one side fits buf.
+template <class FwrdIter, class BufIter, class CMP>
+void rotationMerge(FwrdIter first, FwrdIter mid, FwrdIter last,
+                   std::ptrdiff_t len1, std::ptrdiff_t len2,
+                   BufIter buf, std::ptrdiff_t cap, const CMP& cmp,
+                   std::forward_iterator_tag)
+{
+    if (len1 == 0 || len2 == 0 || !cmp(*mid, *std::next(first, len1 - 1))){
+        return;
+    }
+    if (len1 <= cap){
+        bufferedMergeLow(first, mid, last, buf, cmp);
+        return;
+    }
+    if (len1 + len2 == 2){
+        std::iter_swap(first, mid);
+        return;
+    }
+    FwrdIter cut1 = first;
+    FwrdIter cut2 = mid;
+    std::ptrdiff_t len11 = 0;
+    std::ptrdiff_t len22 = 0;
+    if (len1 > len2){
+        len11 = len1 / 2;
+        std::advance(cut1, len11);
+        cut2 = std::lower_bound(mid, last, *cut1, cmp);
+        len22 = std::distance(mid, cut2);
+    }
+    else {
+        len22 = len2 / 2;
+        std::advance(cut2, len22);
+        cut1 = std::upper_bound(first, mid, *cut2, cmp);
+        len11 = std::distance(first, cut1);
+    }
+    FwrdIter new_mid = std::rotate(cut1, mid, cut2);
+    rotationMerge(first, cut1, new_mid, len11, len22, buf, cap, cmp,
+                  std::forward_iterator_tag());
+    rotationMerge(new_mid, cut2, last, len1 - len11, len2 - len22, buf, cap,
+                  cmp, std::forward_iterator_tag());
+}
+
+
+// Random access version: uses the buffer from both sides, and block merge
+// when the buffer holds sqrt(len1 + len2) elements.
+template <class RandIter, class BufIter, class CMP>
+void rotationMerge(RandIter first, RandIter mid, RandIter last,
+                   std::ptrdiff_t len1, std::ptrdiff_t len2,
+                   BufIter buf, std::ptrdiff_t cap, const CMP& cmp,
+                   std::random_access_iterator_tag)
+{
+    if (len1 == 0 || len2 == 0 || !cmp(*mid, mid[-1])){
+        return;
+    }
+    if (len1 <= cap){
+        bufferedMergeLow(first, mid, last, buf, cmp);
+        return;
+    }
+    if (len2 <= cap){
+        bufferedMergeHigh(first, mid, last, buf, cmp);
+        return;
+    }
+    const std::ptrdiff_t s = isqrt(len1 + len2);
+    if (s <= cap){
+        blockMerge(first, mid, last, s, buf, cmp);
+        return;
+    }
+    if (len1 + len2 == 2){
+        std::iter_swap(first, mid);
+        return;
+    }
+    RandIter cut1 = first;
+    RandIter cut2 = mid;
+    if (len1 > len2){
+        cut1 += len1 / 2;
+        cut2 = std::lower_bound(mid, last, *cut1, cmp);
+    }
+    else {
+        cut2 += len2 / 2;
+        cut1 = std::upper_bound(first, mid, *cut2, cmp);
+    }
+    RandIter new_mid = std::rotate(cut1, mid, cut2);
+    rotationMerge(first, cut1, new_mid, cut1 - first, cut2 - mid, buf, cap,
+                  cmp, std::random_access_iterator_tag());
+    rotationMerge(new_mid, cut2, last, mid - cut1, last - cut2, buf, cap,
+                  cmp, std::random_access_iterator_tag());
+}
+
+
+// Top-down merge sort with in-place merges for forward and bidirectional
+// iterators. buf has room for cap elements.
+template <class FwrdIter, class BufIter, class CMP>
+void inPlaceMergeSort(FwrdIter first, FwrdIter last, std::ptrdiff_t range,
+                      BufIter buf, std::ptrdiff_t cap, const CMP& cmp)
+{
+    if (range <= static_cast<std::ptrdiff_t>(MERGESORT_INSERTION_THRESHOLD)){
+        sortLeaf(first, last, cmp);
+        return;
+    }
+    FwrdIter mid = std::next(first, range/2);
+    inPlaceMergeSort(first, mid, range/2, buf, cap, cmp);
+    inPlaceMergeSort(mid, last, range - range/2, buf, cap, cmp);
+    rotationMerge(first, mid, last, range/2, range - range/2, buf, cap, cmp,
+                  std::forward_iterator_tag());
+}
+
+
+// Bottom-up merge sort with in-place merges for random access iterators.
+// buf has room for cap elements.
+template <class RandIter, class BufIter, class CMP>
+void inPlaceMergeSortBottomUp(RandIter first, RandIter last, BufIter buf,
+                              std::ptrdiff_t cap, const CMP& cmp)
+{
+    const std::ptrdiff_t range = last - first;
+    const std::ptrdiff_t run = MERGESORT_INSERTION_THRESHOLD;
+
+    for (RandIter it = first; it < last; it += std::min(run, last - it)){
+        sortLeaf(it, it + std::min(run, last - it), cmp);
+    }
+    for (std::ptrdiff_t width = run; width < range; width *= 2){
+        for (std::ptrdiff_t i = 0; range - i > width; i += 2*width){
+            const std::ptrdiff_t len2 = std::min(width, range - i - width);
+            rotationMerge(first + i, first + i + width, first + i + width + len2,
+                          width, len2, buf, cap, cmp,
+                          std::random_access_iterator_tag());
+        }
+    }
+}
+
+
+// Number of elements of type E that fit in memory_budget bytes.
+template <class E>
+std::ptrdiff_t bufferCapacity(std::size_t memory_budget)
+{
+    const std::size_t cap = memory_budget / sizeof(E);
+    const std::size_t max = static_cast<std::size_t>(PTRDIFF_MAX);
+    return static_cast<std::ptrdiff_t>(cap < max ? cap : max);
+}
+
+
+template <class FwrdIter, class CMP>
+void mergeSort(FwrdIter first, FwrdIter last, const CMP& cmp,
+               std::size_t memory_budget, std::forward_iterator_tag)
+{
+    std::ptrdiff_t range = std::distance(first, last);
+    if (range <= 1){
+        return;
+    }
+    using E = typename std::iterator_traits<FwrdIter>::value_type;
+    const std::ptrdiff_t cap = bufferCapacity<E>(memory_budget);
+    if (cap >= range/2){
+        std::vector<E> aux_v(range/2);
+        mergeSortTopDown(first, last, range, aux_v.begin(), cmp);
+    }
+    else {
+        std::vector<E> aux_v(cap);
+        inPlaceMergeSort(first, last, range, aux_v.begin(), cap, cmp);
+    }
+}
+
+
+template <class RandIter, class CMP>
+void mergeSort(RandIter first, RandIter last, const CMP& cmp,
+               std::size_t memory_budget, std::random_access_iterator_tag)
+{
+    const std::ptrdiff_t range = last - first;
+    if (range <= static_cast<std::ptrdiff_t>(MERGESORT_INSERTION_THRESHOLD)){
+        sortLeaf(first, last, cmp);
+        return;
+    }
+    using E = typename std::iterator_traits<RandIter>::value_type;
+    const std::ptrdiff_t cap = bufferCapacity<E>(memory_budget);
+    if (cap >= range){
+        std::vector<E> aux_v(range);
+        mergeSortBottomUp(first, last, aux_v.begin(), cmp);
+    }
+    else {
+        std::vector<E> aux_v(cap);
+        inPlaceMergeSortBottomUp(first, last, aux_v.begin(), cap, cmp);
+    }
+}
+
+
+// Runs tasks in the shared WorkerPool using at most threads threads, calling
+// thread included. The first exception thrown by a task is rethrown after all
+// tasks have finished.
+inline void runTasks(const std::vector<std::function<void()> >& tasks,
+                     unsigned threads)
+{
+    WorkerPool::shared().run(tasks, threads);
+}
+
+
+/*
+ * Co-rank of output position k in the stable merge of [a, a+m) and [b, b+n):
+ * returns i such that the first k merged elements are exactly a[0..i) and
+ * b[0..k-i).
+ */
+template <class RandIter1, class RandIter2, class CMP>
+std::ptrdiff_t coRank(std::ptrdiff_t k,
+                      RandIter1 a, std::ptrdiff_t m,
+                      RandIter2 b, std::ptrdiff_t n, const CMP& cmp)
+{
+    std::ptrdiff_t lo = std::max<std::ptrdiff_t>(0, k - n);
+    std::ptrdiff_t hi = std::min(k, m);
+    while (lo < hi){
+        std::ptrdiff_t i = lo + (hi - lo) / 2;
+        // a[i] belongs to the first k elements, if it precedes b[k-i-1].
+        if (!cmp(b[k-i-1], a[i])){
+            lo = i + 1;
+        }
+        else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+
+/*
+ * Adds tasks merging adjacent pairs of runs from src into dst. Runs are given
+ * as offsets in bounds, which is replaced with offsets of the merged runs.
+ * Each merge gets a share of parts proportional to its width.
+ */
+template <class SrcIter, class DstIter, class CMP>
+void addMergeRound(std::vector<std::function<void()> >& tasks,
+                   SrcIter src, DstIter dst,
+                   std::vector<std::ptrdiff_t>& bounds,
+                   unsigned parts, const CMP& cmp)
+{
+    const std::ptrdiff_t total = bounds.back();
+    std::vector<std::ptrdiff_t> merged(1, 0);
+
+    for (std::size_t r = 0; r + 1 < bounds.size(); r += 2){
+        const std::ptrdiff_t begin = bounds[r];
+        const std::ptrdiff_t mid = bounds[r+1];
+        const std::ptrdiff_t end = (r + 2 < bounds.size()) ? bounds[r+2] : mid;
+        merged.push_back(end);
+
+        const SrcIter a = src + begin;
+        const SrcIter b = src + mid;
+        const std::ptrdiff_t m = mid - begin;
+        const std::ptrdiff_t n = end - mid;
+        const DstIter out = dst + begin;
+        std::ptrdiff_t share = std::max<std::ptrdiff_t>(1, parts * (end - begin) / total);
+
+        for (std::ptrdiff_t p = 0; p < share; ++p){
+            const std::ptrdiff_t k0 = (m + n) * p / share;
+            const std::ptrdiff_t k1 = (m + n) * (p + 1) / share;
+            tasks.push_back([=, &cmp]()
+            {
+                std::ptrdiff_t i0 = coRank(k0, a, m, b, n, cmp);
+                std::ptrdiff_t i1 = coRank(k1, a, m, b, n, cmp);
+                moveMerge(a + i0, a + i1, b + (k0 - i0), b + (k1 - i1),
+                          out + k0, cmp);
+            });
+        }
+    }
+    bounds.swap(merged);
+}
+
+
+// Adds tasks moving [src, src+n) to dst in parts pieces.
+template <class SrcIter, class DstIter>
+void addMoveTasks(std::vector<std::function<void()> >& tasks,
+                  SrcIter src, DstIter dst, std::ptrdiff_t n, unsigned parts)
+{
+    for (unsigned p = 0; p < parts; ++p){
+        const std::ptrdiff_t b = n * p / parts;
+        const std::ptrdiff_t e = n * (p + 1) / parts;
+        tasks.push_back([=]()
+        {
+            std::move(src + b, src + e, dst + b);
+        });
+    }
+}
+
+
+// Comparator with reversed arguments. Used to run merges backwards.
+template <class CMP>
+class ReversedCmp
+{
+public:
+    explicit ReversedCmp(const CMP& cmp) : cmp_(cmp) {}
+
+    template <class T>
+    bool operator()(const T& a, const T& b) const {return cmp_(b, a);}
+
+private:
+    const CMP& cmp_;
+};
+
+
+// Upper bound of key in [first, last) using exponential search from first.
+template <class RandIter, class T, class CMP>
+RandIter gallopUpperBound(RandIter first, RandIter last, const T& key,
+                          const CMP& cmp)
+{
+    const std::ptrdiff_t n = last - first;
+    std::ptrdiff_t lo = 0, probe = 0, step = 1;
+    while (probe < n && !cmp(key, first[probe])){
+        lo = probe + 1;
+        probe += step;
+        step *= 2;
+    }
+    return std::upper_bound(first + lo, first + std::min(probe, n), key, cmp);
+}
+
+
+// Lower bound of key in [first, last) using exponential search from first.
+template <class RandIter, class T, class CMP>
+RandIter gallopLowerBound(RandIter first, RandIter last, const T& key,
+                          const CMP& cmp)
+{
+    const std::ptrdiff_t n = last - first;
+    std::ptrdiff_t lo = 0, probe = 0, step = 1;
+    while (probe < n && cmp(first[probe], key)){
+        lo = probe + 1;
+        probe += step;
+        step *= 2;
+    }
+    return std::lower_bound(first + lo, first + std::min(probe, n), key, cmp);
+}
+
+
+/*
+ * Merges adjacent runs [a, a+na) and [b, b+nb), b == a+na, from front to back.
+ * The first run is moved to tmp and wins ties. When one run keeps winning, 
+ * switches to galloping. min_gallop adapts to how well galloping pays off.
+ */
+template <class RandIter, class BufIter, class CMP>
+void gallopingMergeLo(RandIter a, std::ptrdiff_t na,
+                      RandIter b, std::ptrdiff_t nb,
+                      BufIter tmp, const CMP& cmp, std::ptrdiff_t& min_gallop)
+{
+    BufIter t = tmp;
+    BufIter t_end = std::move(a, a + na, tmp);
+    RandIter dst = a;
+    RandIter b_end = b + nb;
+
+    while (t != t_end && b != b_end){
+        // One element at a time until one run wins min_gallop times in a row.
+        std::ptrdiff_t a_wins = 0, b_wins = 0;
+        while (t != t_end && b != b_end &&
+               a_wins < min_gallop && b_wins < min_gallop){
+            if (cmp(*b, *t)){
+                *dst++ = std::move(*b++);
+                ++b_wins;
+                a_wins = 0;
+            }
+            else {
+                *dst++ = std::move(*t++);
+                ++a_wins;
+                b_wins = 0;
+            }
+        }
+
+        // Galloping until neither run wins long streaks anymore.
+        while (t != t_end && b != b_end){
+            BufIter t_stop = gallopUpperBound(t, t_end, *b, cmp);
+            std::ptrdiff_t a_count = t_stop - t;
+            dst = std::move(t, t_stop, dst);
+            t = t_stop;
+            if (t == t_end){
+                break;
+            }
+            RandIter b_stop = gallopLowerBound(b, b_end, *t, cmp);
+            std::ptrdiff_t b_count = b_stop - b;
+            dst = std::move(b, b_stop, dst);
+            b = b_stop;
+
+            const std::ptrdiff_t limit = ADAPTIVE_MERGESORT_MIN_GALLOP;
+            if (a_count < limit && b_count < limit){
+                ++min_gallop;
+                break;
+            }
+            if (min_gallop > 1){
+                --min_gallop;
+            }
+        }
+    }
+    // Rest of the second run is already in place.
+    std::move(t, t_end, dst);
+}
+
+
+/*
+ * Merges adjacent runs [a, a+na) and [a+na, a+na+nb) using galloping. Parts 
+ * of the runs that are already in place are skipped first, and the shorter of
+ * the remaining runs is moved to buf. buf is grown as needed.
+ */
+template <class RandIter, class E, class CMP>
+void gallopingMerge(RandIter a, std::ptrdiff_t na, std::ptrdiff_t nb,
+                    std::vector<E>& buf, const CMP& cmp,
+                    std::ptrdiff_t& min_gallop)
+{
+    RandIter b = a + na;
+
+    // Elements of the first run not greater than b[0] are in place.
+    RandIter a_start = gallopUpperBound(a, b, *b, cmp);
+    na -= a_start - a;
+    a = a_start;
+    if (na == 0){
+        return;
+    }
+    // Elements of the second run not less than the last of a are in place.
+    typedef std::reverse_iterator<RandIter> RevIter;
+    ReversedCmp<CMP> rcmp(cmp);
+    nb -= gallopUpperBound(RevIter(b + nb), RevIter(b), a[na-1], rcmp)
+          - RevIter(b + nb);
+    if (nb == 0){
+        return;
+    }
+
+    std::size_t needed = std::min(na, nb);
+    if (buf.size() < needed){
+        buf.resize(std::max(needed, 2 * buf.size()));
+    }
+    if (na <= nb){
+        gallopingMergeLo(a, na, b, nb, buf.begin(), cmp, min_gallop);
+    }
+    else {
+        // Merge backwards: the reversed second run wins ties.
+        gallopingMergeLo(RevIter(b + nb), nb, RevIter(b), na,
+                         buf.begin(), rcmp, min_gallop);
+    }
+}
+
+
+/*
+ * Returns length of the run starting at first. Strictly descending runs are
+ * reversed, so the run is ascending on return.
+ */
+template <class RandIter, class CMP>
+std::ptrdiff_t makeAscendingRun(RandIter first, RandIter last, const CMP& cmp)
+{
+    RandIter run_end = first + 1;
+    if (run_end == last){
+        return 1;
+    }
+    if (cmp(*run_end, *first)){
+        while (++run_end != last && cmp(*run_end, *(run_end - 1))){
+        }
+        std::reverse(first, run_end);
+    }
+    else {
+        while (++run_end != last && !cmp(*run_end, *(run_end - 1))){
+        }
+    }
+    return run_end - first;
+}
+
+
+// Minimum run length: n / minrun is a power of two or slightly less.
+inline std::ptrdiff_t minRunLength(std::ptrdiff_t n)
+{
+    const std::ptrdiff_t limit = 2 * MERGESORT_INSERTION_THRESHOLD;
+    std::ptrdiff_t r = 0;
+    while (n >= limit){
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+
+/*
+ * Maps radix sort keys to unsigned integers of the same width so that the
+ * unsigned order matches the key order.
+ */
+template <class K, class Enable = void>
+struct RadixKeyTraits;
+
+template <class K>
+struct RadixKeyTraits<K, typename std::enable_if<std::is_integral<K>::value &&
+                                                 std::is_unsigned<K>::value>::type>
+{
+    typedef K Unsigned;
+    static Unsigned map(K k) {return k;}
+};
+
+template <class K>
+struct RadixKeyTraits<K, typename std::enable_if<std::is_integral<K>::value &&
+                                                 std::is_signed<K>::value>::type>
+{
+    typedef typename std::make_unsigned<K>::type Unsigned;
+    static Unsigned map(K k)
+    {
+        return static_cast<Unsigned>(k) ^ (Unsigned(1) << (sizeof(K) * 8 - 1));
+    }
+};
+
+template <class K>
+struct RadixKeyTraits<K, typename std::enable_if<std::is_floating_point<K>::value>::type>
+{
+    static_assert(sizeof(K) == 4 || sizeof(K) == 8,
+                  "radixSort supports only 32- and 64-bit floating point keys.");
+    typedef typename std::conditional<sizeof(K) == 4, 
+                                      std::uint32_t, std::uint64_t>::type Unsigned;
+    static Unsigned map(K k)
+    {
+        Unsigned u;
+        std::memcpy(&u, &k, sizeof(u));
+        const Unsigned sign = Unsigned(1) << (sizeof(K) * 8 - 1);
+        return (u & sign) ? ~u : (u | sign);
+    }
+};
+
+
+inline void prefetchWrite(const void* address)
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(address, 1);
+#else
+    (void)address;
+#endif
+}
+
+
+inline void prefetchRead(const void* address)
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(address, 0);
+#else
+    (void)address;
+#endif
+}
+
+
+// Index of the highest set bit of x > 0.
+inline unsigned highestBit(unsigned long long x)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(x);
+#else
+    unsigned bit = 0;
+    while (x >>= 1){
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+
+// Number of trailing one bits in x.
+inline unsigned trailingOnes(unsigned long long x)
+{
+#if defined(__GNUC__)
+    return ~x == 0 ? 64 : __builtin_ctzll(~x);
+#else
+    unsigned ones = 0;
+    while (x & 1){
+        x >>= 1;
+        ++ones;
+    }
+    return ones;
+#endif
+}
+
+
+// Adds digit histograms of all passes for [first, last) to counts.
+template <unsigned Bits, class Traits, class RandIter, class KeyFn>
+void radixHistogram(RandIter first, RandIter last, const KeyFn& key,
+                    unsigned passes, std::size_t* counts)
+{
+    const std::size_t buckets = std::size_t(1) << Bits;
+    for (; first != last; ++first){
+        typename Traits::Unsigned u = Traits::map(key(*first));
+        for (unsigned p = 0; p < passes; ++p){
+            ++counts[p * buckets + ((u >> (p * Bits)) & (buckets - 1))];
+        }
+    }
+}
+
+
+// Moves [first, last) to out ordered by the digit at shift. offsets holds 
+// the exclusive prefix sums of the digit histogram and is consumed.
+template <unsigned Bits, class Traits, class SrcIter, class DstIter, class KeyFn>
+void radixScatter(SrcIter first, SrcIter last, DstIter out, const KeyFn& key,
+                  unsigned shift, std::size_t* offsets)
+{
+    const std::size_t mask = (std::size_t(1) << Bits) - 1;
+    const std::ptrdiff_t prefetch_distance = 16;
+    const std::ptrdiff_t n = last - first;
+    for (std::ptrdiff_t i = 0; i < n; ++i){
+        if (i + prefetch_distance < n){
+            std::size_t ahead = (Traits::map(key(first[i + prefetch_distance])) 
+                                 >> shift) & mask;
+            prefetchWrite(&*(out + offsets[ahead]));
+        }
+        std::size_t digit = (Traits::map(key(first[i])) >> shift) & mask;
+        out[offsets[digit]++] = std::move(first[i]);
+    }
+}
+
+
+template <unsigned Bits, class RandIter, class KeyFn>
+void radixSortDigits(RandIter first, RandIter last, const KeyFn& key,
+                     unsigned threads)
+{
+    typedef typename std::decay<decltype(key(*first))>::type K;
+    typedef RadixKeyTraits<K> Traits;
+    const unsigned passes = (sizeof(K) * 8 + Bits - 1) / Bits;
+    const std::size_t buckets = std::size_t(1) << Bits;
+    const std::ptrdiff_t range = last - first;
+
+    // Count histograms for all passes at once, one set per thread.
+    std::vector<std::size_t> counts(passes * buckets, 0);
+    if (threads > 1){
+        std::vector<std::vector<std::size_t> > partial(threads);
+        std::vector<std::function<void()> > tasks;
+        for (unsigned t = 0; t < threads; ++t){
+            std::vector<std::size_t>* c = &partial[t];
+            RandIter b = first + range * t / threads;
+            RandIter e = first + range * (t + 1) / threads;
+            tasks.push_back([=, &key]()
+            {
+                c->assign(passes * buckets, 0);
+                radixHistogram<Bits, Traits>(b, e, key, passes, c->data());
+            });
+        }
+        runTasks(tasks, threads);
+        for (const std::vector<std::size_t>& c : partial){
+            for (std::size_t i = 0; i < counts.size(); ++i){
+                counts[i] += c[i];
+            }
+        }
+    }
+    else {
+        radixHistogram<Bits, Traits>(first, last, key, passes, counts.data());
+    }
+
+    using E = typename std::iterator_traits<RandIter>::value_type;
+    std::vector<E> aux_v;
+    bool in_buf = false;
+    for (unsigned p = 0; p < passes; ++p){
+        std::size_t* offsets = &counts[p * buckets];
+        const unsigned shift = p * Bits;
+
+        // All elements have the same digit: the pass would not move anything.
+        std::size_t digit = (Traits::map(key(in_buf ? aux_v.front() : *first))
+                             >> shift) & (buckets - 1);
+        if (offsets[digit] == static_cast<std::size_t>(range)){
+            continue;
+        }
+
+        std::size_t sum = 0;
+        for (std::size_t b = 0; b < buckets; ++b){
+            std::size_t c = offsets[b];
+            offsets[b] = sum;
+            sum += c;
+        }
+        if (aux_v.empty()){
+            aux_v.resize(range);
+        }
+        if (in_buf){
+            radixScatter<Bits, Traits>(aux_v.begin(), aux_v.end(), first, key,
+                                       shift, offsets);
+        }
+        else {
+            radixScatter<Bits, Traits>(first, last, aux_v.begin(), key,
+                                       shift, offsets);
+        }
+        in_buf = !in_buf;
+    }
+    if (in_buf){
+        std::move(aux_v.begin(), aux_v.end(), first);
+    }
+}
+
+
+// LoserTree source reading an iterator range.
+template <class InIter>
+class RangeSource
+{
+public:
+    typedef typename std::iterator_traits<InIter>::value_type value_type;
+
+    RangeSource(InIter first, InIter last) : first_(first), last_(last) {}
+
+    bool empty() const {return first_ == last_;}
+
+    const value_type& front() const {return *first_;}
+
+    void pop() {++first_;}
+
+    // Moves the element, if InIter is a std::move_iterator.
+    value_type take()
+    {
+        value_type rv(*first_);
+        ++first_;
+        return rv;
+    }
+
+private:
+    InIter first_;
+    InIter last_;
+};
+
+
+// True, if Source provides take().
+template <class Source>
+class HasTake
+{
+    template <class S>
+    static char test(decltype(std::declval<S&>().take())*);
+    template <class S>
+    static long test(...);
+public:
+    static const bool value = sizeof(test<Source>(nullptr)) == 1;
+};
+
+
+// Takes front of source with its take().
+template <class Source>
+typename Source::value_type takeFront(Source& source, std::true_type)
+{
+    return source.take();
+}
+
+
+// Copies front of a source without take(), and pops it.
+template <class Source>
+typename Source::value_type takeFront(Source& source, std::false_type)
+{
+    typename Source::value_type rv(source.front());
+    source.pop();
+    return rv;
+}
+
+// Compares (key, index) pairs by key only.
+template <class K, class CMP>
+class DecoratedKeyCmp
+{
+public:
+    explicit DecoratedKeyCmp(const CMP& cmp) : cmp_(cmp) {}
+    
+    bool operator()(const std::pair<K, std::size_t>& a, 
+                    const std::pair<K, std::size_t>& b) const
+    {
+        return cmp_(a.first, b.first);
+    }
+    
+private:
+    const CMP& cmp_;
+};
+
+
+// Compares indices by the elements they refer to.
+template <class RandIter, class CMP>
+class IndexCmp
+{
+public:
+    IndexCmp(RandIter first, const CMP& cmp) : first_(first), cmp_(cmp) {}
+    
+    bool operator()(std::size_t a, std::size_t b) const
+    {
+        return cmp_(first_[a], first_[b]);
+    }
+    
+private:
+    RandIter first_;
+    const CMP& cmp_;
+};
+
+
+// Moves *(first + source[i]) to *(first + i) for every i following the 
+// cycles of the permutation. source is left as the identity permutation.
+template <class RandIter, class Source>
+void applyPermutation(RandIter first, Source& source, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i){
+        if (source(i) == i){
+            continue;
+        }
+        typename std::iterator_traits<RandIter>::value_type tmp(std::move(first[i]));
+        std::size_t j = i;
+        while (source(j) != i){
+            std::size_t next = source(j);
+            first[j] = std::move(first[next]);
+            source(j) = j;
+            j = next;
+        }
+        first[j] = std::move(tmp);
+        source(j) = j;
+    }
+}
+
+
+// Accesses the index half of decorated keys.
+template <class K>
+class DecoratedIndex
+{
+public:
+    explicit DecoratedIndex(std::vector<std::pair<K, std::size_t> >& v) : v_(v) {}
+    
+    std::size_t& operator()(std::size_t i) {return v_[i].second;}
+    
+private:
+    std::vector<std::pair<K, std::size_t> >& v_;
+};
+
+// Partitions [first, last) around the median of its first, middle and last
+// elements. Returns the final position of the pivot. Elements equal to the 
+// pivot stop both scans, so they are split evenly between the sides.
+template <class RandIter, class CMP>
+RandIter partitionAroundMedian(RandIter first, RandIter last, const CMP& cmp)
+{
+    RandIter mid = first + (last - first) / 2;
+    RandIter back = last - 1;
+    if (cmp(*mid, *first)){
+        std::iter_swap(mid, first);
+    }
+    if (cmp(*back, *mid)){
+        std::iter_swap(back, mid);
+        if (cmp(*mid, *first)){
+            std::iter_swap(mid, first);
+        }
+    }
+    std::iter_swap(first, mid);
+
+    RandIter i = first + 1;
+    RandIter j = back;
+    while (true){
+        while (i <= j && cmp(*i, *first)){
+            ++i;
+        }
+        while (i <= j && cmp(*first, *j)){
+            --j;
+        }
+        if (i >= j){
+            break;
+        }
+        std::iter_swap(i, j);
+        ++i;
+        --j;
+    }
+    std::iter_swap(first, j);
+    return j;
+}
+
+} // Namespace detail
+
+
+template <class FwrdIter, class CMP>
+void mergeSort(FwrdIter first, FwrdIter last, const CMP& cmp,
+               std::size_t memory_budget)
+{
+    detail::mergeSort(first, last, cmp, memory_budget,
+                      typename std::iterator_traits<FwrdIter>::iterator_category());
+}
+
+
+template <class RandIter, class CMP>
+void parallelMergeSort(RandIter first, RandIter last, const CMP& cmp,
+                       unsigned threads)
+{
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::ptrdiff_t range = last - first;
+    const std::ptrdiff_t max_threads = range / PARALLEL_MERGESORT_MIN_CHUNK;
+    if (max_threads < static_cast<std::ptrdiff_t>(threads)){
+        threads = static_cast<unsigned>(std::max<std::ptrdiff_t>(1, max_threads));
+    }
+    if (threads == 1){
+        PPUtils::mergeSort(first, last, cmp);
+        return;
+    }
+
+    using E = typename std::iterator_traits<RandIter>::value_type;
+    std::vector<E> aux_v(range);
+    typename std::vector<E>::iterator buf = aux_v.begin();
+
+    // Sort one chunk per thread. Each chunk uses its own part of aux_v.
+    std::vector<std::function<void()> > tasks;
+    std::vector<std::ptrdiff_t> bounds;
+    for (unsigned t = 0; t <= threads; ++t){
+        bounds.push_back(range * t / threads);
+    }
+    for (unsigned t = 0; t < threads; ++t){
+        const std::ptrdiff_t b = bounds[t];
+        const std::ptrdiff_t e = bounds[t+1];
+        tasks.push_back([=, &cmp]()
+        {
+            detail::mergeSortBottomUp(first + b, first + e, buf + b, cmp);
+        });
+    }
+    detail::runTasks(tasks, threads);
+
+    // Merge runs back and forth between the range and aux_v.
+    bool in_buf = false;
+    while (bounds.size() > 2){
+        tasks.clear();
+        if (in_buf){
+            detail::addMergeRound(tasks, buf, first, bounds, threads, cmp);
+        }
+        else {
+            detail::addMergeRound(tasks, first, buf, bounds, threads, cmp);
+        }
+        detail::runTasks(tasks, threads);
+        in_buf = !in_buf;
+    }
+    if (in_buf){
+        tasks.clear();
+        detail::addMoveTasks(tasks, buf, first, range, threads);
+        detail::runTasks(tasks, threads);
+    }
+}
+
+
+template <class RandIter, class CMP>
+void adaptiveMergeSort(RandIter first, RandIter last, const CMP& cmp)
+{
+    const std::ptrdiff_t range = last - first;
+    if (range < 2){
+        return;
+    }
+    const std::ptrdiff_t min_run = detail::minRunLength(range);
+
+    using E = typename std::iterator_traits<RandIter>::value_type;
+    std::vector<E> buf;
+    std::vector<std::ptrdiff_t> run_base;
+    std::vector<std::ptrdiff_t> run_len;
+    std::ptrdiff_t min_gallop = ADAPTIVE_MERGESORT_MIN_GALLOP;
+
+    auto mergeAt = [&](std::size_t i)
+    {
+        detail::gallopingMerge(first + run_base[i], run_len[i], run_len[i+1],
+                               buf, cmp, min_gallop);
+        run_len[i] += run_len[i+1];
+        run_base.erase(run_base.begin() + i + 1);
+        run_len.erase(run_len.begin() + i + 1);
+    };
+
+    std::ptrdiff_t pos = 0;
+    while (pos < range){
+        // Find next run and extend it to min_run elements.
+        std::ptrdiff_t len = detail::makeAscendingRun(first + pos, last, cmp);
+        if (len < min_run){
+            len = std::min(min_run, range - pos);
+            PPUtils::insertionSort(first + pos, first + pos + len, cmp);
+        }
+        run_base.push_back(pos);
+        run_len.push_back(len);
+        pos += len;
+
+        // Keep run lengths on the stack decreasing faster than Fibonacci
+        // numbers, so that merges stay balanced.
+        while (run_len.size() > 1){
+            std::size_t n = run_len.size() - 2;
+            if ((n > 0 && run_len[n-1] <= run_len[n] + run_len[n+1]) ||
+                (n > 1 && run_len[n-2] <= run_len[n-1] + run_len[n])){
+                if (run_len[n-1] < run_len[n+1]){
+                    --n;
+                }
+                mergeAt(n);
+            }
+            else if (run_len[n] <= run_len[n+1]){
+                mergeAt(n);
+            }
+            else {
+                break;
+            }
+        }
+    }
+
+    // Merge remaining runs.
+    while (run_len.size() > 1){
+        std::size_t n = run_len.size() - 2;
+        if (n > 0 && run_len[n-1] < run_len[n+1]){
+            --n;
+        }
+        mergeAt(n);
+    }
+}
+
+
+template <class RandIter, class KeyFn>
+void radixSort(RandIter first, RandIter last, const KeyFn& key,
+               unsigned threads)
+{
+    typedef typename std::decay<decltype(key(*first))>::type K;
+    static_assert(std::is_arithmetic<K>::value && !std::is_same<K, bool>::value,
+                  "radixSort key must be an integral or floating point type.");
+    static_assert(sizeof(K) <= 8, "radixSort keys may have at most 64 bits.");
+
+    const std::ptrdiff_t range = last - first;
+    if (range < 2){
+        return;
+    }
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Same chunk limit as parallelMergeSort.
+    const std::ptrdiff_t max_threads = range / PARALLEL_MERGESORT_MIN_CHUNK;
+    if (max_threads < static_cast<std::ptrdiff_t>(threads)){
+        threads = static_cast<unsigned>(std::max<std::ptrdiff_t>(1, max_threads));
+    }
+
+    if (sizeof(K) >= 4 && 
+        range >= static_cast<std::ptrdiff_t>(RADIXSORT_WIDE_DIGIT_MIN_RANGE)){
+        detail::radixSortDigits<11>(first, last, key, threads);
+    }
+    else {
+        detail::radixSortDigits<8>(first, last, key, threads);
+    }
+}
+
+
+template <class Source, class CMP>
+LoserTree<Source,CMP>::LoserTree(const std::vector<Source*>& sources,
+                                 const CMP& cmp) :
+    sources_(sources), losers_(std::max<std::size_t>(1, sources.size()), 0),
+    cmp_(cmp)
+{
+    // Leaves are nodes k..2k-1 and internal nodes 1..k-1 of an implicit
+    // binary tree. Play the matches bottom-up.
+    const std::size_t k = sources_.size();
+    std::vector<std::size_t> winners(2 * k);
+    for (std::size_t i = 0; i < k; ++i){
+        winners[k + i] = i;
+    }
+    for (std::size_t n = (k > 0) ? k - 1 : 0; n > 0; --n){
+        std::size_t a = winners[2*n];
+        std::size_t b = winners[2*n + 1];
+        if (beats(a, b)){
+            winners[n] = a;
+            losers_[n] = b;
+        }
+        else {
+            winners[n] = b;
+            losers_[n] = a;
+        }
+    }
+    losers_[0] = (k > 1) ? winners[1] : 0;
+}
+
+
+template <class Source, class CMP>
+bool LoserTree<Source,CMP>::empty() const
+{
+    return sources_.empty() || sources_[losers_[0]]->empty();
+}
+
+
+template <class Source, class CMP>
+const typename LoserTree<Source,CMP>::value_type& 
+LoserTree<Source,CMP>::front() const
+{
+    return sources_[losers_[0]]->front();
+}
+
+
+template <class Source, class CMP>
+std::size_t LoserTree<Source,CMP>::source() const
+{
+    return losers_[0];
+}
+
+
+template <class Source, class CMP>
+void LoserTree<Source,CMP>::pop()
+{
+    const std::size_t winner = losers_[0];
+    sources_[winner]->pop();
+    replay(winner);
+}
+
+
+template <class Source, class CMP>
+typename LoserTree<Source,CMP>::value_type LoserTree<Source,CMP>::take()
+{
+    const std::size_t winner = losers_[0];
+    value_type rv = detail::takeFront(*sources_[winner], 
+            std::integral_constant<bool, detail::HasTake<Source>::value>());
+    replay(winner);
+    return rv;
+}
+
+
+template <class Source, class CMP>
+void LoserTree<Source,CMP>::replay(std::size_t winner)
+{
+    for (std::size_t n = (winner + sources_.size()) / 2; n > 0; n /= 2){
+        if (beats(losers_[n], winner)){
+            std::swap(losers_[n], winner);
+        }
+    }
+    losers_[0] = winner;
+}
+
+
+template <class Source, class CMP>
+bool LoserTree<Source,CMP>::beats(std::size_t a, std::size_t b) const
+{
+    // Exhausted sources are sentinels greater than any element. Ties go to
+    // the source with the lower index. One comparison per match.
+    const Source* sa = sources_[a];
+    const Source* sb = sources_[b];
+    if (sb->empty()){
+        return !sa->empty() || a < b;
+    }
+    if (sa->empty()){
+        return false;
+    }
+    return a < b ? !cmp_(sb->front(), sa->front()) 
+                 : cmp_(sa->front(), sb->front());
+}
+
+
+template <class InIter, class OutIter, class CMP>
+OutIter kWayMerge(const std::vector<std::pair<InIter, InIter> >& ranges,
+                  OutIter out, const CMP& cmp)
+{
+    typedef detail::RangeSource<InIter> Source;
+    std::vector<Source> sources;
+    sources.reserve(ranges.size());
+    std::vector<Source*> pointers;
+    for (const std::pair<InIter, InIter>& r : ranges){
+        sources.push_back(Source(r.first, r.second));
+        pointers.push_back(&sources.back());
+    }
+    return kWayMerge(pointers, out, cmp);
+}
+
+
+template <class Source, class OutIter, class CMP>
+OutIter kWayMerge(const std::vector<Source*>& sources,
+                  OutIter out, const CMP& cmp)
+{
+    LoserTree<Source, CMP> tree(sources, cmp);
+    while (!tree.empty()){
+        *out++ = tree.take();
+    }
+    return out;
+}
+
+
+template <class FwrdIter, class CMP>
+void insertionSort(FwrdIter first, FwrdIter last, const CMP& cmp)
+{
+    detail::insertionSort(first, last, cmp,
+                          typename std::iterator_traits<FwrdIter>::iterator_category());
+}
+
+template <class RandIter, class KeyFn, class CMP>
+void sortByKey(RandIter first, RandIter last, const KeyFn& key, const CMP& cmp)
+{
+    typedef typename SortKey<RandIter, KeyFn>::type K;
+    
+    std::size_t n = last - first;
+    std::vector<std::pair<K, std::size_t> > decorated;
+    decorated.reserve(n);
+    for (std::size_t i = 0; i < n; ++i){
+        decorated.push_back( std::make_pair(key(first[i]), i) );
+    }
+    mergeSort(decorated.begin(), decorated.end(), 
+              detail::DecoratedKeyCmp<K, CMP>(cmp));
+    
+    detail::DecoratedIndex<K> source(decorated);
+    detail::applyPermutation(first, source, n);
+}
+
+
+template <class RandIter, class CMP>
+std::vector<std::size_t> argsort(RandIter first, RandIter last, const CMP& cmp)
+{
+    std::vector<std::size_t> indices(last - first);
+    for (std::size_t i = 0; i < indices.size(); ++i){
+        indices[i] = i;
+    }
+    mergeSort(indices.begin(), indices.end(), 
+              detail::IndexCmp<RandIter, CMP>(first, cmp));
+    return indices;
+}
+
+template <class T, class CMP>
+bool StreamingTopK<T,CMP>::EntryCmp::operator()(const Entry& a, 
+                                                const Entry& b) const
+{
+    if (cmp(a.first, b.first)){
+        return true;
+    }
+    return !cmp(b.first, a.first) && a.second < b.second;
+}
+
+
+template <class T, class CMP>
+StreamingTopK<T,CMP>::StreamingTopK(std::size_t k, const CMP& cmp) :
+    k_(k), cmp_(cmp), heap_(), pushed_(0)
+{
+    heap_.reserve(k);
+}
+
+
+template <class T, class CMP>
+bool StreamingTopK<T,CMP>::push(const T& t)
+{
+    return insert(t);
+}
+
+
+template <class T, class CMP>
+bool StreamingTopK<T,CMP>::push(T&& t)
+{
+    return insert(std::move(t));
+}
+
+
+template <class T, class CMP>
+bool StreamingTopK<T,CMP>::rejects(const T& t) const
+{
+    if (heap_.size() < k_){
+        return false;
+    }
+    // New element is the latest, so it precedes the root only if it is less.
+    return k_ == 0 || !cmp_.cmp(t, heap_.front().first);
+}
+
+
+template <class T, class CMP>
+template <class U>
+bool StreamingTopK<T,CMP>::insert(U&& t)
+{
+    if (rejects(t)){
+        ++pushed_;
+        return false;
+    }
+    if (heap_.size() == k_){
+        std::pop_heap(heap_.begin(), heap_.end(), cmp_);
+        heap_.back() = Entry(std::forward<U>(t), pushed_++);
+    }
+    else {
+        heap_.push_back( Entry(std::forward<U>(t), pushed_++) );
+    }
+    std::push_heap(heap_.begin(), heap_.end(), cmp_);
+    return true;
+}
+
+
+template <class T, class CMP>
+std::size_t StreamingTopK<T,CMP>::size() const
+{
+    return heap_.size();
+}
+
+
+template <class T, class CMP>
+std::size_t StreamingTopK<T,CMP>::k() const
+{
+    return k_;
+}
+
+
+template <class T, class CMP>
+const T& StreamingTopK<T,CMP>::threshold() const
+{
+    return heap_.front().first;
+}
+
+
+template <class T, class CMP>
+std::vector<T> StreamingTopK<T,CMP>::sorted() const
+{
+    std::vector<Entry> entries(heap_);
+    std::sort_heap(entries.begin(), entries.end(), cmp_);
+    std::vector<T> result;
+    result.reserve(entries.size());
+    for (Entry& e : entries){
+        result.push_back(std::move(e.first));
+    }
+    return result;
+}
+
+
+template <class T, class CMP>
+std::vector<T> StreamingTopK<T,CMP>::take()
+{
+    std::sort_heap(heap_.begin(), heap_.end(), cmp_);
+    std::vector<T> result;
+    result.reserve(heap_.size());
+    for (Entry& e : heap_){
+        result.push_back(std::move(e.first));
+    }
+    heap_.clear();
+    pushed_ = 0;
+    return result;
+}
+
+
+template <class InIter, class CMP>
+std::vector<typename std::iterator_traits<InIter>::value_type>
+topK(InIter first, InIter last, std::size_t k, const CMP& cmp)
+{
+    StreamingTopK<typename std::iterator_traits<InIter>::value_type, CMP> top(k, cmp);
+    for (; first != last; ++first){
+        top.push(*first);
+    }
+    return top.take();
+}
+
+
+template <class RandIter, class CMP>
+std::vector<typename std::iterator_traits<RandIter>::value_type>
+parallelTopK(RandIter first, RandIter last, std::size_t k, const CMP& cmp,
+             unsigned threads)
+{
+    typedef typename std::iterator_traits<RandIter>::value_type E;
+    
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::ptrdiff_t range = last - first;
+    const std::ptrdiff_t max_threads = range / PARALLEL_MERGESORT_MIN_CHUNK;
+    if (max_threads < static_cast<std::ptrdiff_t>(threads)){
+        threads = static_cast<unsigned>(std::max<std::ptrdiff_t>(1, max_threads));
+    }
+    if (threads == 1){
+        return topK(first, last, k, cmp);
+    }
+    
+    // Collect top k of each chunk, then merge chunk results in chunk order.
+    std::vector<std::vector<E> > partial(threads);
+    std::vector<std::function<void()> > tasks;
+    for (unsigned t = 0; t < threads; ++t){
+        const RandIter b = first + range * t / threads;
+        const RandIter e = first + range * (t + 1) / threads;
+        std::vector<E>* out = &partial[t];
+        tasks.push_back([=, &cmp]()
+        {
+            *out = topK(b, e, k, cmp);
+        });
+    }
+    detail::runTasks(tasks, threads);
+    
+    typedef std::move_iterator<typename std::vector<E>::iterator> MoveIter;
+    std::vector<std::pair<MoveIter, MoveIter> > ranges;
+    std::size_t candidates = 0;
+    for (std::vector<E>& p : partial){
+        ranges.push_back( std::make_pair(MoveIter(p.begin()), MoveIter(p.end())) );
+        candidates += p.size();
+    }
+    std::vector<E> result;
+    result.reserve(candidates);
+    kWayMerge(ranges, std::back_inserter(result), cmp);
+    if (result.size() > k){
+        result.erase(result.begin() + k, result.end());
+    }
+    return result;
+}
+
+
+template <class RandIter, class CMP>
+void nthElement(RandIter first, RandIter nth, RandIter last, const CMP& cmp)
+{
+    if (nth == last){
+        return;
+    }
+    unsigned rounds = 0;
+    for (std::ptrdiff_t n = last - first; n > 1; n /= 2){
+        rounds += 2;
+    }
+    while (last - first > static_cast<std::ptrdiff_t>(MERGESORT_INSERTION_THRESHOLD)){
+        if (rounds-- == 0){
+            PPUtils::mergeSort(first, last, cmp);
+            return;
+        }
+        RandIter cut = detail::partitionAroundMedian(first, last, cmp);
+        if (cut == nth){
+            return;
+        }
+        if (nth < cut){
+            last = cut;
+        }
+        else {
+            first = cut + 1;
+        }
+    }
+    detail::sortLeaf(first, last, cmp);
+}
+
+template <class T, std::size_t N, class CMP>
+void networkSort(std::array<T, N>& a, const CMP& cmp)
+{
+    detail::Network<N>::apply(a.begin(), cmp);
+}
+
+
+template <std::size_t N, class RandIter, class CMP>
+void networkSort(RandIter first, const CMP& cmp)
+{
+    detail::Network<N>::apply(first, cmp);
+}
+
+
+constexpr std::size_t sortingNetworkSize(std::size_t n)
+{
+    return detail::networkSize(n, detail::networkTopBit(n));
+}
+
+template <class T, class CMP>
+template <class InIter>
+StaticSearchIndex<T,CMP>::StaticSearchIndex(InIter first, InIter last,
+                                            const CMP& cmp) :
+    storage_(), tree_(nullptr), n_(0), levels_(0), cmp_(cmp)
+{
+    std::vector<T> sorted(first, last);
+    n_ = sorted.size();
+    while ((std::size_t(2) << levels_) - 1 <= n_){
+        ++levels_;
+    }
+    
+    // Node 0 is unused. Align node 0 to a cache line, so that nodes 
+    // 16k...16k+15 (for 4-byte keys) share one line.
+    const std::size_t per_line = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+    storage_.resize(n_ + per_line);
+    std::size_t offset = 0;
+    while (offset + 1 < per_line && 64 % sizeof(T) == 0 &&
+           reinterpret_cast<std::uintptr_t>(storage_.data() + offset) % 64 != 0){
+        ++offset;
+    }
+    tree_ = storage_.data() + offset;
+    fill(sorted.begin(), 1);
+}
+
+
+template <class T, class CMP>
+std::size_t StaticSearchIndex<T,CMP>::size() const
+{
+    return n_;
+}
+
+
+template <class T, class CMP>
+bool StaticSearchIndex<T,CMP>::empty() const
+{
+    return n_ == 0;
+}
+
+
+template <class T, class CMP>
+std::size_t StaticSearchIndex<T,CMP>::lowerBound(const T& key) const
+{
+    const std::size_t stride = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+    std::size_t k = 1;
+    for (std::size_t level = 0; level < levels_; ++level){
+        prefetchDescendants(k, stride);
+        k = 2 * k + cmp_(tree_[k], key);
+    }
+    if (k <= n_){
+        k = 2 * k + cmp_(tree_[k], key);
+    }
+    return resolve(k);
+}
+
+
+template <class T, class CMP>
+template <class InIter, class OutIter>
+OutIter StaticSearchIndex<T,CMP>::lowerBound(InIter first, InIter last, 
+                                             OutIter out) const
+{
+    const std::size_t stride = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+    T keys[STATIC_SEARCH_BATCH];
+    std::size_t k[STATIC_SEARCH_BATCH];
+    
+    while (first != last){
+        std::size_t batch = 0;
+        for (; batch < STATIC_SEARCH_BATCH && first != last; ++batch, ++first){
+            keys[batch] = *first;
+            k[batch] = 1;
+        }
+        for (std::size_t level = 0; level < levels_; ++level){
+            for (std::size_t q = 0; q < batch; ++q){
+                k[q] = 2 * k[q] + cmp_(tree_[k[q]], keys[q]);
+                prefetchDescendants(k[q], stride);
+            }
+        }
+        for (std::size_t q = 0; q < batch; ++q){
+            if (k[q] <= n_){
+                k[q] = 2 * k[q] + cmp_(tree_[k[q]], keys[q]);
+            }
+            *out++ = resolve(k[q]);
+        }
+    }
+    return out;
+}
+
+
+template <class T, class CMP>
+void StaticSearchIndex<T,CMP>::prefetchDescendants(std::size_t k, 
+                                                   std::size_t stride) const
+{
+    detail::prefetchRead(tree_ + std::min(k * stride, n_));
+}
+
+
+template <class T, class CMP>
+std::size_t StaticSearchIndex<T,CMP>::rank(std::size_t k) const
+{
+    // Levels 0...levels_-1 are complete. The last level has m nodes, which 
+    // are in-order between the nodes of level levels_-1.
+    const std::size_t depth = detail::highestBit(k);
+    const std::size_t pos = k - (std::size_t(1) << depth);
+    if (depth == levels_){
+        return 2 * pos;
+    }
+    const std::size_t m = n_ - ((std::size_t(1) << levels_) - 1);
+    const std::size_t before = (2 * pos + 1) << (levels_ - 1 - depth);
+    return before - 1 + std::min(m, before);
+}
+
+
+template <class T, class CMP>
+std::size_t StaticSearchIndex<T,CMP>::resolve(std::size_t k) const
+{
+    // Right turns are trailing ones. Strip them and the last left turn.
+    k >>= detail::trailingOnes(k) + 1;
+    return k == 0 ? n_ : rank(k);
+}
+
+
+template <class T, class CMP>
+template <class RandIter>
+RandIter StaticSearchIndex<T,CMP>::fill(RandIter it, std::size_t k)
+{
+    if (k <= n_){
+        it = fill(it, 2 * k);
+        tree_[k] = *it++;
+        it = fill(it, 2 * k + 1);
+    }
+    return it;
+}
+
+} // Namespace PPUtils
+
+#endif // ALGO_IMPL_HH
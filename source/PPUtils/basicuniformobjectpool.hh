@@ -0,0 +1,133 @@
+/* basicuniformobjectpool.hh
+ * This header file defines the PPUtils::BasicUniformObjectPool class
+ * template, a non-virtual object pool configured with compile-time policies.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef BASICUNIFORMOBJECTPOOL_HH
+#define BASICUNIFORMOBJECTPOOL_HH
+
+#include <memory>
+#include <cstddef>
+#include "poolpolicies.hh"
+
+namespace PPUtils
+{
+
+/*!
+ * \brief The BasicUniformObjectPool class
+ *  Object pool with the reserve/release interface of UniformObjectPool, but
+ *  with no virtual methods and no type-erased builder. The builder, storage,
+ *  locking and growth are template policies (see poolpolicies.hh), so that
+ *  with the default policies reserve and release inline into a few
+ *  instructions: a vector pop or push. Use UniformObjectPool when its
+ *  run-time features (idle limits, reset policies, PooledPtr) are needed,
+ *  and this class on hot paths.
+ *
+ *  The pool is thread safe, if Locking is thread safe (MutexLock or
+ *  SpinLock). Builder is called without holding the lock.
+ *
+ *  Type arguments:
+ *   \p T: Type of stored objects.
+ *
+ *   \p Builder: Functor returning a new T allocated with new. Default
+ *  constructs T.
+ *
+ *   \p Storage: Where idle objects are kept. VectorStorage (default) or
+ *  FixedStorage.
+ *
+ *   \p Locking: NoLock (default), MutexLock or SpinLock.
+ *
+ *   \p Growth: How many objects are built when the pool is empty.
+ *  GrowOnDemand (default), GrowBatch or GrowGeometric.
+ */
+template <class T,
+          class Builder = DefaultBuilder<T>,
+          class Storage = VectorStorage<T>,
+          class Locking = NoLock,
+          class Growth = GrowOnDemand>
+class BasicUniformObjectPool final
+{
+public:
+
+    /*!
+     * \brief Constructor.
+     * \param builder Builder used to construct new objects. A copy is used.
+     * \param growth Growth policy. A copy is used.
+     * \pre None.
+     * \post Pool is empty.
+     */
+    explicit BasicUniformObjectPool(const Builder& builder = Builder(),
+                                    const Growth& growth = Growth());
+
+    /*!
+     * \brief Destructor destroys all stored objects.
+     */
+    ~BasicUniformObjectPool();
+
+    //! Copy-constructor is forbidden.
+    BasicUniformObjectPool(const BasicUniformObjectPool&) = delete;
+
+    //! Copy-assignment is forbidden.
+    BasicUniformObjectPool& operator = (const BasicUniformObjectPool&) = delete;
+
+    /*!
+     * \brief Reserve next object from the pool.
+     * \return The most recently released object. If the pool is empty, new
+     *  objects are built as told by Growth: one is returned and the rest are
+     *  stored.
+     * \pre None.
+     * \post If Builder throws, objects built so far are stored and the
+     *  exception is propagated.
+     */
+    std::unique_ptr<T> reserve();
+
+    /*!
+     * \brief Return object to the pool.
+     * \param object Object returned to the pool.
+     * \pre object != nullptr, and object can be deleted with delete.
+     * \post Object is stored in its current state. If Storage is full, object
+     *  is destroyed instead.
+     */
+    void release(std::unique_ptr<T>&& object);
+
+    /*!
+     * \brief Return number of objects currently stored in the pool.
+     * \pre None.
+     */
+    unsigned size() const;
+
+    /*!
+     * \brief Return total number of objects built by this pool.
+     * \pre None.
+     */
+    std::size_t built() const;
+
+    /*!
+     * \brief Destroy all objects currently stored in the pool.
+     * \pre None.
+     * \post size() == 0.
+     */
+    void clear();
+
+
+private:
+
+    Builder builder_;
+    Growth growth_;
+    Storage storage_;
+    mutable Locking lock_;
+    std::size_t built_;
+
+    // Slow path of reserve: builds a batch of objects.
+    std::unique_ptr<T> grow();
+};
+
+} // Namespace PPUtils
+
+// Include template implementations.
+#include "basicuniformobjectpool_impl.hh"
+
+#endif // BASICUNIFORMOBJECTPOOL_HH
@@ -0,0 +1,133 @@
+/* basicuniformobjectpool_impl.hh
+ * This is the implementation file for the PPUtils::BasicUniformObjectPool
+ * class template methods.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef BASICUNIFORMOBJECTPOOL_IMPL_HH
+#define BASICUNIFORMOBJECTPOOL_IMPL_HH
+
+#include <cassert>
+#include <mutex>
+#include <utility>
+
+namespace PPUtils
+{
+
+template <class T, class Builder, class Storage, class Locking, class Growth>
+BasicUniformObjectPool<T,Builder,Storage,Locking,Growth>::
+BasicUniformObjectPool(const Builder& builder, const Growth& growth) :
+    builder_(builder), growth_(growth), storage_(), lock_(), built_(0)
+{
+}
+
+
+template <class T, class Builder, class Storage, class Locking, class Growth>
+BasicUniformObjectPool<T,Builder,Storage,Locking,Growth>::~BasicUniformObjectPool()
+{
+    clear();
+}
+
+
+template <class T, class Builder, class Storage, class Locking, class Growth>
+std::unique_ptr<T> BasicUniformObjectPool<T,Builder,Storage,Locking,Growth>::reserve()
+{
+    {
+        std::lock_guard<Locking> guard(lock_);
+        T* object = storage_.pop();
+        if (object != nullptr){
+            return std::unique_ptr<T>(object);
+        }
+    }
+    return grow();
+}
+
+
+template <class T, class Builder, class Storage, class Locking, class Growth>
+void BasicUniformObjectPool<T,Builder,Storage,Locking,Growth>::
+release(std::unique_ptr<T>&& object)
+{
+    assert(object != nullptr);
+    {
+        std::lock_guard<Locking> guard(lock_);
+        if (storage_.push(object.get())){
+            object.release();
+            return;
+        }
+    }
+    // Storage is full.
+    object.reset();
+}
+
+
+template <class T, class Builder, class Storage, class Locking, class Growth>
+unsigned BasicUniformObjectPool<T,Builder,Storage,Locking,Growth>::size() const
+{
+    std::lock_guard<Locking> guard(lock_);
+    return storage_.size();
+}
+
+
+template <class T, class Builder, class Storage, class Locking, class Growth>
+std::size_t BasicUniformObjectPool<T,Builder,Storage,Locking,Growth>::built() const
+{
+    std::lock_guard<Locking> guard(lock_);
+    return built_;
+}
+
+
+template <class T, class Builder, class Storage, class Locking, class Growth>
+void BasicUniformObjectPool<T,Builder,Storage,Locking,Growth>::clear()
+{
+    while (true){
+        T* object = nullptr;
+        {
+            std::lock_guard<Locking> guard(lock_);
+            object = storage_.pop();
+        }
+        if (object == nullptr){
+            return;
+        }
+        delete object;
+    }
+}
+
+
+template <class T, class Builder, class Storage, class Locking, class Growth>
+std::unique_ptr<T> BasicUniformObjectPool<T,Builder,Storage,Locking,Growth>::grow()
+{
+    std::size_t batch = 0;
+    {
+        std::lock_guard<Locking> guard(lock_);
+        batch = growth_.batch(built_);
+    }
+    assert(batch > 0);
+
+    std::unique_ptr<T> first(builder_());
+    {
+        std::lock_guard<Locking> guard(lock_);
+        ++built_;
+    }
+    for (std::size_t i = 1; i < batch; ++i){
+        std::unique_ptr<T> extra;
+        try {
+            extra.reset(builder_());
+        }
+        catch (...){
+            release(std::move(first));
+            throw;
+        }
+        {
+            std::lock_guard<Locking> guard(lock_);
+            ++built_;
+        }
+        release(std::move(extra));
+    }
+    return first;
+}
+
+} // Namespace PPUtils
+
+#endif // BASICUNIFORMOBJECTPOOL_IMPL_HH
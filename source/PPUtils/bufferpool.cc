@@ -0,0 +1,453 @@
+/* bufferpool.cc
+ *
+ * This is the implementation file for the PPUtils::BufferPool class defined
+ * in bufferpool.hh.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include "bufferpool.hh"
+#include "poolpolicies.hh"
+#include "mappedarena.hh"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <thread>
+#include <cstdint>
+
+namespace PPUtils
+{
+
+BufferPoolOptions::BufferPoolOptions() :
+    classes(BUFFER_CLASSES_QUARTERS), min_size(64), max_size(64 << 20),
+    huge_page_size(2 << 20), thread_max_size(64 << 10), thread_blocks(8),
+    shared_blocks(64)
+{
+}
+
+
+namespace detail
+{
+
+namespace
+{
+
+// Alignment of buffers not mapped with mmap.
+const std::size_t BUFFER_ALIGNMENT = 64;
+
+
+// Returns a number of the calling thread, used to pick its thread tier.
+unsigned threadNumber()
+{
+    static std::atomic<unsigned> next(0);
+    static thread_local unsigned number = next.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+
+// Idle buffers of one class.
+struct IdleList
+{
+    BufferBlock* head;
+    unsigned count;
+};
+
+
+BufferBlock* pop(IdleList& list)
+{
+    BufferBlock* block = list.head;
+    if (block != nullptr){
+        list.head = block->next;
+        --list.count;
+    }
+    return block;
+}
+
+
+bool push(IdleList& list, BufferBlock* block, unsigned limit)
+{
+    if (list.count >= limit){
+        return false;
+    }
+    block->next = list.head;
+    list.head = block;
+    ++list.count;
+    return true;
+}
+
+
+// Moves all blocks of lists to the front of out.
+void drain(std::vector<IdleList>& lists, BufferBlock*& out)
+{
+    for (IdleList& list : lists){
+        while (BufferBlock* block = pop(list)){
+            block->next = out;
+            out = block;
+        }
+    }
+}
+
+} // Anonymous namespace
+
+
+/*!
+ * \brief The BufferPoolCore class
+ *  State of a BufferPool. Every built block holds a reference to the core,
+ *  so the core lives as long as the pool or any of its buffers.
+ */
+class BufferPoolCore
+{
+public:
+
+    explicit BufferPoolCore(const BufferPoolOptions& options);
+
+    Buffer reserve(std::size_t size);
+    void release(BufferBlock* block) noexcept;
+    std::size_t classSize(std::size_t size) const;
+    unsigned classCount() const;
+    unsigned threadTiers() const;
+    std::size_t idle(bool bytes) const;
+    void trim();
+
+    // Destroys idle blocks and stops storing released ones. Called when the
+    // pool is destroyed.
+    void close();
+
+    // Drops a reference. Destroys the core, when the last one is gone.
+    void unref() noexcept;
+
+private:
+
+    // Idle lists of one thread tier. Padded, so that tiers do not share the
+    // cache line of their lock.
+    struct ThreadTier
+    {
+        mutable SpinLock lock;
+        bool closed;
+        std::vector<IdleList> lists;
+        char padding[64];
+    };
+
+    const BufferPoolOptions options_;
+    std::vector<std::size_t> class_sizes_;
+    unsigned thread_classes_;       // Classes kept in thread tiers.
+    unsigned tier_count_;
+    std::unique_ptr<ThreadTier[]> tiers_;
+    mutable std::mutex mx_;         // Guards the shared tier.
+    bool closed_;
+    std::vector<IdleList> shared_;
+    std::atomic<std::size_t> refs_;
+
+    unsigned classOf(std::size_t size) const;
+    ThreadTier& threadTier();
+    BufferBlock* build(unsigned size_class, std::size_t capacity);
+    void destroy(BufferBlock* block) noexcept;
+    void destroyAll(BufferBlock* list) noexcept;
+};
+
+
+BufferPoolCore::BufferPoolCore(const BufferPoolOptions& options) :
+    options_(options), class_sizes_(), thread_classes_(0),
+    tier_count_(std::max(BUFFER_POOL_THREAD_TIERS, std::thread::hardware_concurrency())),
+    tiers_(new ThreadTier[tier_count_]), mx_(), closed_(false),
+    shared_(), refs_(1)
+{
+    assert(options.min_size <= options.max_size);
+    std::size_t power = 1;
+    while (power < options.min_size){
+        power <<= 1;
+    }
+    const unsigned steps = options.classes == BUFFER_CLASSES_QUARTERS ? 4 : 1;
+    while (class_sizes_.empty() || class_sizes_.back() < options.max_size){
+        for (unsigned k = 0; k < steps; ++k){
+            const std::size_t size = power + power / 4 * k;
+            if (class_sizes_.empty() || size > class_sizes_.back()){
+                class_sizes_.push_back(size);
+            }
+            if (class_sizes_.back() >= options.max_size){
+                break;
+            }
+        }
+        power <<= 1;
+    }
+    while (thread_classes_ < class_sizes_.size() &&
+           class_sizes_[thread_classes_] <= options.thread_max_size){
+        ++thread_classes_;
+    }
+
+    const IdleList empty = {nullptr, 0};
+    shared_.assign(class_sizes_.size(), empty);
+    for (unsigned i = 0; i < tier_count_; ++i){
+        tiers_[i].closed = false;
+        tiers_[i].lists.assign(thread_classes_, empty);
+    }
+}
+
+
+Buffer BufferPoolCore::reserve(std::size_t size)
+{
+    if (size > class_sizes_.back()){
+        BufferBlock* block = build(BufferBlock::NO_CLASS, size);
+        block->refs.store(1, std::memory_order_relaxed);
+        return Buffer(block, size);
+    }
+    const unsigned size_class = classOf(size);
+    BufferBlock* block = nullptr;
+    if (size_class < thread_classes_){
+        ThreadTier& tier = threadTier();
+        std::lock_guard<SpinLock> lock(tier.lock);
+        block = pop(tier.lists[size_class]);
+    }
+    if (block == nullptr){
+        std::lock_guard<std::mutex> lock(mx_);
+        block = pop(shared_[size_class]);
+    }
+    if (block == nullptr){
+        block = build(size_class, class_sizes_[size_class]);
+    }
+    block->refs.store(1, std::memory_order_relaxed);
+    return Buffer(block, size);
+}
+
+
+void BufferPoolCore::release(BufferBlock* block) noexcept
+{
+    const unsigned size_class = block->size_class;
+    if (size_class != BufferBlock::NO_CLASS){
+        if (size_class < thread_classes_){
+            ThreadTier& tier = threadTier();
+            std::lock_guard<SpinLock> lock(tier.lock);
+            if (!tier.closed && push(tier.lists[size_class], block, options_.thread_blocks)){
+                return;
+            }
+        }
+        // Thread tier is full: try the shared tier.
+        std::lock_guard<std::mutex> lock(mx_);
+        if (!closed_ && push(shared_[size_class], block, options_.shared_blocks)){
+            return;
+        }
+    }
+    destroy(block);
+}
+
+
+std::size_t BufferPoolCore::classSize(std::size_t size) const
+{
+    if (size > class_sizes_.back()){
+        return size;
+    }
+    return class_sizes_[classOf(size)];
+}
+
+
+unsigned BufferPoolCore::classCount() const
+{
+    return class_sizes_.size();
+}
+
+
+unsigned BufferPoolCore::threadTiers() const
+{
+    return tier_count_;
+}
+
+
+std::size_t BufferPoolCore::idle(bool bytes) const
+{
+    std::size_t rv = 0;
+    for (unsigned i = 0; i < tier_count_; ++i){
+        std::lock_guard<SpinLock> lock(tiers_[i].lock);
+        for (unsigned c = 0; c < thread_classes_; ++c){
+            rv += tiers_[i].lists[c].count * (bytes ? class_sizes_[c] : 1);
+        }
+    }
+    std::lock_guard<std::mutex> lock(mx_);
+    for (unsigned c = 0; c < class_sizes_.size(); ++c){
+        rv += shared_[c].count * (bytes ? class_sizes_[c] : 1);
+    }
+    return rv;
+}
+
+
+void BufferPoolCore::trim()
+{
+    BufferBlock* blocks = nullptr;
+    for (unsigned i = 0; i < tier_count_; ++i){
+        std::lock_guard<SpinLock> lock(tiers_[i].lock);
+        drain(tiers_[i].lists, blocks);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mx_);
+        drain(shared_, blocks);
+    }
+    destroyAll(blocks);
+}
+
+
+void BufferPoolCore::close()
+{
+    BufferBlock* blocks = nullptr;
+    for (unsigned i = 0; i < tier_count_; ++i){
+        std::lock_guard<SpinLock> lock(tiers_[i].lock);
+        tiers_[i].closed = true;
+        drain(tiers_[i].lists, blocks);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mx_);
+        closed_ = true;
+        drain(shared_, blocks);
+    }
+    destroyAll(blocks);
+}
+
+
+void BufferPoolCore::unref() noexcept
+{
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1){
+        delete this;
+    }
+}
+
+
+unsigned BufferPoolCore::classOf(std::size_t size) const
+{
+    return std::lower_bound(class_sizes_.begin(), class_sizes_.end(), size)
+            - class_sizes_.begin();
+}
+
+
+BufferPoolCore::ThreadTier& BufferPoolCore::threadTier()
+{
+    return tiers_[threadNumber() % tier_count_];
+}
+
+
+BufferBlock* BufferPoolCore::build(unsigned size_class, std::size_t capacity)
+{
+    char* data = nullptr;
+    std::size_t mapped_bytes = 0;
+    if (options_.huge_page_size != 0 && capacity >= options_.huge_page_size){
+        ArenaPages pages;
+        data = detail::mapPages(capacity, ARENA_PAGES_HUGETLB, options_.huge_page_size,
+                                false, mapped_bytes, pages);
+    }
+    // Header and data share one allocation, unless data is mapped.
+    const std::size_t bytes = data != nullptr
+            ? sizeof(BufferBlock)
+            : sizeof(BufferBlock) + BUFFER_ALIGNMENT - 1 + capacity;
+    char* raw = nullptr;
+    try {
+        raw = static_cast<char*>(::operator new(bytes));
+    }
+    catch (...){
+        if (data != nullptr){
+            unmapPages(data, mapped_bytes);
+        }
+        throw;
+    }
+    if (data == nullptr){
+        const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(raw + sizeof(BufferBlock));
+        data = raw + sizeof(BufferBlock) +
+                (BUFFER_ALIGNMENT - first % BUFFER_ALIGNMENT) % BUFFER_ALIGNMENT;
+    }
+
+    BufferBlock* block = new (raw) BufferBlock();
+    block->core = this;
+    block->data = data;
+    block->capacity = capacity;
+    block->size_class = size_class;
+    block->mapped = mapped_bytes != 0;
+    block->mapped_bytes = mapped_bytes;
+    block->next = nullptr;
+    refs_.fetch_add(1, std::memory_order_relaxed);
+    return block;
+}
+
+
+void BufferPoolCore::destroy(BufferBlock* block) noexcept
+{
+    if (block->mapped){
+        unmapPages(block->data, block->mapped_bytes);
+    }
+    block->~BufferBlock();
+    ::operator delete(block);
+    unref();
+}
+
+
+void BufferPoolCore::destroyAll(BufferBlock* list) noexcept
+{
+    while (list != nullptr){
+        BufferBlock* next = list->next;
+        destroy(list);
+        list = next;
+    }
+}
+
+
+void releaseBlock(BufferBlock* block) noexcept
+{
+    block->core->release(block);
+}
+
+} // Namespace detail
+
+
+BufferPool::BufferPool(const BufferPoolOptions& options) :
+    core_(new detail::BufferPoolCore(options))
+{
+}
+
+
+BufferPool::~BufferPool()
+{
+    core_->close();
+    core_->unref();
+}
+
+
+Buffer BufferPool::reserve(std::size_t size)
+{
+    return core_->reserve(size);
+}
+
+
+std::size_t BufferPool::classSize(std::size_t size) const
+{
+    return core_->classSize(size);
+}
+
+
+unsigned BufferPool::classCount() const
+{
+    return core_->classCount();
+}
+
+
+unsigned BufferPool::threadTiers() const
+{
+    return core_->threadTiers();
+}
+
+
+std::size_t BufferPool::idle() const
+{
+    return core_->idle(false);
+}
+
+
+std::size_t BufferPool::idleBytes() const
+{
+    return core_->idle(true);
+}
+
+
+void BufferPool::trim()
+{
+    core_->trim();
+}
+
+} // Namespace PPUtils
@@ -0,0 +1,351 @@
+/* bufferpool.hh
+ * This header defines the PPUtils::BufferPool class, a pool of byte buffers
+ * of varying sizes, and PPUtils::Buffer, a reference counted handle to a
+ * pooled buffer.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef BUFFERPOOL_HH
+#define BUFFERPOOL_HH
+
+#include <atomic>
+#include <utility>
+#include <cstddef>
+#include <cassert>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief Spacing of the size classes of a BufferPool.
+ */
+enum BufferSizeClasses
+{
+    BUFFER_CLASSES_POWER_OF_TWO = 0,    //!< 64, 128, 256, ... Up to 50 % waste.
+    BUFFER_CLASSES_QUARTERS = 1         //!< Four classes per power of two, as
+                                        //!< in jemalloc: 64, 80, 96, 112, 128,
+                                        //!< 160, ... Up to 20 % waste.
+};
+
+/*!
+ * \brief Minimum number of thread tiers of a BufferPool. A pool has one tier
+ *  per hardware thread, but at least this many.
+ */
+const unsigned BUFFER_POOL_THREAD_TIERS = 16;
+
+
+/*!
+ * \brief The BufferPoolOptions struct
+ *  Configuration of a BufferPool. Default constructed options suit I/O
+ *  buffers from 64 bytes to 64 MiB.
+ */
+struct BufferPoolOptions
+{
+    BufferSizeClasses classes;      //!< Spacing of size classes.
+    std::size_t min_size;           //!< Smallest class, rounded up to a
+                                    //!< power of two. Default 64.
+    std::size_t max_size;           //!< Largest pooled class. Larger buffers
+                                    //!< are allocated and freed directly.
+                                    //!< Default 64 MiB.
+    std::size_t huge_page_size;     //!< Classes at least this large are
+                                    //!< mapped on huge pages. 0 disables.
+                                    //!< Default 2 MiB.
+    std::size_t thread_max_size;    //!< Largest class kept in thread tiers.
+                                    //!< Default 64 KiB.
+    unsigned thread_blocks;         //!< Idle buffers per class kept in each
+                                    //!< thread tier. Default 8.
+    unsigned shared_blocks;         //!< Idle buffers per class kept in the
+                                    //!< shared tier. Default 64.
+
+    //! Constructor sets the default values.
+    BufferPoolOptions();
+};
+
+
+namespace detail
+{
+
+class BufferPoolCore;
+
+// Pooled memory block shared by the Buffers referring to it.
+struct BufferBlock
+{
+    std::atomic<unsigned> refs;     // Buffers referring to this block.
+    BufferPoolCore* core;
+    char* data;
+    std::size_t capacity;
+    unsigned size_class;            // Index, or NO_CLASS if not pooled.
+    bool mapped;                    // Data is mapped with mmap.
+    std::size_t mapped_bytes;
+    BufferBlock* next;              // Link in idle lists.
+
+    static const unsigned NO_CLASS = static_cast<unsigned>(-1);
+};
+
+// Returns block, whose last reference is gone, to its pool.
+void releaseBlock(BufferBlock* block) noexcept;
+
+} // Namespace detail
+
+
+/*!
+ * \brief The Buffer class
+ *  Reference counted handle to a byte range of a pooled buffer. Copies and
+ *  slices of a Buffer share the same memory without copying it, and the
+ *  memory returns to its BufferPool when the last of them is destroyed,
+ *  even if the pool has been destroyed already. Reference counting is
+ *  thread safe, so slices can be handed to readers in other threads;
+ *  synchronizing access to the bytes is left to the user.
+ */
+class Buffer
+{
+public:
+
+    /*!
+     * \brief Constructor. Constructs an empty Buffer.
+     */
+    Buffer() noexcept : block_(nullptr), data_(nullptr), size_(0) {}
+
+    /*!
+     * \brief Copy-constructor. The copy refers to the same bytes.
+     */
+    Buffer(const Buffer& other) noexcept :
+        block_(other.block_), data_(other.data_), size_(other.size_)
+    {
+        acquire();
+    }
+
+    /*!
+     * \brief Move-constructor. \p other is left empty.
+     */
+    Buffer(Buffer&& other) noexcept :
+        block_(other.block_), data_(other.data_), size_(other.size_)
+    {
+        other.block_ = nullptr;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    /*!
+     * \brief Destructor. Returns the memory to its pool, if this is the last
+     *  Buffer referring to it.
+     */
+    ~Buffer() {reset();}
+
+    //! Copy-assignment operator.
+    Buffer& operator = (const Buffer& other) noexcept
+    {
+        Buffer copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    //! Move-assignment operator. \p other is left empty.
+    Buffer& operator = (Buffer&& other) noexcept
+    {
+        Buffer moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    //! Returns the first byte. nullptr, if empty.
+    char* data() const noexcept {return data_;}
+
+    //! Returns number of bytes in this Buffer.
+    std::size_t size() const noexcept {return size_;}
+
+    /*!
+     * \brief Return number of bytes available from data() to the end of the
+     *  underlying memory block.
+     */
+    std::size_t capacity() const noexcept
+    {
+        return block_ == nullptr ? 0 : block_->capacity - (data_ - block_->data);
+    }
+
+    /*!
+     * \brief Change size of this Buffer, e.g. to the number of bytes read.
+     * \pre new_size <= capacity().
+     * \post size() == new_size. Other Buffers sharing the bytes are not
+     *  changed.
+     */
+    void resize(std::size_t new_size) noexcept
+    {
+        assert(new_size <= capacity());
+        size_ = new_size;
+    }
+
+    /*!
+     * \brief Return a Buffer referring to bytes [offset, offset + length) of
+     *  this Buffer. No bytes are copied.
+     * \pre offset + length <= size().
+     */
+    Buffer slice(std::size_t offset, std::size_t length) const noexcept
+    {
+        assert(offset + length <= size_);
+        Buffer rv(*this);
+        rv.data_ += offset;
+        rv.size_ = length;
+        return rv;
+    }
+
+    /*!
+     * \brief Return true, if no other Buffer shares the memory.
+     */
+    bool unique() const noexcept
+    {
+        return block_ != nullptr && block_->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    //! Returns true, if this Buffer is not empty.
+    explicit operator bool() const noexcept {return block_ != nullptr;}
+
+    /*!
+     * \brief Release the memory and make this Buffer empty.
+     */
+    void reset() noexcept
+    {
+        if (block_ != nullptr &&
+                block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+            detail::releaseBlock(block_);
+        }
+        block_ = nullptr;
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    //! Swaps contents with \p other.
+    void swap(Buffer& other) noexcept
+    {
+        std::swap(block_, other.block_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+    }
+
+
+private:
+
+    friend class detail::BufferPoolCore;
+
+    detail::BufferBlock* block_;
+    char* data_;
+    std::size_t size_;
+
+    // Takes over a block with reference count 1.
+    Buffer(detail::BufferBlock* block, std::size_t size) noexcept :
+        block_(block), data_(block->data), size_(size) {}
+
+    void acquire() noexcept
+    {
+        if (block_ != nullptr){
+            block_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+
+/*!
+ * \brief The BufferPool class
+ *  Pool of byte buffers of varying sizes. Requested sizes are rounded up to
+ *  the next size class, and a buffer of a class serves any request of that
+ *  class, so e.g. a 4097-byte request reuses an idle 5120-byte buffer.
+ *
+ *  Idle buffers of small classes are kept first in a spin-locked thread tier
+ *  of the releasing thread, and then in a shared tier used by all threads.
+ *  Threads are assigned to the thread tiers round-robin in the order they
+ *  first use any BufferPool. There are threadTiers() of them, so a thread
+ *  has its tier to itself only while there are at most that many threads;
+ *  beyond that, threads share tiers and contend on their locks. Classes of at least huge_page_size bytes are mapped
+ *  directly with mmap on huge pages, or on normal pages with a transparent
+ *  huge page hint if no huge pages are reserved, so that large buffers do
+ *  not exhaust the TLB.
+ *
+ *  Buffers are handed out as reference counted Buffers, which may be sliced
+ *  and shared without copying the bytes. The class is thread safe.
+ */
+class BufferPool
+{
+public:
+
+    /*!
+     * \brief Constructor.
+     * \param options Size classes and tier limits of the pool.
+     * \pre options.min_size <= options.max_size.
+     * \post Pool is empty.
+     */
+    explicit BufferPool(const BufferPoolOptions& options = BufferPoolOptions());
+
+    /*!
+     * \brief Destructor destroys idle buffers.
+     * \pre The pool is not used by other threads. Buffers may still be
+     *  destroyed by other threads.
+     * \post Buffers destroyed later free their memory.
+     */
+    ~BufferPool();
+
+    //! Copy-constructor is forbidden.
+    BufferPool(const BufferPool&) = delete;
+
+    //! Copy-assignment is forbidden.
+    BufferPool& operator = (const BufferPool&) = delete;
+
+    /*!
+     * \brief Reserve a buffer of at least \p size bytes.
+     * \return Buffer with size() == size and capacity() == classSize(size).
+     *  Contents of the bytes are unspecified.
+     * \pre None.
+     * \exception std::bad_alloc, if memory cannot be allocated.
+     */
+    Buffer reserve(std::size_t size);
+
+    /*!
+     * \brief Return capacity of buffers reserved for \p size bytes: size
+     *  rounded up to the next class, or size itself if it is larger than
+     *  the largest class.
+     * \pre None.
+     */
+    std::size_t classSize(std::size_t size) const;
+
+    /*!
+     * \brief Return number of size classes.
+     * \pre None.
+     */
+    unsigned classCount() const;
+
+    /*!
+     * \brief Return number of thread tiers: hardware threads of the machine,
+     *  but at least BUFFER_POOL_THREAD_TIERS.
+     * \pre None.
+     */
+    unsigned threadTiers() const;
+
+    /*!
+     * \brief Return number of idle buffers in all tiers.
+     * \pre None.
+     */
+    std::size_t idle() const;
+
+    /*!
+     * \brief Return number of bytes in idle buffers in all tiers.
+     * \pre None.
+     */
+    std::size_t idleBytes() const;
+
+    /*!
+     * \brief Destroy all idle buffers.
+     * \pre None.
+     * \post idle() == 0, unless buffers were released meanwhile.
+     */
+    void trim();
+
+
+private:
+
+    detail::BufferPoolCore* core_;
+};
+
+} // Namespace PPUtils
+
+#endif // BUFFERPOOL_HH
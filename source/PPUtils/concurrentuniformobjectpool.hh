@@ -11,8 +11,8 @@ namespace PPUtils
  * \brief The ConcurrentUniformObjectPool class
  *  This is a thread safe version of UniformObjectPool.
  */
-template <class T, class Builder = std::function<T*()> >
-class ConcurrentUniformObjectPool : public UniformObjectPool
+template <class T, class Builder = std::function<T*()>, class ResetPolicy = NoReset>
+class ConcurrentUniformObjectPool : public UniformObjectPool<T, Builder, ResetPolicy>
 {
 public:
     
@@ -22,7 +22,8 @@ public:
      * \pre builder != nullptr
      * \post Does the same as UniformObjectPool's corresponding constructor.
      */
-    explicit ConcurrentUniformObjectPool(Builder* builder);
+    explicit ConcurrentUniformObjectPool(Builder* builder, unsigned initial_size = 0,
+                                         const ResetPolicy& reset_policy = ResetPolicy());
     
     /*!
      * \brief Constructor
@@ -30,13 +31,17 @@ public:
      * \pre None.
      * \post Does the same as UniformObjectPool's corresponding constructor.
      */
-    explicit ConcurrentUniformObjectPool(const Builder& builder = DEFAULT_BUILDER);
+    explicit ConcurrentUniformObjectPool(
+            const Builder& builder = UniformObjectPool<T, Builder, ResetPolicy>::DEFAULT_BUILDER,
+            unsigned initial_size = 0,
+            const ResetPolicy& reset_policy = ResetPolicy());
     
     /*!
      * \brief Destructor.
      * \pre  Undefined behaviour occurs, if any other thread is accessing the 
-     *  object at the moment.
+     *  object at the moment. PooledPtrs may still be destroyed concurrently.
      * \post destroys this object and all its currently stored objects.
+     *  PooledPtrs destroyed later destroy their objects.
      */
     virtual ~ConcurrentUniformObjectPool();
     
@@ -61,24 +66,70 @@ public:
     ConcurrentUniformObjectPool& operator=(ConcurrentUniformObjectPool&&) = delete;
     
     /*!
-     * \brief Reimplements UniformObjectPool::reserve to be thread safe.
+     * \brief Reimplements UniformObjectPool::reserve to be thread safe. Objects
+     *  are reset, validated and built without holding the lock.
      */
     virtual typename std::unique_ptr<T> reserve();
     
     /*!
-     * \brief Reimplements UniformObjectPool::release to be thread safe.
+     * \brief Reimplements UniformObjectPool::release to be thread safe. Eager
+     *  reset is done without holding the lock.
      */
     virtual void release(typename std::unique_ptr<T>&& object);
     
+    /*!
+     * \brief Reimplements UniformObjectPool::prewarm to be thread safe.
+     *  Objects are built without holding the lock, so the pool can be used
+     *  while it is being prewarmed.
+     */
+    virtual std::chrono::steady_clock::duration prewarm(unsigned n,
+                                                        unsigned threads = 1);
+    
     /*!
      * \brief Reimplements UniformObjectPool::clear to be thread safe.
      */
     virtual void clear();
     
+    /*!
+     * \brief Reimplements UniformObjectPool::setMaxIdle to be thread safe.
+     */
+    virtual void setMaxIdle(unsigned max_idle);
+    
+    /*!
+     * \brief Reimplements UniformObjectPool::trim to be thread safe.
+     */
+    virtual void trim(unsigned target_size);
+    
+    /*!
+     * \brief Reimplements UniformObjectPool::setMaxIdleTime to be thread safe.
+     */
+    virtual void setMaxIdleTime(std::chrono::steady_clock::duration max_idle_time);
+    
+    /*!
+     * \brief Reimplements UniformObjectPool::evictIdle to be thread safe.
+     *  Can be called from a background thread, see PoolEvictor.
+     */
+    virtual unsigned evictIdle();
+    
+    /*!
+     * \brief Reimplements UniformObjectPool::resetDirty to be thread safe.
+     *  Objects are reset without holding the lock, so the pool can be used
+     *  meanwhile. Can be called from a background thread, see PoolCleaner.
+     */
+    virtual unsigned resetDirty();
+    
+    /*!
+     * \brief Reimplements UniformObjectPool::statistics to be thread safe.
+     *  Counters are updated without the lock by other threads, so reserves
+     *  and releases going on while the snapshot is taken may be partly
+     *  included.
+     */
+    virtual PoolStatistics statistics() const;
+    
     
 private:
     
-    std::mutex mx_;
+    mutable std::mutex mx_;
 };
 
 } // namespace PPUtils
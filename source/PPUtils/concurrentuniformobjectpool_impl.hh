@@ -1,57 +1,187 @@
 #ifndef CONCURRENTUNIFORMOBJECTPOOL_IMPL_HH
 #define CONCURRENTUNIFORMOBJECTPOOL_IMPL_HH
 
+#include <cassert>
+
 namespace PPUtils 
 {
 
-template <class T, class Builder>
-ConcurrentUniformObjectPool<T,Builder>::
-ConcurrentUniformObjectPool(Builder* builder) :
-    UniformObjectPool<T,Builder>(builder), mx_()
+template <class T, class Builder, class ResetPolicy>
+ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::
+ConcurrentUniformObjectPool(Builder* builder, unsigned initial_size,
+                            const ResetPolicy& reset_policy) :
+    UniformObjectPool<T,Builder,ResetPolicy>(builder, initial_size, reset_policy), mx_()
+{
+    this->makeLink(true);
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::
+ConcurrentUniformObjectPool(const Builder& builder, unsigned initial_size,
+                            const ResetPolicy& reset_policy) :
+    UniformObjectPool<T,Builder,ResetPolicy>(builder, initial_size, reset_policy), mx_()
+{
+    this->makeLink(true);
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::~ConcurrentUniformObjectPool()
 {
+    // Stop PooledPtrs before release() stops locking.
+    this->detachLink();
 }
 
 
-template <class T, class Builder>
-ConcurrentUniformObjectPool<T,Builder>::
-ConcurrentUniformObjectPool(const PPUtils::Builder& builder) :
-    UniformObjectPool<T,Builder>(builder), mx_()
+template <class T, class Builder, class ResetPolicy>
+std::unique_ptr<T> ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::reserve()
 {
+    // Reset, validation and building are done without the lock.
+    typename std::unique_ptr<T> rv(nullptr);
+    bool dirty = false;
+    bool rejected = false;
+    while (true){
+        std::unique_lock<std::mutex> lock(mx_);
+        // Outstanding count changes only under the lock. An object rejected
+        // by the validator is replaced by the next one without counting.
+        if (!rejected){
+            this->countOutstanding(1);
+        }
+        if (!this->takeIdle(rv, dirty)){
+            break;
+        }
+        lock.unlock();
+        if (this->prepareReserved(*rv, dirty)){
+            this->countReserve(true);
+            return rv;
+        }
+        rv.reset();
+        rejected = true;
+    }
+    try {
+        rv = this->buildObject();
+    }
+    catch (...){
+        std::lock_guard<std::mutex> lock(mx_);
+        this->countOutstanding(-1);
+        throw;
+    }
+    this->countReserve(false);
+    return rv;
 }
 
 
-template <class T, class Builder>
-ConcurrentUniformObjectPool<T,Builder>::~ConcurrentUniformObjectPool()
-{   
+template <class T, class Builder, class ResetPolicy>
+void ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::
+release(std::unique_ptr<T>&& object)
+{
+    assert(object != nullptr);
+    const bool dirty = this->prepareReleased(*object);
+    this->countRelease();
+    std::lock_guard<std::mutex> lock(mx_);
+    this->countOutstanding(-1);
+    this->storeIdle(std::move(object), dirty);
 }
 
 
-template <class T, class Builder>
-std::unique_ptr<T> ConcurrentUniformObjectPool<T,Builder>::reserve()
+template <class T, class Builder, class ResetPolicy>
+std::chrono::steady_clock::duration
+ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::prewarm(unsigned n, unsigned threads)
 {
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
     std::unique_lock<std::mutex> lock(mx_);
-    if (this->size() > 0){
-        return UniformObjectPool(mx_);
+    const unsigned max_idle = this->maxIdle();
+    const unsigned room = max_idle - std::min<unsigned>(max_idle, this->size());
+    n = std::min(n, room);
+    lock.unlock();
+    
+    std::vector<std::unique_ptr<T> > built;
+    std::exception_ptr error = this->buildObjects(n, threads, built);
+    lock.lock();
+    for (std::unique_ptr<T>& object : built){
+        this->storeIdle(std::move(object), false);
     }
     lock.unlock();
-    return typename std::unique_ptr<T>( this->getBuilder()->operator()() );
+    if (error != nullptr){
+        std::rethrow_exception(error);
+    }
+    return std::chrono::steady_clock::now() - start;
 }
 
 
-template <class T, class Builder>
-void ConcurrentUniformObjectPool<T,Builder>::
-release(std::unique_ptr<T>&& object)
+template <class T, class Builder, class ResetPolicy>
+unsigned ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::resetDirty()
+{
+    std::vector<std::unique_ptr<T> > objects;
+    std::unique_lock<std::mutex> lock(mx_);
+    this->takeDirty(objects);
+    lock.unlock();
+    
+    for (std::unique_ptr<T>& object : objects){
+        if (!this->prepareReserved(*object, true)){
+            object.reset();
+        }
+    }
+    
+    lock.lock();
+    for (std::unique_ptr<T>& object : objects){
+        if (object != nullptr){
+            this->storeIdle(std::move(object), false);
+        }
+    }
+    lock.unlock();
+    return objects.size();
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+PoolStatistics ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::statistics() const
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    return UniformObjectPool<T,Builder,ResetPolicy>::statistics();
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::clear()
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    UniformObjectPool<T,Builder,ResetPolicy>::clear();
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::setMaxIdle(unsigned max_idle)
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    UniformObjectPool<T,Builder,ResetPolicy>::setMaxIdle(max_idle);
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::trim(unsigned target_size)
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    UniformObjectPool<T,Builder,ResetPolicy>::trim(target_size);
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::
+setMaxIdleTime(std::chrono::steady_clock::duration max_idle_time)
 {
     std::lock_guard<std::mutex> lock(mx_);
-    UniformObjectPool::release( std::move(object) );
+    UniformObjectPool<T,Builder,ResetPolicy>::setMaxIdleTime(max_idle_time);
 }
 
 
-template <class T, class Builder>
-void ConcurrentUniformObjectPool<T,Builder>::clear()
+template <class T, class Builder, class ResetPolicy>
+unsigned ConcurrentUniformObjectPool<T,Builder,ResetPolicy>::evictIdle()
 {
     std::lock_guard<std::mutex> lock(mx_);
-    UniformObjectPool::clear();
+    return UniformObjectPool<T,Builder,ResetPolicy>::evictIdle();
 }
 
 } // namespace PPUtils
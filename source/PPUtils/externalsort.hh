@@ -0,0 +1,179 @@
+/* externalsort.hh
+ * This header defines the PPUtils::ExternalSorter class template and the
+ * PPUtils::externalSort function template for sorting data sets that do not
+ * fit into memory.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef EXTERNALSORT_HH
+#define EXTERNALSORT_HH
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief The ExternalSorter class template
+ *  Sorts streams of fixed-size records that are larger than the available
+ *  memory. Sorting is done in three phases:
+ *
+ *  1. Records are streamed from a file or an input iterator into chunks that
+ *  fit the memory budget.
+ *  2. Each chunk is sorted with parallelMergeSort and written into a
+ *  temporary run file.
+ *  3. Run files are merged with a LoserTree k-way merge. Each run is read in large
+ *  blocks, and the next block of each run is read in the background while
+ *  the current one is merged. Output blocks are written in the background
+ *  too. If there are too many runs to merge at once within the memory budget,
+ *  runs are merged in several passes.
+ *
+ *  If all records fit into one chunk, no temporary files are created.
+ *  The sort is stable. Temporary files are removed also if sorting fails.
+ *
+ *  Type arguments:
+ *   \p T: Record type. Must be trivially copyable and default-constructible.
+ *  Records are written to files in their in-memory representation.
+ *
+ *   \p CMP: Comparator that defines the record order, like in mergeSort.
+ *  It is called from several threads concurrently.
+ *
+ *  One ExternalSorter should be used from one thread at a time.
+ */
+template <class T, class CMP = std::less<T> >
+class ExternalSorter
+{
+public:
+
+    /*!
+     * \brief Default memory budget in bytes.
+     */
+    static const std::size_t DEFAULT_MEMORY_BUDGET = std::size_t(256) << 20;
+
+    /*!
+     * \brief Smallest block size in bytes used to read a run file during a
+     *  merge. Limits the number of runs merged in one pass.
+     */
+    static const std::size_t MIN_MERGE_BLOCK = std::size_t(256) << 10;
+
+    /*!
+     * \brief Constructor.
+     * \param memory_budget Approximate maximum number of bytes used for
+     *  record buffers.
+     * \param temp_dir Directory where the temporary run files are created.
+     * \param threads Maximum number of threads used to sort chunks. If 0,
+     *  std::thread::hardware_concurrency() threads are used.
+     * \param cmp Comparator.
+     * \pre @p temp_dir exists and is writable.
+     * \post ExternalSorter is ready to use.
+     */
+    explicit ExternalSorter(std::size_t memory_budget = DEFAULT_MEMORY_BUDGET,
+                            const std::string& temp_dir = ".",
+                            unsigned threads = 0,
+                            const CMP& cmp = CMP());
+
+    /*!
+     * \brief Destructor.
+     */
+    ~ExternalSorter();
+
+    //! Copy-constructor is forbidden.
+    ExternalSorter(const ExternalSorter&) = delete;
+
+    //! Copy-assignment is forbidden.
+    ExternalSorter& operator = (const ExternalSorter&) = delete;
+
+    /*!
+     * \brief Sort records in file @p input and write them into @p output.
+     * \param input Name of file containing the records back to back.
+     * \param output Name of file where sorted records are written. Existing
+     *  file is truncated.
+     * \pre @p input size is a multiple of sizeof(T). @p input and @p output
+     *  are different files.
+     * \post @p output contains the records of @p input in sorted order.
+     * \exception std::runtime_error, if a file cannot be opened, read or
+     *  written. std::bad_alloc, if memory allocation fails.
+     */
+    void sortFile(const std::string& input, const std::string& output);
+
+    /*!
+     * \brief Sort records from @p first to @p last and write them to @p out.
+     *  InIter must be at least an input iterator and OutIter an output
+     *  iterator accepting T.
+     * \return Iterator past the last written record.
+     * \pre Range from @p first to @p last is valid.
+     * \post Sorted records are written to @p out.
+     * \exception std::runtime_error, if a temporary file cannot be created,
+     *  read or written. std::bad_alloc, if memory allocation fails.
+     */
+    template <class InIter, class OutIter>
+    OutIter sort(InIter first, InIter last, OutIter out);
+
+    /*!
+     * \brief Return the memory budget in bytes.
+     */
+    std::size_t memoryBudget() const;
+
+    /*!
+     * \brief Return the temporary file directory.
+     */
+    const std::string& tempDir() const;
+
+
+private:
+
+    std::size_t memory_budget_;
+    std::string temp_dir_;
+    unsigned threads_;
+    CMP cmp_;
+    std::string run_prefix_;
+    unsigned next_run_id_;
+
+    // Returns name for a new temporary run file.
+    std::string newRunName();
+
+    // Sorts all records read by source and writes them to sink.
+    template <class Source, class Sink>
+    void sortStream(Source& source, Sink& sink);
+
+    // Merges runs into sink, using several passes if needed. Names of 
+    // intermediate run files are added to temps.
+    template <class Sink>
+    void mergeRuns(std::vector<std::string> runs, Sink& sink,
+                   std::vector<std::string>& temps);
+
+    // Merges runs into sink in one pass.
+    template <class Sink>
+    void mergeOnce(const std::vector<std::string>& runs, Sink& sink);
+};
+
+
+/*!
+ * \brief Sort a file of fixed-size records that may be larger than memory.
+ *  Convenience function for ExternalSorter<T,CMP>::sortFile.
+ * \param input Name of file containing the records back to back.
+ * \param output Name of the sorted output file.
+ * \param memory_budget Approximate maximum number of bytes used for buffers.
+ * \param temp_dir Directory for temporary run files.
+ * \param cmp Comparator.
+ * \pre See ExternalSorter::sortFile.
+ * \post @p output contains the records of @p input in sorted order.
+ * \exception See ExternalSorter::sortFile.
+ */
+template <class T, class CMP = std::less<T> >
+void externalSort(const std::string& input, const std::string& output,
+                  std::size_t memory_budget = ExternalSorter<T,CMP>::DEFAULT_MEMORY_BUDGET,
+                  const std::string& temp_dir = ".",
+                  const CMP& cmp = CMP());
+
+} // Namespace PPUtils
+
+// Include template implementations.
+#include "externalsort_impl.hh"
+
+#endif // EXTERNALSORT_HH
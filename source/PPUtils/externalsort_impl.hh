@@ -0,0 +1,548 @@
+/* externalsort_impl.hh
+ * This is the implementation file for the PPUtils::ExternalSorter class
+ * template and the PPUtils::externalSort function template.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef EXTERNALSORT_IMPL_HH
+#define EXTERNALSORT_IMPL_HH
+
+#include "algo.hh"
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+#include <future>
+#include <memory>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <algorithm>
+
+namespace PPUtils
+{
+
+namespace detail
+{
+
+// Owns a C file handle. Throws std::runtime_error if the file cannot be opened.
+class RecordFile
+{
+public:
+    RecordFile(const std::string& name, const char* mode) :
+        file_(std::fopen(name.c_str(), mode)), name_(name)
+    {
+        if (file_ == nullptr){
+            throw std::runtime_error("Cannot open file " + name);
+        }
+        // Records are read and written in large blocks.
+        std::setvbuf(file_, nullptr, _IONBF, 0);
+    }
+
+    ~RecordFile()
+    {
+        if (file_ != nullptr){
+            std::fclose(file_);
+        }
+    }
+
+    RecordFile(const RecordFile&) = delete;
+    RecordFile& operator = (const RecordFile&) = delete;
+
+    // Reads at most n records into buf. Returns number of records read.
+    template <class T>
+    std::size_t read(T* buf, std::size_t n)
+    {
+        std::size_t count = std::fread(buf, sizeof(T), n, file_);
+        if (count < n && std::ferror(file_)){
+            throw std::runtime_error("Cannot read file " + name_);
+        }
+        return count;
+    }
+
+    template <class T>
+    void write(const T* buf, std::size_t n)
+    {
+        if (std::fwrite(buf, sizeof(T), n, file_) != n){
+            throw std::runtime_error("Cannot write file " + name_);
+        }
+    }
+
+    void close()
+    {
+        std::FILE* f = file_;
+        file_ = nullptr;
+        if (std::fclose(f) != 0){
+            throw std::runtime_error("Cannot close file " + name_);
+        }
+    }
+
+private:
+    std::FILE* file_;
+    std::string name_;
+};
+
+
+// Removes listed files in destructor.
+class TempFiles
+{
+public:
+    TempFiles() : names_() {}
+
+    ~TempFiles()
+    {
+        for (const std::string& name : names_){
+            std::remove(name.c_str());
+        }
+    }
+
+    TempFiles(const TempFiles&) = delete;
+    TempFiles& operator = (const TempFiles&) = delete;
+
+    std::vector<std::string>& names() {return names_;}
+
+private:
+    std::vector<std::string> names_;
+};
+
+
+// Record source reading a file.
+template <class T>
+class FileRecordSource
+{
+public:
+    explicit FileRecordSource(const std::string& name) : file_(name, "rb") {}
+
+    std::size_t read(T* buf, std::size_t n) {return file_.read(buf, n);}
+
+private:
+    RecordFile file_;
+};
+
+
+// Record source reading an input iterator range.
+template <class T, class InIter>
+class IteratorRecordSource
+{
+public:
+    IteratorRecordSource(InIter first, InIter last) : first_(first), last_(last) {}
+
+    std::size_t read(T* buf, std::size_t n)
+    {
+        std::size_t count = 0;
+        while (count < n && first_ != last_){
+            buf[count++] = *first_;
+            ++first_;
+        }
+        return count;
+    }
+
+private:
+    InIter first_;
+    InIter last_;
+};
+
+
+/*
+ * Record sink writing a file. Records are collected into one block while the
+ * previous block is written in the background.
+ */
+template <class T>
+class FileRecordSink
+{
+public:
+    FileRecordSink(const std::string& name, std::size_t block_records) :
+        file_(name, "wb"), current_(0), fill_(0), pending_()
+    {
+        blocks_[0].resize(block_records);
+        blocks_[1].resize(block_records);
+    }
+
+    ~FileRecordSink()
+    {
+        if (pending_.valid()){
+            pending_.wait();
+        }
+    }
+
+    void push(const T& record)
+    {
+        blocks_[current_][fill_++] = record;
+        if (fill_ == blocks_[current_].size()){
+            flush();
+        }
+    }
+
+    // Writes n records from buf. Buffered records are written first.
+    void write(const T* buf, std::size_t n)
+    {
+        flush();
+        wait();
+        file_.write(buf, n);
+    }
+
+    // Writes all buffered records and closes the file.
+    void finish()
+    {
+        flush();
+        wait();
+        file_.close();
+    }
+
+private:
+    RecordFile file_;
+    std::vector<T> blocks_[2];
+    unsigned current_;
+    std::size_t fill_;
+    std::future<void> pending_;
+
+    // Waits until the previous block is written.
+    void wait()
+    {
+        if (pending_.valid()){
+            pending_.get();
+        }
+    }
+
+    // Starts writing the current block and switches to the other one.
+    void flush()
+    {
+        wait();
+        if (fill_ == 0){
+            return;
+        }
+        const T* data = blocks_[current_].data();
+        const std::size_t n = fill_;
+        RecordFile* file = &file_;
+        pending_ = std::async(std::launch::async, [file, data, n]()
+        {
+            file->write(data, n);
+        });
+        current_ ^= 1;
+        fill_ = 0;
+    }
+};
+
+
+// Record sink writing to an output iterator.
+template <class T, class OutIter>
+class IteratorRecordSink
+{
+public:
+    explicit IteratorRecordSink(OutIter out) : out_(out) {}
+
+    void push(const T& record) {*out_++ = record;}
+
+    void write(const T* buf, std::size_t n) {out_ = std::copy(buf, buf + n, out_);}
+
+    void finish() {}
+
+    OutIter out() const {return out_;}
+
+private:
+    OutIter out_;
+};
+
+
+/*
+ * Reads a run file block by block. The next block is read in the background
+ * while the current one is consumed.
+ */
+template <class T>
+class RunReader
+{
+public:
+    typedef T value_type;
+
+    RunReader(const std::string& name, std::size_t block_records) :
+        file_(name, "rb"), current_(0), pos_(0), size_(0), next_()
+    {
+        blocks_[0].resize(block_records);
+        blocks_[1].resize(block_records);
+        size_ = file_.read(blocks_[0].data(), block_records);
+        readNext();
+    }
+
+    ~RunReader()
+    {
+        if (next_.valid()){
+            next_.wait();
+        }
+    }
+
+    RunReader(const RunReader&) = delete;
+    RunReader& operator = (const RunReader&) = delete;
+
+    bool empty() const {return pos_ == size_;}
+
+    const T& front() const {return blocks_[current_][pos_];}
+
+    void pop()
+    {
+        if (++pos_ == size_ && size_ == blocks_[current_].size()){
+            size_ = next_.get();
+            current_ ^= 1;
+            pos_ = 0;
+            readNext();
+        }
+    }
+
+private:
+    RecordFile file_;
+    std::vector<T> blocks_[2];
+    unsigned current_;
+    std::size_t pos_;
+    std::size_t size_;
+    std::future<std::size_t> next_;
+
+    void readNext()
+    {
+        if (size_ < blocks_[current_].size()){
+            return; // End of file reached.
+        }
+        T* data = blocks_[current_ ^ 1].data();
+        const std::size_t n = blocks_[current_ ^ 1].size();
+        RecordFile* file = &file_;
+        next_ = std::async(std::launch::async, [file, data, n]()
+        {
+            return file->read(data, n);
+        });
+    }
+};
+
+
+// Reads at most max records from source into chunk, growing it gradually.
+// Capacity is reserved exactly, so that it never exceeds max: resize alone
+// may double it, and the chunks are reused for the whole sort.
+template <class T, class Source>
+void fillChunk(Source& source, std::vector<T>& chunk, std::size_t max)
+{
+    chunk.clear();
+    while (chunk.size() < max){
+        std::size_t old_size = chunk.size();
+        std::size_t new_size = std::min(max, std::max<std::size_t>(2 * old_size, 4096));
+        if (chunk.capacity() < new_size){
+            chunk.reserve(new_size);
+        }
+        chunk.resize(new_size);
+        std::size_t n = source.read(chunk.data() + old_size, new_size - old_size);
+        chunk.resize(old_size + n);
+        if (n < new_size - old_size){
+            return;
+        }
+    }
+}
+
+} // Namespace detail
+
+
+template <class T, class CMP>
+const std::size_t ExternalSorter<T,CMP>::DEFAULT_MEMORY_BUDGET;
+
+template <class T, class CMP>
+const std::size_t ExternalSorter<T,CMP>::MIN_MERGE_BLOCK;
+
+
+template <class T, class CMP>
+ExternalSorter<T,CMP>::ExternalSorter(std::size_t memory_budget,
+                                      const std::string& temp_dir,
+                                      unsigned threads,
+                                      const CMP& cmp) :
+    memory_budget_(memory_budget), temp_dir_(temp_dir), threads_(threads),
+    cmp_(cmp), run_prefix_(), next_run_id_(0)
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "ExternalSorter records must be trivially copyable.");
+    std::random_device rd;
+    run_prefix_ = temp_dir_ + "/ppext-" + std::to_string(rd()) + "-";
+}
+
+
+template <class T, class CMP>
+ExternalSorter<T,CMP>::~ExternalSorter()
+{
+}
+
+
+template <class T, class CMP>
+void ExternalSorter<T,CMP>::sortFile(const std::string& input,
+                                     const std::string& output)
+{
+    detail::FileRecordSource<T> source(input);
+    std::size_t block = std::max<std::size_t>(1, MIN_MERGE_BLOCK / sizeof(T));
+    detail::FileRecordSink<T> sink(output, block);
+    sortStream(source, sink);
+}
+
+
+template <class T, class CMP>
+template <class InIter, class OutIter>
+OutIter ExternalSorter<T,CMP>::sort(InIter first, InIter last, OutIter out)
+{
+    detail::IteratorRecordSource<T, InIter> source(first, last);
+    detail::IteratorRecordSink<T, OutIter> sink(out);
+    sortStream(source, sink);
+    return sink.out();
+}
+
+
+template <class T, class CMP>
+std::size_t ExternalSorter<T,CMP>::memoryBudget() const
+{
+    return memory_budget_;
+}
+
+
+template <class T, class CMP>
+const std::string& ExternalSorter<T,CMP>::tempDir() const
+{
+    return temp_dir_;
+}
+
+
+template <class T, class CMP>
+std::string ExternalSorter<T,CMP>::newRunName()
+{
+    return run_prefix_ + std::to_string(next_run_id_++) + ".run";
+}
+
+
+template <class T, class CMP>
+template <class Source, class Sink>
+void ExternalSorter<T,CMP>::sortStream(Source& source, Sink& sink)
+{
+    // The chunk being sorted, its sort buffer and the previous chunk being
+    // written share the budget.
+    const std::size_t chunk_records =
+            std::max<std::size_t>(1, memory_budget_ / (3 * sizeof(T)));
+
+    detail::TempFiles temps;
+    std::vector<std::string> runs;
+    std::vector<T> chunks[2];
+    unsigned c = 0;
+    std::future<void> writing;
+
+    while (true){
+        detail::fillChunk(source, chunks[c], chunk_records);
+        if (chunks[c].empty()){
+            break;
+        }
+        const bool last = chunks[c].size() < chunk_records;
+        PPUtils::parallelMergeSort(chunks[c].begin(), chunks[c].end(), cmp_,
+                                   threads_);
+
+        if (runs.empty() && last){
+            // Everything fits into memory.
+            sink.write(chunks[c].data(), chunks[c].size());
+            sink.finish();
+            return;
+        }
+
+        // Write the run in the background while the next chunk is read.
+        if (writing.valid()){
+            writing.get();
+        }
+        std::string name = newRunName();
+        temps.names().push_back(name);
+        runs.push_back(name);
+        const std::vector<T>* chunk = &chunks[c];
+        writing = std::async(std::launch::async, [name, chunk]()
+        {
+            detail::RecordFile file(name, "wb");
+            file.write(chunk->data(), chunk->size());
+            file.close();
+        });
+        c ^= 1;
+        if (last){
+            break;
+        }
+    }
+    if (writing.valid()){
+        writing.get();
+    }
+    chunks[0] = std::vector<T>();
+    chunks[1] = std::vector<T>();
+
+    if (!runs.empty()){
+        mergeRuns(runs, sink, temps.names());
+    }
+    sink.finish();
+}
+
+
+template <class T, class CMP>
+template <class Sink>
+void ExternalSorter<T,CMP>::mergeRuns(std::vector<std::string> runs,
+                                      Sink& sink,
+                                      std::vector<std::string>& temps)
+{
+    // Each run needs two blocks, and output two more.
+    const std::size_t max_runs = std::max<std::size_t>(
+                3, memory_budget_ / (2 * MIN_MERGE_BLOCK)) - 1;
+
+    // Merge consecutive groups of runs to keep the sort stable.
+    while (runs.size() > max_runs){
+        std::vector<std::string> merged;
+        for (std::size_t i = 0; i < runs.size(); i += max_runs){
+            std::size_t end = std::min(runs.size(), i + max_runs);
+            if (end - i == 1){
+                merged.push_back(runs[i]);
+                continue;
+            }
+            std::vector<std::string> group(runs.begin() + i, runs.begin() + end);
+            std::string name = newRunName();
+            temps.push_back(name);
+            std::size_t block = std::max<std::size_t>(
+                        1, memory_budget_ / ((2 * group.size() + 2) * sizeof(T)));
+            detail::FileRecordSink<T> run_sink(name, block);
+            mergeOnce(group, run_sink);
+            run_sink.finish();
+            for (const std::string& old_run : group){
+                std::remove(old_run.c_str());
+            }
+            merged.push_back(name);
+        }
+        runs.swap(merged);
+    }
+    mergeOnce(runs, sink);
+}
+
+
+template <class T, class CMP>
+template <class Sink>
+void ExternalSorter<T,CMP>::mergeOnce(const std::vector<std::string>& runs,
+                                      Sink& sink)
+{
+    typedef detail::RunReader<T> Reader;
+    const std::size_t block = std::max<std::size_t>(
+                1, memory_budget_ / ((2 * runs.size() + 2) * sizeof(T)));
+
+    std::vector<std::unique_ptr<Reader> > readers;
+    std::vector<Reader*> sources;
+    for (const std::string& name : runs){
+        readers.push_back(std::unique_ptr<Reader>(new Reader(name, block)));
+        sources.push_back(readers.back().get());
+    }
+
+    // Equal records are taken from the earlier run.
+    LoserTree<Reader, CMP> tree(sources, cmp_);
+    while (!tree.empty()){
+        sink.push(tree.front());
+        tree.pop();
+    }
+}
+
+
+template <class T, class CMP>
+void externalSort(const std::string& input, const std::string& output,
+                  std::size_t memory_budget, const std::string& temp_dir,
+                  const CMP& cmp)
+{
+    ExternalSorter<T,CMP> sorter(memory_budget, temp_dir, 0, cmp);
+    sorter.sortFile(input, output);
+}
+
+} // Namespace PPUtils
+
+#endif // EXTERNALSORT_IMPL_HH
@@ -0,0 +1,210 @@
+/* mappedarena.cc
+ * This is the implementation file for the PPUtils::MappedArena class defined
+ * in mappedarena.hh.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include "mappedarena.hh"
+#include <new>
+#include <cassert>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace PPUtils
+{
+
+MappedArenaOptions::MappedArenaOptions() :
+    bytes(256 << 20), pages(ARENA_PAGES_HUGETLB), huge_page_size(2 << 20),
+    populate(false)
+{
+}
+
+
+namespace detail
+{
+
+#ifdef __linux__
+
+namespace
+{
+
+// Returns flags selecting huge page size page for MAP_HUGETLB.
+int hugePageFlags(std::size_t page)
+{
+    int flags = MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+    int shift = 0;
+    while ((std::size_t(1) << shift) < page){
+        ++shift;
+    }
+    flags |= shift << MAP_HUGE_SHIFT;
+#else
+    (void)page;
+#endif
+    return flags;
+}
+
+} // Anonymous namespace
+
+
+char* mapPages(std::size_t bytes, ArenaPages pages, std::size_t huge_page_size,
+               bool populate, std::size_t& mapped, ArenaPages& got) noexcept
+{
+    const int populate_flag = populate ? MAP_POPULATE : 0;
+    if (pages == ARENA_PAGES_HUGETLB){
+        mapped = (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+        void* p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | hugePageFlags(huge_page_size) | populate_flag,
+                       -1, 0);
+        if (p != MAP_FAILED){
+            got = ARENA_PAGES_HUGETLB;
+            return static_cast<char*>(p);
+        }
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (pages != ARENA_PAGES_NORMAL){
+        // Over-map by one huge page, and trim the ends, so that the mapping
+        // is aligned for the kernel to use transparent huge pages.
+        mapped = (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+        void* p = mmap(nullptr, mapped + huge_page_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p != MAP_FAILED){
+            char* start = static_cast<char*>(p);
+            const std::size_t head = (huge_page_size -
+                    reinterpret_cast<std::uintptr_t>(start) % huge_page_size) % huge_page_size;
+            if (head != 0){
+                munmap(start, head);
+            }
+            munmap(start + head + mapped, huge_page_size - head);
+            start += head;
+            got = madvise(start, mapped, MADV_HUGEPAGE) == 0
+                    ? ARENA_PAGES_TRANSPARENT : ARENA_PAGES_NORMAL;
+            if (populate){
+                // Touching after madvise faults in huge pages where possible;
+                // MAP_POPULATE would fault in normal pages before the advice.
+                const std::size_t step = sysconf(_SC_PAGESIZE);
+                for (std::size_t i = 0; i < mapped; i += step){
+                    static_cast<volatile char*>(start)[i] = 0;
+                }
+            }
+            return start;
+        }
+    }
+#endif
+
+    const std::size_t page = sysconf(_SC_PAGESIZE);
+    mapped = (bytes + page - 1) / page * page;
+    void* p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | populate_flag, -1, 0);
+    if (p == MAP_FAILED){
+        mapped = 0;
+        return nullptr;
+    }
+    got = ARENA_PAGES_NORMAL;
+    return static_cast<char*>(p);
+}
+
+
+void unmapPages(char* data, std::size_t mapped) noexcept
+{
+    munmap(data, mapped);
+}
+
+#else
+
+char* mapPages(std::size_t, ArenaPages, std::size_t, bool, std::size_t& mapped,
+               ArenaPages& got) noexcept
+{
+    mapped = 0;
+    got = ARENA_PAGES_NORMAL;
+    return nullptr;
+}
+
+
+void unmapPages(char*, std::size_t) noexcept
+{
+}
+
+#endif
+
+} // Namespace detail
+
+
+MappedArena::MappedArena(const MappedArenaOptions& options) :
+    data_(nullptr), size_(0), pages_(ARENA_PAGES_NORMAL), mapped_(true), used_(0)
+{
+    assert(options.bytes > 0);
+    data_ = detail::mapPages(options.bytes, options.pages, options.huge_page_size,
+                             options.populate, size_, pages_);
+    if (data_ == nullptr){
+#ifdef __linux__
+        throw std::bad_alloc();
+#else
+        data_ = static_cast<char*>(::operator new(options.bytes));
+        size_ = options.bytes;
+        mapped_ = false;
+#endif
+    }
+}
+
+
+MappedArena::~MappedArena()
+{
+    if (mapped_){
+        detail::unmapPages(data_, size_);
+    }
+    else {
+        ::operator delete(data_);
+    }
+}
+
+
+void* MappedArena::allocate(std::size_t bytes, std::size_t align)
+{
+    assert(align != 0 && (align & (align - 1)) == 0);
+    std::size_t used = used_.load(std::memory_order_relaxed);
+    std::size_t start = 0;
+    do {
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(data_) + used;
+        start = used + (align - address % align) % align;
+        if (start > size_ || bytes > size_ - start){
+            throw std::bad_alloc();
+        }
+    } while (!used_.compare_exchange_weak(used, start + bytes, std::memory_order_relaxed));
+    return data_ + start;
+}
+
+
+bool MappedArena::contains(const void* p) const noexcept
+{
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+    const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(data_);
+    return address >= start && address - start < size_;
+}
+
+
+std::size_t MappedArena::size() const noexcept
+{
+    return size_;
+}
+
+
+std::size_t MappedArena::used() const noexcept
+{
+    return used_.load(std::memory_order_relaxed);
+}
+
+
+ArenaPages MappedArena::pages() const noexcept
+{
+    return pages_;
+}
+
+} // Namespace PPUtils
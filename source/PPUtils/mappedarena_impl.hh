@@ -0,0 +1,89 @@
+/* mappedarena_impl.hh
+ * This is the implementation file for the PPUtils::ArenaObject class
+ * template.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef MAPPEDARENA_IMPL_HH
+#define MAPPEDARENA_IMPL_HH
+
+#include <new>
+
+namespace PPUtils
+{
+
+template <class Derived>
+std::mutex ArenaObject<Derived>::mx_;
+
+template <class Derived>
+MappedArena* ArenaObject<Derived>::arena_ = nullptr;
+
+template <class Derived>
+void* ArenaObject<Derived>::free_ = nullptr;
+
+
+template <class Derived>
+void* ArenaObject<Derived>::operator new(std::size_t size)
+{
+    if (size == sizeof(Derived)){
+        std::lock_guard<std::mutex> lock(mx_);
+        if (free_ != nullptr){
+            void* p = free_;
+            free_ = *static_cast<void**>(p);
+            return p;
+        }
+        if (arena_ != nullptr){
+            const std::size_t bytes = size > sizeof(void*) ? size : sizeof(void*);
+            const std::size_t align =
+                    alignof(Derived) > alignof(void*) ? alignof(Derived) : alignof(void*);
+            try {
+                return arena_->allocate(bytes, align);
+            }
+            catch (const std::bad_alloc&){
+                // Arena is full: use the heap.
+            }
+        }
+    }
+    return ::operator new(size);
+}
+
+
+template <class Derived>
+void ArenaObject<Derived>::operator delete(void* p, std::size_t size) noexcept
+{
+    if (p == nullptr){
+        return;
+    }
+    if (size == sizeof(Derived)){
+        std::lock_guard<std::mutex> lock(mx_);
+        if (arena_ != nullptr && arena_->contains(p)){
+            *static_cast<void**>(p) = free_;
+            free_ = p;
+            return;
+        }
+    }
+    ::operator delete(p);
+}
+
+
+template <class Derived>
+void ArenaObject<Derived>::setArena(MappedArena* arena)
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    arena_ = arena;
+    free_ = nullptr;
+}
+
+
+template <class Derived>
+MappedArena* ArenaObject<Derived>::arena()
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    return arena_;
+}
+
+} // Namespace PPUtils
+
+#endif // MAPPEDARENA_IMPL_HH
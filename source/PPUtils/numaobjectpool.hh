@@ -0,0 +1,272 @@
+/* numaobjectpool.hh
+ * This header file defines the PPUtils::NumaUniformObjectPool class
+ * template, a thread safe object pool keeping objects on the NUMA node of
+ * the threads using them.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef NUMAOBJECTPOOL_HH
+#define NUMAOBJECTPOOL_HH
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include "numatopology.hh"
+#include "poolstatistics.hh"
+
+namespace PPUtils
+{
+
+/*!
+ * \brief The NumaNodeStatistics struct
+ *  Statistics of one node of a NumaUniformObjectPool. Reserves, hits and
+ *  misses are counted on the node of the reserving thread; releases, idle
+ *  and outstanding objects on the home node of the objects.
+ */
+struct NumaNodeStatistics
+{
+    PoolStatistics pool;        //!< Counters of the node. Zero, unless
+                                //!< statistics are enabled.
+    std::uint64_t steals;       //!< Reserves on this node served by idle
+                                //!< objects of other nodes.
+    std::uint64_t stolen;       //!< Objects of this node reserved by
+                                //!< threads of other nodes.
+
+    //! Constructor sets the counters to zero.
+    NumaNodeStatistics() : pool(), steals(0), stolen(0) {}
+};
+
+
+/*!
+ * \brief The NumaUniformObjectPool class
+ *  Thread safe object pool with a free list for each NUMA node. Objects are
+ *  built by threads on their own node, which makes the node their home.
+ *  Reserved objects carry their home node in their deleter, and released
+ *  objects always return to the free list of their home node, also when
+ *  released by a thread of another node. Reserve takes objects from the free
+ *  list of the calling thread's node. Only if that list is empty, an idle
+ *  object of another node is taken, nearest node first, before building a
+ *  new one. Thus threads of different nodes do not contend on the same lock,
+ *  and each object is used mostly on one node.
+ *
+ *  The builder runs with memory preferred on the home node (see
+ *  NumaBinding), but that places only pages touched for the first time
+ *  while it runs. Small objects are usually carved by the heap allocator
+ *  from pages touched earlier, so they end up wherever those pages are,
+ *  typically on the node of the building thread. The binding helps objects
+ *  that allocate large or fresh memory, such as big buffers.
+ *
+ *  The node of the calling thread is asked from the NumaTopology, which can
+ *  be simulated to test on single-node machines.
+ *
+ *  Type arguments:
+ *   \p T: Type of stored objects.
+ *
+ *   \p Builder: A functor class that is used to construct new objects. It
+ *  must provide a function operator taking no arguments and returning
+ *  pointer to an object allocated with new. It is called concurrently.
+ */
+template <class T, class Builder = typename std::function<T*()> >
+class NumaUniformObjectPool
+{
+public:
+
+    /*!
+     * \brief The NodeDeleter class
+     *  Deleter of reserved objects. Destroys the object like std::default_delete,
+     *  and tells release the home node of the object.
+     */
+    class NodeDeleter
+    {
+    public:
+
+        //! Construct a deleter without a home node.
+        NodeDeleter() noexcept : node_(NO_NODE) {}
+
+        //! Destroy object.
+        void operator()(T* object) const noexcept {delete object;}
+
+        //! Return the home node of the object, or NO_NODE if it has none.
+        unsigned node() const noexcept {return node_;}
+
+        //! Node of objects not built by a pool.
+        static const unsigned NO_NODE = ~0u;
+
+    private:
+
+        friend class NumaUniformObjectPool;
+        explicit NodeDeleter(unsigned node) noexcept : node_(node) {}
+        unsigned node_;
+    };
+
+    /*!
+     * \brief Pointer to a reserved object. It may be released to the pool or
+     *  destroyed.
+     */
+    typedef std::unique_ptr<T, NodeDeleter> Pointer;
+
+    /*!
+     * \brief Constructor.
+     * \param builder Builder object used to construct new objects. This
+     *  object uses a copy of builder.
+     * \param topology Nodes of the pool. This object uses a copy.
+     * \pre None.
+     * \post Pool is empty. Stealing is enabled and statistics are disabled.
+     */
+    explicit NumaUniformObjectPool(const Builder& builder = DEFAULT_BUILDER,
+                                   const NumaTopology& topology = NumaTopology::system());
+
+    /*!
+     * \brief Destructor destroys all stored objects.
+     * \pre No other thread uses the pool. Reserved objects may still be
+     *  destroyed later, but not released.
+     */
+    ~NumaUniformObjectPool();
+
+    //! Copy-constructor is forbidden.
+    NumaUniformObjectPool(const NumaUniformObjectPool&) = delete;
+
+    //! Copy-assignment is forbidden.
+    NumaUniformObjectPool& operator = (const NumaUniformObjectPool&) = delete;
+
+    /*!
+     * \brief Reserve an object, preferably one whose home is the node of the
+     *  calling thread.
+     * \return The most recently released object of the calling thread's
+     *  node. If there is none, an idle object of the nearest node that has
+     *  one, if stealing is enabled. Otherwise a new object built on the
+     *  calling thread's node.
+     * \pre None.
+     * \exception Exceptions thrown by Builder, and std::bad_alloc. The pool
+     *  is not modified.
+     */
+    Pointer reserve();
+
+    /*!
+     * \brief Return object back to the free list of its home node.
+     * \param object Object reserved from this pool. Objects without a home
+     *  node get the calling thread's node as home.
+     * \pre object != nullptr.
+     * \post Object is stored in its current state.
+     */
+    void release(Pointer&& object);
+
+    /*!
+     * \brief Store an object not reserved from this pool on the calling
+     *  thread's node, which becomes its home.
+     * \param object Object allocated with new.
+     * \pre object != nullptr.
+     * \post Object is stored in its current state.
+     */
+    void release(std::unique_ptr<T>&& object);
+
+    /*!
+     * \brief Build \p n objects with \p node as their home and store them.
+     *  Memory is preferred on node as in reserve, so call this in a thread
+     *  running on node to have small objects placed there.
+     * \pre node < topology().nodeCount().
+     * \exception Exceptions thrown by Builder. Objects built so far are
+     *  stored.
+     */
+    void prewarm(unsigned node, unsigned n);
+
+    /*!
+     * \brief Enable or disable taking idle objects of other nodes, when the
+     *  calling thread's node has none.
+     * \pre None.
+     */
+    void setStealing(bool steal);
+
+    /*!
+     * \brief Return number of idle objects on all nodes.
+     * \pre None.
+     */
+    std::size_t size() const;
+
+    /*!
+     * \brief Return number of idle objects whose home is \p node.
+     * \pre node < topology().nodeCount().
+     */
+    std::size_t size(unsigned node) const;
+
+    /*!
+     * \brief Destroy all idle objects.
+     * \pre None.
+     * \post size() == 0, unless objects were released meanwhile.
+     */
+    void clear();
+
+    /*!
+     * \brief Return the topology of this pool.
+     * \pre None.
+     */
+    const NumaTopology& topology() const;
+
+    /*!
+     * \brief Enable or disable hit/miss and occupancy statistics. Steals are
+     *  always counted. Enabling resets the counters.
+     * \pre The pool is not used by other threads meanwhile.
+     */
+    void enableStatistics(bool enable = true);
+
+    /*!
+     * \brief Return snapshot of the statistics of each node, indexed by node.
+     * \pre None.
+     */
+    std::vector<NumaNodeStatistics> nodeStatistics() const;
+
+    /*!
+     * \brief DEFAULT_BUILDER
+     *  This functor constructs stored objects using their default constructor.
+     *  Instantiating this functor requires \p T to be default constructible.
+     */
+    static const typename std::function<T*()> DEFAULT_BUILDER;
+
+
+private:
+
+    // State of one node. Padded, so that nodes do not share the cache line
+    // of their lock.
+    struct Node
+    {
+        mutable std::mutex mx;
+        std::vector<std::unique_ptr<T> > idle;
+        std::vector<unsigned> steal_order;      // Other nodes, nearest first.
+        std::unique_ptr<detail::PoolCounters> counters;
+        std::atomic<std::uint64_t> steals;
+        std::atomic<std::uint64_t> stolen;
+        char padding[64];
+
+        Node() : mx(), idle(), steal_order(), counters(),
+            steals(0), stolen(0) {}
+    };
+
+    Builder builder_;
+    NumaTopology topology_;
+    std::unique_ptr<Node[]> nodes_;
+    std::atomic<bool> steal_;
+
+    // Returns node of the calling thread.
+    unsigned currentNode() const;
+
+    // Takes an idle object of node. Called under its lock.
+    std::unique_ptr<T> takeIdle(Node& node);
+
+    // Builds an object with node as its home.
+    Pointer build(unsigned node);
+
+    // Stores object on the free list of node.
+    void store(unsigned node, std::unique_ptr<T>&& object, bool reserved);
+};
+
+} // Namespace PPUtils
+
+// Include template implementations.
+#include "numaobjectpool_impl.hh"
+
+#endif // NUMAOBJECTPOOL_HH
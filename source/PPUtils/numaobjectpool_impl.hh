@@ -0,0 +1,280 @@
+/* numaobjectpool_impl.hh
+ * This is the implementation file for the PPUtils::NumaUniformObjectPool
+ * class template.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef NUMAOBJECTPOOL_IMPL_HH
+#define NUMAOBJECTPOOL_IMPL_HH
+
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+
+namespace PPUtils
+{
+
+template <class T, class Builder>
+const std::function<T*()> NumaUniformObjectPool<T,Builder>::DEFAULT_BUILDER ([](){return new T();});
+
+template <class T, class Builder>
+const unsigned NumaUniformObjectPool<T,Builder>::NodeDeleter::NO_NODE;
+
+
+template <class T, class Builder>
+NumaUniformObjectPool<T,Builder>::NumaUniformObjectPool(const Builder& builder,
+                                                        const NumaTopology& topology) :
+    builder_(builder), topology_(topology),
+    nodes_(new Node[topology.nodeCount()]), steal_(true)
+{
+    const unsigned count = topology_.nodeCount();
+    for (unsigned n = 0; n < count; ++n){
+        std::vector<unsigned>& order = nodes_[n].steal_order;
+        for (unsigned other = 0; other < count; ++other){
+            if (other != n){
+                order.push_back(other);
+            }
+        }
+        const NumaTopology& t = topology_;
+        std::stable_sort(order.begin(), order.end(), [&t, n](unsigned a, unsigned b)
+        {
+            return t.distance(n, a) < t.distance(n, b);
+        });
+    }
+}
+
+
+template <class T, class Builder>
+NumaUniformObjectPool<T,Builder>::~NumaUniformObjectPool()
+{
+}
+
+
+template <class T, class Builder>
+typename NumaUniformObjectPool<T,Builder>::Pointer NumaUniformObjectPool<T,Builder>::reserve()
+{
+    const unsigned local = currentNode();
+    Node& node = nodes_[local];
+    {
+        std::lock_guard<std::mutex> lock(node.mx);
+        std::unique_ptr<T> object = takeIdle(node);
+        if (object){
+            if (node.counters){
+                node.counters->reserved(true);
+            }
+            return Pointer(object.release(), NodeDeleter(local));
+        }
+    }
+
+    // Local list is empty: take from the nearest node that has objects.
+    if (steal_.load(std::memory_order_relaxed)){
+        for (unsigned other : node.steal_order){
+            Node& home = nodes_[other];
+            std::unique_lock<std::mutex> lock(home.mx);
+            std::unique_ptr<T> object = takeIdle(home);
+            if (object){
+                home.stolen.fetch_add(1, std::memory_order_relaxed);
+                lock.unlock();
+                node.steals.fetch_add(1, std::memory_order_relaxed);
+                if (node.counters){
+                    node.counters->reserved(true);
+                }
+                return Pointer(object.release(), NodeDeleter(other));
+            }
+        }
+    }
+
+    Pointer object = build(local);
+    if (node.counters){
+        node.counters->reserved(false);
+    }
+    return object;
+}
+
+
+template <class T, class Builder>
+void NumaUniformObjectPool<T,Builder>::release(Pointer&& object)
+{
+    assert(object != nullptr);
+    unsigned home = object.get_deleter().node();
+    const bool reserved = home != NodeDeleter::NO_NODE;
+    if (!reserved){
+        home = currentNode();
+    }
+    assert(home < topology_.nodeCount());
+    store(home, std::unique_ptr<T>(object.release()), reserved);
+}
+
+
+template <class T, class Builder>
+void NumaUniformObjectPool<T,Builder>::release(std::unique_ptr<T>&& object)
+{
+    assert(object != nullptr);
+    store(currentNode(), std::move(object), false);
+}
+
+
+template <class T, class Builder>
+void NumaUniformObjectPool<T,Builder>::prewarm(unsigned node, unsigned n)
+{
+    assert(node < topology_.nodeCount());
+    NumaBinding binding(topology_, node);
+    for (unsigned i = 0; i < n; ++i){
+        std::unique_ptr<T> object(builder_());
+        Node& home = nodes_[node];
+        std::lock_guard<std::mutex> lock(home.mx);
+        home.idle.push_back(std::move(object));
+        if (home.counters){
+            home.counters->idle(home.idle.size());
+        }
+    }
+}
+
+
+template <class T, class Builder>
+void NumaUniformObjectPool<T,Builder>::setStealing(bool steal)
+{
+    steal_.store(steal, std::memory_order_relaxed);
+}
+
+
+template <class T, class Builder>
+std::size_t NumaUniformObjectPool<T,Builder>::size() const
+{
+    std::size_t rv = 0;
+    for (unsigned n = 0; n < topology_.nodeCount(); ++n){
+        rv += size(n);
+    }
+    return rv;
+}
+
+
+template <class T, class Builder>
+std::size_t NumaUniformObjectPool<T,Builder>::size(unsigned node) const
+{
+    assert(node < topology_.nodeCount());
+    std::lock_guard<std::mutex> lock(nodes_[node].mx);
+    return nodes_[node].idle.size();
+}
+
+
+template <class T, class Builder>
+void NumaUniformObjectPool<T,Builder>::clear()
+{
+    for (unsigned n = 0; n < topology_.nodeCount(); ++n){
+        std::vector<std::unique_ptr<T> > objects;
+        {
+            Node& node = nodes_[n];
+            std::lock_guard<std::mutex> lock(node.mx);
+            objects.swap(node.idle);
+        }
+        // Objects are destroyed without holding the lock.
+    }
+}
+
+
+template <class T, class Builder>
+const NumaTopology& NumaUniformObjectPool<T,Builder>::topology() const
+{
+    return topology_;
+}
+
+
+template <class T, class Builder>
+void NumaUniformObjectPool<T,Builder>::enableStatistics(bool enable)
+{
+    for (unsigned n = 0; n < topology_.nodeCount(); ++n){
+        Node& node = nodes_[n];
+        std::lock_guard<std::mutex> lock(node.mx);
+        node.counters.reset(enable ? new detail::PoolCounters() : nullptr);
+        if (enable){
+            node.counters->idle(node.idle.size());
+        }
+    }
+}
+
+
+template <class T, class Builder>
+std::vector<NumaNodeStatistics> NumaUniformObjectPool<T,Builder>::nodeStatistics() const
+{
+    std::vector<NumaNodeStatistics> rv(topology_.nodeCount());
+    for (unsigned n = 0; n < topology_.nodeCount(); ++n){
+        const Node& node = nodes_[n];
+        std::lock_guard<std::mutex> lock(node.mx);
+        if (node.counters){
+            rv[n].pool = node.counters->snapshot(node.idle.size());
+        }
+        rv[n].steals = node.steals.load(std::memory_order_relaxed);
+        rv[n].stolen = node.stolen.load(std::memory_order_relaxed);
+    }
+    return rv;
+}
+
+
+template <class T, class Builder>
+unsigned NumaUniformObjectPool<T,Builder>::currentNode() const
+{
+    const unsigned node = topology_.currentNode();
+    assert(node < topology_.nodeCount());
+    return node;
+}
+
+
+template <class T, class Builder>
+std::unique_ptr<T> NumaUniformObjectPool<T,Builder>::takeIdle(Node& node)
+{
+    if (node.idle.empty()){
+        return std::unique_ptr<T>();
+    }
+    std::unique_ptr<T> object = std::move(node.idle.back());
+    node.idle.pop_back();
+    if (node.counters){
+        node.counters->outstanding(1);
+        node.counters->idle(node.idle.size());
+    }
+    return object;
+}
+
+
+template <class T, class Builder>
+typename NumaUniformObjectPool<T,Builder>::Pointer NumaUniformObjectPool<T,Builder>::build(unsigned node)
+{
+    Node& home = nodes_[node];
+    Pointer object;
+    {
+        NumaBinding binding(topology_, node);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        object = Pointer(builder_(), NodeDeleter(node));
+        if (home.counters){
+            home.counters->built(std::chrono::steady_clock::now() - start);
+        }
+    }
+    if (home.counters){
+        std::lock_guard<std::mutex> lock(home.mx);
+        home.counters->outstanding(1);
+    }
+    return object;
+}
+
+
+template <class T, class Builder>
+void NumaUniformObjectPool<T,Builder>::store(unsigned node, std::unique_ptr<T>&& object,
+                                             bool reserved)
+{
+    Node& home = nodes_[node];
+    std::lock_guard<std::mutex> lock(home.mx);
+    home.idle.push_back(std::move(object));
+    if (home.counters){
+        home.counters->released();
+        if (reserved){
+            home.counters->outstanding(-1);
+        }
+        home.counters->idle(home.idle.size());
+    }
+}
+
+} // Namespace PPUtils
+
+#endif // NUMAOBJECTPOOL_IMPL_HH
@@ -0,0 +1,205 @@
+/* numatopology.cc
+ * This is the implementation file for the PPUtils::NumaTopology and
+ * PPUtils::NumaBinding classes defined in numatopology.hh.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include "numatopology.hh"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cassert>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+namespace PPUtils
+{
+
+namespace
+{
+
+// Distance of a node to itself in the ACPI SLIT.
+const unsigned LOCAL_DISTANCE = 10;
+
+#ifdef __linux__
+
+// Memory policy modes of set_mempolicy(2), defined here to avoid depending
+// on the libnuma headers.
+const int MPOL_DEFAULT_MODE = 0;
+const int MPOL_PREFERRED_MODE = 1;
+
+const char NODE_DIR[] = "/sys/devices/system/node/node";
+
+
+// Parses a cpulist such as "0-3,8-11". Returns the listed CPUs.
+std::vector<unsigned> parseCpuList(const std::string& list)
+{
+    std::vector<unsigned> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ',')){
+        if (range.empty() || range[0] < '0' || range[0] > '9'){
+            continue;
+        }
+        const std::size_t dash = range.find('-');
+        const unsigned first = std::stoul(range.substr(0, dash));
+        const unsigned last = dash == std::string::npos
+                ? first : std::stoul(range.substr(dash + 1));
+        for (unsigned cpu = first; cpu <= last; ++cpu){
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+#endif
+
+} // Anonymous namespace
+
+
+NumaTopology::NumaTopology(unsigned nodes, const std::function<unsigned()>& current_node,
+                           unsigned remote_distance) :
+    nodes_(nodes), distances_(nodes * nodes, remote_distance), cpu_nodes_(),
+    current_node_(current_node)
+{
+    assert(nodes > 0);
+    assert(current_node);
+    for (unsigned n = 0; n < nodes; ++n){
+        distances_[n * nodes + n] = LOCAL_DISTANCE;
+    }
+}
+
+
+NumaTopology::NumaTopology() :
+    nodes_(1), distances_(1, LOCAL_DISTANCE), cpu_nodes_(), current_node_()
+{
+#ifdef __linux__
+    // Nodes are numbered from 0 without gaps on nearly all machines. A gap
+    // ends the scan, leaving the nodes found so far.
+    std::vector<std::vector<unsigned> > node_cpus;
+    while (true){
+        std::ifstream file(NODE_DIR + std::to_string(node_cpus.size()) + "/cpulist");
+        std::string list;
+        if (!file || !std::getline(file, list)){
+            break;
+        }
+        node_cpus.push_back(parseCpuList(list));
+    }
+    if (node_cpus.size() < 2){
+        return;
+    }
+
+    nodes_ = node_cpus.size();
+    distances_.assign(nodes_ * nodes_, 2 * LOCAL_DISTANCE);
+    for (unsigned n = 0; n < nodes_; ++n){
+        std::ifstream file(NODE_DIR + std::to_string(n) + "/distance");
+        for (unsigned m = 0; m < nodes_; ++m){
+            unsigned d = 0;
+            if (file >> d){
+                distances_[n * nodes_ + m] = d;
+            }
+        }
+        distances_[n * nodes_ + n] = LOCAL_DISTANCE;
+        for (unsigned cpu : node_cpus[n]){
+            if (cpu >= cpu_nodes_.size()){
+                cpu_nodes_.resize(cpu + 1, 0);
+            }
+            cpu_nodes_[cpu] = n;
+        }
+    }
+#endif
+}
+
+
+const NumaTopology& NumaTopology::system()
+{
+    static const NumaTopology topology;
+    return topology;
+}
+
+
+unsigned NumaTopology::nodeCount() const
+{
+    return nodes_;
+}
+
+
+unsigned NumaTopology::currentNode() const
+{
+    if (current_node_){
+        return current_node_();
+    }
+#ifdef __linux__
+    const int cpu = sched_getcpu();
+    if (cpu >= 0 && unsigned(cpu) < cpu_nodes_.size()){
+        return cpu_nodes_[cpu];
+    }
+#endif
+    return 0;
+}
+
+
+unsigned NumaTopology::distance(unsigned from, unsigned to) const
+{
+    assert(from < nodes_ && to < nodes_);
+    return distances_[from * nodes_ + to];
+}
+
+
+bool NumaTopology::simulated() const
+{
+    return static_cast<bool>(current_node_);
+}
+
+
+NumaBinding::NumaBinding(const NumaTopology& topology, unsigned node) :
+    bound_(false), old_mode_(0), old_mask_()
+{
+    assert(node < topology.nodeCount());
+#ifdef __linux__
+    if (topology.simulated() || node >= MASK_WORDS * 8 * sizeof(unsigned long)){
+        return;
+    }
+    if (syscall(SYS_get_mempolicy, &old_mode_, old_mask_,
+                MASK_WORDS * 8 * sizeof(unsigned long), nullptr, 0) != 0){
+        return;
+    }
+    unsigned long mask[MASK_WORDS] = {};
+    mask[node / (8 * sizeof(unsigned long))] = 1ul << (node % (8 * sizeof(unsigned long)));
+    bound_ = syscall(SYS_set_mempolicy, MPOL_PREFERRED_MODE, mask,
+                     MASK_WORDS * 8 * sizeof(unsigned long)) == 0;
+#else
+    (void)topology;
+    (void)node;
+#endif
+}
+
+
+NumaBinding::~NumaBinding()
+{
+#ifdef __linux__
+    if (bound_){
+        if (old_mode_ == MPOL_DEFAULT_MODE){
+            syscall(SYS_set_mempolicy, MPOL_DEFAULT_MODE, nullptr, 0);
+        }
+        else {
+            syscall(SYS_set_mempolicy, old_mode_, old_mask_,
+                    MASK_WORDS * 8 * sizeof(unsigned long));
+        }
+    }
+#endif
+}
+
+
+bool NumaBinding::bound() const
+{
+    return bound_;
+}
+
+} // Namespace PPUtils
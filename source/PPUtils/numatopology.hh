@@ -0,0 +1,142 @@
+/* numatopology.hh
+ * This header defines the PPUtils::NumaTopology class, which tells the NUMA
+ * node of the calling thread, and PPUtils::NumaBinding, which places pages
+ * first touched by the calling thread on a given node.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef NUMATOPOLOGY_HH
+#define NUMATOPOLOGY_HH
+
+#include <vector>
+#include <functional>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief The NumaTopology class
+ *  NUMA nodes of the machine: their number, distances, and the node of the
+ *  CPU running the calling thread. system() reads the topology from
+ *  /sys/devices/system/node on Linux, and is a single node elsewhere.
+ *
+ *  A simulated topology has any number of nodes, and a function telling the
+ *  node of the calling thread, so that NUMA-aware code can be tested on a
+ *  single-node machine. Memory is not bound to simulated nodes.
+ */
+class NumaTopology
+{
+public:
+
+    /*!
+     * \brief Constructor. Constructs a simulated topology.
+     * \param nodes Number of nodes.
+     * \param current_node Returns the node of the calling thread. Called
+     *  concurrently from any thread.
+     * \param remote_distance Distance between different nodes. Distance of a
+     *  node to itself is 10, as in the ACPI SLIT.
+     * \pre nodes > 0. current_node returns a value less than nodes.
+     */
+    NumaTopology(unsigned nodes, const std::function<unsigned()>& current_node,
+                 unsigned remote_distance = 20);
+
+    /*!
+     * \brief Return the topology of this machine. Detected on the first call.
+     * \pre None.
+     */
+    static const NumaTopology& system();
+
+    /*!
+     * \brief Return number of nodes.
+     * \pre None.
+     */
+    unsigned nodeCount() const;
+
+    /*!
+     * \brief Return node of the CPU running the calling thread. The thread
+     *  may migrate to another node at any time.
+     * \pre None.
+     * \post Return value < nodeCount().
+     */
+    unsigned currentNode() const;
+
+    /*!
+     * \brief Return relative distance from node \p from to node \p to.
+     * \pre from < nodeCount(), to < nodeCount().
+     */
+    unsigned distance(unsigned from, unsigned to) const;
+
+    /*!
+     * \brief Return true, if this is a simulated topology.
+     * \pre None.
+     */
+    bool simulated() const;
+
+
+private:
+
+    unsigned nodes_;
+    std::vector<unsigned> distances_;       // nodes_ x nodes_, row major.
+    std::vector<unsigned> cpu_nodes_;       // Node of each CPU.
+    std::function<unsigned()> current_node_; // Empty, if not simulated.
+
+    NumaTopology();
+};
+
+
+/*!
+ * \brief The NumaBinding class
+ *  While a NumaBinding exists, pages first touched by the calling thread are
+ *  placed on the given node, if it has free memory (set_mempolicy with
+ *  MPOL_PREFERRED). The previous memory policy of the thread is restored by
+ *  the destructor. If the policy cannot be set, e.g. on systems without NUMA
+ *  support, in restricted containers or for simulated topologies, pages
+ *  stay on the node of the thread touching them first.
+ *
+ *  Only pages touched for the first time while the binding exists are
+ *  affected. Small heap allocations are usually served from pages the
+ *  allocator has touched before, so they stay where those pages are. The
+ *  binding is useful for large allocations, which get fresh pages.
+ */
+class NumaBinding
+{
+public:
+
+    /*!
+     * \brief Constructor. Prefers \p node for the calling thread.
+     * \pre node < topology.nodeCount().
+     */
+    NumaBinding(const NumaTopology& topology, unsigned node);
+
+    /*!
+     * \brief Destructor restores the previous memory policy.
+     * \pre Called in the thread that constructed this object.
+     */
+    ~NumaBinding();
+
+    //! Copy-constructor is forbidden.
+    NumaBinding(const NumaBinding&) = delete;
+
+    //! Copy-assignment is forbidden.
+    NumaBinding& operator = (const NumaBinding&) = delete;
+
+    /*!
+     * \brief Return true, if the memory policy was set.
+     */
+    bool bound() const;
+
+
+private:
+
+    static const unsigned MASK_WORDS = 16;   // Up to 1024 nodes.
+
+    bool bound_;
+    int old_mode_;
+    unsigned long old_mask_[MASK_WORDS];
+};
+
+} // Namespace PPUtils
+
+#endif // NUMATOPOLOGY_HH
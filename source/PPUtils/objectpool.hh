@@ -13,6 +13,8 @@
 #include <vector>
 #include <functional>
 #include <unordered_map>
+#include "pooledptr.hh"
+#include "poolstatistics.hh"
 
 namespace PPUtils
 {
@@ -123,6 +125,18 @@ public:
     template <class... Args>
     typename std::unique_ptr<T> reserve(Args... builder_args);
     
+    /*!
+     * \brief Exclusively reserve a stored object as a PooledPtr, that releases
+     *  the object back to this pool when it is destroyed.
+     * \param builder_args Same as in reserve.
+     * \return PooledPtr to the object reserved with reserve(builder_args...).
+     * \pre None.
+     * \post If this pool is destroyed before the PooledPtr, the object is
+     *  destroyed by the PooledPtr.
+     */
+    template <class... Args>
+    PooledPtr<T> acquire(Args... builder_args);
+    
     /*!
      * \brief Release an object to be reused.
      * \param object Released object.
@@ -164,6 +178,31 @@ public:
      */
     const Selector* getSelector() const;
     
+    /*!
+     * \brief Start or stop collecting statistics. Statistics are not collected
+     *  by default.
+     * \param enable If false, collected statistics are dropped.
+     * \pre None.
+     * \post If \p enable, statistics start from zero.
+     */
+    void enableStatistics(bool enable = true);
+    
+    /*!
+     * \brief Return hit/miss and occupancy statistics of the whole pool.
+     * \return Snapshot of the statistics. All zero, if statistics are not
+     *  enabled.
+     * \pre None.
+     */
+    PoolStatistics statistics() const;
+    
+    /*!
+     * \brief Return statistics of each segment.
+     * \return Snapshot of the statistics of each key reserved or released
+     *  since statistics were enabled.
+     * \pre None.
+     */
+    std::unordered_map<Key, PoolStatistics> keyStatistics() const;
+    
     
 private:
     
@@ -173,6 +212,14 @@ private:
     std::unique_ptr<Builder> builder_;
     std::unique_ptr<Selector> selector_;
     unsigned total_size_;
+    std::shared_ptr<detail::PoolLink<T> > link_;
+    std::unique_ptr<detail::PoolCounters> stats_;   // nullptr if disabled.
+    std::unordered_map<Key, detail::PoolCounters> key_stats_;
+    
+    // Returns counters of key, creating them on first use.
+    detail::PoolCounters& keyCounters(const Key& key);
+    
+    static void recycle(void* pool, std::unique_ptr<T>&& object);
 };
 
 } // Namespace PPUtils
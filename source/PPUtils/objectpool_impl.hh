@@ -35,6 +35,9 @@ ObjectPool(const Builder& b, const Selector& s) :
 template <class T, class Builder, class Key, class Selector>
 ObjectPool<T,Builder,Key,Selector>::~ObjectPool()
 {
+    if (link_ != nullptr){
+        link_->moveTo(nullptr);
+    }
 }
 
 
@@ -45,7 +48,13 @@ ObjectPool(ObjectPool<T,Builder,Key,Selector>&& other) noexcept
     std::swap(this->objects_, other.objects_);
     std::swap(this->builder_, other.builder_);
     std::swap(this->selector_, other.selector_);
+    std::swap(this->link_, other.link_);
+    std::swap(this->stats_, other.stats_);
+    std::swap(this->key_stats_, other.key_stats_);
     this->total_size_ = other.total_size_;
+    if (link_ != nullptr){
+        link_->moveTo(this);
+    }
 }
 
 
@@ -59,7 +68,16 @@ operator =(ObjectPool<T,Builder,Key,Selector>&& other) noexcept
         std::swap(this->objects_, other.objects_);
         std::swap(this->builder_, other.builder_);
         std::swap(this->selector_, other.selector_);
+        std::swap(this->link_, other.link_);
+        std::swap(this->stats_, other.stats_);
+        std::swap(this->key_stats_, other.key_stats_);
         this->total_size_ = other.total_size_;
+        if (link_ != nullptr){
+            link_->moveTo(this);
+        }
+        if (other.link_ != nullptr){
+            other.link_->moveTo(&other);
+        }
     }
     return *this;
 }
@@ -73,19 +91,48 @@ ObjectPool<T,Builder,Key,Selector>::reserve(Args... builder_args)
     typename std::unique_ptr<T> rv(nullptr);
     Key k = selector_->operator()(builder_args...);
     auto it = objects_.find(k);
+    const bool hit = it != objects_.end() && !it->second.empty();
     
-    if (it == objects_.end() || it->second.empty()){
-       rv.reset(builder_->operator()(builder_args...));
-    }
-    else {
+    if (hit){
         rv.swap(it->second.back());
         it->second.pop_back();
         --total_size_;
     }
+    else if (stats_ == nullptr){
+       rv.reset(builder_->operator()(builder_args...));
+    }
+    else {
+        const std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+        rv.reset(builder_->operator()(builder_args...));
+        const std::chrono::steady_clock::duration latency =
+                std::chrono::steady_clock::now() - start;
+        stats_->built(latency);
+        keyCounters(k).built(latency);
+    }
+    
+    if (stats_ != nullptr){
+        detail::PoolCounters& key_stats = keyCounters(k);
+        stats_->reserved(hit);
+        stats_->outstanding(1);
+        key_stats.reserved(hit);
+        key_stats.outstanding(1);
+    }
     return rv;
 }
 
 
+template <class T, class Builder, class Key, class Selector>
+template <class... Args>
+PooledPtr<T> ObjectPool<T,Builder,Key,Selector>::acquire(Args... builder_args)
+{
+    if (link_ == nullptr){
+        link_ = std::make_shared<detail::PoolLink<T> >(this, &recycle, false);
+    }
+    return PooledPtr<T>(reserve(builder_args...), link_);
+}
+
+
 template <class T, class Builder, class Key, class Selector>
 void ObjectPool<T,Builder,Key,Selector>::
 release(typename std::unique_ptr<T>&& object)
@@ -105,6 +152,16 @@ release(typename std::unique_ptr<T>&& object)
         it->second.push_back( std::move(object) );
     }
     ++total_size_;
+    
+    if (stats_ != nullptr){
+        detail::PoolCounters& key_stats = keyCounters(k);
+        stats_->released();
+        stats_->outstanding(-1);
+        stats_->idle(total_size_);
+        key_stats.released();
+        key_stats.outstanding(-1);
+        key_stats.idle(size(k));
+    }
 }
 
 
@@ -148,6 +205,57 @@ const Selector* ObjectPool<T,Builder,Key,Selector>::getSelector() const
 }
 
 
+template <class T, class Builder, class Key, class Selector>
+void ObjectPool<T,Builder,Key,Selector>::enableStatistics(bool enable)
+{
+    // Used from one thread only: one counter stripe is enough.
+    stats_.reset(enable ? new detail::PoolCounters(1) : nullptr);
+    key_stats_.clear();
+}
+
+
+template <class T, class Builder, class Key, class Selector>
+PoolStatistics ObjectPool<T,Builder,Key,Selector>::statistics() const
+{
+    if (stats_ == nullptr){
+        return PoolStatistics();
+    }
+    return stats_->snapshot(total_size_);
+}
+
+
+template <class T, class Builder, class Key, class Selector>
+std::unordered_map<Key, PoolStatistics>
+ObjectPool<T,Builder,Key,Selector>::keyStatistics() const
+{
+    std::unordered_map<Key, PoolStatistics> rv;
+    for (const auto& key_stats : key_stats_){
+        rv.insert( std::make_pair(key_stats.first,
+                                  key_stats.second.snapshot(size(key_stats.first))) );
+    }
+    return rv;
+}
+
+
+template <class T, class Builder, class Key, class Selector>
+detail::PoolCounters& ObjectPool<T,Builder,Key,Selector>::keyCounters(const Key& key)
+{
+    auto it = key_stats_.find(key);
+    if (it == key_stats_.end()){
+        it = key_stats_.insert( std::make_pair(key, detail::PoolCounters(1)) ).first;
+    }
+    return it->second;
+}
+
+
+template <class T, class Builder, class Key, class Selector>
+void ObjectPool<T,Builder,Key,Selector>::
+recycle(void* pool, std::unique_ptr<T>&& object)
+{
+    static_cast<ObjectPool*>(pool)->release(std::move(object));
+}
+
+
 } // Namespace PPUtils
 
 #endif // OBJECTPOOL_IMPL_HH
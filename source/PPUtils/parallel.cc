@@ -0,0 +1,170 @@
+/* parallel.cc
+ * This is the implementation file for the WorkerPool class defined in
+ * parallel.hh.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include "parallel.hh"
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+namespace PPUtils
+{
+
+// Batch of tasks given to one run() call.
+struct WorkerPool::Batch
+{
+    // Valid only while some task is unfinished. size is used to check that.
+    const std::vector<std::function<void()> >* tasks;
+    std::size_t size;
+    std::atomic<std::size_t> next;
+    std::atomic<std::size_t> finished;
+    // Number of workers that may still join. Protected by pool's mx_.
+    unsigned free_slots;
+    std::exception_ptr error;
+    std::mutex mx;
+    std::condition_variable done;
+};
+
+
+WorkerPool::WorkerPool(unsigned threads) :
+    workers_(), queue_(), mx_(), cv_(), stop_(false)
+{
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 1; i < threads; ++i){
+        workers_.push_back(std::thread(&WorkerPool::workerLoop, this));
+    }
+}
+
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& t : workers_){
+        t.join();
+    }
+}
+
+
+unsigned WorkerPool::threads() const
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    return static_cast<unsigned>(workers_.size()) + 1;
+}
+
+
+void WorkerPool::run(const std::vector<std::function<void()> >& tasks,
+                     unsigned threads)
+{
+    if (tasks.empty()){
+        return;
+    }
+    const unsigned helpers = static_cast<unsigned>(
+            std::min<std::size_t>(threads == 0 ? this->threads() : threads,
+                                  tasks.size()) - 1);
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+    batch->tasks = &tasks;
+    batch->size = tasks.size();
+    batch->next = 0;
+    batch->finished = 0;
+    batch->free_slots = helpers;
+
+    if (helpers > 0){
+        {
+            std::lock_guard<std::mutex> lock(mx_);
+            while (workers_.size() < helpers){
+                workers_.push_back(std::thread(&WorkerPool::workerLoop, this));
+            }
+            queue_.push_back(batch);
+        }
+        if (helpers == 1){
+            cv_.notify_one();
+        }
+        else {
+            cv_.notify_all();
+        }
+    }
+
+    work(*batch);
+    {
+        std::unique_lock<std::mutex> lock(batch->mx);
+        batch->done.wait(lock, [&batch]()
+        {
+            return batch->finished == batch->size;
+        });
+    }
+
+    // Workers that did not join must not see the batch after return.
+    if (helpers > 0){
+        std::lock_guard<std::mutex> lock(mx_);
+        auto it = std::find(queue_.begin(), queue_.end(), batch);
+        if (it != queue_.end()){
+            queue_.erase(it);
+        }
+    }
+    if (batch->error){
+        std::rethrow_exception(batch->error);
+    }
+}
+
+
+WorkerPool& WorkerPool::shared()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+
+void WorkerPool::workerLoop()
+{
+    while (true){
+        std::shared_ptr<Batch> batch;
+        {
+            std::unique_lock<std::mutex> lock(mx_);
+            cv_.wait(lock, [this]()
+            {
+                return stop_ || !queue_.empty();
+            });
+            if (queue_.empty()){
+                return;
+            }
+            batch = queue_.front();
+            if (--batch->free_slots == 0){
+                queue_.pop_front();
+            }
+        }
+        work(*batch);
+    }
+}
+
+
+void WorkerPool::work(Batch& batch)
+{
+    for (std::size_t i = batch.next++; i < batch.size; i = batch.next++){
+        try {
+            (*batch.tasks)[i]();
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(batch.mx);
+            if (!batch.error){
+                batch.error = std::current_exception();
+            }
+        }
+        if (++batch.finished == batch.size){
+            std::lock_guard<std::mutex> lock(batch.mx);
+            batch.done.notify_all();
+        }
+    }
+}
+
+} // Namespace PPUtils
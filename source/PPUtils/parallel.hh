@@ -0,0 +1,265 @@
+/* parallel.hh
+ * This header defines the PPUtils::WorkerPool class, and parallel algorithms
+ * that run on the shared worker pool.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef PARALLEL_HH
+#define PARALLEL_HH
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief Default number of elements in one chunk of work in the parallel
+ *  algorithms. Chunk boundaries depend only on the range and the grain, not
+ *  on the number of threads, which makes results deterministic.
+ */
+const std::size_t PARALLEL_DEFAULT_GRAIN = 1 << 14;
+
+
+/*!
+ * \brief The WorkerPool class
+ *  Set of worker threads that run batches of tasks. The thread that
+ *  calls run() works on its own batch too, and returns when all tasks of the
+ *  batch are finished. Because of that tasks may call run() themselves
+ *  (nested parallelism) without deadlocking, even if all workers are busy.
+ *
+ *  Several threads may call run() concurrently. Batches are served in
+ *  order of arrival. Workers are started when the pool is constructed, and
+ *  more when a batch asks for more threads than the pool has. Workers are
+ *  stopped only when the pool is destroyed.
+ */
+class WorkerPool
+{
+public:
+
+    /*!
+     * \brief Constructor. Starts threads-1 worker threads.
+     * \param threads Initial number of threads running a batch, calling
+     *  thread included. If 0, std::thread::hardware_concurrency() is used.
+     * \pre None.
+     * \post Workers are waiting for tasks.
+     * \exception std::system_error, if threads cannot be started.
+     */
+    explicit WorkerPool(unsigned threads = 0);
+
+    /*!
+     * \brief Destructor.
+     * \pre No run() is in progress.
+     * \post Worker threads are stopped and joined.
+     */
+    ~WorkerPool();
+
+    //! Copy-constructor is forbidden.
+    WorkerPool(const WorkerPool&) = delete;
+
+    //! Copy-assignment is forbidden.
+    WorkerPool& operator = (const WorkerPool&) = delete;
+
+    /*!
+     * \brief Return the number of threads that may run a batch, calling
+     *  thread included.
+     */
+    unsigned threads() const;
+
+    /*!
+     * \brief Run tasks and wait for them to finish.
+     * \param tasks Tasks to run. Each task is run once, in any thread.
+     * \param threads Maximum number of threads used, calling thread included.
+     *  If 0, threads() is used. If greater than threads(), more workers are
+     *  started first, and they stay in the pool.
+     * \pre None.
+     * \post All tasks have been run.
+     * \exception If tasks throw, the first exception is rethrown after all
+     *  tasks have finished. Remaining tasks are still run. std::system_error,
+     *  if a worker thread cannot be started.
+     */
+    void run(const std::vector<std::function<void()> >& tasks,
+             unsigned threads = 0);
+
+    /*!
+     * \brief Return the process-wide pool used by the parallel algorithms
+     *  and the parallel sorts in algo.hh. It starts with 
+     *  std::thread::hardware_concurrency() threads on first use.
+     */
+    static WorkerPool& shared();
+
+
+private:
+
+    struct Batch;
+
+    std::vector<std::thread> workers_;
+    std::deque<std::shared_ptr<Batch> > queue_;
+    mutable std::mutex mx_;
+    std::condition_variable cv_;
+    bool stop_;
+
+    void workerLoop();
+
+    // Runs tasks of batch until none is left.
+    static void work(Batch& batch);
+};
+
+
+/*!
+ * \brief Call @p f(i) for each i from @p first to @p last in parallel.
+ *  The range is split into chunks of @p grain indices, and each chunk is
+ *  one task in the shared WorkerPool.
+ *
+ *  Type arguments:
+ *
+ *  Index: Integral type.
+ *
+ *  Function: Callable object taking Index. Called concurrently.
+ *
+ * \param first First index.
+ * \param last Past-end index.
+ * \param f Function called for each index.
+ * \param grain Number of indices in a chunk. If 0, PARALLEL_DEFAULT_GRAIN.
+ * \param threads Maximum number of threads (calling thread included). If 0,
+ *  all threads of the shared pool may be used.
+ * \pre None.
+ * \post @p f has been called once for each index.
+ * \exception First exception thrown by @p f, after all chunks have finished.
+ */
+template <class Index, class Function>
+void parallelFor(Index first, Index last, const Function& f,
+                 std::size_t grain = PARALLEL_DEFAULT_GRAIN,
+                 unsigned threads = 0);
+
+
+/*!
+ * \brief Parallel transform-reduce: returns
+ *  init + transform(e0) + transform(e1) + ..., where + is @p reduce.
+ *  Each chunk is reduced in a local variable, and chunk results are combined
+ *  in chunk order in the calling thread. The grouping depends only on the
+ *  range and @p grain, so the result is the same with any number of
+ *  threads, also for non-associative operations like floating point sums.
+ *
+ *  Type arguments:
+ *
+ *  RandIter: STL-compatible random access iterator.
+ *
+ *  T: Result type. Must be copy-constructible and copy-assignable.
+ *
+ *  Reduce: Callable object taking two T and returning T. Should be
+ *  associative.
+ *
+ *  Transform: Callable object taking RandIter's reference type and returning
+ *  a type convertible to T.
+ *
+ * \param first Iterator to the first element.
+ * \param last Past-end iterator.
+ * \param init Initial value.
+ * \param reduce Binary reduction operation.
+ * \param transform Unary transformation.
+ * \param grain Number of elements in a chunk. If 0, PARALLEL_DEFAULT_GRAIN.
+ * \param threads Maximum number of threads. If 0, whole shared pool.
+ * \return Reduced value.
+ * \pre Range from @p first to @p last is valid.
+ * \exception std::bad_alloc, if memory allocation fails. First exception
+ *  thrown by @p reduce or @p transform.
+ */
+template <class RandIter, class T, class Reduce, class Transform>
+T parallelTransformReduce(RandIter first, RandIter last, T init,
+                          const Reduce& reduce, const Transform& transform,
+                          std::size_t grain = PARALLEL_DEFAULT_GRAIN,
+                          unsigned threads = 0);
+
+
+/*!
+ * \brief Parallel inclusive scan (prefix sum):
+ *  out[i] = in[0] + in[1] + ... + in[i], where + is @p op.
+ *  Two passes: chunk totals are reduced in parallel and scanned serially,
+ *  and then each chunk is scanned starting from its offset. As in
+ *  parallelTransformReduce, the result does not depend on @p threads.
+ *
+ *  Type arguments:
+ *
+ *  InIter: STL-compatible random access iterator.
+ *
+ *  OutIter: Random access iterator with InIter's value type assignable to it.
+ *
+ *  BinaryOp: Callable object taking two InIter's value type and returning
+ *  it. Must be associative. Defaults to std::plus.
+ *
+ * \param first Iterator to the first input element.
+ * \param last Past-end input iterator.
+ * \param out Iterator to the first output element. May be @p first.
+ * \param op Binary operation.
+ * \param grain Number of elements in a chunk. If 0, PARALLEL_DEFAULT_GRAIN.
+ * \param threads Maximum number of threads. If 0, whole shared pool.
+ * \return Past-end output iterator.
+ * \pre Output range has room for all elements and it is either the input
+ *  range or does not overlap it.
+ * \post Output holds the inclusive scan of input.
+ *
+ *  Complexity: about 2N applications of @p op, memory O(N / grain).
+ *
+ * \exception std::bad_alloc, if memory allocation fails. First exception
+ *  thrown by @p op.
+ */
+template <class InIter, class OutIter,
+          class BinaryOp = std::plus<typename std::iterator_traits<InIter>::value_type> >
+OutIter inclusiveScan(InIter first, InIter last, OutIter out,
+                      const BinaryOp& op = BinaryOp(),
+                      std::size_t grain = PARALLEL_DEFAULT_GRAIN,
+                      unsigned threads = 0);
+
+
+/*!
+ * \brief Parallel stable partition.
+ *  @p pred is evaluated once for each element and the results are counted
+ *  per chunk. Chunk counts are scanned to find where each chunk writes its
+ *  elements, then elements are moved into a buffer in parallel, and back.
+ *
+ *  Type arguments:
+ *
+ *  RandIter: STL-compatible random access iterator. Value type must be
+ *  default-constructible and move-assignable.
+ *
+ *  Predicate: Callable object taking constant reference to the value type
+ *  and returning bool. Called concurrently.
+ *
+ * \param first Iterator to the first element.
+ * \param last Past-end iterator.
+ * \param pred Predicate.
+ * \param grain Number of elements in a chunk. If 0, PARALLEL_DEFAULT_GRAIN.
+ * \param threads Maximum number of threads. If 0, whole shared pool.
+ * \return Iterator to the first element for which @p pred is false.
+ * \pre Range from @p first to @p last is valid.
+ * \post Elements satisfying @p pred precede the others. Relative order of
+ *  elements in both groups is preserved.
+ *
+ *  Complexity: N calls of @p pred, 2N moves, memory O(N).
+ *
+ * \exception std::bad_alloc, if memory allocation fails. First exception
+ *  thrown by @p pred or value type's move-assignment. If @p pred throws,
+ *  the range is not modified.
+ */
+template <class RandIter, class Predicate>
+RandIter parallelPartition(RandIter first, RandIter last, const Predicate& pred,
+                           std::size_t grain = PARALLEL_DEFAULT_GRAIN,
+                           unsigned threads = 0);
+
+} // Namespace PPUtils
+
+
+// Include template implementations.
+#include "parallel_impl.hh"
+
+#endif // PARALLEL_HH
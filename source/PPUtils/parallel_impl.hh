@@ -0,0 +1,236 @@
+/* parallel_impl.hh
+ * This is the implementation file for the parallel algorithm templates
+ * declared in parallel.hh.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef PARALLEL_IMPL_HH
+#define PARALLEL_IMPL_HH
+
+#include <algorithm>
+#include <utility>
+
+namespace PPUtils
+{
+
+namespace detail
+{
+
+// Per-chunk result padded to its own cache line(s), so that threads storing
+// results of neighbouring chunks do not share a line.
+template <class T>
+struct PaddedValue
+{
+    char before[64];
+    T value;
+    char after[64];
+
+    PaddedValue() : value() {}
+};
+
+
+// Number of chunks of grain elements needed for n elements.
+inline std::size_t chunkCount(std::size_t n, std::size_t grain)
+{
+    return (n + grain - 1) / grain;
+}
+
+
+// Adds one task per chunk calling f(chunk, begin, end) with offsets.
+template <class Function>
+void addChunkTasks(std::vector<std::function<void()> >& tasks,
+                   std::size_t n, std::size_t grain, const Function& f)
+{
+    const std::size_t chunks = chunkCount(n, grain);
+    for (std::size_t c = 0; c < chunks; ++c){
+        const std::size_t b = c * grain;
+        const std::size_t e = std::min(n, b + grain);
+        tasks.push_back([=, &f]()
+        {
+            f(c, b, e);
+        });
+    }
+}
+
+} // Namespace detail
+
+
+template <class Index, class Function>
+void parallelFor(Index first, Index last, const Function& f,
+                 std::size_t grain, unsigned threads)
+{
+    if (!(first < last)){
+        return;
+    }
+    if (grain == 0){
+        grain = PARALLEL_DEFAULT_GRAIN;
+    }
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    std::vector<std::function<void()> > tasks;
+    auto chunk = [first, &f](std::size_t, std::size_t b, std::size_t e)
+    {
+        for (std::size_t i = b; i < e; ++i){
+            f(static_cast<Index>(first + i));
+        }
+    };
+    detail::addChunkTasks(tasks, n, grain, chunk);
+    WorkerPool::shared().run(tasks, threads);
+}
+
+
+template <class RandIter, class T, class Reduce, class Transform>
+T parallelTransformReduce(RandIter first, RandIter last, T init,
+                          const Reduce& reduce, const Transform& transform,
+                          std::size_t grain, unsigned threads)
+{
+    if (grain == 0){
+        grain = PARALLEL_DEFAULT_GRAIN;
+    }
+    const std::size_t n = last - first;
+    std::vector<detail::PaddedValue<T> > partial(detail::chunkCount(n, grain));
+    std::vector<std::function<void()> > tasks;
+    auto chunk = [first, &partial, &reduce, &transform]
+            (std::size_t c, std::size_t b, std::size_t e)
+    {
+        T local = transform(first[b]);
+        for (std::size_t i = b + 1; i < e; ++i){
+            local = reduce(local, transform(first[i]));
+        }
+        partial[c].value = local;
+    };
+    detail::addChunkTasks(tasks, n, grain, chunk);
+    WorkerPool::shared().run(tasks, threads);
+
+    for (const detail::PaddedValue<T>& p : partial){
+        init = reduce(init, p.value);
+    }
+    return init;
+}
+
+
+template <class InIter, class OutIter, class BinaryOp>
+OutIter inclusiveScan(InIter first, InIter last, OutIter out,
+                      const BinaryOp& op, std::size_t grain, unsigned threads)
+{
+    typedef typename std::iterator_traits<InIter>::value_type T;
+
+    if (grain == 0){
+        grain = PARALLEL_DEFAULT_GRAIN;
+    }
+    const std::size_t n = last - first;
+    const std::size_t chunks = detail::chunkCount(n, grain);
+    if (chunks <= 1){
+        if (n > 0){
+            T local = first[0];
+            out[0] = local;
+            for (std::size_t i = 1; i < n; ++i){
+                local = op(local, first[i]);
+                out[i] = local;
+            }
+        }
+        return out + n;
+    }
+
+    // Pass 1: totals of all but the last chunk.
+    std::vector<detail::PaddedValue<T> > offsets(chunks);
+    std::vector<std::function<void()> > tasks;
+    auto total = [first, &offsets, &op](std::size_t c, std::size_t b, std::size_t e)
+    {
+        T local = first[b];
+        for (std::size_t i = b + 1; i < e; ++i){
+            local = op(local, first[i]);
+        }
+        offsets[c].value = local;
+    };
+    detail::addChunkTasks(tasks, (chunks - 1) * grain, grain, total);
+    WorkerPool::shared().run(tasks, threads);
+
+    // Serial exclusive scan of chunk totals. Chunk 0 has no offset.
+    for (std::size_t c = 2; c < chunks; ++c){
+        offsets[c-1].value = op(offsets[c-2].value, offsets[c-1].value);
+    }
+
+    // Pass 2: scan each chunk from its offset.
+    tasks.clear();
+    auto scan = [first, out, &offsets, &op](std::size_t c, std::size_t b, std::size_t e)
+    {
+        T local = (c == 0) ? T(first[b]) : op(offsets[c-1].value, first[b]);
+        out[b] = local;
+        for (std::size_t i = b + 1; i < e; ++i){
+            local = op(local, first[i]);
+            out[i] = local;
+        }
+    };
+    detail::addChunkTasks(tasks, n, grain, scan);
+    WorkerPool::shared().run(tasks, threads);
+    return out + n;
+}
+
+
+template <class RandIter, class Predicate>
+RandIter parallelPartition(RandIter first, RandIter last, const Predicate& pred,
+                           std::size_t grain, unsigned threads)
+{
+    typedef typename std::iterator_traits<RandIter>::value_type E;
+
+    if (grain == 0){
+        grain = PARALLEL_DEFAULT_GRAIN;
+    }
+    const std::size_t n = last - first;
+    const std::size_t chunks = detail::chunkCount(n, grain);
+
+    // Pass 1: evaluate pred and count selected elements per chunk.
+    std::vector<char> selected(n);
+    std::vector<detail::PaddedValue<std::size_t> > counts(chunks);
+    std::vector<std::function<void()> > tasks;
+    auto count = [first, &selected, &counts, &pred]
+            (std::size_t c, std::size_t b, std::size_t e)
+    {
+        std::size_t local = 0;
+        for (std::size_t i = b; i < e; ++i){
+            selected[i] = pred(first[i]) ? 1 : 0;
+            local += selected[i];
+        }
+        counts[c].value = local;
+    };
+    detail::addChunkTasks(tasks, n, grain, count);
+    WorkerPool::shared().run(tasks, threads);
+
+    // Output offsets of each chunk for selected and rejected elements.
+    std::vector<std::size_t> true_offset(chunks + 1, 0);
+    for (std::size_t c = 0; c < chunks; ++c){
+        true_offset[c+1] = true_offset[c] + counts[c].value;
+    }
+    const std::size_t n_true = true_offset[chunks];
+
+    // Pass 2: move elements into the buffer, and pass 3: move them back.
+    std::vector<E> buffer(n);
+    tasks.clear();
+    auto scatter = [first, n_true, &buffer, &selected, &true_offset]
+            (std::size_t c, std::size_t b, std::size_t e)
+    {
+        std::size_t t = true_offset[c];
+        std::size_t f = n_true + (b - true_offset[c]);
+        for (std::size_t i = b; i < e; ++i){
+            buffer[selected[i] ? t++ : f++] = std::move(first[i]);
+        }
+    };
+    detail::addChunkTasks(tasks, n, grain, scatter);
+    WorkerPool::shared().run(tasks, threads);
+
+    tasks.clear();
+    auto gather = [first, &buffer](std::size_t, std::size_t b, std::size_t e)
+    {
+        std::move(buffer.begin() + b, buffer.begin() + e, first + b);
+    };
+    detail::addChunkTasks(tasks, n, grain, gather);
+    WorkerPool::shared().run(tasks, threads);
+
+    return first + n_true;
+}
+
+} // Namespace PPUtils
+
+#endif // PARALLEL_IMPL_HH
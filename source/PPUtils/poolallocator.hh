@@ -0,0 +1,240 @@
+/* poolallocator.hh
+ * This header file defines the PPUtils::PoolAllocator class template, an
+ * allocator for standard containers that takes single objects from pools of
+ * fixed-size blocks.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef POOLALLOCATOR_HH
+#define POOLALLOCATOR_HH
+
+#include <mutex>
+#include <vector>
+#include <cstddef>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief Size of one chunk of blocks allocated by the block pools behind
+ *  PoolAllocator, in bytes.
+ */
+const std::size_t POOL_ALLOCATOR_CHUNK_BYTES = 64 * 1024;
+
+/*!
+ * \brief Maximum number of blocks kept in the per-thread cache of one block
+ *  size. Half of it is moved to or from the shared pool at a time.
+ */
+const unsigned POOL_ALLOCATOR_CACHE_BLOCKS = 64;
+
+
+namespace detail
+{
+
+// Link of a free block.
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+
+/*!
+ * \brief The BlockPool class
+ *  Thread safe pool of blocks of Size bytes aligned to Align. Blocks are cut
+ *  from chunks of POOL_ALLOCATOR_CHUNK_BYTES, and free blocks are kept in an
+ *  intrusive list. Chunks are freed only when the pool is destroyed.
+ */
+template <std::size_t Size, std::size_t Align>
+class BlockPool
+{
+    static_assert(Size >= sizeof(FreeBlock) && Size % Align == 0,
+                  "Block must hold a link and keep its successor aligned");
+
+public:
+
+    BlockPool();
+    ~BlockPool();
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator = (const BlockPool&) = delete;
+
+    //! Returns a free block. \exception std::bad_alloc
+    void* allocate();
+
+    //! Returns block to the pool.
+    void deallocate(void* block) noexcept;
+
+    //! Moves up to n free blocks to the front of list. Returns their number.
+    //! \exception std::bad_alloc, if no block could be taken.
+    unsigned take(FreeBlock*& list, unsigned n);
+
+    //! Returns a nullptr terminated list of blocks to the pool.
+    void give(FreeBlock* list) noexcept;
+
+    //! Returns number of blocks in all chunks.
+    std::size_t capacity() const;
+
+    //! Returns number of blocks in the pool, that are free.
+    std::size_t available() const;
+
+    //! Pool shared by all PoolAllocators of this block size. Never destroyed,
+    //! so that containers with static storage duration can still use it.
+    static BlockPool& instance();
+
+private:
+
+    mutable std::mutex mx_;
+    std::vector<char*> chunks_;
+    FreeBlock* free_;
+    std::size_t free_count_;
+    char* fresh_;           // Never used blocks of the newest chunk.
+    char* fresh_end_;
+
+    // Pops a block. Called under the lock.
+    FreeBlock* pop();
+};
+
+
+/*!
+ * \brief The BlockCache class
+ *  Per-thread cache in front of BlockPool<Size, Align>. Blocks are taken
+ *  and returned without locking, and moved between the cache and the shared
+ *  pool in batches. The cache returns its blocks to the shared pool when its
+ *  thread exits.
+ */
+template <std::size_t Size, std::size_t Align>
+class BlockCache
+{
+public:
+
+    BlockCache();
+    ~BlockCache();
+
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator = (const BlockCache&) = delete;
+
+    void* allocate();
+    void deallocate(void* block) noexcept;
+
+    //! Returns cache of the calling thread, or nullptr if the thread is
+    //! exiting and its cache is already gone.
+    static BlockCache* local();
+
+private:
+
+    FreeBlock* blocks_;
+    unsigned count_;
+
+    // Trivially destructible, so it can be read after the cache is gone.
+    static thread_local bool exited_;
+};
+
+} // Namespace detail
+
+
+/*!
+ * \brief The PoolAllocator class
+ *  Allocator for standard containers. Single objects, such as the nodes of
+ *  std::list, std::map and std::unordered_map, are taken from a pool of
+ *  fixed-size blocks instead of the heap, so that inserting and erasing does
+ *  not call malloc and free. Arrays (n > 1), such as the buckets of
+ *  std::unordered_map, are allocated with operator new.
+ *
+ *  All PoolAllocators of the same block size share one thread safe pool, so
+ *  allocators are stateless and always compare equal, and memory allocated by
+ *  one can be deallocated by any other, in any thread. Rebinding to the node
+ *  types of a container works as for std::allocator. Memory in the pools is
+ *  reused, but not returned to the system.
+ *
+ *  Type arguments:
+ *   \p T: Type of allocated objects.
+ *
+ *   \p ThreadCache: If true (default), each thread keeps a small cache of
+ *  free blocks, so that most allocations take no lock. If false, every
+ *  allocation locks the shared pool, but no memory is held by idle threads.
+ */
+template <class T, bool ThreadCache = true>
+class PoolAllocator
+{
+public:
+
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    //! Same allocator for type U.
+    template <class U>
+    struct rebind
+    {
+        typedef PoolAllocator<U, ThreadCache> other;
+    };
+
+    //! Alignment of pooled blocks.
+    static const std::size_t BLOCK_ALIGN =
+            alignof(T) > alignof(detail::FreeBlock) ? alignof(T) : alignof(detail::FreeBlock);
+
+    //! Size of pooled blocks: sizeof(T) rounded up to BLOCK_ALIGN.
+    static const std::size_t BLOCK_SIZE =
+            ((sizeof(T) > sizeof(detail::FreeBlock) ? sizeof(T) : sizeof(detail::FreeBlock))
+             + BLOCK_ALIGN - 1) / BLOCK_ALIGN * BLOCK_ALIGN;
+
+    //! Pool the blocks are taken from.
+    typedef detail::BlockPool<BLOCK_SIZE, BLOCK_ALIGN> Pool;
+
+    /*!
+     * \brief Constructor.
+     */
+    PoolAllocator() noexcept {}
+
+    /*!
+     * \brief Converting constructor used by rebind.
+     */
+    template <class U>
+    PoolAllocator(const PoolAllocator<U, ThreadCache>&) noexcept {}
+
+    /*!
+     * \brief Allocate memory for \p n objects of type T.
+     * \return Pointer to uninitialized memory.
+     * \pre None.
+     * \exception std::bad_alloc, if memory cannot be allocated.
+     */
+    T* allocate(std::size_t n);
+
+    /*!
+     * \brief Deallocate memory allocated by allocate(n).
+     * \param p Pointer returned by allocate of any PoolAllocator<U,
+     *  ThreadCache> rebound to T.
+     * \param n Same as in allocate.
+     * \pre Objects in the memory have been destroyed.
+     */
+    void deallocate(T* p, std::size_t n) noexcept;
+};
+
+
+//! PoolAllocators are stateless: memory can be deallocated by any of them.
+template <class T, class U, bool ThreadCache>
+bool operator == (const PoolAllocator<T, ThreadCache>&,
+                  const PoolAllocator<U, ThreadCache>&) noexcept
+{
+    return true;
+}
+
+template <class T, class U, bool ThreadCache>
+bool operator != (const PoolAllocator<T, ThreadCache>&,
+                  const PoolAllocator<U, ThreadCache>&) noexcept
+{
+    return false;
+}
+
+} // Namespace PPUtils
+
+// Include template implementations.
+#include "poolallocator_impl.hh"
+
+#endif // POOLALLOCATOR_HH
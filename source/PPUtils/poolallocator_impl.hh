@@ -0,0 +1,254 @@
+/* poolallocator_impl.hh
+ * This is the implementation file for the PPUtils::PoolAllocator class
+ * template and its block pools.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef POOLALLOCATOR_IMPL_HH
+#define POOLALLOCATOR_IMPL_HH
+
+#include <cassert>
+#include <new>
+#include <cstdint>
+
+namespace PPUtils
+{
+
+namespace detail
+{
+
+template <std::size_t Size, std::size_t Align>
+BlockPool<Size,Align>::BlockPool() :
+    mx_(), chunks_(), free_(nullptr), free_count_(0), fresh_(nullptr),
+    fresh_end_(nullptr)
+{
+}
+
+
+template <std::size_t Size, std::size_t Align>
+BlockPool<Size,Align>::~BlockPool()
+{
+    for (char* chunk : chunks_){
+        ::operator delete(chunk);
+    }
+}
+
+
+template <std::size_t Size, std::size_t Align>
+void* BlockPool<Size,Align>::allocate()
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    return pop();
+}
+
+
+template <std::size_t Size, std::size_t Align>
+void BlockPool<Size,Align>::deallocate(void* block) noexcept
+{
+    FreeBlock* link = static_cast<FreeBlock*>(block);
+    link->next = nullptr;
+    give(link);
+}
+
+
+template <std::size_t Size, std::size_t Align>
+unsigned BlockPool<Size,Align>::take(FreeBlock*& list, unsigned n)
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    unsigned taken = 0;
+    try {
+        for (; taken < n; ++taken){
+            FreeBlock* block = pop();
+            block->next = list;
+            list = block;
+        }
+    }
+    catch (const std::bad_alloc&){
+        if (taken == 0){
+            throw;
+        }
+    }
+    return taken;
+}
+
+
+template <std::size_t Size, std::size_t Align>
+void BlockPool<Size,Align>::give(FreeBlock* list) noexcept
+{
+    if (list == nullptr){
+        return;
+    }
+    std::size_t count = 1;
+    FreeBlock* last = list;
+    while (last->next != nullptr){
+        last = last->next;
+        ++count;
+    }
+    std::lock_guard<std::mutex> lock(mx_);
+    last->next = free_;
+    free_ = list;
+    free_count_ += count;
+}
+
+
+template <std::size_t Size, std::size_t Align>
+std::size_t BlockPool<Size,Align>::capacity() const
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    return chunks_.size() * (POOL_ALLOCATOR_CHUNK_BYTES / Size);
+}
+
+
+template <std::size_t Size, std::size_t Align>
+std::size_t BlockPool<Size,Align>::available() const
+{
+    std::lock_guard<std::mutex> lock(mx_);
+    return free_count_ + (fresh_end_ - fresh_) / Size;
+}
+
+
+template <std::size_t Size, std::size_t Align>
+BlockPool<Size,Align>& BlockPool<Size,Align>::instance()
+{
+    static BlockPool* pool = new BlockPool();
+    return *pool;
+}
+
+
+template <std::size_t Size, std::size_t Align>
+FreeBlock* BlockPool<Size,Align>::pop()
+{
+    if (free_ != nullptr){
+        FreeBlock* block = free_;
+        free_ = block->next;
+        --free_count_;
+        return block;
+    }
+    if (fresh_ == fresh_end_){
+        static_assert(POOL_ALLOCATOR_CHUNK_BYTES >= Size,
+                      "Block does not fit in a chunk");
+        // Room to align the first block: operator new aligns only for
+        // fundamental types.
+        chunks_.reserve(chunks_.size() + 1);
+        char* chunk = static_cast<char*>(::operator new(POOL_ALLOCATOR_CHUNK_BYTES + Align - 1));
+        chunks_.push_back(chunk);
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(chunk);
+        fresh_ = chunk + (Align - address % Align) % Align;
+        fresh_end_ = fresh_ + POOL_ALLOCATOR_CHUNK_BYTES / Size * Size;
+    }
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(fresh_);
+    fresh_ += Size;
+    return block;
+}
+
+
+template <std::size_t Size, std::size_t Align>
+thread_local bool BlockCache<Size,Align>::exited_ = false;
+
+
+template <std::size_t Size, std::size_t Align>
+BlockCache<Size,Align>::BlockCache() :
+    blocks_(nullptr), count_(0)
+{
+}
+
+
+template <std::size_t Size, std::size_t Align>
+BlockCache<Size,Align>::~BlockCache()
+{
+    exited_ = true;
+    BlockPool<Size,Align>::instance().give(blocks_);
+}
+
+
+template <std::size_t Size, std::size_t Align>
+void* BlockCache<Size,Align>::allocate()
+{
+    if (blocks_ == nullptr){
+        count_ = BlockPool<Size,Align>::instance().take(blocks_, POOL_ALLOCATOR_CACHE_BLOCKS / 2);
+    }
+    FreeBlock* block = blocks_;
+    blocks_ = block->next;
+    --count_;
+    return block;
+}
+
+
+template <std::size_t Size, std::size_t Align>
+void BlockCache<Size,Align>::deallocate(void* block) noexcept
+{
+    if (count_ == POOL_ALLOCATOR_CACHE_BLOCKS){
+        // Full: give the older half back.
+        FreeBlock* last = blocks_;
+        for (unsigned i = 1; i < POOL_ALLOCATOR_CACHE_BLOCKS / 2; ++i){
+            last = last->next;
+        }
+        FreeBlock* rest = last->next;
+        last->next = nullptr;
+        BlockPool<Size,Align>::instance().give(rest);
+        count_ = POOL_ALLOCATOR_CACHE_BLOCKS / 2;
+    }
+    FreeBlock* link = static_cast<FreeBlock*>(block);
+    link->next = blocks_;
+    blocks_ = link;
+    ++count_;
+}
+
+
+template <std::size_t Size, std::size_t Align>
+BlockCache<Size,Align>* BlockCache<Size,Align>::local()
+{
+    if (exited_){
+        return nullptr;
+    }
+    static thread_local BlockCache cache;
+    return &cache;
+}
+
+} // Namespace detail
+
+
+template <class T, bool ThreadCache>
+const std::size_t PoolAllocator<T,ThreadCache>::BLOCK_ALIGN;
+
+template <class T, bool ThreadCache>
+const std::size_t PoolAllocator<T,ThreadCache>::BLOCK_SIZE;
+
+
+template <class T, bool ThreadCache>
+T* PoolAllocator<T,ThreadCache>::allocate(std::size_t n)
+{
+    if (n != 1){
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    detail::BlockCache<BLOCK_SIZE, BLOCK_ALIGN>* cache =
+            ThreadCache ? detail::BlockCache<BLOCK_SIZE, BLOCK_ALIGN>::local() : nullptr;
+    if (cache != nullptr){
+        return static_cast<T*>(cache->allocate());
+    }
+    return static_cast<T*>(Pool::instance().allocate());
+}
+
+
+template <class T, bool ThreadCache>
+void PoolAllocator<T,ThreadCache>::deallocate(T* p, std::size_t n) noexcept
+{
+    if (n != 1){
+        ::operator delete(p);
+        return;
+    }
+    detail::BlockCache<BLOCK_SIZE, BLOCK_ALIGN>* cache =
+            ThreadCache ? detail::BlockCache<BLOCK_SIZE, BLOCK_ALIGN>::local() : nullptr;
+    if (cache != nullptr){
+        cache->deallocate(p);
+    }
+    else {
+        Pool::instance().deallocate(p);
+    }
+}
+
+} // Namespace PPUtils
+
+#endif // POOLALLOCATOR_IMPL_HH
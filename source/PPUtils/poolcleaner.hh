@@ -0,0 +1,80 @@
+/* poolcleaner.hh
+ * This header defines the PPUtils::PoolCleaner class template, an active
+ * object that resets released objects of a pool in the background.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef POOLCLEANER_HH
+#define POOLCLEANER_HH
+
+#include "activeobject.hh"
+#include <chrono>
+#include <atomic>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief The PoolCleaner class
+ *  Active object that calls resetDirty of a pool whose ResetPolicy is
+ *  RESET_IN_BACKGROUND, so that objects are reset neither in release nor in
+ *  reserve. Released objects are reset in batches; when there are none, the
+ *  cleaner sleeps for the poll interval.
+ *
+ *  Type arguments:
+ *   \p Pool: Type of the pool. Pool must provide a thread safe resetDirty
+ *  method, e.g. ConcurrentUniformObjectPool.
+ */
+template <class Pool>
+class PoolCleaner : public ActiveObject
+{
+public:
+
+    /*!
+     * \brief Constructor.
+     * \param pool Pool, whose released objects are reset.
+     * \param poll_interval Time to sleep, when there is nothing to reset.
+     *  stop may have to wait this long.
+     * \pre poll_interval > 0. pool outlives this object.
+     * \post Cleaner is not started before start is called.
+     */
+    explicit PoolCleaner(Pool& pool,
+                         std::chrono::steady_clock::duration poll_interval =
+                            std::chrono::milliseconds(1));
+
+    /*!
+     * \brief Destructor. Stops the cleaner and waits it to finish.
+     */
+    virtual ~PoolCleaner();
+
+    /*!
+     * \brief Return total number of objects reset by this cleaner.
+     * \pre None.
+     */
+    unsigned long cleaned() const;
+
+
+protected:
+
+    /*!
+     * \brief Resets released objects of the pool, or sleeps if there are
+     *  none.
+     */
+    virtual void action();
+
+
+private:
+
+    Pool& pool_;
+    std::chrono::steady_clock::duration poll_interval_;
+    std::atomic<unsigned long> cleaned_;
+};
+
+} // Namespace PPUtils
+
+// Include template implementations.
+#include "poolcleaner_impl.hh"
+
+#endif // POOLCLEANER_HH
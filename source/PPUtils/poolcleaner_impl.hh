@@ -0,0 +1,55 @@
+/* poolcleaner_impl.hh
+ * This is the implementation file for the PPUtils::PoolCleaner class
+ * template methods.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef POOLCLEANER_IMPL_HH
+#define POOLCLEANER_IMPL_HH
+
+#include <cassert>
+#include <thread>
+
+namespace PPUtils
+{
+
+template <class Pool>
+PoolCleaner<Pool>::PoolCleaner(Pool& pool,
+                               std::chrono::steady_clock::duration poll_interval) :
+    ActiveObject(), pool_(pool), poll_interval_(poll_interval), cleaned_(0)
+{
+    assert(poll_interval > std::chrono::steady_clock::duration::zero());
+}
+
+
+template <class Pool>
+PoolCleaner<Pool>::~PoolCleaner()
+{
+    // action must not be called after this object is gone.
+    stop();
+}
+
+
+template <class Pool>
+unsigned long PoolCleaner<Pool>::cleaned() const
+{
+    return cleaned_.load(std::memory_order_relaxed);
+}
+
+
+template <class Pool>
+void PoolCleaner<Pool>::action()
+{
+    const unsigned count = pool_.resetDirty();
+    if (count == 0){
+        std::this_thread::sleep_for(poll_interval_);
+        return;
+    }
+    cleaned_.fetch_add(count, std::memory_order_relaxed);
+}
+
+} // Namespace PPUtils
+
+#endif // POOLCLEANER_IMPL_HH
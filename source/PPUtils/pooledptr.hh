@@ -0,0 +1,182 @@
+/* pooledptr.hh
+ * This header defines the PPUtils::PooledPtr class template, a smart pointer
+ * that returns its object to the pool it was reserved from.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef POOLEDPTR_HH
+#define POOLEDPTR_HH
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+namespace PPUtils
+{
+
+namespace detail
+{
+
+/*
+ * Link between a pool and the PooledPtrs reserved from it. The pool owns one
+ * shared link and clears it when destroyed, so handles that outlive the pool
+ * destroy their objects instead of returning them. For concurrent pools,
+ * handles returning objects are counted, and clearing the link waits until
+ * they are done, so a handle never returns its object to a pool that is
+ * being destroyed. Objects are returned without holding any lock of the
+ * link, so returns are serialized only by the pool itself.
+ */
+template <class T>
+class PoolLink
+{
+public:
+
+    typedef void (*Recycle)(void* pool, std::unique_ptr<T>&& object);
+
+    PoolLink(void* pool, Recycle recycle, bool concurrent);
+
+    // Returns object to the pool, or destroys it if the pool is gone.
+    void put(std::unique_ptr<T>&& object);
+
+    // Pool moved to a new address (nullptr: pool destroyed). Clearing waits
+    // for objects being returned by other threads.
+    void moveTo(void* pool);
+
+private:
+
+    // Ends a put. Wakes up moveTo, if it waits for the last put.
+    void finishPut();
+
+    std::atomic<void*> pool_;
+    Recycle recycle_;
+    bool concurrent_;
+    std::atomic<unsigned> in_flight_;   // Calls of recycle_ in progress.
+    std::mutex mx_;                     // Guards waiting for in_flight_.
+    std::condition_variable done_;
+};
+
+} // Namespace detail
+
+
+/*!
+ * \brief The PooledPtr class
+ *  Move-only smart pointer to an object reserved from a pool. When the
+ *  PooledPtr is destroyed or reset, the object is released back to the pool
+ *  it came from. If the pool has already been destroyed, the object is
+ *  destroyed instead. PooledPtrs are returned by acquire-methods of
+ *  UniformObjectPool, ConcurrentUniformObjectPool and ObjectPool.
+ *
+ *  Type arguments:
+ *   \p T: Type of the object. Same as the pool's T.
+ */
+template <class T>
+class PooledPtr
+{
+public:
+
+    /*!
+     * \brief Construct an empty PooledPtr.
+     */
+    PooledPtr() noexcept;
+
+    /*!
+     * \brief Construct an empty PooledPtr.
+     */
+    PooledPtr(std::nullptr_t) noexcept;
+
+    /*!
+     * \brief Constructor used by the pools.
+     * \param object Object reserved from the pool.
+     * \param link Link of the pool.
+     */
+    PooledPtr(std::unique_ptr<T>&& object,
+              const std::shared_ptr<detail::PoolLink<T> >& link) noexcept;
+
+    /*!
+     * \brief Destructor. Returns the object to its pool.
+     */
+    ~PooledPtr();
+
+    //! Copy-constructor is forbidden.
+    PooledPtr(const PooledPtr&) = delete;
+
+    //! Copy-assignment is forbidden.
+    PooledPtr& operator = (const PooledPtr&) = delete;
+
+    /*!
+     * \brief Move-constructor.
+     * \post \p other is empty.
+     */
+    PooledPtr(PooledPtr&& other) noexcept;
+
+    /*!
+     * \brief Move-assignment. Current object is returned to its pool first.
+     * \post \p other is empty.
+     */
+    PooledPtr& operator = (PooledPtr&& other) noexcept;
+
+    /*!
+     * \brief Return pointer to the object, or nullptr if empty.
+     */
+    T* get() const noexcept;
+
+    /*!
+     * \brief Dereference the object.
+     * \pre get() != nullptr.
+     */
+    T& operator * () const;
+
+    /*!
+     * \brief Access the object's members.
+     * \pre get() != nullptr.
+     */
+    T* operator -> () const noexcept;
+
+    /*!
+     * \brief Return true, if not empty.
+     */
+    explicit operator bool () const noexcept;
+
+    /*!
+     * \brief Return the object to its pool now.
+     * \pre None.
+     * \post This PooledPtr is empty.
+     */
+    void reset() noexcept;
+
+    /*!
+     * \brief Take the object out of pool control.
+     * \return The object. It is not returned to the pool any more.
+     * \post This PooledPtr is empty.
+     */
+    std::unique_ptr<T> detach() noexcept;
+
+    /*!
+     * \brief Swap contents with other.
+     */
+    void swap(PooledPtr& other) noexcept;
+
+
+private:
+
+    std::unique_ptr<T> object_;
+    std::shared_ptr<detail::PoolLink<T> > link_;
+};
+
+
+template <class T>
+bool operator == (const PooledPtr<T>& p, std::nullptr_t) noexcept;
+
+template <class T>
+bool operator != (const PooledPtr<T>& p, std::nullptr_t) noexcept;
+
+} // Namespace PPUtils
+
+// Include template implementations.
+#include "pooledptr_impl.hh"
+
+#endif // POOLEDPTR_HH
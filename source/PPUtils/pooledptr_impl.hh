@@ -0,0 +1,203 @@
+/* pooledptr_impl.hh
+ * This is the implementation file for the PPUtils::PooledPtr class template
+ * methods.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef POOLEDPTR_IMPL_HH
+#define POOLEDPTR_IMPL_HH
+
+#include <cassert>
+#include <utility>
+
+namespace PPUtils
+{
+
+namespace detail
+{
+
+template <class T>
+PoolLink<T>::PoolLink(void* pool, Recycle recycle, bool concurrent) :
+    pool_(pool), recycle_(recycle), concurrent_(concurrent), in_flight_(0),
+    mx_(), done_()
+{
+}
+
+
+template <class T>
+void PoolLink<T>::put(std::unique_ptr<T>&& object)
+{
+    // Announce the return before looking at the pool. moveTo clears the pool
+    // before looking at the counter, so either this call sees the pool
+    // cleared, or moveTo waits for this call to finish.
+    in_flight_.fetch_add(1);
+    void* pool = pool_.load();
+    try {
+        if (pool != nullptr){
+            recycle_(pool, std::move(object));
+        }
+        else {
+            object.reset();
+        }
+    }
+    catch (...){
+        finishPut();
+        throw;
+    }
+    finishPut();
+}
+
+
+template <class T>
+void PoolLink<T>::moveTo(void* pool)
+{
+    pool_.store(pool);
+    if (pool == nullptr && concurrent_){
+        std::unique_lock<std::mutex> lock(mx_);
+        done_.wait(lock, [this](){return in_flight_.load() == 0;});
+    }
+}
+
+
+template <class T>
+void PoolLink<T>::finishPut()
+{
+    if (in_flight_.fetch_sub(1) == 1 && pool_.load() == nullptr){
+        // The pool may be waiting in moveTo. Locking orders this
+        // notification after its check of the counter.
+        std::lock_guard<std::mutex> lock(mx_);
+        done_.notify_all();
+    }
+}
+
+} // Namespace detail
+
+
+template <class T>
+PooledPtr<T>::PooledPtr() noexcept :
+    object_(), link_()
+{
+}
+
+
+template <class T>
+PooledPtr<T>::PooledPtr(std::nullptr_t) noexcept :
+    object_(), link_()
+{
+}
+
+
+template <class T>
+PooledPtr<T>::PooledPtr(std::unique_ptr<T>&& object,
+                        const std::shared_ptr<detail::PoolLink<T> >& link) noexcept :
+    object_(std::move(object)), link_(link)
+{
+}
+
+
+template <class T>
+PooledPtr<T>::~PooledPtr()
+{
+    reset();
+}
+
+
+template <class T>
+PooledPtr<T>::PooledPtr(PooledPtr&& other) noexcept :
+    object_(std::move(other.object_)), link_(std::move(other.link_))
+{
+}
+
+
+template <class T>
+PooledPtr<T>& PooledPtr<T>::operator = (PooledPtr&& other) noexcept
+{
+    if (&other != this){
+        reset();
+        object_ = std::move(other.object_);
+        link_ = std::move(other.link_);
+    }
+    return *this;
+}
+
+
+template <class T>
+T* PooledPtr<T>::get() const noexcept
+{
+    return object_.get();
+}
+
+
+template <class T>
+T& PooledPtr<T>::operator * () const
+{
+    assert(object_ != nullptr);
+    return *object_;
+}
+
+
+template <class T>
+T* PooledPtr<T>::operator -> () const noexcept
+{
+    assert(object_ != nullptr);
+    return object_.get();
+}
+
+
+template <class T>
+PooledPtr<T>::operator bool () const noexcept
+{
+    return object_ != nullptr;
+}
+
+
+template <class T>
+void PooledPtr<T>::reset() noexcept
+{
+    if (object_ != nullptr && link_ != nullptr){
+        try {
+            link_->put(std::move(object_));
+        }
+        catch (...){
+            // Pool could not store the object: it is destroyed below.
+        }
+    }
+    object_.reset();
+    link_.reset();
+}
+
+
+template <class T>
+std::unique_ptr<T> PooledPtr<T>::detach() noexcept
+{
+    link_.reset();
+    return std::move(object_);
+}
+
+
+template <class T>
+void PooledPtr<T>::swap(PooledPtr& other) noexcept
+{
+    object_.swap(other.object_);
+    link_.swap(other.link_);
+}
+
+
+template <class T>
+bool operator == (const PooledPtr<T>& p, std::nullptr_t) noexcept
+{
+    return p.get() == nullptr;
+}
+
+
+template <class T>
+bool operator != (const PooledPtr<T>& p, std::nullptr_t) noexcept
+{
+    return p.get() != nullptr;
+}
+
+} // Namespace PPUtils
+
+#endif // POOLEDPTR_IMPL_HH
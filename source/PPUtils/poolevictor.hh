@@ -0,0 +1,77 @@
+/* poolevictor.hh
+ * This header defines the PPUtils::PoolEvictor class template, an active
+ * object that periodically destroys objects idle for too long in a pool.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef POOLEVICTOR_HH
+#define POOLEVICTOR_HH
+
+#include "activeobject.hh"
+#include <chrono>
+#include <atomic>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief The PoolEvictor class
+ *  Active object that calls evictIdle of a pool at regular intervals, so that
+ *  idle objects are destroyed even if the pool is not used. The pool's idle
+ *  time limit is set with its setMaxIdleTime method.
+ *
+ *  Type arguments:
+ *   \p Pool: Type of the pool. Pool must provide a thread safe evictIdle
+ *  method, e.g. ConcurrentUniformObjectPool.
+ */
+template <class Pool>
+class PoolEvictor : public ActiveObject
+{
+public:
+
+    /*!
+     * \brief Constructor.
+     * \param pool Pool, whose idle objects are evicted.
+     * \param interval Time between two evictIdle calls.
+     * \pre interval > 0. pool outlives this object.
+     * \post Evictor is not started before start is called.
+     */
+    PoolEvictor(Pool& pool, std::chrono::steady_clock::duration interval);
+
+    /*!
+     * \brief Destructor. Stops the evictor and waits it to finish.
+     */
+    virtual ~PoolEvictor();
+
+    /*!
+     * \brief Return total number of objects destroyed by this evictor.
+     * \pre None.
+     */
+    unsigned long evicted() const;
+
+
+protected:
+
+    /*!
+     * \brief Waits for the next interval in short slices, so that stop
+     *  returns quickly, and then evicts idle objects of the pool.
+     */
+    virtual void action();
+
+
+private:
+
+    Pool& pool_;
+    std::chrono::steady_clock::duration interval_;
+    std::chrono::steady_clock::time_point next_;
+    std::atomic<unsigned long> evicted_;
+};
+
+} // Namespace PPUtils
+
+// Include template implementations.
+#include "poolevictor_impl.hh"
+
+#endif // POOLEVICTOR_HH
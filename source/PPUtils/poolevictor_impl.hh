@@ -0,0 +1,70 @@
+/* poolevictor_impl.hh
+ * This is the implementation file for the PPUtils::PoolEvictor class
+ * template methods.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef POOLEVICTOR_IMPL_HH
+#define POOLEVICTOR_IMPL_HH
+
+#include <cassert>
+#include <thread>
+#include <algorithm>
+
+namespace PPUtils
+{
+
+namespace detail
+{
+
+// Longest single sleep of PoolEvictor. Limits the time stop waits.
+const std::chrono::milliseconds EVICTOR_SLICE(10);
+
+} // Namespace detail
+
+
+template <class Pool>
+PoolEvictor<Pool>::PoolEvictor(Pool& pool,
+                               std::chrono::steady_clock::duration interval) :
+    ActiveObject(), pool_(pool), interval_(interval),
+    next_(std::chrono::steady_clock::now() + interval), evicted_(0)
+{
+    assert(interval > std::chrono::steady_clock::duration::zero());
+}
+
+
+template <class Pool>
+PoolEvictor<Pool>::~PoolEvictor()
+{
+    // action must not be called after this object is gone.
+    stop();
+}
+
+
+template <class Pool>
+unsigned long PoolEvictor<Pool>::evicted() const
+{
+    return evicted_.load(std::memory_order_relaxed);
+}
+
+
+template <class Pool>
+void PoolEvictor<Pool>::action()
+{
+    const std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+    if (now < next_){
+        std::this_thread::sleep_for(
+                    std::min<std::chrono::steady_clock::duration>(
+                        next_ - now, detail::EVICTOR_SLICE));
+        return;
+    }
+    evicted_.fetch_add(pool_.evictIdle(), std::memory_order_relaxed);
+    next_ = now + interval_;
+}
+
+} // Namespace PPUtils
+
+#endif // POOLEVICTOR_IMPL_HH
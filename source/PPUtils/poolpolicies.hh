@@ -0,0 +1,203 @@
+/* poolpolicies.hh
+ * This header defines the builder, storage, locking and growth policies of
+ * PPUtils::BasicUniformObjectPool. Policies are plain classes with inline,
+ * non-virtual methods, so that the compiler can inline them into the pool.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef POOLPOLICIES_HH
+#define POOLPOLICIES_HH
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <cstddef>
+
+namespace PPUtils
+{
+
+// Builder policies. A builder provides T* operator()() returning an object
+// allocated with new.
+
+/*!
+ * \brief Builder policy constructing objects with their default constructor.
+ */
+template <class T>
+class DefaultBuilder
+{
+public:
+    T* operator () () const {return new T();}
+};
+
+
+// Storage policies. A storage keeps pointers to idle objects:
+//  bool push(T* object): store object, or return false if there is no room.
+//  T* pop(): remove and return the most recently pushed object, or nullptr.
+//  std::size_t size() const: number of stored objects.
+
+/*!
+ * \brief Storage policy keeping idle objects in a std::vector. Unbounded.
+ */
+template <class T>
+class VectorStorage
+{
+public:
+
+    bool push(T* object)
+    {
+        objects_.push_back(object);
+        return true;
+    }
+
+    T* pop()
+    {
+        if (objects_.empty()){
+            return nullptr;
+        }
+        T* object = objects_.back();
+        objects_.pop_back();
+        return object;
+    }
+
+    std::size_t size() const {return objects_.size();}
+
+private:
+    std::vector<T*> objects_;
+};
+
+
+/*!
+ * \brief Storage policy keeping at most N idle objects in an array inside
+ *  the pool. Never allocates; objects released to a full storage are
+ *  destroyed.
+ */
+template <class T, std::size_t N>
+class FixedStorage
+{
+public:
+
+    FixedStorage() : size_(0) {}
+
+    bool push(T* object)
+    {
+        if (size_ == N){
+            return false;
+        }
+        objects_[size_++] = object;
+        return true;
+    }
+
+    T* pop() {return size_ == 0 ? nullptr : objects_[--size_];}
+
+    std::size_t size() const {return size_;}
+
+private:
+    T* objects_[N];
+    std::size_t size_;
+};
+
+
+// Locking policies are BasicLockable: lock() and unlock().
+
+/*!
+ * \brief Locking policy for pools used from one thread only. Compiles to
+ *  nothing.
+ */
+class NoLock
+{
+public:
+    void lock() {}
+    void unlock() {}
+};
+
+
+/*!
+ * \brief Locking policy using std::mutex.
+ */
+class MutexLock
+{
+public:
+    void lock() {mx_.lock();}
+    void unlock() {mx_.unlock();}
+
+private:
+    std::mutex mx_;
+};
+
+
+/*!
+ * \brief Locking policy using a spin lock that yields after a while. Good
+ *  when critical sections are a few instructions and threads rarely collide.
+ */
+class SpinLock
+{
+public:
+
+    SpinLock() : flag_() {flag_.clear();}
+
+    void lock()
+    {
+        unsigned spins = 0;
+        while (flag_.test_and_set(std::memory_order_acquire)){
+            if (++spins % 64 == 0){
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void unlock() {flag_.clear(std::memory_order_release);}
+
+private:
+    std::atomic_flag flag_;
+};
+
+
+// Growth policies tell how many objects are built when reserve finds the
+// pool empty: std::size_t batch(std::size_t built) const, where built is the
+// number of objects built so far. Result must be at least 1.
+
+/*!
+ * \brief Growth policy building one object per miss.
+ */
+class GrowOnDemand
+{
+public:
+    std::size_t batch(std::size_t) const {return 1;}
+};
+
+
+/*!
+ * \brief Growth policy building N objects per miss.
+ */
+template <std::size_t N>
+class GrowBatch
+{
+    static_assert(N > 0, "GrowBatch needs N > 0");
+
+public:
+    std::size_t batch(std::size_t) const {return N;}
+};
+
+
+/*!
+ * \brief Growth policy doubling the number of built objects on each miss,
+ *  up to Max objects per miss.
+ */
+template <std::size_t Max = 1024>
+class GrowGeometric
+{
+    static_assert(Max > 0, "GrowGeometric needs Max > 0");
+
+public:
+    std::size_t batch(std::size_t built) const
+    {
+        return built == 0 ? 1 : (built < Max ? built : Max);
+    }
+};
+
+} // Namespace PPUtils
+
+#endif // POOLPOLICIES_HH
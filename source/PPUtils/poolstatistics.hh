@@ -0,0 +1,297 @@
+/* poolstatistics.hh
+ * This header defines PPUtils::PoolStatistics, a snapshot of the hit/miss and
+ * occupancy statistics of an object pool, and the counters the pools use to
+ * collect them.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef POOLSTATISTICS_HH
+#define POOLSTATISTICS_HH
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <ostream>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief Number of buckets in the builder latency histogram. Bucket i counts
+ *  builds that took more than 2^i and at most 2^(i+1) nanoseconds. The first
+ *  bucket also counts faster builds and the last bucket slower ones.
+ */
+const unsigned POOL_LATENCY_BUCKETS = 32;
+
+
+/*!
+ * \brief The PoolStatistics struct
+ *  Snapshot of the statistics of an object pool, returned by the statistics
+ *  method of the pools. Use it to size pools: a low hit rate means the pool
+ *  is too small or objects are evicted too early, and a high idle count
+ *  compared to outstanding_high_water means memory is held for nothing.
+ */
+struct PoolStatistics
+{
+    std::uint64_t reserves;                 //!< Objects reserved.
+    std::uint64_t hits;                     //!< Reserves served by an idle object.
+    std::uint64_t misses;                   //!< Reserves that called the builder.
+    std::uint64_t releases;                 //!< Objects released.
+    std::uint64_t idle;                     //!< Objects stored in the pool.
+    std::uint64_t idle_high_water;          //!< Most objects stored at once.
+    std::uint64_t outstanding;              //!< Reserved and not released.
+    std::uint64_t outstanding_high_water;   //!< Most objects reserved at once.
+
+    //! Builds by their duration, see POOL_LATENCY_BUCKETS. Also counts builds
+    //! done by prewarm.
+    std::vector<std::uint64_t> builder_latency;
+
+    //! Total duration of the builds in nanoseconds.
+    std::uint64_t builder_latency_sum_ns;
+
+    /*!
+     * \brief Constructor.
+     * \post All values are zero.
+     */
+    PoolStatistics();
+
+    /*!
+     * \brief Return hits / reserves, or 0 if nothing has been reserved.
+     */
+    double hitRate() const;
+
+    /*!
+     * \brief Write the statistics to \p out in the Prometheus text format.
+     *  Each value is written as a "<prefix>_<name> <value>" line after a
+     *  "# TYPE" line. The latency histogram "<prefix>_builder_latency_ns" is
+     *  written as cumulative "_bucket{le="<limit>"}" lines, where a build of
+     *  at most limit nanoseconds is counted, followed by "_sum" and "_count".
+     * \param out Output stream.
+     * \param prefix Prefix of the value names, e.g. the name of the pool.
+     */
+    void write(std::ostream& out, const std::string& prefix) const;
+};
+
+
+namespace detail
+{
+
+/*!
+ * \brief Number of counter stripes in the statistics of a concurrent pool.
+ */
+const unsigned POOL_STATS_STRIPES = 16;
+
+
+// Returns a per-thread number used to pick a counter stripe.
+inline unsigned poolStatsThread()
+{
+    static std::atomic<unsigned> next(0);
+    static thread_local unsigned thread = next.fetch_add(1, std::memory_order_relaxed);
+    return thread;
+}
+
+
+/*!
+ * \brief The PoolCounters class
+ *  Statistics collected by a pool. Event counters are relaxed atomics split
+ *  into stripes, and each thread counts in its own stripe, so that pool
+ *  threads do not contend on the counters and they can be updated without
+ *  holding the pool's lock. Idle and outstanding gauges need a consistent
+ *  view and are updated only while the pool is locked.
+ */
+class PoolCounters
+{
+public:
+
+    /*!
+     * \brief Constructor.
+     * \param stripes Number of counter stripes. 1 for single threaded pools.
+     */
+    explicit PoolCounters(unsigned stripes = POOL_STATS_STRIPES) :
+        stripes_(new Stripe[stripes]), stripe_count_(stripes),
+        idle_high_water_(0), outstanding_(0), outstanding_high_water_(0)
+    {
+        for (unsigned i = 0; i < stripes; ++i){
+            Stripe& s = stripes_[i];
+            s.reserves.store(0, std::memory_order_relaxed);
+            s.hits.store(0, std::memory_order_relaxed);
+            s.releases.store(0, std::memory_order_relaxed);
+            s.latency_sum.store(0, std::memory_order_relaxed);
+            for (std::atomic<std::uint64_t>& bucket : s.latency){
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //! Count a reserve. Thread safe.
+    void reserved(bool hit)
+    {
+        Stripe& s = stripe();
+        s.reserves.fetch_add(1, std::memory_order_relaxed);
+        if (hit){
+            s.hits.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    //! Count a release. Thread safe.
+    void released()
+    {
+        stripe().releases.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //! Count a build that took \p latency. Thread safe.
+    void built(std::chrono::steady_clock::duration latency)
+    {
+        const std::int64_t count =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+        const std::uint64_t ns = count > 0 ? count : 0;
+        // Upper limits of the buckets are inclusive: 2 ns goes to bucket 0.
+        std::uint64_t rest = ns > 0 ? ns - 1 : 0;
+        unsigned bucket = 0;
+        while (rest > 1 && bucket + 1 < POOL_LATENCY_BUCKETS){
+            rest >>= 1;
+            ++bucket;
+        }
+        Stripe& s = stripe();
+        s.latency[bucket].fetch_add(1, std::memory_order_relaxed);
+        s.latency_sum.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    //! Update idle high-water mark. Called under the pool's lock.
+    void idle(std::size_t count)
+    {
+        if (count > idle_high_water_){
+            idle_high_water_ = count;
+        }
+    }
+
+    //! Add \p delta to the outstanding gauge. Called under the pool's lock.
+    void outstanding(int delta)
+    {
+        outstanding_ += delta;
+        if (outstanding_ > outstanding_high_water_){
+            outstanding_high_water_ = outstanding_;
+        }
+    }
+
+    /*!
+     * \brief Return the statistics. Called under the pool's lock.
+     * \param idle Number of objects stored in the pool.
+     */
+    PoolStatistics snapshot(std::size_t idle) const
+    {
+        PoolStatistics rv;
+        for (unsigned i = 0; i < stripe_count_; ++i){
+            const Stripe& s = stripes_[i];
+            rv.reserves += s.reserves.load(std::memory_order_relaxed);
+            rv.hits += s.hits.load(std::memory_order_relaxed);
+            rv.releases += s.releases.load(std::memory_order_relaxed);
+            rv.builder_latency_sum_ns += s.latency_sum.load(std::memory_order_relaxed);
+            for (unsigned b = 0; b < POOL_LATENCY_BUCKETS; ++b){
+                rv.builder_latency[b] += s.latency[b].load(std::memory_order_relaxed);
+            }
+        }
+        // Hits and reserves of other threads may be counted in between.
+        rv.misses = rv.reserves - std::min(rv.hits, rv.reserves);
+        rv.idle = idle;
+        rv.idle_high_water = std::max<std::uint64_t>(idle_high_water_, idle);
+        // Objects not reserved from this pool may be released to it.
+        rv.outstanding = outstanding_ > 0 ? outstanding_ : 0;
+        rv.outstanding_high_water = outstanding_high_water_;
+        return rv;
+    }
+
+private:
+
+    // Counters of one thread. Frequently updated counters of neighbouring
+    // stripes are kept apart by the rarely updated histogram.
+    struct Stripe
+    {
+        std::atomic<std::uint64_t> reserves;
+        std::atomic<std::uint64_t> hits;
+        std::atomic<std::uint64_t> releases;
+        std::atomic<std::uint64_t> latency[POOL_LATENCY_BUCKETS];
+        std::atomic<std::uint64_t> latency_sum;
+    };
+
+    std::unique_ptr<Stripe[]> stripes_;
+    unsigned stripe_count_;
+    std::size_t idle_high_water_;
+    std::int64_t outstanding_;
+    std::int64_t outstanding_high_water_;
+
+    Stripe& stripe()
+    {
+        return stripe_count_ == 1 ? stripes_[0]
+                                  : stripes_[poolStatsThread() % stripe_count_];
+    }
+};
+
+} // Namespace detail
+
+
+inline PoolStatistics::PoolStatistics() :
+    reserves(0), hits(0), misses(0), releases(0), idle(0), idle_high_water(0),
+    outstanding(0), outstanding_high_water(0),
+    builder_latency(POOL_LATENCY_BUCKETS, 0), builder_latency_sum_ns(0)
+{
+}
+
+
+inline double PoolStatistics::hitRate() const
+{
+    return reserves == 0 ? 0.0 : double(hits) / reserves;
+}
+
+
+inline void PoolStatistics::write(std::ostream& out, const std::string& prefix) const
+{
+    struct Value
+    {
+        const char* name;
+        const char* type;
+        std::uint64_t value;
+    };
+    const Value values[] = {
+        {"reserves", "counter", reserves},
+        {"hits", "counter", hits},
+        {"misses", "counter", misses},
+        {"releases", "counter", releases},
+        {"idle", "gauge", idle},
+        {"idle_high_water", "gauge", idle_high_water},
+        {"outstanding", "gauge", outstanding},
+        {"outstanding_high_water", "gauge", outstanding_high_water}
+    };
+    for (const Value& v : values){
+        out << "# TYPE " << prefix << '_' << v.name << ' ' << v.type << '\n'
+            << prefix << '_' << v.name << ' ' << v.value << '\n';
+    }
+
+    const std::string histogram = prefix + "_builder_latency_ns";
+    out << "# TYPE " << histogram << " histogram\n";
+    std::uint64_t cumulative = 0;
+    for (unsigned i = 0; i < builder_latency.size(); ++i){
+        cumulative += builder_latency[i];
+        out << histogram << "_bucket{le=\"";
+        if (i + 1 < builder_latency.size()){
+            out << (std::uint64_t(1) << (i + 1));
+        }
+        else {
+            out << "+Inf";
+        }
+        out << "\"} " << cumulative << '\n';
+    }
+    out << histogram << "_sum " << builder_latency_sum_ns << '\n'
+        << histogram << "_count " << cumulative << '\n';
+}
+
+} // Namespace PPUtils
+
+#endif // POOLSTATISTICS_HH
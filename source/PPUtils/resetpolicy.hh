@@ -0,0 +1,96 @@
+/* resetpolicy.hh
+ * This header defines the reset policies of UniformObjectPool. A reset policy
+ * tells how and when objects released to the pool are brought back to a
+ * re-usable state.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef RESETPOLICY_HH
+#define RESETPOLICY_HH
+
+#include <functional>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief When a pool resets released objects.
+ */
+enum ResetTiming
+{
+    RESET_NEVER = 0,            //!< Objects are stored in their current state.
+    RESET_ON_RELEASE = 1,       //!< Eagerly in release.
+    RESET_ON_RESERVE = 2,       //!< Lazily in reserve, before returning.
+    RESET_IN_BACKGROUND = 3     //!< In resetDirty, e.g. by a PoolCleaner.
+};
+
+
+/*!
+ * \brief The NoReset class
+ *  Default reset policy: objects are not reset.
+ */
+class NoReset
+{
+public:
+
+    static const ResetTiming TIMING = RESET_NEVER;
+
+    template <class T>
+    void operator () (T&) const {}
+};
+
+
+/*!
+ * \brief The PoolReset class
+ *  Reset policy that resets objects with \p Reset at time \p Timing.
+ *
+ *  Type arguments:
+ *   \p Timing: When objects are reset.
+ *
+ *   \p Reset: A functor class with a function operator taking a reference
+ *  to the object. With RESET_ON_RESERVE and RESET_IN_BACKGROUND the reset is
+ *  called outside the lock of ConcurrentUniformObjectPool, so it may be
+ *  called from several threads at once.
+ */
+template <ResetTiming Timing, class Reset>
+class PoolReset
+{
+public:
+
+    static const ResetTiming TIMING = Timing;
+
+    /*!
+     * \brief Constructor.
+     * \param reset Functor resetting one object. A copy is used.
+     */
+    explicit PoolReset(const Reset& reset = Reset()) : reset_(reset) {}
+
+    /*!
+     * \brief Reset \p object.
+     */
+    template <class T>
+    void operator () (T& object) {reset_(object);}
+
+private:
+
+    Reset reset_;
+};
+
+
+//! Reset objects in release.
+template <class Reset>
+using EagerReset = PoolReset<RESET_ON_RELEASE, Reset>;
+
+//! Reset objects in reserve.
+template <class Reset>
+using LazyReset = PoolReset<RESET_ON_RESERVE, Reset>;
+
+//! Reset objects in resetDirty, called by a cleaner thread.
+template <class Reset>
+using BackgroundReset = PoolReset<RESET_IN_BACKGROUND, Reset>;
+
+} // Namespace PPUtils
+
+#endif // RESETPOLICY_HH
@@ -0,0 +1,663 @@
+/* simdsort.cc
+ * This is the implementation file for the vectorized sort functions declared
+ * in simdsort.hh. SIMD kernels are compiled with function level target
+ * attributes, so no special compiler flags are needed, and the kernel is
+ * chosen at run time.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#include "simdsort.hh"
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define PPUTILS_SIMDSORT_X86
+#include <immintrin.h>
+#define PPUTILS_TARGET_AVX2 __attribute__((target("avx2")))
+#define PPUTILS_TARGET_SSE4 __attribute__((target("sse4.2")))
+#endif
+
+namespace PPUtils
+{
+
+namespace
+{
+
+/*
+ * Sorts blocks of lanes*lanes keys so that each vector is a sorted run, and
+ * merges two sorted runs whose lengths are multiples of lanes.
+ */
+template <class K>
+struct Kernel
+{
+    std::size_t lanes;
+    void (*sortBlocks)(K* data, std::size_t n);
+    void (*merge)(const K* a, std::size_t na, const K* b, std::size_t nb, K* out);
+};
+
+
+#ifdef PPUTILS_SIMDSORT_X86
+
+// AVX2, 8 x int32.
+struct Avx2Int32
+{
+    typedef std::int32_t Scalar;
+    typedef __m256i V;
+    static const std::size_t LANES = 8;
+
+    PPUTILS_TARGET_AVX2 static V load(const Scalar* p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const V*>(p));
+    }
+
+    PPUTILS_TARGET_AVX2 static void store(Scalar* p, V v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<V*>(p), v);
+    }
+
+    PPUTILS_TARGET_AVX2 static void minMax(V& a, V& b)
+    {
+        V t = _mm256_min_epi32(a, b);
+        b = _mm256_max_epi32(a, b);
+        a = t;
+    }
+
+    PPUTILS_TARGET_AVX2 static V reverse(V v)
+    {
+        return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+
+    // Sorts a bitonic vector: compare-exchange lanes at distances 4, 2, 1.
+    PPUTILS_TARGET_AVX2 static V clean(V v)
+    {
+        V t = _mm256_permute2x128_si256(v, v, 1);
+        v = _mm256_blend_epi32(_mm256_min_epi32(v, t), _mm256_max_epi32(v, t), 0xF0);
+        t = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+        v = _mm256_blend_epi32(_mm256_min_epi32(v, t), _mm256_max_epi32(v, t), 0xCC);
+        t = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm256_blend_epi32(_mm256_min_epi32(v, t), _mm256_max_epi32(v, t), 0xAA);
+    }
+
+    // Sorts lanes across the registers with a 19 comparator network and
+    // transposes, so that each register holds a sorted run.
+    PPUTILS_TARGET_AVX2 static void sortBlock(V* r)
+    {
+        minMax(r[0], r[2]); minMax(r[1], r[3]); minMax(r[4], r[6]); minMax(r[5], r[7]);
+        minMax(r[0], r[4]); minMax(r[1], r[5]); minMax(r[2], r[6]); minMax(r[3], r[7]);
+        minMax(r[0], r[1]); minMax(r[2], r[3]); minMax(r[4], r[5]); minMax(r[6], r[7]);
+        minMax(r[2], r[4]); minMax(r[3], r[5]);
+        minMax(r[1], r[4]); minMax(r[3], r[6]);
+        minMax(r[1], r[2]); minMax(r[3], r[4]); minMax(r[5], r[6]);
+
+        V t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+        V t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+        V t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+        V t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+        V t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+        V t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+        V t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+        V t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+        V u0 = _mm256_unpacklo_epi64(t0, t2);
+        V u1 = _mm256_unpackhi_epi64(t0, t2);
+        V u2 = _mm256_unpacklo_epi64(t1, t3);
+        V u3 = _mm256_unpackhi_epi64(t1, t3);
+        V u4 = _mm256_unpacklo_epi64(t4, t6);
+        V u5 = _mm256_unpackhi_epi64(t4, t6);
+        V u6 = _mm256_unpacklo_epi64(t5, t7);
+        V u7 = _mm256_unpackhi_epi64(t5, t7);
+        r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+        r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+        r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+        r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+        r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+        r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+        r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+        r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+    }
+};
+
+
+// AVX2, 4 x int64.
+struct Avx2Int64
+{
+    typedef std::int64_t Scalar;
+    typedef __m256i V;
+    static const std::size_t LANES = 4;
+
+    PPUTILS_TARGET_AVX2 static V load(const Scalar* p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const V*>(p));
+    }
+
+    PPUTILS_TARGET_AVX2 static void store(Scalar* p, V v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<V*>(p), v);
+    }
+
+    PPUTILS_TARGET_AVX2 static V min(V a, V b)
+    {
+        return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+    }
+
+    PPUTILS_TARGET_AVX2 static V max(V a, V b)
+    {
+        return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+    }
+
+    PPUTILS_TARGET_AVX2 static void minMax(V& a, V& b)
+    {
+        V gt = _mm256_cmpgt_epi64(a, b);
+        V t = _mm256_blendv_epi8(a, b, gt);
+        b = _mm256_blendv_epi8(b, a, gt);
+        a = t;
+    }
+
+    PPUTILS_TARGET_AVX2 static V reverse(V v)
+    {
+        return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+
+    // Sorts a bitonic vector: compare-exchange lanes at distances 2, 1.
+    PPUTILS_TARGET_AVX2 static V clean(V v)
+    {
+        V t = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 3, 2));
+        v = _mm256_blend_epi32(min(v, t), max(v, t), 0xF0);
+        t = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+        return _mm256_blend_epi32(min(v, t), max(v, t), 0xCC);
+    }
+
+    PPUTILS_TARGET_AVX2 static void sortBlock(V* r)
+    {
+        minMax(r[0], r[1]); minMax(r[2], r[3]);
+        minMax(r[0], r[2]); minMax(r[1], r[3]);
+        minMax(r[1], r[2]);
+
+        V t0 = _mm256_unpacklo_epi64(r[0], r[1]);
+        V t1 = _mm256_unpackhi_epi64(r[0], r[1]);
+        V t2 = _mm256_unpacklo_epi64(r[2], r[3]);
+        V t3 = _mm256_unpackhi_epi64(r[2], r[3]);
+        r[0] = _mm256_permute2x128_si256(t0, t2, 0x20);
+        r[1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+        r[2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+        r[3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+    }
+};
+
+
+// SSE4.1, 4 x int32.
+struct Sse4Int32
+{
+    typedef std::int32_t Scalar;
+    typedef __m128i V;
+    static const std::size_t LANES = 4;
+
+    PPUTILS_TARGET_SSE4 static V load(const Scalar* p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const V*>(p));
+    }
+
+    PPUTILS_TARGET_SSE4 static void store(Scalar* p, V v)
+    {
+        _mm_storeu_si128(reinterpret_cast<V*>(p), v);
+    }
+
+    PPUTILS_TARGET_SSE4 static void minMax(V& a, V& b)
+    {
+        V t = _mm_min_epi32(a, b);
+        b = _mm_max_epi32(a, b);
+        a = t;
+    }
+
+    PPUTILS_TARGET_SSE4 static V reverse(V v)
+    {
+        return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+
+    // Sorts a bitonic vector: compare-exchange lanes at distances 2, 1.
+    PPUTILS_TARGET_SSE4 static V clean(V v)
+    {
+        V t = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+        v = _mm_blend_epi16(_mm_min_epi32(v, t), _mm_max_epi32(v, t), 0xF0);
+        t = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_blend_epi16(_mm_min_epi32(v, t), _mm_max_epi32(v, t), 0xCC);
+    }
+
+    PPUTILS_TARGET_SSE4 static void sortBlock(V* r)
+    {
+        minMax(r[0], r[1]); minMax(r[2], r[3]);
+        minMax(r[0], r[2]); minMax(r[1], r[3]);
+        minMax(r[1], r[2]);
+
+        V t0 = _mm_unpacklo_epi32(r[0], r[1]);
+        V t1 = _mm_unpackhi_epi32(r[0], r[1]);
+        V t2 = _mm_unpacklo_epi32(r[2], r[3]);
+        V t3 = _mm_unpackhi_epi32(r[2], r[3]);
+        r[0] = _mm_unpacklo_epi64(t0, t2);
+        r[1] = _mm_unpackhi_epi64(t0, t2);
+        r[2] = _mm_unpacklo_epi64(t1, t3);
+        r[3] = _mm_unpackhi_epi64(t1, t3);
+    }
+};
+
+
+// SSE4.2, 2 x int64.
+struct Sse4Int64
+{
+    typedef std::int64_t Scalar;
+    typedef __m128i V;
+    static const std::size_t LANES = 2;
+
+    PPUTILS_TARGET_SSE4 static V load(const Scalar* p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const V*>(p));
+    }
+
+    PPUTILS_TARGET_SSE4 static void store(Scalar* p, V v)
+    {
+        _mm_storeu_si128(reinterpret_cast<V*>(p), v);
+    }
+
+    PPUTILS_TARGET_SSE4 static void minMax(V& a, V& b)
+    {
+        V gt = _mm_cmpgt_epi64(a, b);
+        V t = _mm_blendv_epi8(a, b, gt);
+        b = _mm_blendv_epi8(b, a, gt);
+        a = t;
+    }
+
+    PPUTILS_TARGET_SSE4 static V reverse(V v)
+    {
+        return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    }
+
+    // Sorts a bitonic vector: compare-exchange lanes at distance 1.
+    PPUTILS_TARGET_SSE4 static V clean(V v)
+    {
+        V t = reverse(v);
+        V gt = _mm_cmpgt_epi64(v, t);
+        return _mm_blend_epi16(_mm_blendv_epi8(v, t, gt),
+                               _mm_blendv_epi8(t, v, gt), 0xF0);
+    }
+
+    PPUTILS_TARGET_SSE4 static void sortBlock(V* r)
+    {
+        minMax(r[0], r[1]);
+        V t = _mm_unpacklo_epi64(r[0], r[1]);
+        r[1] = _mm_unpackhi_epi64(r[0], r[1]);
+        r[0] = t;
+    }
+};
+
+
+/*
+ * Generic block sort and merge. The same code is compiled once per target,
+ * because functions using AVX2 intrinsics may only be inlined into functions
+ * compiled for AVX2.
+ */
+template <class Ops>
+PPUTILS_TARGET_AVX2 void avx2SortBlocks(typename Ops::Scalar* data, std::size_t n)
+{
+    const std::size_t w = Ops::LANES;
+    typename Ops::V r[Ops::LANES];
+    for (std::size_t i = 0; i < n; i += w * w){
+        for (std::size_t j = 0; j < w; ++j){
+            r[j] = Ops::load(data + i + j * w);
+        }
+        Ops::sortBlock(r);
+        for (std::size_t j = 0; j < w; ++j){
+            Ops::store(data + i + j * w, r[j]);
+        }
+    }
+}
+
+
+template <class Ops>
+PPUTILS_TARGET_AVX2 void avx2Merge(const typename Ops::Scalar* a, std::size_t na,
+                                   const typename Ops::Scalar* b, std::size_t nb,
+                                   typename Ops::Scalar* out)
+{
+    typedef typename Ops::V V;
+    const std::size_t w = Ops::LANES;
+    const typename Ops::Scalar* a_end = a + na;
+    const typename Ops::Scalar* b_end = b + nb;
+
+    // hi keeps the largest w elements merged so far.
+    V lo = Ops::load(a);
+    V hi = Ops::load(b);
+    a += w;
+    b += w;
+    while (true){
+        hi = Ops::reverse(hi);
+        Ops::minMax(lo, hi);
+        Ops::store(out, Ops::clean(lo));
+        hi = Ops::clean(hi);
+        out += w;
+        if (a == a_end && b == b_end){
+            break;
+        }
+        if (b == b_end || (a != a_end && *a <= *b)){
+            lo = Ops::load(a);
+            a += w;
+        }
+        else {
+            lo = Ops::load(b);
+            b += w;
+        }
+    }
+    Ops::store(out, hi);
+}
+
+
+template <class Ops>
+PPUTILS_TARGET_SSE4 void sse4SortBlocks(typename Ops::Scalar* data, std::size_t n)
+{
+    const std::size_t w = Ops::LANES;
+    typename Ops::V r[Ops::LANES];
+    for (std::size_t i = 0; i < n; i += w * w){
+        for (std::size_t j = 0; j < w; ++j){
+            r[j] = Ops::load(data + i + j * w);
+        }
+        Ops::sortBlock(r);
+        for (std::size_t j = 0; j < w; ++j){
+            Ops::store(data + i + j * w, r[j]);
+        }
+    }
+}
+
+
+template <class Ops>
+PPUTILS_TARGET_SSE4 void sse4Merge(const typename Ops::Scalar* a, std::size_t na,
+                                   const typename Ops::Scalar* b, std::size_t nb,
+                                   typename Ops::Scalar* out)
+{
+    typedef typename Ops::V V;
+    const std::size_t w = Ops::LANES;
+    const typename Ops::Scalar* a_end = a + na;
+    const typename Ops::Scalar* b_end = b + nb;
+
+    // hi keeps the largest w elements merged so far.
+    V lo = Ops::load(a);
+    V hi = Ops::load(b);
+    a += w;
+    b += w;
+    while (true){
+        hi = Ops::reverse(hi);
+        Ops::minMax(lo, hi);
+        Ops::store(out, Ops::clean(lo));
+        hi = Ops::clean(hi);
+        out += w;
+        if (a == a_end && b == b_end){
+            break;
+        }
+        if (b == b_end || (a != a_end && *a <= *b)){
+            lo = Ops::load(a);
+            a += w;
+        }
+        else {
+            lo = Ops::load(b);
+            b += w;
+        }
+    }
+    Ops::store(out, hi);
+}
+
+#endif // PPUTILS_SIMDSORT_X86
+
+
+template <class K>
+Kernel<K> selectKernel(SimdLevel level);
+
+template <>
+Kernel<std::int32_t> selectKernel(SimdLevel level)
+{
+#ifdef PPUTILS_SIMDSORT_X86
+    if (level >= SIMD_AVX2){
+        Kernel<std::int32_t> k = {Avx2Int32::LANES, &avx2SortBlocks<Avx2Int32>,
+                                  &avx2Merge<Avx2Int32>};
+        return k;
+    }
+    if (level >= SIMD_SSE4){
+        Kernel<std::int32_t> k = {Sse4Int32::LANES, &sse4SortBlocks<Sse4Int32>,
+                                  &sse4Merge<Sse4Int32>};
+        return k;
+    }
+#endif
+    (void)level;
+    Kernel<std::int32_t> k = {0, nullptr, nullptr};
+    return k;
+}
+
+template <>
+Kernel<std::int64_t> selectKernel(SimdLevel level)
+{
+#ifdef PPUTILS_SIMDSORT_X86
+    if (level >= SIMD_AVX2){
+        Kernel<std::int64_t> k = {Avx2Int64::LANES, &avx2SortBlocks<Avx2Int64>,
+                                  &avx2Merge<Avx2Int64>};
+        return k;
+    }
+    if (level >= SIMD_SSE4){
+        Kernel<std::int64_t> k = {Sse4Int64::LANES, &sse4SortBlocks<Sse4Int64>,
+                                  &sse4Merge<Sse4Int64>};
+        return k;
+    }
+#endif
+    (void)level;
+    Kernel<std::int64_t> k = {0, nullptr, nullptr};
+    return k;
+}
+
+
+/*
+ * Sorts keys with the best kernel allowed by max_level. Keys are padded with
+ * the maximum value to a multiple of the block size, sorted into runs of one
+ * vector, and merged bottom-up between keys and one buffer.
+ */
+template <class K>
+void sortKeys(std::vector<K>& keys, SimdLevel max_level)
+{
+    const std::size_t n = keys.size();
+    const Kernel<K> kernel = selectKernel<K>(std::min(max_level,
+                                                      simdSortSupportedLevel()));
+    const std::size_t block = kernel.lanes * kernel.lanes;
+    if (kernel.lanes == 0 || n < 2 * block){
+        std::sort(keys.begin(), keys.end());
+        return;
+    }
+
+    const std::size_t padded = (n + block - 1) / block * block;
+    keys.resize(padded, std::numeric_limits<K>::max());
+    std::vector<K> buf(padded);
+    kernel.sortBlocks(keys.data(), padded);
+
+    K* src = keys.data();
+    K* dst = buf.data();
+    for (std::size_t width = kernel.lanes; width < padded; width *= 2){
+        for (std::size_t i = 0; i < padded; i += 2 * width){
+            if (i + width >= padded){
+                std::copy(src + i, src + padded, dst + i);
+            }
+            else {
+                kernel.merge(src + i, width, src + i + width,
+                             std::min(width, padded - i - width), dst + i);
+            }
+        }
+        std::swap(src, dst);
+    }
+    if (src != keys.data()){
+        std::copy(src, src + n, keys.begin());
+    }
+    keys.resize(n);
+}
+
+
+// Order preserving maps to signed integers. Each map is its own inverse.
+inline std::int32_t mapKey(std::int32_t k)
+{
+    return k;
+}
+
+inline std::int32_t mapKey(std::uint32_t k)
+{
+    return static_cast<std::int32_t>(k ^ 0x80000000u);
+}
+
+inline std::int32_t mapKey(float k)
+{
+    std::int32_t i;
+    std::memcpy(&i, &k, sizeof(i));
+    return i < 0 ? (i ^ 0x7FFFFFFF) : i;
+}
+
+inline std::int64_t mapKey(std::int64_t k)
+{
+    return k;
+}
+
+inline std::int64_t mapKey(std::uint64_t k)
+{
+    return static_cast<std::int64_t>(k ^ 0x8000000000000000ull);
+}
+
+inline std::int64_t mapKey(double k)
+{
+    std::int64_t i;
+    std::memcpy(&i, &k, sizeof(i));
+    return i < 0 ? (i ^ 0x7FFFFFFFFFFFFFFFll) : i;
+}
+
+template <class T, class K>
+T unmapKey(K k)
+{
+    T t;
+    K i = (std::is_floating_point<T>::value && k < 0)
+            ? K(k ^ std::numeric_limits<K>::max()) : k;
+    if (!std::is_floating_point<T>::value && !std::is_signed<T>::value){
+        i = K(i ^ std::numeric_limits<K>::min());
+    }
+    std::memcpy(&t, &i, sizeof(t));
+    return t;
+}
+
+
+template <class T>
+void sortMapped(T* first, T* last, SimdLevel max_level)
+{
+    typedef decltype(mapKey(T())) K;
+    std::vector<K> keys(last - first);
+    for (std::size_t i = 0; i < keys.size(); ++i){
+        keys[i] = mapKey(first[i]);
+    }
+    sortKeys(keys, max_level);
+    for (std::size_t i = 0; i < keys.size(); ++i){
+        first[i] = unmapKey<T>(keys[i]);
+    }
+}
+
+
+// Packs mapped key to the high and payload to the low half of an int64.
+template <class T>
+void sortMappedByKey(T* first, T* last, std::uint32_t* payload,
+                     SimdLevel max_level)
+{
+    std::vector<std::int64_t> packed(last - first);
+    for (std::size_t i = 0; i < packed.size(); ++i){
+        std::uint32_t key = static_cast<std::uint32_t>(mapKey(first[i]));
+        packed[i] = static_cast<std::int64_t>((std::uint64_t(key) << 32) | payload[i]);
+    }
+    sortKeys(packed, max_level);
+    for (std::size_t i = 0; i < packed.size(); ++i){
+        std::uint64_t p = static_cast<std::uint64_t>(packed[i]);
+        first[i] = unmapKey<T>(static_cast<std::int32_t>(p >> 32));
+        payload[i] = static_cast<std::uint32_t>(p);
+    }
+}
+
+} // Anonymous namespace
+
+
+SimdLevel simdSortSupportedLevel()
+{
+#ifdef PPUTILS_SIMDSORT_X86
+    static const SimdLevel level = []()
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")){
+            return SIMD_AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.2")){
+            return SIMD_SSE4;
+        }
+        return SIMD_SCALAR;
+    }();
+    return level;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+
+void simdSort(std::int32_t* first, std::int32_t* last, SimdLevel max_level)
+{
+    sortMapped(first, last, max_level);
+}
+
+
+void simdSort(std::uint32_t* first, std::uint32_t* last, SimdLevel max_level)
+{
+    sortMapped(first, last, max_level);
+}
+
+
+void simdSort(float* first, float* last, SimdLevel max_level)
+{
+    sortMapped(first, last, max_level);
+}
+
+
+void simdSort(std::int64_t* first, std::int64_t* last, SimdLevel max_level)
+{
+    sortMapped(first, last, max_level);
+}
+
+
+void simdSort(std::uint64_t* first, std::uint64_t* last, SimdLevel max_level)
+{
+    sortMapped(first, last, max_level);
+}
+
+
+void simdSort(double* first, double* last, SimdLevel max_level)
+{
+    sortMapped(first, last, max_level);
+}
+
+
+void simdSortByKey(std::int32_t* keys_first, std::int32_t* keys_last,
+                   std::uint32_t* payload, SimdLevel max_level)
+{
+    sortMappedByKey(keys_first, keys_last, payload, max_level);
+}
+
+
+void simdSortByKey(std::uint32_t* keys_first, std::uint32_t* keys_last,
+                   std::uint32_t* payload, SimdLevel max_level)
+{
+    sortMappedByKey(keys_first, keys_last, payload, max_level);
+}
+
+
+void simdSortByKey(float* keys_first, float* keys_last,
+                   std::uint32_t* payload, SimdLevel max_level)
+{
+    sortMappedByKey(keys_first, keys_last, payload, max_level);
+}
+
+} // Namespace PPUtils
@@ -0,0 +1,113 @@
+/* simdsort.hh
+ * This header declares vectorized sort functions for arrays of primitive keys,
+ * with and without a payload.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef SIMDSORT_HH
+#define SIMDSORT_HH
+
+#include <cstdint>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief Instruction set levels of the simdSort kernels.
+ */
+enum SimdLevel
+{
+    SIMD_SCALAR = 0,    //!< Portable scalar code.
+    SIMD_SSE4 = 1,      //!< SSE4.1 for 32-bit lanes, SSE4.2 for 64-bit lanes.
+    SIMD_AVX2 = 2       //!< AVX2.
+};
+
+
+/*!
+ * \brief Return the best SimdLevel supported by the running CPU. SIMD levels
+ *  are available only for x86 targets compiled with GCC or Clang.
+ * \pre None.
+ */
+SimdLevel simdSortSupportedLevel();
+
+
+/*!
+ * \brief Vectorized merge sort for arrays of primitive keys.
+ *  Keys are mapped to signed integers of the same width preserving their
+ *  order, and sorted with a merge sort whose leaf and merge steps work on
+ *  whole vectors: blocks of W vectors of W lanes are sorted with an
+ *  in-register sorting network followed by a transpose, and runs are merged
+ *  with a bitonic merge network of two vectors. W is 8 (AVX2) or 4 (SSE4)
+ *  for 32-bit keys and 4 or 2 for 64-bit keys. The kernel is chosen at run
+ *  time. Arrays shorter than two blocks are sorted with scalar code.
+ *
+ * \param first Pointer to the first key.
+ * \param last Pointer past the last key.
+ * \param max_level Highest SimdLevel that may be used. The actual level is
+ *  the lower of this and simdSortSupportedLevel().
+ * \pre [first, last) is a valid array.
+ * \post Keys are in ascending order. Floating point keys are ordered by their
+ *  bits: -0.0 precedes 0.0, negative NaNs are first and positive NaNs last.
+ *  The result does not depend on the SimdLevel used.
+ *
+ *  Complexity: time O(N log N), memory O(N).
+ *
+ * \exception std::bad_alloc, if memory allocation fails.
+ */
+void simdSort(std::int32_t* first, std::int32_t* last,
+              SimdLevel max_level = SIMD_AVX2);
+
+//! \overload
+void simdSort(std::uint32_t* first, std::uint32_t* last,
+              SimdLevel max_level = SIMD_AVX2);
+
+//! \overload
+void simdSort(float* first, float* last, SimdLevel max_level = SIMD_AVX2);
+
+//! \overload
+void simdSort(std::int64_t* first, std::int64_t* last,
+              SimdLevel max_level = SIMD_AVX2);
+
+//! \overload
+void simdSort(std::uint64_t* first, std::uint64_t* last,
+              SimdLevel max_level = SIMD_AVX2);
+
+//! \overload
+void simdSort(double* first, double* last, SimdLevel max_level = SIMD_AVX2);
+
+
+/*!
+ * \brief Vectorized sort of 32-bit keys with a 32-bit payload, for example
+ *  an index of the record each key belongs to. Each key is packed together
+ *  with its payload into one 64-bit lane and sorted with the 64-bit kernel.
+ *
+ * \param keys_first Pointer to the first key.
+ * \param keys_last Pointer past the last key.
+ * \param payload Pointer to the payload of the first key. Payload array has
+ *  as many elements as the key array.
+ * \param max_level Highest SimdLevel that may be used.
+ * \pre Both arrays are valid and do not overlap.
+ * \post Keys are in ascending order (see simdSort), and each payload stays
+ *  with its key. Equal keys are ordered by their payload, so the sort is
+ *  stable if the payloads are the original indices.
+ *
+ *  Complexity: time O(N log N), memory O(N).
+ *
+ * \exception std::bad_alloc, if memory allocation fails.
+ */
+void simdSortByKey(std::int32_t* keys_first, std::int32_t* keys_last,
+                   std::uint32_t* payload, SimdLevel max_level = SIMD_AVX2);
+
+//! \overload
+void simdSortByKey(std::uint32_t* keys_first, std::uint32_t* keys_last,
+                   std::uint32_t* payload, SimdLevel max_level = SIMD_AVX2);
+
+//! \overload
+void simdSortByKey(float* keys_first, float* keys_last,
+                   std::uint32_t* payload, SimdLevel max_level = SIMD_AVX2);
+
+} // Namespace PPUtils
+
+#endif // SIMDSORT_HH
@@ -0,0 +1,246 @@
+/* slabobjectpool.hh
+ * This header file defines the PPUtils::SlabObjectPool class template, a
+ * slab-backed variant of UniformObjectPool.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef SLABOBJECTPOOL_HH
+#define SLABOBJECTPOOL_HH
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <cstddef>
+
+namespace PPUtils
+{
+
+/*!
+ * \brief Default size of one slab of SlabObjectPool in bytes.
+ */
+const std::size_t SLAB_DEFAULT_BYTES = 64 * 1024;
+
+/*!
+ * \brief Slabs of SlabObjectPool are aligned to at least this many bytes
+ *  (one cache line).
+ */
+const std::size_t SLAB_ALIGNMENT = 64;
+
+
+/*!
+ * \brief The SlabObjectPool class
+ *  Object pool like UniformObjectPool, but objects live in large aligned
+ *  slabs owned by the pool instead of separate heap allocations. Each slab
+ *  holds many slots, and each slot holds one T and a link. Objects are
+ *  constructed into slots with placement new, and released objects are kept
+ *  constructed in an intrusive free list, so reserve and release are O(1)
+ *  pointer pops and pushes that never call the heap allocator. A new slab is
+ *  allocated only when all slots are in use.
+ *
+ *  Reserved objects are returned as unique_ptrs whose deleter releases them
+ *  back to the pool, so a forgotten release does not leak the object, and
+ *  code using UniformObjectPool::reserve and release works with this pool
+ *  after changing the pointer type to SlabObjectPool::Pointer. Because the
+ *  objects live in the slabs, they must be released before the pool is
+ *  destroyed. Slabs are freed only when the pool is destroyed; clear()
+ *  destroys idle objects but keeps their slots for reuse.
+ *
+ *  This class is not thread safe.
+ *
+ *  Type arguments:
+ *   \p T: Type of stored objects. Subclasses of T cannot be stored, because
+ *  slots have room for exactly one T.
+ *
+ *   \p Builder: A functor class that constructs new objects. Builder must
+ *  provide a function operator taking a pointer to uninitialized storage of
+ *  sizeof(T) bytes aligned for T, constructing a T there (placement new) and
+ *  returning pointer to it.
+ */
+template <class T, class Builder = typename std::function<T*(void*)> >
+class SlabObjectPool
+{
+    struct Slabs;
+
+public:
+
+    /*!
+     * \brief The SlabDeleter class
+     *  Deleter of reserved objects. Releases the object back to the pool it
+     *  was reserved from, instead of destroying it.
+     */
+    class SlabDeleter
+    {
+    public:
+
+        //! Construct a deleter not bound to any pool.
+        SlabDeleter() noexcept : slabs_(nullptr) {}
+
+        //! Release object to the pool.
+        void operator()(T* object) const noexcept;
+
+    private:
+
+        friend class SlabObjectPool;
+        explicit SlabDeleter(Slabs* slabs) noexcept : slabs_(slabs) {}
+        Slabs* slabs_;
+    };
+
+    /*!
+     * \brief Pointer to a reserved object. Destroying or resetting it
+     *  releases the object.
+     */
+    typedef std::unique_ptr<T, SlabDeleter> Pointer;
+
+    /*!
+     * \brief Constructor.
+     * \param builder Builder object used to construct new objects. This object
+     *  uses a copy of builder.
+     * \param slab_bytes Size of one slab in bytes. Each slab holds at least
+     *  one object.
+     * \pre None.
+     * \post Pool is empty. No slab is allocated before the first reserve.
+     */
+    explicit SlabObjectPool(const Builder& builder = DEFAULT_BUILDER,
+                            std::size_t slab_bytes = SLAB_DEFAULT_BYTES);
+
+    /*!
+     * \brief Destructor destroys all stored objects and frees the slabs.
+     * \pre All reserved objects have been released, i.e. their Pointers have
+     *  been destroyed, reset or passed to release.
+     */
+    ~SlabObjectPool();
+
+    //! Copy-constructor is forbidden.
+    SlabObjectPool(const SlabObjectPool&) = delete;
+
+    //! Copy-assignment is forbidden.
+    SlabObjectPool& operator = (const SlabObjectPool&) = delete;
+
+    /*!
+     * \brief Move-constructor. Reserved objects stay valid, and their
+     *  Pointers release them to the new pool.
+     * \post This object has the state that \p other used to have. \p other
+     *  is empty.
+     */
+    SlabObjectPool(SlabObjectPool&& other) noexcept;
+
+    /*!
+     * \brief Move-assignment operator. Objects stored in this pool are
+     *  destroyed first.
+     * \pre No object reserved from this pool is outstanding.
+     * \post This object has the state that \p other used to have. \p other
+     *  is empty.
+     */
+    SlabObjectPool& operator = (SlabObjectPool&& other) noexcept;
+
+    /*!
+     * \brief Reserve next object from the pool.
+     * \return Pointer to the reserved object. The most recently released
+     *  object is returned first. If there is none, a new object is built into
+     *  a free slot.
+     * \pre None.
+     * \post Returned object is owned by the caller until the Pointer releases
+     *  it.
+     * \exception std::bad_alloc, if a new slab cannot be allocated. Exceptions
+     *  thrown by Builder. The pool is not modified in either case.
+     */
+    Pointer reserve();
+
+    /*!
+     * \brief Return object back to the pool. Same as object.reset().
+     * \param object Object reserved from this pool.
+     * \pre object != nullptr, and it was reserved from this pool.
+     * \post Object is stored in its current state and may be re-used by
+     *  reserve.
+     */
+    void release(Pointer&& object) noexcept;
+
+    /*!
+     * \brief Return number of idle objects stored in the pool.
+     * \pre None.
+     */
+    unsigned size() const;
+
+    /*!
+     * \brief Return number of reserved objects not released yet.
+     * \pre None.
+     */
+    std::size_t outstanding() const;
+
+    /*!
+     * \brief Return total number of slots in all slabs.
+     * \pre None.
+     */
+    std::size_t capacity() const;
+
+    /*!
+     * \brief Destroy all idle objects. Their slots stay in the pool for new
+     *  objects.
+     * \pre None.
+     * \post size() == 0.
+     */
+    void clear();
+
+    /*!
+     * \brief DEFAULT_BUILDER
+     *  This functor constructs stored objects using their default constructor.
+     *  Instantiating this functor requires \p T to be default constructible.
+     */
+    static const typename std::function<T*(void*)> DEFAULT_BUILDER;
+
+
+private:
+
+    // One slot: a link and storage for one T. The link is used both by the
+    // list of idle objects and by the list of empty slots, so idle objects
+    // stay intact.
+    struct Slot
+    {
+        Slot* next;
+        typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+    };
+
+    // Slabs and free lists. Kept on the heap, so that deleters of reserved
+    // objects stay valid when the pool is moved.
+    struct Slabs
+    {
+        std::size_t slots_per_slab;
+        std::vector<std::unique_ptr<char[]> > blocks;
+        Slot* idle;             // Constructed objects ready for reuse.
+        Slot* empty;            // Slots whose object has been destroyed.
+        Slot* fresh;            // Never used slots of the newest block.
+        Slot* fresh_end;
+        unsigned idle_count;
+        std::size_t outstanding;
+
+        explicit Slabs(std::size_t slot_count) : 
+            slots_per_slab(slot_count), blocks(), idle(nullptr), 
+            empty(nullptr), fresh(nullptr), fresh_end(nullptr), 
+            idle_count(0), outstanding(0) {}
+
+        // Returns a slot without an object. Allocates a new slab if needed.
+        Slot* emptySlot();
+
+        // Puts slot back to the list of empty slots.
+        void pushEmpty(Slot* slot) noexcept;
+
+        // Puts reserved object to the list of idle objects.
+        void release(T* object) noexcept;
+    };
+
+    Builder builder_;
+    std::size_t slots_per_slab_;
+    std::unique_ptr<Slabs> slabs_;  // Allocated on the first reserve.
+
+    static Slot* slotOf(T* object) noexcept;
+};
+
+} // Namespace PPUtils
+
+// Include template implementations.
+#include "slabobjectpool_impl.hh"
+
+#endif // SLABOBJECTPOOL_HH
@@ -0,0 +1,208 @@
+/* slabobjectpool_impl.hh
+ * This is the implementation file for the PPUtils::SlabObjectPool class
+ * template methods.
+ *
+ * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
+ * Created: 18-Oct-2026
+ */
+
+#ifndef SLABOBJECTPOOL_IMPL_HH
+#define SLABOBJECTPOOL_IMPL_HH
+
+#include <cassert>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+namespace PPUtils
+{
+
+template <class T, class Builder>
+const std::function<T*(void*)> SlabObjectPool<T,Builder>::DEFAULT_BUILDER
+    ([](void* storage){return new (storage) T();});
+
+
+template <class T, class Builder>
+void SlabObjectPool<T,Builder>::SlabDeleter::operator()(T* object) const noexcept
+{
+    assert(slabs_ != nullptr);
+    slabs_->release(object);
+}
+
+
+template <class T, class Builder>
+SlabObjectPool<T,Builder>::SlabObjectPool(const Builder& builder,
+                                          std::size_t slab_bytes) :
+    builder_(builder),
+    slots_per_slab_(std::max<std::size_t>(1, slab_bytes / sizeof(Slot))),
+    slabs_()
+{
+}
+
+
+template <class T, class Builder>
+SlabObjectPool<T,Builder>::~SlabObjectPool()
+{
+    assert(outstanding() == 0);
+    clear();
+}
+
+
+template <class T, class Builder>
+SlabObjectPool<T,Builder>::SlabObjectPool(SlabObjectPool&& other) noexcept :
+    builder_(std::move(other.builder_)),
+    slots_per_slab_(other.slots_per_slab_),
+    slabs_(std::move(other.slabs_))
+{
+}
+
+
+template <class T, class Builder>
+SlabObjectPool<T,Builder>&
+SlabObjectPool<T,Builder>::operator = (SlabObjectPool&& other) noexcept
+{
+    if (&other != this){
+        assert(outstanding() == 0);
+        clear();
+        builder_ = std::move(other.builder_);
+        slots_per_slab_ = other.slots_per_slab_;
+        slabs_ = std::move(other.slabs_);
+    }
+    return *this;
+}
+
+
+template <class T, class Builder>
+typename SlabObjectPool<T,Builder>::Pointer SlabObjectPool<T,Builder>::reserve()
+{
+    if (slabs_ == nullptr){
+        slabs_.reset(new Slabs(slots_per_slab_));
+    }
+    Slabs& slabs = *slabs_;
+    if (slabs.idle != nullptr){
+        Slot* slot = slabs.idle;
+        slabs.idle = slot->next;
+        --slabs.idle_count;
+        ++slabs.outstanding;
+        return Pointer(reinterpret_cast<T*>(&slot->storage), SlabDeleter(&slabs));
+    }
+
+    Slot* slot = slabs.emptySlot();
+    T* object = nullptr;
+    try {
+        object = builder_(static_cast<void*>(&slot->storage));
+    }
+    catch (...){
+        slabs.pushEmpty(slot);
+        throw;
+    }
+    assert(static_cast<void*>(object) == static_cast<void*>(&slot->storage));
+    ++slabs.outstanding;
+    return Pointer(object, SlabDeleter(&slabs));
+}
+
+
+template <class T, class Builder>
+void SlabObjectPool<T,Builder>::release(Pointer&& object) noexcept
+{
+    assert(object != nullptr);
+    assert(object.get_deleter().slabs_ == slabs_.get());
+    object.reset();
+}
+
+
+template <class T, class Builder>
+unsigned SlabObjectPool<T,Builder>::size() const
+{
+    return slabs_ != nullptr ? slabs_->idle_count : 0;
+}
+
+
+template <class T, class Builder>
+std::size_t SlabObjectPool<T,Builder>::outstanding() const
+{
+    return slabs_ != nullptr ? slabs_->outstanding : 0;
+}
+
+
+template <class T, class Builder>
+std::size_t SlabObjectPool<T,Builder>::capacity() const
+{
+    return slabs_ != nullptr ? slabs_->blocks.size() * slots_per_slab_ : 0;
+}
+
+
+template <class T, class Builder>
+void SlabObjectPool<T,Builder>::clear()
+{
+    if (slabs_ == nullptr){
+        return;
+    }
+    Slabs& slabs = *slabs_;
+    while (slabs.idle != nullptr){
+        Slot* slot = slabs.idle;
+        slabs.idle = slot->next;
+        reinterpret_cast<T*>(&slot->storage)->~T();
+        slabs.pushEmpty(slot);
+    }
+    slabs.idle_count = 0;
+}
+
+
+template <class T, class Builder>
+typename SlabObjectPool<T,Builder>::Slot* SlabObjectPool<T,Builder>::Slabs::emptySlot()
+{
+    if (empty != nullptr){
+        Slot* slot = empty;
+        empty = slot->next;
+        return slot;
+    }
+    if (fresh == fresh_end){
+        // Over-allocate to align the first slot to SLAB_ALIGNMENT, or more if
+        // T needs it.
+        const std::size_t align = std::max<std::size_t>(SLAB_ALIGNMENT,
+                                                        std::alignment_of<Slot>::value);
+        std::unique_ptr<char[]> slab(new char[slots_per_slab * sizeof(Slot) + align]);
+        const std::uintptr_t raw = reinterpret_cast<std::uintptr_t>(slab.get());
+        const std::uintptr_t aligned = (raw + align - 1) / align * align;
+        blocks.push_back(std::move(slab));
+        fresh = reinterpret_cast<Slot*>(aligned);
+        fresh_end = fresh + slots_per_slab;
+    }
+    return fresh++;
+}
+
+
+template <class T, class Builder>
+void SlabObjectPool<T,Builder>::Slabs::pushEmpty(Slot* slot) noexcept
+{
+    slot->next = empty;
+    empty = slot;
+}
+
+
+template <class T, class Builder>
+void SlabObjectPool<T,Builder>::Slabs::release(T* object) noexcept
+{
+    assert(object != nullptr);
+    assert(outstanding > 0);
+    Slot* slot = slotOf(object);
+    slot->next = idle;
+    idle = slot;
+    ++idle_count;
+    --outstanding;
+}
+
+
+template <class T, class Builder>
+typename SlabObjectPool<T,Builder>::Slot*
+SlabObjectPool<T,Builder>::slotOf(T* object) noexcept
+{
+    return reinterpret_cast<Slot*>(reinterpret_cast<char*>(object) -
+                                   offsetof(Slot, storage));
+}
+
+} // Namespace PPUtils
+
+#endif // SLABOBJECTPOOL_IMPL_HH
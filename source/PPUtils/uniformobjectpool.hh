@@ -13,10 +13,21 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <chrono>
+#include <exception>
+#include "pooledptr.hh"
+#include "resetpolicy.hh"
+#include "poolstatistics.hh"
 
 namespace PPUtils
 {
 
+/*!
+ * \brief Maximum idle count of a UniformObjectPool that has no limit.
+ */
+const unsigned POOL_UNLIMITED_IDLE = static_cast<unsigned>(-1);
+
+
 /*!
  * \brief The UniformObjectPool class
  *  This is a generic object pool. It may be used for storing complex objects
@@ -34,14 +45,31 @@ namespace PPUtils
  *  one thread. If you need to access object pool from multiple threads, use
  *  ConcurrentUniformObjectPool instead.
  *  
+ *  By default the pool keeps every released object. The number of idle
+ *  objects can be limited with setMaxIdle, and objects idle for too long can
+ *  be destroyed with setMaxIdleTime. Idle time is checked lazily when objects
+ *  are reserved or released, or when evictIdle is called (see PoolEvictor).
+ *  Most recently released objects are reused first, so the objects destroyed
+ *  by limits are always the ones idle for longest.
+ *  
+ *  Released objects can be reset by the pool: the ResetPolicy chooses whether
+ *  they are reset in release, in the next reserve, or in the background by
+ *  resetDirty, which keeps reset cost away from both. A validator set with
+ *  setValidator checks idle objects in reserve; objects it rejects (e.g.
+ *  broken connections) are destroyed and the next one is tried.
+ *  
  *  Type arguments:
  *   \p T: Type of stored objects.
  *  
  *   \p Builder: A functor class that is used to construct new objects when 
  *  needed. Builder must provide a function operator taking no arguments and 
  *  returning a dynamically allocated T-object.
+ *  
+ *   \p ResetPolicy: NoReset (default), or a PoolReset such as EagerReset,
+ *  LazyReset or BackgroundReset.
  */
-template <class T, class Builder = typename std::function<T*()> >
+template <class T, class Builder = typename std::function<T*()>,
+          class ResetPolicy = NoReset>
 class UniformObjectPool
 {
 public:
@@ -50,17 +78,25 @@ public:
      * \brief Constructor
      * \param builder Builder object that will be used to construct new objects.
      *  Ownership of builder is passed to this object.
+     * \param initial_size Number of objects built into the pool right away.
+     * \param reset_policy Policy used to reset released objects.
      * \pre builder != nullptr.
      */
-    explicit UniformObjectPool(Builder* builder);
+    explicit UniformObjectPool(Builder* builder, unsigned initial_size = 0,
+                               const ResetPolicy& reset_policy = ResetPolicy());
     
     /*!
      * \brief Constructor
      * \param builder Builder object that will be used to construct new objects.
      *  This object uses a copy of builder to do so (Builder must be 
      *  copy-constructible).
+     * \param initial_size Number of objects built into the pool right away.
+     *  Use prewarm instead to build them in parallel or to measure the time.
+     * \param reset_policy Policy used to reset released objects.
      */
-    explicit UniformObjectPool(const Builder& builder = DEFAULT_BUILDER);
+    explicit UniformObjectPool(const Builder& builder = DEFAULT_BUILDER,
+                               unsigned initial_size = 0,
+                               const ResetPolicy& reset_policy = ResetPolicy());
     
     /*!
      * \brief Destructor destroys the pool and all its currently stored objects.
@@ -99,23 +135,51 @@ public:
     /*!
      * \brief Reserve next object from pool.
      * \return Unique pointer to reserved object. Returned object may be re-used
-     *  or constructed using Builder.
+     *  or constructed using Builder. Re-used objects have been reset and
+     *  accepted by the validator.
      * \pre None.
      */
     virtual typename std::unique_ptr<T> reserve();
     
+    /*!
+     * \brief Reserve next object from pool as a PooledPtr, that releases the
+     *  object back to this pool when it is destroyed.
+     * \return PooledPtr to reserved object. Object is reserved with reserve().
+     * \pre None.
+     * \post If this pool is destroyed before the PooledPtr, the object is
+     *  destroyed by the PooledPtr.
+     */
+    PooledPtr<T> acquire();
+    
     /*!
      * \brief Return object (back) to the pool.
      * \param object Object returned to the pool. Object may be reserved from
      *  the pool earlier or constructed other way.
      * \pre object != nullptr.
      * \post Object is stored in the pool and may be re-used calling the reserve
-     *  method. Object is stored in its current state.
+     *  method. Object is reset now, if the ResetPolicy is RESET_ON_RELEASE.
+     *  Otherwise it is stored in its current state.
      */
     virtual void release(typename std::unique_ptr<T>&& object);
     
     /*!
-     * \brief Return number of objects currently stored in the pool.
+     * \brief Build new objects into the pool before they are needed, so that
+     *  first reserves do not have to wait for the Builder.
+     * \param n Number of objects to build. Only as many are built as fit
+     *  under maxIdle().
+     * \param threads Number of threads building the objects. If greater than
+     *  one, the Builder is called concurrently.
+     * \return Time spent prewarming.
+     * \pre threads > 0. If threads > 1, Builder is thread safe.
+     * \post Built objects are stored in the pool. If the Builder throws,
+     *  objects built so far are stored and the first exception is rethrown.
+     */
+    virtual std::chrono::steady_clock::duration prewarm(unsigned n,
+                                                        unsigned threads = 1);
+    
+    /*!
+     * \brief Return number of objects currently stored in the pool, including
+     *  objects waiting for a background reset.
      * \pre None.
      */
     virtual unsigned size() const final;
@@ -128,8 +192,95 @@ public:
      */
     virtual void clear();
     
+    /*!
+     * \brief Set maximum number of idle objects stored in the pool.
+     * \param max_idle New limit. POOL_UNLIMITED_IDLE removes the limit.
+     * \pre None.
+     * \post Objects idle for longest are destroyed until size() <= max_idle.
+     *  From now on, objects released to a full pool are destroyed instead of
+     *  stored.
+     */
+    virtual void setMaxIdle(unsigned max_idle);
     
-protected:
+    /*!
+     * \brief Return maximum number of idle objects. POOL_UNLIMITED_IDLE by
+     *  default.
+     * \pre None.
+     */
+    unsigned maxIdle() const;
+    
+    /*!
+     * \brief Destroy idle objects until at most \p target_size remain.
+     * \param target_size Number of objects left in the pool.
+     * \pre None.
+     * \post size() <= target_size. Objects idle for longest are destroyed
+     *  first. Limits of the pool are not changed.
+     */
+    virtual void trim(unsigned target_size);
+    
+    /*!
+     * \brief Set maximum time an object may stay idle in the pool.
+     * \param max_idle_time Time limit. Zero (default) disables the limit.
+     * \pre max_idle_time >= 0.
+     * \post Objects idle longer than max_idle_time are destroyed on the next
+     *  reserve, release or evictIdle call. Objects already in the pool are
+     *  considered released now.
+     */
+    virtual void setMaxIdleTime(std::chrono::steady_clock::duration max_idle_time);
+    
+    /*!
+     * \brief Return maximum idle time. Zero, if there is no limit.
+     * \pre None.
+     */
+    std::chrono::steady_clock::duration maxIdleTime() const;
+    
+    /*!
+     * \brief Destroy objects idle longer than maxIdleTime().
+     * \return Number of destroyed objects.
+     * \pre None.
+     * \post No stored object has been idle longer than maxIdleTime(). Does
+     *  nothing if there is no time limit.
+     */
+    virtual unsigned evictIdle();
+    
+    /*!
+     * \brief Reset objects waiting for a background reset, so that they can
+     *  be reserved without resetting them first. Call this periodically from
+     *  a cleaner thread (see PoolCleaner) or when the pool is not busy.
+     * \return Number of objects reset. Always 0, unless the ResetPolicy is
+     *  RESET_IN_BACKGROUND.
+     * \pre None.
+     * \post Objects rejected by the validator are destroyed.
+     */
+    virtual unsigned resetDirty();
+    
+    /*!
+     * \brief Set a hook validating idle objects before they are reused.
+     * \param validator Returns false, if the object must be discarded. Empty
+     *  function (default) accepts all objects.
+     * \pre Not called while other threads use the pool. For concurrent pools,
+     *  validator may be called from several threads at once.
+     * \post reserve destroys idle objects rejected by validator, and tries the
+     *  next one. Newly built objects are not validated.
+     */
+    void setValidator(const std::function<bool(T&)>& validator);
+    
+    /*!
+     * \brief Start or stop collecting statistics. Statistics are not collected
+     *  by default.
+     * \param enable If false, collected statistics are dropped.
+     * \pre Not called while other threads use the pool.
+     * \post If \p enable, statistics start from zero.
+     */
+    void enableStatistics(bool enable = true);
+    
+    /*!
+     * \brief Return hit/miss and occupancy statistics of the pool.
+     * \return Snapshot of the statistics. All zero, if statistics are not
+     *  enabled.
+     * \pre None.
+     */
+    virtual PoolStatistics statistics() const;
     
     /*!
      * \brief DEFAULT_BUILDER
@@ -138,17 +289,132 @@ protected:
      */
     static const typename std::function<T*()> DEFAULT_BUILDER;
     
+    
+protected:
+    
     /*!
      * \brief Returns pointer to the Builder object.
      * \pre None.
      */
     Builder* getBuilder() const;
     
+    /*!
+     * \brief Create the link to PooledPtrs of this pool now, locked if
+     *  \p concurrent. Otherwise the link is created unlocked by the first
+     *  acquire. Concurrent subclasses call this in their constructor.
+     */
+    void makeLink(bool concurrent);
+    
+    /*!
+     * \brief Detach PooledPtrs from this pool: they destroy their objects
+     *  from now on. Subclasses call this first in their destructor, before
+     *  their release is gone.
+     */
+    void detachLink();
+    
+    /*!
+     * \brief Build \p n objects with \p threads threads for prewarm.
+     * \param objects Built objects are appended here, also if the Builder
+     *  throws.
+     * \return First exception thrown by the Builder, or nullptr.
+     */
+    std::exception_ptr buildObjects(unsigned n, unsigned threads,
+                                    std::vector<std::unique_ptr<T> >& objects);
+    
+    /*!
+     * \brief Take the next idle object out of the pool. Evicts expired
+     *  objects first.
+     * \param object The object is moved here.
+     * \param dirty Set true, if the object must be reset before it is used.
+     * \return False, if the pool is empty.
+     */
+    bool takeIdle(std::unique_ptr<T>& object, bool& dirty);
+    
+    /*!
+     * \brief Store an idle object, or destroy it if the pool is full.
+     * \param dirty True, if the object has not been reset.
+     */
+    void storeIdle(std::unique_ptr<T>&& object, bool dirty);
+    
+    /*!
+     * \brief Move all objects waiting for a background reset to \p objects.
+     */
+    void takeDirty(std::vector<std::unique_ptr<T> >& objects);
+    
+    /*!
+     * \brief Prepare an object taken with takeIdle for use: reset it if
+     *  \p dirty and validate it. Does not touch the pool's containers.
+     * \return False, if the validator rejected the object.
+     */
+    bool prepareReserved(T& object, bool dirty);
+    
+    /*!
+     * \brief Prepare a released object for storing: reset it if the
+     *  ResetPolicy is RESET_ON_RELEASE. Does not touch the pool's containers.
+     * \return Value of \p dirty for storeIdle.
+     */
+    bool prepareReleased(T& object);
+    
+    /*!
+     * \brief Build a new object, timing the Builder if statistics are
+     *  enabled. Does not touch the pool's containers.
+     */
+    std::unique_ptr<T> buildObject();
+    
+    /*!
+     * \brief Count a reserve served from the pool (\p hit) or by the Builder
+     *  in statistics. Does not touch the pool's containers.
+     */
+    void countReserve(bool hit);
+    
+    /*!
+     * \brief Count a release in statistics. Does not touch the pool's
+     *  containers.
+     */
+    void countRelease();
+    
+    /*!
+     * \brief Add \p delta to the number of outstanding objects in statistics.
+     *  Concurrent subclasses call this while holding their lock.
+     */
+    void countOutstanding(int delta);
+    
     
 private:
     
-    typename std::vector<std::unique_ptr<T> > objects_;
+    // Idle object and the time it was released. Times are recorded only if
+    // there is an idle time limit.
+    struct IdleObject
+    {
+        std::unique_ptr<T> object;
+        std::chrono::steady_clock::time_point released;
+        bool dirty;     // Not reset since release.
+    };
+    
+    // Oldest first, reserved from the back. Objects waiting for a background
+    // reset are kept apart in dirty_, which is used only if nothing in
+    // objects_ is left.
+    typename std::vector<IdleObject> objects_;
+    typename std::vector<IdleObject> dirty_;
     std::unique_ptr<Builder> builder_;
+    std::shared_ptr<detail::PoolLink<T> > link_;
+    unsigned max_idle_;
+    std::chrono::steady_clock::duration max_idle_time_;
+    ResetPolicy reset_policy_;
+    std::function<bool(T&)> validator_;
+    std::unique_ptr<detail::PoolCounters> stats_;   // nullptr if disabled.
+    
+    // Destroys objects released before now - max_idle_time_.
+    unsigned evictExpired(std::chrono::steady_clock::time_point now);
+    
+    // Destroys objects of list released before limit.
+    static unsigned evictBefore(std::vector<IdleObject>& list,
+                                std::chrono::steady_clock::time_point limit);
+    
+    // Destroys the oldest objects of list, until at most count are left.
+    static void trimList(std::vector<IdleObject>& list, std::size_t count);
+    
+    static void recycle(void* pool, std::unique_ptr<T>&& object);
 };
 
 } // Namespace PPUtils
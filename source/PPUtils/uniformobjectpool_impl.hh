@@ -1,7 +1,7 @@
 /* uniformobjectpool_impl.hh
  * This is the implementation file for the PPUtils::UniforObjectPool class
  * template methods.
- * 
+ *
  * Author: Perttu Paarlahti     perttu.paarlahti@gmail.com
  * Created: 29-June-2015
  */
@@ -10,94 +10,511 @@
 #define UNIFORMOBJECTPOOL_IMPL_HH
 
 #include <cassert>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+#include <system_error>
 
-namespace PPUtils 
+namespace PPUtils
 {
 
-template<class T, class Builder>
-const std::function<T*()> UniformObjectPool<T,Builder>::DEFAULT_BUILDER ([](){return new T();});
+template<class T, class Builder, class ResetPolicy>
+const std::function<T*()> UniformObjectPool<T,Builder,ResetPolicy>::DEFAULT_BUILDER ([](){return new T();});
 
-template <class T, class Builder>
-UniformObjectPool<T, Builder>::UniformObjectPool(Builder* builder) :
-    objects_(), builder_(builder)
+template <class T, class Builder, class ResetPolicy>
+UniformObjectPool<T, Builder, ResetPolicy>::
+UniformObjectPool(Builder* builder, unsigned initial_size,
+                  const ResetPolicy& reset_policy) :
+    objects_(), dirty_(), builder_(builder), link_(),
+    max_idle_(POOL_UNLIMITED_IDLE),
+    max_idle_time_(std::chrono::steady_clock::duration::zero()),
+    reset_policy_(reset_policy), validator_(), stats_()
 {
     assert(builder_ != nullptr);
+    UniformObjectPool::prewarm(initial_size);
 }
 
 
-template <class T, class Builder>
-UniformObjectPool<T, Builder>::UniformObjectPool(const Builder& builder) :
-    objects_(), builder_(new Builder(builder))
+template <class T, class Builder, class ResetPolicy>
+UniformObjectPool<T, Builder, ResetPolicy>::
+UniformObjectPool(const Builder& builder, unsigned initial_size,
+                  const ResetPolicy& reset_policy) :
+    objects_(), dirty_(), builder_(new Builder(builder)), link_(),
+    max_idle_(POOL_UNLIMITED_IDLE),
+    max_idle_time_(std::chrono::steady_clock::duration::zero()),
+    reset_policy_(reset_policy), validator_(), stats_()
 {
+    UniformObjectPool::prewarm(initial_size);
 }
 
 
-template <class T, class Builder>
-UniformObjectPool<T, Builder>::~UniformObjectPool()
+template <class T, class Builder, class ResetPolicy>
+UniformObjectPool<T, Builder, ResetPolicy>::~UniformObjectPool()
 {
+    detachLink();
 }
 
 
-UniformObjectPool::UniformObjectPool(UniformObjectPool&& other) noexcept
+template <class T, class Builder, class ResetPolicy>
+UniformObjectPool<T, Builder, ResetPolicy>::
+UniformObjectPool(UniformObjectPool&& other) noexcept :
+    objects_(), dirty_(), builder_(), link_(), max_idle_(other.max_idle_),
+    max_idle_time_(other.max_idle_time_),
+    reset_policy_(std::move(other.reset_policy_)), validator_(), stats_()
 {
     std::swap(this->objects_, other.objects_);
+    std::swap(this->dirty_, other.dirty_);
     std::swap(this->builder_, other.builder_);
+    std::swap(this->link_, other.link_);
+    std::swap(this->validator_, other.validator_);
+    std::swap(this->stats_, other.stats_);
+    if (link_ != nullptr){
+        link_->moveTo(this);
+    }
 }
 
 
-UniformObjectPool& UniformObjectPool::operator =(UniformObjectPool& other) noexcept
+template <class T, class Builder, class ResetPolicy>
+UniformObjectPool<T, Builder, ResetPolicy>&
+UniformObjectPool<T, Builder, ResetPolicy>::operator =(UniformObjectPool&& other) noexcept
 {
     if (&other != this){
         std::swap(this->objects_, other.objects_);
+        std::swap(this->dirty_, other.dirty_);
         std::swap(this->builder_, other.builder_);
+        std::swap(this->link_, other.link_);
+        std::swap(this->max_idle_, other.max_idle_);
+        std::swap(this->max_idle_time_, other.max_idle_time_);
+        std::swap(this->reset_policy_, other.reset_policy_);
+        std::swap(this->validator_, other.validator_);
+        std::swap(this->stats_, other.stats_);
+        if (link_ != nullptr){
+            link_->moveTo(this);
+        }
+        if (other.link_ != nullptr){
+            other.link_->moveTo(&other);
+        }
     }
     return *this;
 }
 
 
-template <class T, class Builder>
-std::unique_ptr<T> UniformObjectPool<T, Builder>::reserve()
+template <class T, class Builder, class ResetPolicy>
+std::unique_ptr<T> UniformObjectPool<T, Builder, ResetPolicy>::reserve()
 {
     typename std::unique_ptr<T> rv(nullptr);
-    if (!objects_.empty()){
-        rv.swap(objects_.back());
-        objects_.pop_back();
-    }
-    else {
-        rv.reset( builder_->operator()() );
+    bool dirty = false;
+    while (takeIdle(rv, dirty)){
+        if (prepareReserved(*rv, dirty)){
+            countReserve(true);
+            countOutstanding(1);
+            return rv;
+        }
+        // Rejected by the validator.
+        rv.reset();
     }
+    rv = buildObject();
+    countReserve(false);
+    countOutstanding(1);
     return rv;
 }
 
 
-template <class T, class Builder>
-void UniformObjectPool<T, Builder>::release(std::unique_ptr<T>&& object)
+template <class T, class Builder, class ResetPolicy>
+PooledPtr<T> UniformObjectPool<T, Builder, ResetPolicy>::acquire()
+{
+    if (link_ == nullptr){
+        makeLink(false);
+    }
+    return PooledPtr<T>(reserve(), link_);
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T, Builder, ResetPolicy>::release(std::unique_ptr<T>&& object)
 {
     assert(object != nullptr);
-    objects_.push_back( std::move(object) );
+    const bool dirty = prepareReleased(*object);
+    countRelease();
+    countOutstanding(-1);
+    storeIdle(std::move(object), dirty);
 }
 
 
-template <class T, class Builder>
-unsigned UniformObjectPool<T, Builder>::size() const
+template <class T, class Builder, class ResetPolicy>
+std::chrono::steady_clock::duration
+UniformObjectPool<T, Builder, ResetPolicy>::prewarm(unsigned n, unsigned threads)
 {
-    return objects_.size();
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    const unsigned room = max_idle_ - std::min(max_idle_, size());
+    n = std::min(n, room);
+    std::vector<std::unique_ptr<T> > built;
+    std::exception_ptr error = buildObjects(n, threads, built);
+    for (std::unique_ptr<T>& object : built){
+        storeIdle(std::move(object), false);
+    }
+    if (error != nullptr){
+        std::rethrow_exception(error);
+    }
+    return std::chrono::steady_clock::now() - start;
 }
 
 
-template <class T, class Builder>
-void UniformObjectPool<T, Builder>::clear()
+template <class T, class Builder, class ResetPolicy>
+unsigned UniformObjectPool<T, Builder, ResetPolicy>::size() const
+{
+    return objects_.size() + dirty_.size();
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T, Builder, ResetPolicy>::clear()
 {
     objects_.clear();
+    dirty_.clear();
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T, Builder, ResetPolicy>::setMaxIdle(unsigned max_idle)
+{
+    max_idle_ = max_idle;
+    UniformObjectPool::trim(max_idle);
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+unsigned UniformObjectPool<T, Builder, ResetPolicy>::maxIdle() const
+{
+    return max_idle_;
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T, Builder, ResetPolicy>::trim(unsigned target_size)
+{
+    // Objects still waiting for a reset go first.
+    trimList(dirty_, target_size - std::min<std::size_t>(target_size, objects_.size()));
+    trimList(objects_, target_size - dirty_.size());
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T, Builder, ResetPolicy>::
+setMaxIdleTime(std::chrono::steady_clock::duration max_idle_time)
+{
+    assert(max_idle_time >= std::chrono::steady_clock::duration::zero());
+    if (max_idle_time_ == std::chrono::steady_clock::duration::zero()){
+        // Release times were not recorded.
+        const std::chrono::steady_clock::time_point now =
+                std::chrono::steady_clock::now();
+        for (IdleObject& idle : objects_){
+            idle.released = now;
+        }
+        for (IdleObject& idle : dirty_){
+            idle.released = now;
+        }
+    }
+    max_idle_time_ = max_idle_time;
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+std::chrono::steady_clock::duration
+UniformObjectPool<T, Builder, ResetPolicy>::maxIdleTime() const
+{
+    return max_idle_time_;
 }
 
 
-template <class T, class Builder>
-Builder* UniformObjectPool<T,Builder>::getBuilder() const
+template <class T, class Builder, class ResetPolicy>
+unsigned UniformObjectPool<T, Builder, ResetPolicy>::evictIdle()
+{
+    if (max_idle_time_ == std::chrono::steady_clock::duration::zero()){
+        return 0;
+    }
+    return evictExpired(std::chrono::steady_clock::now());
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+unsigned UniformObjectPool<T, Builder, ResetPolicy>::resetDirty()
+{
+    std::vector<std::unique_ptr<T> > objects;
+    takeDirty(objects);
+    for (std::unique_ptr<T>& object : objects){
+        if (prepareReserved(*object, true)){
+            storeIdle(std::move(object), false);
+        }
+        object.reset();
+    }
+    return objects.size();
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T, Builder, ResetPolicy>::
+setValidator(const std::function<bool(T&)>& validator)
+{
+    validator_ = validator;
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T, Builder, ResetPolicy>::enableStatistics(bool enable)
+{
+    stats_.reset(enable ? new detail::PoolCounters() : nullptr);
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+PoolStatistics UniformObjectPool<T, Builder, ResetPolicy>::statistics() const
+{
+    if (stats_ == nullptr){
+        return PoolStatistics();
+    }
+    return stats_->snapshot(size());
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+Builder* UniformObjectPool<T,Builder,ResetPolicy>::getBuilder() const
 {
     return builder_.get();
 }
 
+
+template <class T, class Builder, class ResetPolicy>
+std::exception_ptr UniformObjectPool<T,Builder,ResetPolicy>::
+buildObjects(unsigned n, unsigned threads, std::vector<std::unique_ptr<T> >& objects)
+{
+    assert(threads > 0);
+    threads = std::max(1u, std::min(threads, n));
+    // Thread i builds objects [n*i/threads, n*(i+1)/threads).
+    std::vector<std::vector<std::unique_ptr<T> > > parts(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    auto build = [this, n, threads, &parts, &errors](unsigned i)
+    {
+        const unsigned count = unsigned(std::uint64_t(n) * (i + 1) / threads -
+                                        std::uint64_t(n) * i / threads);
+        try {
+            parts[i].reserve(count);
+            for (unsigned k = 0; k < count; ++k){
+                parts[i].push_back(buildObject());
+            }
+        }
+        catch (...){
+            errors[i] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (unsigned i = 1; i < threads; ++i){
+        try {
+            helpers.push_back(std::thread(build, i));
+        }
+        catch (const std::system_error&){
+            // No more threads: build this part here.
+            build(i);
+        }
+    }
+    build(0);
+    for (std::thread& helper : helpers){
+        helper.join();
+    }
+
+    std::exception_ptr error;
+    for (unsigned i = 0; i < threads; ++i){
+        for (std::unique_ptr<T>& object : parts[i]){
+            objects.push_back(std::move(object));
+        }
+        if (error == nullptr){
+            error = errors[i];
+        }
+    }
+    return error;
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+bool UniformObjectPool<T,Builder,ResetPolicy>::
+takeIdle(std::unique_ptr<T>& object, bool& dirty)
+{
+    if (max_idle_time_ != std::chrono::steady_clock::duration::zero()){
+        evictExpired(std::chrono::steady_clock::now());
+    }
+    if (!objects_.empty()){
+        object.swap(objects_.back().object);
+        dirty = objects_.back().dirty;
+        objects_.pop_back();
+        return true;
+    }
+    if (!dirty_.empty()){
+        // Background reset has not caught up: reset this one in reserve.
+        object.swap(dirty_.back().object);
+        dirty_.pop_back();
+        dirty = true;
+        return true;
+    }
+    return false;
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T,Builder,ResetPolicy>::
+storeIdle(std::unique_ptr<T>&& object, bool dirty)
+{
+    IdleObject idle {std::move(object), std::chrono::steady_clock::time_point(), dirty};
+    if (max_idle_time_ != std::chrono::steady_clock::duration::zero()){
+        idle.released = std::chrono::steady_clock::now();
+        evictExpired(idle.released);
+    }
+    if (size() < max_idle_){
+        if (dirty && ResetPolicy::TIMING == RESET_IN_BACKGROUND){
+            dirty_.push_back( std::move(idle) );
+        }
+        else {
+            objects_.push_back( std::move(idle) );
+        }
+        if (stats_ != nullptr){
+            stats_->idle(size());
+        }
+    }
+    // Else the pool is full: object is destroyed here.
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T,Builder,ResetPolicy>::
+takeDirty(std::vector<std::unique_ptr<T> >& objects)
+{
+    for (IdleObject& idle : dirty_){
+        objects.push_back(std::move(idle.object));
+    }
+    dirty_.clear();
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+bool UniformObjectPool<T,Builder,ResetPolicy>::prepareReserved(T& object, bool dirty)
+{
+    if (dirty){
+        reset_policy_(object);
+    }
+    return !validator_ || validator_(object);
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+bool UniformObjectPool<T,Builder,ResetPolicy>::prepareReleased(T& object)
+{
+    if (ResetPolicy::TIMING == RESET_ON_RELEASE){
+        reset_policy_(object);
+        return false;
+    }
+    return ResetPolicy::TIMING != RESET_NEVER;
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+std::unique_ptr<T> UniformObjectPool<T,Builder,ResetPolicy>::buildObject()
+{
+    if (stats_ == nullptr){
+        return std::unique_ptr<T>(builder_->operator()());
+    }
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    std::unique_ptr<T> object(builder_->operator()());
+    stats_->built(std::chrono::steady_clock::now() - start);
+    return object;
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T,Builder,ResetPolicy>::countReserve(bool hit)
+{
+    if (stats_ != nullptr){
+        stats_->reserved(hit);
+    }
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T,Builder,ResetPolicy>::countRelease()
+{
+    if (stats_ != nullptr){
+        stats_->released();
+    }
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T,Builder,ResetPolicy>::countOutstanding(int delta)
+{
+    if (stats_ != nullptr){
+        stats_->outstanding(delta);
+    }
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T,Builder,ResetPolicy>::makeLink(bool concurrent)
+{
+    link_ = std::make_shared<detail::PoolLink<T> >(this, &recycle, concurrent);
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T,Builder,ResetPolicy>::detachLink()
+{
+    if (link_ != nullptr){
+        link_->moveTo(nullptr);
+    }
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+unsigned UniformObjectPool<T,Builder,ResetPolicy>::
+evictExpired(std::chrono::steady_clock::time_point now)
+{
+    const std::chrono::steady_clock::time_point limit = now - max_idle_time_;
+    return evictBefore(dirty_, limit) + evictBefore(objects_, limit);
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+unsigned UniformObjectPool<T,Builder,ResetPolicy>::
+evictBefore(std::vector<IdleObject>& list, std::chrono::steady_clock::time_point limit)
+{
+    // Release times grow from front to back.
+    auto first_kept = std::find_if(list.begin(), list.end(),
+                                   [&limit](const IdleObject& idle)
+                                   {return idle.released >= limit;});
+    const unsigned evicted = first_kept - list.begin();
+    list.erase(list.begin(), first_kept);
+    return evicted;
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T,Builder,ResetPolicy>::
+trimList(std::vector<IdleObject>& list, std::size_t count)
+{
+    if (list.size() > count){
+        list.erase(list.begin(), list.begin() + (list.size() - count));
+    }
+}
+
+
+template <class T, class Builder, class ResetPolicy>
+void UniformObjectPool<T,Builder,ResetPolicy>::
+recycle(void* pool, std::unique_ptr<T>&& object)
+{
+    // Virtual call: concurrent subclasses lock their mutex.
+    static_cast<UniformObjectPool*>(pool)->release(std::move(object));
+}
+
 } // Namespace PPUtils
 
 
@@ -15,8 +15,12 @@ CONFIG   -= app_bundle
 TEMPLATE = app
 
 
-SOURCES += tst_algotest.cc
-HEADERS += ../../source/PPUtils/algo.hh
+SOURCES += tst_algotest.cc \
+           ../../source/PPUtils/parallel.cc
+HEADERS += ../../source/PPUtils/algo.hh \
+    ../../source/PPUtils/algo_impl.hh \
+    ../../source/PPUtils/parallel.hh \
+    ../../source/PPUtils/parallel_impl.hh
 
 DEFINES += SRCDIR=\\\"$$PWD/\\\"
 
@@ -1,19 +1,57 @@
 #include <QString>
 #include <QtTest>
 #include <forward_list>
+#include <list>
+#include <numeric>
+#include <iterator>
 #include <vector>
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <deque>
+#include <random>
+#include <limits>
+#include <cstdint>
+#include <string>
+#include <array>
+#include <cmath>
 
 #include "algo.hh"
 
 using IntPtr = std::unique_ptr<int>;
 using IntPtrRef = const std::unique_ptr<int>&;
 Q_DECLARE_METATYPE(std::forward_list<int>)
+Q_DECLARE_METATYPE(std::vector<int>)
 Q_DECLARE_METATYPE(std::function<bool(int,int)>)
 Q_DECLARE_METATYPE(std::function<bool(IntPtrRef,IntPtrRef)>)
 
+// Value that counts its copies.
+struct CopyCounted
+{
+    static int copies;
+    int value;
+    explicit CopyCounted(int v = 0) : value(v) {}
+    CopyCounted(const CopyCounted& o) : value(o.value) {++copies;}
+    CopyCounted(CopyCounted&& o) : value(o.value) {}
+    CopyCounted& operator=(const CopyCounted& o) {value = o.value; ++copies; return *this;}
+    CopyCounted& operator=(CopyCounted&& o) {value = o.value; return *this;}
+    bool operator<(const CopyCounted& o) const {return value < o.value;}
+};
+
+int CopyCounted::copies = 0;
+
+
+// Returns true, if radixSort sorts v to the same order as std::sort.
+template <class T>
+bool radixSortsLikeStdSort(std::vector<T> v, unsigned threads)
+{
+    std::vector<T> expected(v);
+    std::sort(expected.begin(), expected.end());
+    PPUtils::radixSort(v.begin(), v.end(), PPUtils::IdentityKey(), threads);
+    return v == expected;
+}
+
+
 class AlgoTest : public QObject
 {
     Q_OBJECT
@@ -32,6 +70,88 @@ private Q_SLOTS:
     // and std::vector.
     void mergeSortTest_not_copyable();
     void mergeSortTest_not_copyable_data();
+    
+    // Test that mergeSort keeps equal elements in their original order with
+    // range widths around the insertion sort threshold. Both the bottom-up
+    // (std::vector) and the top-down (std::forward_list) versions are tested.
+    void mergeSortTest_stable();
+    void mergeSortTest_stable_data();
+    
+    // Test that mergeSort sorts stably when the memory budget is too small
+    // for the auxiliary buffer: with no buffer (rotation merge), a buffer of
+    // sqrt(N) elements (block merge) and a buffer one element too small.
+    void mergeSortTest_memoryBudget();
+    void mergeSortTest_memoryBudget_data();
+    
+    // Test insertionSort with a short range.
+    void insertionSortTest();
+    
+    // Test that parallelMergeSort gives the same stable result as 
+    // std::stable_sort with different thread counts.
+    void parallelMergeSortTest();
+    void parallelMergeSortTest_data();
+    
+    // Test that adaptiveMergeSort gives the same stable result as 
+    // std::stable_sort with sorted, reversed, sawtooth and random input.
+    void adaptiveMergeSortTest();
+    void adaptiveMergeSortTest_data();
+    
+    // Test that adaptiveMergeSort sorts already sorted and reversed input 
+    // using linear number of comparisons.
+    void adaptiveMergeSortTest_linear();
+    
+    // Test radixSort with signed, unsigned and floating point numbers and
+    // with single-threaded and parallel histograms.
+    void radixSortTest_numbers();
+    void radixSortTest_numbers_data();
+    
+    // Test radixSort with a key extractor. Result must be stable.
+    void radixSortTest_keyExtractor();
+    
+    // Test kWayMerge with in-memory ranges, including empty ranges. Result
+    // must be stable and use at most ceil(log2 k) comparisons per element.
+    void kWayMergeTest_ranges();
+    void kWayMergeTest_ranges_data();
+    
+    // Test kWayMerge with pull-based sources and a stacked LoserTree.
+    void kWayMergeTest_sources();
+    
+    // Test that kWayMerge moves elements through std::move_iterators: 
+    // move-only elements are merged and counted elements are not copied.
+    void kWayMergeTest_moving();
+    
+    // Test that sortByKey gives the same stable result as std::stable_sort
+    // and computes each key exactly once.
+    void sortByKeyTest();
+    void sortByKeyTest_data();
+    
+    // Test that argsort returns the stable sorting permutation and does not
+    // modify the range.
+    void argsortTest();
+    
+    // Test that topK and parallelTopK return the same elements as 
+    // std::stable_sort followed by taking k first, with different k.
+    void topKTest();
+    void topKTest_data();
+    
+    // Test that parallelTopK moves the chunk candidates into the result
+    // and copies only what the per-chunk topK calls copy.
+    void topKTest_moving();
+    
+    // Test StreamingTopK early rejection, threshold and reuse after take().
+    void streamingTopKTest();
+    
+    // Test nthElement with random, sorted and all-equal input.
+    void nthElementTest();
+    void nthElementTest_data();
+    
+    // Test networkSort with all 0-1 inputs of up to 16 elements, which
+    // proves the networks correct, and with random strings of 32 elements.
+    void networkSortTest();
+    
+    // Test that StaticSearchIndex single and batched lowerBound give the
+    // same positions as std::lower_bound with all index sizes up to 300.
+    void staticSearchIndexTest();
 };
 
 AlgoTest::AlgoTest()
@@ -128,6 +248,666 @@ void AlgoTest::mergeSortTest_not_copyable_data()
 }
 
 
+void AlgoTest::mergeSortTest_stable()
+{
+    QFETCH(int, width);
+    QFETCH(int, keys);
+    
+    using Item = std::pair<int,int>; // key, original position
+    auto cmp = [](const Item& a, const Item& b){return a.first < b.first;};
+    
+    std::vector<Item> expected;
+    std::default_random_engine gen(width);
+    for (int i=0; i<width; ++i){
+        expected.push_back( Item(gen() % keys, i) );
+    }
+    std::vector<Item> v(expected);
+    std::forward_list<Item> l(expected.begin(), expected.end());
+    std::stable_sort(expected.begin(), expected.end(), cmp);
+    
+    PPUtils::mergeSort(v.begin(), v.end(), cmp);
+    PPUtils::mergeSort(l.begin(), l.end(), cmp);
+    
+    QVERIFY2(v == expected, "std::vector is not stably sorted.");
+    QVERIFY2(std::equal(expected.begin(), expected.end(), l.begin()),
+             "std::forward_list is not stably sorted.");
+}
+
+
+void AlgoTest::mergeSortTest_stable_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("keys");
+    
+    const int threshold = PPUtils::MERGESORT_INSERTION_THRESHOLD;
+    QList<int> widths;
+    widths << 1 << 2 << threshold-1 << threshold << threshold+1 
+           << 2*threshold+1 << 1000 << 4097;
+    
+    for (int width : widths){
+        QTest::newRow(qPrintable(QString("%1 items, 3 keys").arg(width)))
+                << width << 3;
+        QTest::newRow(qPrintable(QString("%1 items, unique keys").arg(width)))
+                << width << 1000000;
+    }
+}
+
+
+void AlgoTest::mergeSortTest_memoryBudget()
+{
+    QFETCH(int, width);
+    QFETCH(int, keys);
+    QFETCH(int, buffer);
+    
+    using Item = std::pair<int,int>; // key, original position
+    auto cmp = [](const Item& a, const Item& b){return a.first < b.first;};
+    const std::size_t budget = buffer * sizeof(Item);
+    
+    std::vector<Item> expected;
+    std::default_random_engine gen(width + buffer);
+    for (int i=0; i<width; ++i){
+        expected.push_back( Item(gen() % keys, i) );
+    }
+    std::vector<Item> v(expected);
+    std::forward_list<Item> l(expected.begin(), expected.end());
+    std::stable_sort(expected.begin(), expected.end(), cmp);
+    
+    PPUtils::mergeSort(v.begin(), v.end(), cmp, budget);
+    PPUtils::mergeSort(l.begin(), l.end(), cmp, budget);
+    
+    QVERIFY2(v == expected, "std::vector is not stably sorted.");
+    QVERIFY2(std::equal(expected.begin(), expected.end(), l.begin()),
+             "std::forward_list is not stably sorted.");
+}
+
+
+void AlgoTest::mergeSortTest_memoryBudget_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("keys");
+    QTest::addColumn<int>("buffer");
+    
+    QList<int> widths;
+    widths << 100 << 1000 << 4097 << 20000;
+    
+    for (int width : widths){
+        QList<int> buffers;
+        buffers << 0 << static_cast<int>(std::sqrt(width)) << width-1;
+        for (int buffer : buffers){
+            QTest::newRow(qPrintable(QString("%1 items, 3 keys, buffer %2")
+                                     .arg(width).arg(buffer)))
+                    << width << 3 << buffer;
+            QTest::newRow(qPrintable(QString("%1 items, unique keys, buffer %2")
+                                     .arg(width).arg(buffer)))
+                    << width << 1000000 << buffer;
+        }
+    }
+}
+
+
+void AlgoTest::insertionSortTest()
+{
+    std::vector<int> v = {5, 3, 9, 1, 1, 7, 0, 2};
+    std::vector<int> expected(v);
+    std::sort(expected.begin(), expected.end());
+    
+    PPUtils::insertionSort(v.begin(), v.end());
+    QCOMPARE(v, expected);
+    
+    PPUtils::insertionSort(v.begin(), v.end(), std::greater<int>());
+    std::reverse(expected.begin(), expected.end());
+    QCOMPARE(v, expected);
+}
+
+void AlgoTest::parallelMergeSortTest()
+{
+    QFETCH(int, width);
+    QFETCH(unsigned, threads);
+    
+    using Item = std::pair<int,int>; // key, original position
+    auto cmp = [](const Item& a, const Item& b){return a.first < b.first;};
+    
+    std::vector<Item> expected;
+    std::default_random_engine gen(width);
+    for (int i=0; i<width; ++i){
+        expected.push_back( Item(gen() % 100, i) );
+    }
+    std::vector<Item> v(expected);
+    std::stable_sort(expected.begin(), expected.end(), cmp);
+    
+    PPUtils::parallelMergeSort(v.begin(), v.end(), cmp, threads);
+    QVERIFY2(v == expected, "Range is not stably sorted.");
+}
+
+
+void AlgoTest::parallelMergeSortTest_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<unsigned>("threads");
+    
+    const int chunk = PPUtils::PARALLEL_MERGESORT_MIN_CHUNK;
+    QList<int> widths;
+    widths << 0 << 1000 << 2*chunk << 5*chunk+3 << 300000;
+    QList<unsigned> thread_counts;
+    thread_counts << 0 << 1 << 2 << 3 << 8;
+    
+    for (int width : widths){
+        for (unsigned threads : thread_counts){
+            QTest::newRow(qPrintable(QString("%1 items, %2 threads")
+                                     .arg(width).arg(threads)))
+                    << width << threads;
+        }
+    }
+}
+
+void AlgoTest::adaptiveMergeSortTest()
+{
+    QFETCH(std::vector<int>, keys);
+    
+    using Item = std::pair<int,int>; // key, original position
+    auto cmp = [](const Item& a, const Item& b){return a.first < b.first;};
+    
+    std::vector<Item> expected;
+    for (unsigned i=0; i<keys.size(); ++i){
+        expected.push_back( Item(keys[i], i) );
+    }
+    std::vector<Item> v(expected);
+    std::stable_sort(expected.begin(), expected.end(), cmp);
+    
+    PPUtils::adaptiveMergeSort(v.begin(), v.end(), cmp);
+    QVERIFY2(v == expected, "Range is not stably sorted.");
+}
+
+
+void AlgoTest::adaptiveMergeSortTest_data()
+{
+    QTest::addColumn<std::vector<int> >("keys");
+    
+    std::default_random_engine gen;
+    QList<int> widths;
+    widths << 0 << 1 << 63 << 64 << 1000 << 100001;
+    
+    for (int width : widths){
+        std::vector<int> sorted, reversed, sawtooth, random, few;
+        for (int i=0; i<width; ++i){
+            sorted.push_back(i);
+            reversed.push_back(width - i);
+            sawtooth.push_back(i % 1000);
+            random.push_back(gen());
+            few.push_back(gen() % 3);
+        }
+        QTest::newRow(qPrintable(QString("%1 sorted").arg(width))) << sorted;
+        QTest::newRow(qPrintable(QString("%1 reversed").arg(width))) << reversed;
+        QTest::newRow(qPrintable(QString("%1 sawtooth").arg(width))) << sawtooth;
+        QTest::newRow(qPrintable(QString("%1 random").arg(width))) << random;
+        QTest::newRow(qPrintable(QString("%1 few unique").arg(width))) << few;
+    }
+}
+
+
+void AlgoTest::adaptiveMergeSortTest_linear()
+{
+    const int width = 100000;
+    std::vector<int> ascending, descending;
+    for (int i=0; i<width; ++i){
+        ascending.push_back(i);
+        descending.push_back(width - i);
+    }
+    
+    int comparisons = 0;
+    auto cmp = [&comparisons](int a, int b){++comparisons; return a < b;};
+    
+    PPUtils::adaptiveMergeSort(ascending.begin(), ascending.end(), cmp);
+    QVERIFY(comparisons < width);
+    
+    comparisons = 0;
+    PPUtils::adaptiveMergeSort(descending.begin(), descending.end(), cmp);
+    QVERIFY(comparisons < width);
+    QVERIFY(std::is_sorted(descending.begin(), descending.end()));
+}
+
+void AlgoTest::radixSortTest_numbers()
+{
+    QFETCH(int, width);
+    QFETCH(unsigned, threads);
+    
+    std::mt19937_64 gen(width);
+    std::vector<std::uint32_t> u32;
+    std::vector<std::int64_t> i64;
+    std::vector<short> i16;
+    std::vector<float> f32;
+    std::vector<double> f64;
+    for (int i=0; i<width; ++i){
+        u32.push_back(gen());
+        i64.push_back(gen());
+        i16.push_back(gen());
+        f32.push_back( float(int(gen() % 20001) - 10000) / 7.0f );
+        f64.push_back( double(std::int64_t(gen())) * 1e-300 );
+    }
+    f64.push_back(std::numeric_limits<double>::infinity());
+    f64.push_back(-std::numeric_limits<double>::infinity());
+    
+    QVERIFY2(radixSortsLikeStdSort(u32, threads), "uint32 keys are not sorted.");
+    QVERIFY2(radixSortsLikeStdSort(i64, threads), "int64 keys are not sorted.");
+    QVERIFY2(radixSortsLikeStdSort(i16, threads), "short keys are not sorted.");
+    QVERIFY2(radixSortsLikeStdSort(f32, threads), "float keys are not sorted.");
+    QVERIFY2(radixSortsLikeStdSort(f64, threads), "double keys are not sorted.");
+}
+
+
+void AlgoTest::radixSortTest_numbers_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<unsigned>("threads");
+    
+    QList<int> widths;
+    widths << 0 << 1 << 1000 << int(PPUtils::RADIXSORT_WIDE_DIGIT_MIN_RANGE) 
+           << 200000;
+    for (int width : widths){
+        QTest::newRow(qPrintable(QString("%1 items, 1 thread").arg(width)))
+                << width << 1u;
+        QTest::newRow(qPrintable(QString("%1 items, 4 threads").arg(width)))
+                << width << 4u;
+    }
+}
+
+
+void AlgoTest::radixSortTest_keyExtractor()
+{
+    using Item = std::pair<double,int>; // key, original position
+    
+    std::vector<Item> expected;
+    std::default_random_engine gen;
+    for (int i=0; i<100000; ++i){
+        expected.push_back( Item(int(gen() % 50) - 25.5, i) );
+    }
+    std::deque<Item> d(expected.begin(), expected.end());
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const Item& a, const Item& b){return a.first < b.first;});
+    
+    PPUtils::radixSort(d.begin(), d.end(), [](const Item& i){return i.first;});
+    QVERIFY2(std::equal(expected.begin(), expected.end(), d.begin()),
+             "Records are not stably sorted by key.");
+}
+
+void AlgoTest::kWayMergeTest_ranges()
+{
+    QFETCH(int, k);
+    
+    using Item = std::pair<int,int>; // key, range index
+    std::vector<std::list<Item> > inputs(k);
+    std::vector<Item> expected;
+    std::default_random_engine gen(k);
+    for (int r=0; r<k; ++r){
+        int width = (r % 3 == 1) ? 0 : gen() % 500;
+        for (int i=0; i<width; ++i){
+            inputs[r].push_back( Item(gen() % 50, r) );
+        }
+        inputs[r].sort();
+        expected.insert(expected.end(), inputs[r].begin(), inputs[r].end());
+    }
+    auto cmp_keys = [](const Item& a, const Item& b){return a.first < b.first;};
+    std::stable_sort(expected.begin(), expected.end(), cmp_keys);
+    
+    typedef std::list<Item>::const_iterator Iter;
+    std::vector<std::pair<Iter, Iter> > ranges;
+    for (const std::list<Item>& l : inputs){
+        ranges.push_back( std::make_pair(l.begin(), l.end()) );
+    }
+    
+    unsigned comparisons = 0;
+    std::vector<Item> result;
+    PPUtils::kWayMerge(ranges, std::back_inserter(result),
+                       [&](const Item& a, const Item& b)
+    {
+        ++comparisons;
+        return a.first < b.first;
+    });
+    
+    QVERIFY2(result == expected, "Merged elements are in a wrong order.");
+    unsigned depth = 0;
+    while ((1 << depth) < k) ++depth;
+    // Initial tournament plays k-1 matches.
+    QVERIFY(comparisons <= result.size() * depth + k);
+}
+
+
+void AlgoTest::kWayMergeTest_ranges_data()
+{
+    QTest::addColumn<int>("k");
+    
+    QList<int> ks;
+    ks << 0 << 1 << 2 << 3 << 8 << 13 << 64;
+    for (int k : ks){
+        QTest::newRow(qPrintable(QString("%1 ranges").arg(k))) << k;
+    }
+}
+
+
+void AlgoTest::kWayMergeTest_sources()
+{
+    typedef PPUtils::detail::RangeSource<std::vector<int>::const_iterator> Source;
+    typedef PPUtils::LoserTree<Source> Tree;
+    
+    std::vector<int> a = {1, 4, 7}, b = {2, 5, 8}, c = {3, 6, 9}, d = {0, 10};
+    Source sa(a.begin(), a.end()), sb(b.begin(), b.end()), 
+           sc(c.begin(), c.end()), sd(d.begin(), d.end());
+    
+    // Merge (a, b) and (c, d) with two trees, and their output with a third.
+    std::vector<Source*> left_sources = {&sa, &sb};
+    std::vector<Source*> right_sources = {&sc, &sd};
+    Tree left(left_sources), right(right_sources);
+    std::vector<Tree*> trees = {&left, &right};
+    
+    std::vector<int> result;
+    PPUtils::kWayMerge(trees, std::back_inserter(result));
+    
+    std::vector<int> expected(11);
+    std::iota(expected.begin(), expected.end(), 0);
+    QCOMPARE(result, expected);
+    QVERIFY(left.empty() && right.empty());
+}
+
+
+void AlgoTest::kWayMergeTest_moving()
+{
+    typedef std::move_iterator<std::vector<IntPtr>::iterator> PtrIter;
+    std::vector<std::vector<IntPtr> > ptrs(3);
+    for (int i=0; i<9; ++i){
+        ptrs[i % 3].push_back(IntPtr(new int(i)));
+    }
+    std::vector<std::pair<PtrIter, PtrIter> > ptr_ranges;
+    for (std::vector<IntPtr>& v : ptrs){
+        ptr_ranges.push_back( std::make_pair(PtrIter(v.begin()), PtrIter(v.end())) );
+    }
+    std::vector<IntPtr> merged;
+    PPUtils::kWayMerge(ptr_ranges, std::back_inserter(merged), 
+                       [](IntPtrRef a, IntPtrRef b){return *a < *b;});
+    QCOMPARE(merged.size(), std::size_t(9));
+    for (int i=0; i<9; ++i){
+        QCOMPARE(*merged[i], i);
+    }
+    
+    typedef std::move_iterator<std::vector<CopyCounted>::iterator> CountedIter;
+    std::vector<std::vector<CopyCounted> > counted(4);
+    for (int i=0; i<100; ++i){
+        counted[i % 4].emplace_back(i);
+    }
+    std::vector<std::pair<CountedIter, CountedIter> > counted_ranges;
+    for (std::vector<CopyCounted>& v : counted){
+        counted_ranges.push_back( std::make_pair(CountedIter(v.begin()), 
+                                                 CountedIter(v.end())) );
+    }
+    std::vector<CopyCounted> result;
+    result.reserve(100);
+    CopyCounted::copies = 0;
+    PPUtils::kWayMerge(counted_ranges, std::back_inserter(result));
+    QCOMPARE(CopyCounted::copies, 0);
+    QCOMPARE(result.size(), std::size_t(100));
+    QCOMPARE(result.back().value, 99);
+}
+
+
+void AlgoTest::sortByKeyTest()
+{
+    QFETCH(int, width);
+    
+    using Item = std::pair<std::string,int>; // key as text, original position
+    std::vector<Item> expected;
+    std::default_random_engine gen(width);
+    for (int i=0; i<width; ++i){
+        expected.push_back( Item(std::to_string(gen() % 100), i) );
+    }
+    std::deque<Item> d(expected.begin(), expected.end());
+    std::stable_sort(expected.begin(), expected.end(), [](const Item& a, const Item& b)
+    {
+        return std::stoi(a.first) < std::stoi(b.first);
+    });
+    
+    int calls = 0;
+    PPUtils::sortByKey(d.begin(), d.end(), [&calls](const Item& i)
+    {
+        ++calls;
+        return std::stoi(i.first);
+    });
+    QCOMPARE(calls, width);
+    QVERIFY2(std::equal(expected.begin(), expected.end(), d.begin()),
+             "Items are not stably sorted by key.");
+}
+
+
+void AlgoTest::sortByKeyTest_data()
+{
+    QTest::addColumn<int>("width");
+    
+    QList<int> widths;
+    widths << 0 << 1 << 2 << 33 << 1000 << 100000;
+    for (int width : widths){
+        QTest::newRow(qPrintable(QString("%1 items").arg(width))) << width;
+    }
+}
+
+
+void AlgoTest::argsortTest()
+{
+    std::vector<int> v;
+    std::default_random_engine gen;
+    for (int i=0; i<10000; ++i){
+        v.push_back(gen() % 100);
+    }
+    const std::vector<int> original(v);
+    
+    std::vector<std::size_t> indices = PPUtils::argsort(v.begin(), v.end(), 
+                                                        std::greater<int>());
+    QCOMPARE(v, original);
+    QCOMPARE(indices.size(), v.size());
+    for (std::size_t i=1; i<indices.size(); ++i){
+        QVERIFY(v[indices[i-1]] > v[indices[i]] ||
+                (v[indices[i-1]] == v[indices[i]] && indices[i-1] < indices[i]));
+    }
+}
+
+
+void AlgoTest::topKTest()
+{
+    QFETCH(int, width);
+    QFETCH(int, k);
+    
+    using Item = std::pair<int,int>; // key, original position
+    auto cmp_keys = [](const Item& a, const Item& b){return a.first < b.first;};
+    std::vector<Item> v;
+    std::default_random_engine gen(width);
+    for (int i=0; i<width; ++i){
+        v.push_back( Item(gen() % (width / 4 + 1), i) );
+    }
+    std::vector<Item> expected(v);
+    std::stable_sort(expected.begin(), expected.end(), cmp_keys);
+    expected.resize(std::min(width, k));
+    
+    std::list<Item> l(v.begin(), v.end());
+    QVERIFY(PPUtils::topK(l.begin(), l.end(), k, cmp_keys) == expected);
+    for (unsigned threads : {1u, 2u, 4u}){
+        QVERIFY(PPUtils::parallelTopK(v.begin(), v.end(), k, cmp_keys, 
+                                      threads) == expected);
+    }
+}
+
+
+void AlgoTest::topKTest_moving()
+{
+    const unsigned threads = 4;
+    const std::size_t width = threads * PPUtils::PARALLEL_MERGESORT_MIN_CHUNK;
+    const std::size_t k = 100;
+    std::vector<CopyCounted> v;
+    std::default_random_engine gen(1);
+    for (std::size_t i=0; i<width; ++i){
+        v.emplace_back(gen() % 100000);
+    }
+    
+    CopyCounted::copies = 0;
+    std::size_t chunk_candidates = 0;
+    for (unsigned t=0; t<threads; ++t){
+        chunk_candidates += PPUtils::topK(v.begin() + width * t / threads,
+                                          v.begin() + width * (t + 1) / threads,
+                                          k, std::less<CopyCounted>()).size();
+    }
+    const int chunk_copies = CopyCounted::copies;
+    QCOMPARE(chunk_candidates, threads * k);
+    
+    CopyCounted::copies = 0;
+    std::vector<CopyCounted> result = 
+        PPUtils::parallelTopK(v.begin(), v.end(), k, std::less<CopyCounted>(), 
+                              threads);
+    QCOMPARE(CopyCounted::copies, chunk_copies);
+    QCOMPARE(result.size(), k);
+}
+
+
+void AlgoTest::topKTest_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("k");
+    
+    QTest::newRow("empty") << 0 << 10;
+    QTest::newRow("k = 0") << 1000 << 0;
+    QTest::newRow("k > width") << 100 << 1000;
+    QTest::newRow("top 100") << 100000 << 100;
+    QTest::newRow("top 10000") << 100000 << 10000;
+}
+
+
+void AlgoTest::streamingTopKTest()
+{
+    PPUtils::StreamingTopK<int, std::greater<int> > top(3);
+    for (int i : {5, 1, 9, 7, 9, 2}){
+        top.push(i);
+    }
+    QCOMPARE(top.size(), std::size_t(3));
+    QCOMPARE(top.threshold(), 7);
+    QVERIFY(top.rejects(7));
+    QVERIFY(!top.rejects(8));
+    QVERIFY(!top.push(3));
+    QCOMPARE(top.sorted(), std::vector<int>({9, 9, 7}));
+    QCOMPARE(top.take(), std::vector<int>({9, 9, 7}));
+    QCOMPARE(top.size(), std::size_t(0));
+    
+    QVERIFY(top.push(1));
+    QCOMPARE(top.take(), std::vector<int>({1}));
+}
+
+
+void AlgoTest::nthElementTest()
+{
+    QFETCH(std::vector<int>, v);
+    
+    std::vector<int> expected(v);
+    std::sort(expected.begin(), expected.end());
+    for (std::size_t nth : {std::size_t(0), v.size() / 3, v.size() - 1}){
+        std::vector<int> w(v);
+        PPUtils::nthElement(w.begin(), w.begin() + nth, w.end());
+        QCOMPARE(w[nth], expected[nth]);
+        for (std::size_t i=0; i<w.size(); ++i){
+            QVERIFY(i >= nth || w[i] <= w[nth]);
+            QVERIFY(i <= nth || w[i] >= w[nth]);
+        }
+    }
+}
+
+
+void AlgoTest::nthElementTest_data()
+{
+    QTest::addColumn<std::vector<int> >("v");
+    
+    std::vector<int> random, sorted, equal(100000, 7);
+    std::default_random_engine gen;
+    for (int i=0; i<100000; ++i){
+        random.push_back(gen() % 1000);
+        sorted.push_back(i);
+    }
+    QTest::newRow("short") << std::vector<int>({3, 1, 2});
+    QTest::newRow("random") << random;
+    QTest::newRow("sorted") << sorted;
+    QTest::newRow("equal") << equal;
+}
+
+
+namespace
+{
+
+// Sorts every array of N zeros and ones. A comparator network sorts all
+// inputs if it sorts all 0-1 inputs.
+template <std::size_t N>
+bool networkSortsZeroOne()
+{
+    for (unsigned long bits = 0; bits < (1ul << N); ++bits){
+        std::array<int, N> a;
+        for (std::size_t i=0; i<N; ++i){
+            a[i] = (bits >> i) & 1;
+        }
+        PPUtils::networkSort(a);
+        if (!std::is_sorted(a.begin(), a.end())){
+            return false;
+        }
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
+
+void AlgoTest::networkSortTest()
+{
+    static_assert(PPUtils::sortingNetworkSize(8) == 19, "Network is not optimal.");
+    
+    QVERIFY(networkSortsZeroOne<2>());
+    QVERIFY(networkSortsZeroOne<3>());
+    QVERIFY(networkSortsZeroOne<5>());
+    QVERIFY(networkSortsZeroOne<8>());
+    QVERIFY(networkSortsZeroOne<13>());
+    QVERIFY(networkSortsZeroOne<16>());
+    
+    std::default_random_engine gen;
+    for (int r=0; r<100; ++r){
+        std::vector<std::string> v;
+        for (int i=0; i<32; ++i){
+            v.push_back(std::to_string(gen() % 20));
+        }
+        std::vector<std::string> expected(v);
+        std::sort(expected.begin(), expected.end(), std::greater<std::string>());
+        PPUtils::networkSort<32>(v.begin(), std::greater<std::string>());
+        QCOMPARE(v, expected);
+    }
+}
+
+
+void AlgoTest::staticSearchIndexTest()
+{
+    std::default_random_engine gen;
+    for (int width=0; width<300; ++width){
+        std::vector<int> v;
+        for (int i=0; i<width; ++i){
+            v.push_back(gen() % (2 * width + 1));
+        }
+        std::sort(v.begin(), v.end(), std::greater<int>());
+        PPUtils::StaticSearchIndex<int, std::greater<int> > index(v.begin(), v.end());
+        QCOMPARE(index.size(), v.size());
+        
+        std::vector<int> queries;
+        for (int q=-1; q<=2*width+1; ++q){
+            queries.push_back(q);
+        }
+        std::vector<std::size_t> batched;
+        index.lowerBound(queries.begin(), queries.end(), std::back_inserter(batched));
+        QCOMPARE(batched.size(), queries.size());
+        for (std::size_t i=0; i<queries.size(); ++i){
+            std::size_t expected = std::lower_bound(v.begin(), v.end(), queries[i],
+                                                    std::greater<int>()) - v.begin();
+            QCOMPARE(index.lowerBound(queries[i]), expected);
+            QCOMPARE(batched[i], expected);
+        }
+    }
+}
+
 
 QTEST_APPLESS_MAIN(AlgoTest)
 
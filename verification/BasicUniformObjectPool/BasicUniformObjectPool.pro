@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Unit tests for PPUtils::BasicUniformObjectPool.
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_basicuniformobjectpooltest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += tst_basicuniformobjectpooltest.cc
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+HEADERS += \
+    ../../source/PPUtils/basicuniformobjectpool.hh \
+    ../../source/PPUtils/basicuniformobjectpool_impl.hh \
+    ../../source/PPUtils/poolpolicies.hh
+
+INCLUDEPATH += ../../source/PPUtils
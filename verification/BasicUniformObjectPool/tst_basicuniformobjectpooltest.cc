@@ -0,0 +1,270 @@
+#include <QString>
+#include <QtTest>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "basicuniformobjectpool.hh"
+
+
+// Counts live instances across threads.
+class Counted
+{
+public:
+    static std::atomic<int> live;
+    int value;
+
+    explicit Counted(int v = 0) : value(v) {++live;}
+    ~Counted() {--live;}
+};
+
+std::atomic<int> Counted::live(0);
+
+
+// Builder numbering the objects it builds. Fails after fail_after objects.
+class CountingBuilder
+{
+public:
+    int* built;
+    int fail_after;
+
+    explicit CountingBuilder(int* b = nullptr, int f = -1) : built(b), fail_after(f) {}
+
+    Counted* operator () () const
+    {
+        if (fail_after >= 0 && *built >= fail_after){
+            throw std::runtime_error("builder failed");
+        }
+        return new Counted(++*built);
+    }
+};
+
+
+class BasicUniformObjectPoolTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    BasicUniformObjectPoolTest();
+
+private Q_SLOTS:
+
+    /*!
+     * \brief Test reserve and release with default policies.
+     *  - Expected behaviour: Released objects are reused in LIFO order and
+     *    the builder is called only on misses. The pool is not polymorphic.
+     */
+    void reuseTest();
+
+    /*!
+     * \brief Test FixedStorage.
+     *  - Expected behaviour: Objects released to a full storage are
+     *    destroyed.
+     */
+    void fixedStorageTest();
+
+    /*!
+     * \brief Test growth policies.
+     *  - Expected behaviour: GrowBatch builds N objects per miss and
+     *    GrowGeometric doubles the number of built objects.
+     */
+    void growthTest();
+
+    /*!
+     * \brief Test throwing builder.
+     *  - Expected behaviour: Exception propagates. Objects built before it
+     *    in the same batch are stored.
+     */
+    void builderExceptionTest();
+
+    /*!
+     * \brief Test reserve and release from several threads with MutexLock and
+     *  SpinLock.
+     *  - Expected behaviour: No object is lost or reserved twice.
+     */
+    void lockingTest();
+};
+
+
+BasicUniformObjectPoolTest::BasicUniformObjectPoolTest()
+{
+}
+
+
+void BasicUniformObjectPoolTest::reuseTest()
+{
+    static_assert(!std::is_polymorphic<PPUtils::BasicUniformObjectPool<Counted> >::value,
+                  "BasicUniformObjectPool must not have virtual methods");
+    Counted::live = 0;
+    int built = 0;
+    {
+        PPUtils::BasicUniformObjectPool<Counted, CountingBuilder> pool((CountingBuilder(&built)));
+        QCOMPARE(pool.size(), 0u);
+
+        std::vector<std::unique_ptr<Counted> > objects;
+        for (int i = 0; i < 5; ++i){
+            objects.push_back(pool.reserve());
+            QCOMPARE(objects.back()->value, i + 1);
+        }
+        QCOMPARE(pool.built(), std::size_t(5));
+        for (auto& object : objects){
+            pool.release(std::move(object));
+        }
+        QCOMPARE(pool.size(), 5u);
+
+        // Last released is reserved first.
+        for (int i = 5; i > 0; --i){
+            objects[i - 1] = pool.reserve();
+            QCOMPARE(objects[i - 1]->value, i);
+        }
+        QCOMPARE(built, 5);
+        for (auto& object : objects){
+            pool.release(std::move(object));
+        }
+        pool.clear();
+        QCOMPARE(pool.size(), 0u);
+        QCOMPARE(Counted::live.load(), 0);
+
+        pool.release(pool.reserve());
+    }
+    QCOMPARE(Counted::live.load(), 0);
+}
+
+
+void BasicUniformObjectPoolTest::fixedStorageTest()
+{
+    Counted::live = 0;
+    {
+        PPUtils::BasicUniformObjectPool<Counted, PPUtils::DefaultBuilder<Counted>,
+                PPUtils::FixedStorage<Counted, 3> > pool;
+        std::vector<std::unique_ptr<Counted> > objects;
+        for (int i = 0; i < 5; ++i){
+            objects.push_back(pool.reserve());
+        }
+        for (auto& object : objects){
+            pool.release(std::move(object));
+        }
+        QCOMPARE(pool.size(), 3u);
+        QCOMPARE(Counted::live.load(), 3);
+    }
+    QCOMPARE(Counted::live.load(), 0);
+}
+
+
+void BasicUniformObjectPoolTest::growthTest()
+{
+    Counted::live = 0;
+    int built = 0;
+    PPUtils::BasicUniformObjectPool<Counted, CountingBuilder, PPUtils::VectorStorage<Counted>,
+            PPUtils::NoLock, PPUtils::GrowBatch<4> > batch((CountingBuilder(&built)));
+    std::unique_ptr<Counted> a = batch.reserve();
+    QCOMPARE(built, 4);
+    QCOMPARE(batch.size(), 3u);
+    std::vector<std::unique_ptr<Counted> > objects;
+    for (int i = 0; i < 4; ++i){
+        objects.push_back(batch.reserve());
+    }
+    QCOMPARE(built, 8);
+    QCOMPARE(batch.size(), 3u);
+
+    built = 0;
+    PPUtils::BasicUniformObjectPool<Counted, CountingBuilder, PPUtils::VectorStorage<Counted>,
+            PPUtils::NoLock, PPUtils::GrowGeometric<8> > geometric((CountingBuilder(&built)));
+    std::vector<std::unique_ptr<Counted> > held;
+    std::vector<int> totals;
+    for (int i = 0; i < 40; ++i){
+        held.push_back(geometric.reserve());
+        if (totals.empty() || totals.back() != built){
+            totals.push_back(built);
+        }
+    }
+    // 1, 2, 4, 8, then at most 8 per miss.
+    QCOMPARE(totals.size(), std::size_t(8));
+    QCOMPARE(totals[0], 1);
+    QCOMPARE(totals[1], 2);
+    QCOMPARE(totals[2], 4);
+    QCOMPARE(totals[3], 8);
+    QCOMPARE(totals[4], 16);
+    QCOMPARE(totals[5], 24);
+    QCOMPARE(totals[6], 32);
+    QCOMPARE(totals[7], 40);
+}
+
+
+void BasicUniformObjectPoolTest::builderExceptionTest()
+{
+    Counted::live = 0;
+    int built = 0;
+    {
+        PPUtils::BasicUniformObjectPool<Counted, CountingBuilder, PPUtils::VectorStorage<Counted>,
+                PPUtils::NoLock, PPUtils::GrowBatch<4> > pool(CountingBuilder(&built, 3));
+        QVERIFY_EXCEPTION_THROWN(pool.reserve(), std::runtime_error);
+        QCOMPARE(pool.size(), 3u);
+        QCOMPARE(pool.built(), std::size_t(3));
+
+        std::unique_ptr<Counted> c = pool.reserve();
+        QVERIFY(c != nullptr);
+        pool.release(std::move(c));
+    }
+    QCOMPARE(Counted::live.load(), 0);
+
+    built = 0;
+    PPUtils::BasicUniformObjectPool<Counted, CountingBuilder> pool(CountingBuilder(&built, 0));
+    QVERIFY_EXCEPTION_THROWN(pool.reserve(), std::runtime_error);
+    QCOMPARE(pool.size(), 0u);
+    QCOMPARE(pool.built(), std::size_t(0));
+}
+
+
+template <class Locking>
+static void hammer()
+{
+    Counted::live = 0;
+    {
+        PPUtils::BasicUniformObjectPool<Counted, PPUtils::DefaultBuilder<Counted>,
+                PPUtils::VectorStorage<Counted>, Locking> pool;
+        std::atomic<bool> twice(false);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t){
+            threads.push_back(std::thread([&pool, &twice, t]()
+            {
+                for (int i = 0; i < 5000; ++i){
+                    std::unique_ptr<Counted> a = pool.reserve();
+                    std::unique_ptr<Counted> b = pool.reserve();
+                    // Mark objects as owned by this thread.
+                    a->value = t + 1;
+                    b->value = t + 1;
+                    std::this_thread::yield();
+                    if (a->value != t + 1 || b->value != t + 1){
+                        twice = true;
+                    }
+                    pool.release(std::move(a));
+                    pool.release(std::move(b));
+                }
+            }));
+        }
+        for (std::thread& t : threads){
+            t.join();
+        }
+        QVERIFY(!twice);
+        QCOMPARE(std::size_t(pool.size()), pool.built());
+        QCOMPARE(Counted::live.load(), int(pool.size()));
+        QVERIFY(pool.size() <= 8u);
+    }
+    QCOMPARE(Counted::live.load(), 0);
+}
+
+
+void BasicUniformObjectPoolTest::lockingTest()
+{
+    hammer<PPUtils::MutexLock>();
+    hammer<PPUtils::SpinLock>();
+}
+
+
+QTEST_APPLESS_MAIN(BasicUniformObjectPoolTest)
+
+#include "tst_basicuniformobjectpooltest.moc"
@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Unit tests for PPUtils::BufferPool.
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_bufferpooltest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += tst_bufferpooltest.cc \
+           ../../source/PPUtils/bufferpool.cc \
+           ../../source/PPUtils/mappedarena.cc
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+HEADERS += \
+    ../../source/PPUtils/bufferpool.hh \
+    ../../source/PPUtils/poolpolicies.hh \
+    ../../source/PPUtils/mappedarena.hh \
+    ../../source/PPUtils/mappedarena_impl.hh
+
+INCLUDEPATH += ../../source/PPUtils
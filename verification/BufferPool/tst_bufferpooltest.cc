@@ -0,0 +1,283 @@
+#include <QString>
+#include <QtTest>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+
+#include "bufferpool.hh"
+
+
+class BufferPoolTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    BufferPoolTest();
+
+private Q_SLOTS:
+
+    /*!
+     * \brief Test rounding sizes to size classes.
+     *  - Expected behaviour: Sizes round up to the next power of two, or to
+     *    the next quarter step, and sizes over max_size are not rounded.
+     */
+    void sizeClassTest();
+
+    /*!
+     * \brief Test reusing released buffers.
+     *  - Expected behaviour: A released buffer serves the next request of
+     *    the same class, and trim destroys idle buffers.
+     */
+    void reuseTest();
+
+    /*!
+     * \brief Test copies and slices.
+     *  - Expected behaviour: Slices share bytes with the original, and the
+     *    buffer returns to the pool when the last slice is destroyed.
+     */
+    void sliceTest();
+
+    /*!
+     * \brief Test buffers of huge page classes.
+     *  - Expected behaviour: Buffers are aligned to the huge page size and
+     *    reused like other buffers.
+     */
+    void hugePageTest();
+
+    /*!
+     * \brief Test reserving in some threads and releasing slices in others.
+     *  - Expected behaviour: Bytes are not overwritten while referred to,
+     *    and idle buffers stay within the tier limits.
+     */
+    void concurrentTest();
+
+    /*!
+     * \brief Test destroying the pool before its buffers.
+     *  - Expected behaviour: Buffers stay usable and free their memory when
+     *    destroyed.
+     */
+    void lifetimeTest();
+};
+
+
+BufferPoolTest::BufferPoolTest()
+{
+}
+
+
+void BufferPoolTest::sizeClassTest()
+{
+    PPUtils::BufferPoolOptions options;
+    options.classes = PPUtils::BUFFER_CLASSES_POWER_OF_TWO;
+    options.min_size = 100;
+    options.max_size = 1 << 20;
+    PPUtils::BufferPool powers(options);
+    QCOMPARE(powers.classSize(1), std::size_t(128));
+    QCOMPARE(powers.classSize(128), std::size_t(128));
+    QCOMPARE(powers.classSize(129), std::size_t(256));
+    QCOMPARE(powers.classSize(4097), std::size_t(8192));
+    QCOMPARE(powers.classSize(1 << 20), std::size_t(1 << 20));
+    QCOMPARE(powers.classSize((1 << 20) + 1), std::size_t((1 << 20) + 1));
+    QCOMPARE(powers.classCount(), 14u);
+    QVERIFY(powers.threadTiers() >= PPUtils::BUFFER_POOL_THREAD_TIERS);
+    QVERIFY(powers.threadTiers() >= std::thread::hardware_concurrency());
+
+    options.classes = PPUtils::BUFFER_CLASSES_QUARTERS;
+    PPUtils::BufferPool quarters(options);
+    QCOMPARE(quarters.classSize(129), std::size_t(160));
+    QCOMPARE(quarters.classSize(4097), std::size_t(5120));
+    QCOMPARE(quarters.classSize(6000), std::size_t(6144));
+    QCOMPARE(quarters.classSize(7169), std::size_t(8192));
+    QCOMPARE(quarters.classCount(), 53u);
+
+    PPUtils::Buffer buffer = quarters.reserve(4097);
+    QCOMPARE(buffer.size(), std::size_t(4097));
+    QCOMPARE(buffer.capacity(), std::size_t(5120));
+    QCOMPARE(reinterpret_cast<std::uintptr_t>(buffer.data()) % 64, std::uintptr_t(0));
+    buffer.resize(5120);
+    QCOMPARE(buffer.size(), std::size_t(5120));
+}
+
+
+void BufferPoolTest::reuseTest()
+{
+    PPUtils::BufferPool pool;
+    char* data = nullptr;
+    {
+        PPUtils::Buffer buffer = pool.reserve(5000);
+        data = buffer.data();
+        std::memset(data, 1, buffer.size());
+    }
+    QCOMPARE(pool.idle(), std::size_t(1));
+    QCOMPARE(pool.idleBytes(), std::size_t(5120));
+
+    PPUtils::Buffer buffer = pool.reserve(4097);
+    QVERIFY(buffer.data() == data);
+    QCOMPARE(pool.idle(), std::size_t(0));
+    buffer.reset();
+    QVERIFY(!buffer);
+
+    // Beyond thread tier: into the shared tier, then destroyed.
+    PPUtils::BufferPoolOptions options;
+    std::vector<PPUtils::Buffer> buffers;
+    for (unsigned i = 0; i < options.thread_blocks + options.shared_blocks + 10; ++i){
+        buffers.push_back(pool.reserve(100));
+    }
+    buffers.clear();
+    QCOMPARE(pool.idle(), std::size_t(options.thread_blocks + options.shared_blocks + 1));
+
+    // Larger than max_size: not pooled.
+    PPUtils::Buffer large = pool.reserve(options.max_size + 1);
+    QCOMPARE(large.capacity(), options.max_size + 1);
+    large.reset();
+    QCOMPARE(pool.idle(), std::size_t(options.thread_blocks + options.shared_blocks + 1));
+
+    pool.trim();
+    QCOMPARE(pool.idle(), std::size_t(0));
+    QCOMPARE(pool.idleBytes(), std::size_t(0));
+}
+
+
+void BufferPoolTest::sliceTest()
+{
+    PPUtils::BufferPool pool;
+    PPUtils::Buffer buffer = pool.reserve(1000);
+    QVERIFY(buffer.unique());
+    for (int i = 0; i < 1000; ++i){
+        buffer.data()[i] = char(i % 100);
+    }
+
+    PPUtils::Buffer head = buffer.slice(0, 100);
+    PPUtils::Buffer tail = buffer.slice(900, 100);
+    QVERIFY(!buffer.unique());
+    QVERIFY(head.data() == buffer.data());
+    QVERIFY(tail.data() == buffer.data() + 900);
+    QCOMPARE(tail.size(), std::size_t(100));
+    QCOMPARE(tail.capacity(), buffer.capacity() - 900);
+    QCOMPARE(int(tail.data()[50]), 50);
+
+    PPUtils::Buffer inner = tail.slice(10, 20);
+    QCOMPARE(int(inner.data()[0]), 10);
+
+    buffer.reset();
+    head = PPUtils::Buffer();
+    tail = std::move(inner);
+    QCOMPARE(pool.idle(), std::size_t(0));
+    QVERIFY(tail.unique());
+    QCOMPARE(int(tail.data()[19]), 29);
+
+    PPUtils::Buffer copy(tail);
+    copy.swap(head);
+    QVERIFY(!copy);
+    QVERIFY(head.data() == tail.data());
+    tail = head;
+    head.reset();
+    tail.reset();
+    QCOMPARE(pool.idle(), std::size_t(1));
+}
+
+
+void BufferPoolTest::hugePageTest()
+{
+    PPUtils::BufferPoolOptions options;
+    PPUtils::BufferPool pool(options);
+    const std::size_t size = 3000000;
+    QCOMPARE(pool.classSize(size), std::size_t(3 << 20));
+
+    char* data = nullptr;
+    {
+        PPUtils::Buffer buffer = pool.reserve(size);
+        data = buffer.data();
+        QCOMPARE(reinterpret_cast<std::uintptr_t>(data) % options.huge_page_size,
+                 std::uintptr_t(0));
+        std::memset(data, 7, buffer.capacity());
+    }
+    QCOMPARE(pool.idleBytes(), std::size_t(3 << 20));
+    PPUtils::Buffer buffer = pool.reserve(2900000);
+    QVERIFY(buffer.data() == data);
+    QCOMPARE(int(buffer.data()[2899999]), 7);
+}
+
+
+void BufferPoolTest::concurrentTest()
+{
+    PPUtils::BufferPoolOptions options;
+    PPUtils::BufferPool pool(options);
+    const int THREADS = 4;
+    const int BUFFERS = 2000;
+    std::vector<std::vector<PPUtils::Buffer> > slices(THREADS);
+    std::atomic<bool> overwritten(false);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t){
+        threads.push_back(std::thread([&pool, &slices, &overwritten, t]()
+        {
+            for (int i = 0; i < BUFFERS; ++i){
+                PPUtils::Buffer buffer = pool.reserve(64 + (i * 37) % 20000);
+                std::memset(buffer.data(), t + 1, buffer.size());
+                if (i % 4 == 0){
+                    slices[t].push_back(buffer.slice(buffer.size() / 2, buffer.size() / 2));
+                }
+                else if (buffer.data()[buffer.size() - 1] != char(t + 1)){
+                    overwritten = true;
+                }
+            }
+        }));
+    }
+    for (std::thread& t : threads){
+        t.join();
+    }
+    threads.clear();
+
+    // Release slices in another thread.
+    for (int t = 0; t < THREADS; ++t){
+        threads.push_back(std::thread([&slices, &overwritten, t]()
+        {
+            const int other = (t + 1) % THREADS;
+            for (PPUtils::Buffer& slice : slices[other]){
+                for (std::size_t i = 0; i < slice.size(); ++i){
+                    if (slice.data()[i] != char(other + 1)){
+                        overwritten = true;
+                    }
+                }
+                slice.reset();
+            }
+        }));
+    }
+    for (std::thread& t : threads){
+        t.join();
+    }
+    QVERIFY(!overwritten);
+    QVERIFY(pool.idle() > 0);
+    QVERIFY(pool.idle() <= (options.thread_blocks * pool.threadTiers() +
+                            options.shared_blocks) * pool.classCount());
+}
+
+
+void BufferPoolTest::lifetimeTest()
+{
+    std::unique_ptr<PPUtils::BufferPool> pool(new PPUtils::BufferPool());
+    PPUtils::Buffer small = pool->reserve(10);
+    PPUtils::Buffer huge = pool->reserve(4 << 20);
+    pool->reserve(10);
+    QCOMPARE(pool->idle(), std::size_t(1));
+    pool.reset();
+
+    std::memset(small.data(), 1, small.size());
+    std::memset(huge.data(), 2, huge.size());
+    PPUtils::Buffer slice = huge.slice(100, 100);
+    std::thread([&small, &huge]()
+    {
+        small.reset();
+        huge.reset();
+    }).join();
+    QCOMPARE(int(slice.data()[99]), 2);
+}
+
+
+QTEST_APPLESS_MAIN(BufferPoolTest)
+
+#include "tst_bufferpooltest.moc"
@@ -15,9 +15,23 @@ CONFIG   -= app_bundle
 TEMPLATE = app
 
 
-SOURCES += tst_concurrentuniformobjectpooltest.cc
+SOURCES += tst_concurrentuniformobjectpooltest.cc \
+    ../../source/PPUtils/activeobject.cc
 DEFINES += SRCDIR=\\\"$$PWD/\\\"
 
 HEADERS += \
     ../../source/PPUtils/concurrentuniformobjectpool.hh \
-    ../../source/PPUtils/concurrentuniformobjectpool_impl.hh
+    ../../source/PPUtils/concurrentuniformobjectpool_impl.hh \
+    ../../source/PPUtils/uniformobjectpool.hh \
+    ../../source/PPUtils/uniformobjectpool_impl.hh \
+    ../../source/PPUtils/pooledptr.hh \
+    ../../source/PPUtils/pooledptr_impl.hh \
+    ../../source/PPUtils/poolevictor.hh \
+    ../../source/PPUtils/poolevictor_impl.hh \
+    ../../source/PPUtils/poolcleaner.hh \
+    ../../source/PPUtils/poolcleaner_impl.hh \
+    ../../source/PPUtils/resetpolicy.hh \
+    ../../source/PPUtils/poolstatistics.hh \
+    ../../source/PPUtils/activeobject.hh
+
+INCLUDEPATH += ../../source/PPUtils
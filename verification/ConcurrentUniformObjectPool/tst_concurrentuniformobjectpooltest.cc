@@ -1,5 +1,72 @@
 #include <QString>
 #include <QtTest>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+#include "concurrentuniformobjectpool.hh"
+#include "poolevictor.hh"
+#include "poolcleaner.hh"
+
+
+// Counts live instances across threads.
+class Counted
+{
+public:
+    static std::atomic<int> live;
+    Counted() {++live;}
+    ~Counted() {--live;}
+};
+
+std::atomic<int> Counted::live(0);
+
+
+// Object that must be reset before reuse.
+class Buffer
+{
+public:
+    int used;
+    Buffer() : used(0) {}
+};
+
+// Resets a Buffer and counts resets across threads.
+class BufferReset
+{
+public:
+    std::atomic<int>* calls;
+    explicit BufferReset(std::atomic<int>* c = nullptr) : calls(c) {}
+    void operator () (Buffer& b) const
+    {
+        b.used = 0;
+        ++*calls;
+    }
+};
+
+
+// Slow reset, recording how many resets run at the same time.
+class SlowReset
+{
+public:
+    std::atomic<int>* active;
+    std::atomic<int>* peak;
+    SlowReset(std::atomic<int>* a = nullptr, std::atomic<int>* p = nullptr) :
+        active(a), peak(p) {}
+    void operator () (Buffer& b) const
+    {
+        int now = ++*active;
+        int old = peak->load();
+        while (now > old && !peak->compare_exchange_weak(old, now)){
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        b.used = 0;
+        --*active;
+    }
+};
+
 
 class ConcurrentUniformObjectPoolTest : public QObject
 {
@@ -10,6 +77,70 @@ public:
     
 private Q_SLOTS:
     void testCase1();
+    
+    /*!
+     * \brief Test reserve and release from several threads.
+     *  - Expected behaviour: Every built object ends up in the pool, and no
+     *    object is reserved by two threads at once.
+     */
+    void reserveReleaseTest();
+    
+    /*!
+     * \brief Test PooledPtrs acquired and destroyed in several threads.
+     *  - Expected behaviour: All objects return to the pool.
+     */
+    void pooledPtrTest();
+    
+    /*!
+     * \brief Test destroying the pool while other threads hold PooledPtrs.
+     *  - Expected behaviour: Remaining PooledPtrs destroy their objects, and
+     *    no object is leaked.
+     */
+    void pooledPtrOrphanTest();
+    
+    /*!
+     * \brief Test PooledPtrs destroyed in several threads with a slow
+     *  EagerReset.
+     *  - Expected behaviour: Objects are reset in parallel, outside of any
+     *    lock, and every acquired object has been reset.
+     */
+    void pooledPtrResetTest();
+    
+    /*!
+     * \brief Test idle limits while other threads use the pool.
+     *  - Expected behaviour: The pool never stores more than the limit, and
+     *    trim and evictIdle from another thread are safe.
+     */
+    void limitsTest();
+    
+    /*!
+     * \brief Test PoolEvictor.
+     *  - Expected behaviour: Idle objects are destroyed in the background
+     *    without using the pool, and the evictor stops when destroyed.
+     */
+    void evictorTest();
+    
+    /*!
+     * \brief Test prewarm while other threads use the pool.
+     *  - Expected behaviour: Every prewarmed object ends up in the pool, and
+     *    the pool stays usable while objects are being built.
+     */
+    void prewarmTest();
+    
+    /*!
+     * \brief Test BackgroundReset with a PoolCleaner while other threads use
+     *  the pool.
+     *  - Expected behaviour: Every reserved object has been reset, and the
+     *    cleaner resets objects released by the users.
+     */
+    void cleanerTest();
+    
+    /*!
+     * \brief Test statistics while other threads use the pool.
+     *  - Expected behaviour: Every reserve and release is counted, and
+     *    statistics can be read while the pool is used.
+     */
+    void statisticsTest();
 };
 
 ConcurrentUniformObjectPoolTest::ConcurrentUniformObjectPoolTest()
@@ -21,6 +152,316 @@ void ConcurrentUniformObjectPoolTest::testCase1()
     QVERIFY2(true, "Failure");
 }
 
+
+void ConcurrentUniformObjectPoolTest::reserveReleaseTest()
+{
+    std::atomic<int> built(0);
+    std::function<int*()> builder = [&built](){++built; return new int(0);};
+    PPUtils::ConcurrentUniformObjectPool<int> pool(builder);
+    std::atomic<bool> shared_use(false);
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t){
+        threads.push_back(std::thread([&pool, &shared_use]()
+        {
+            for (int i = 0; i < 10000; ++i){
+                std::unique_ptr<int> p = pool.reserve();
+                if (++*p != 1){
+                    shared_use = true;
+                }
+                --*p;
+                pool.release(std::move(p));
+            }
+        }));
+    }
+    for (std::thread& t : threads){
+        t.join();
+    }
+    QVERIFY(!shared_use);
+    QCOMPARE(int(pool.size()), built.load());
+    QVERIFY(built.load() <= 4);
+}
+
+
+void ConcurrentUniformObjectPoolTest::pooledPtrTest()
+{
+    Counted::live = 0;
+    {
+        PPUtils::ConcurrentUniformObjectPool<Counted> pool;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t){
+            threads.push_back(std::thread([&pool]()
+            {
+                for (int i = 0; i < 1000; ++i){
+                    PPUtils::PooledPtr<Counted> a = pool.acquire();
+                    PPUtils::PooledPtr<Counted> b = pool.acquire();
+                    a.swap(b);
+                }
+            }));
+        }
+        for (std::thread& t : threads){
+            t.join();
+        }
+        QCOMPARE(int(pool.size()), Counted::live.load());
+        QVERIFY(Counted::live.load() <= 8);
+    }
+    QCOMPARE(Counted::live.load(), 0);
+}
+
+
+void ConcurrentUniformObjectPoolTest::pooledPtrOrphanTest()
+{
+    Counted::live = 0;
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    {
+        PPUtils::ConcurrentUniformObjectPool<Counted> pool;
+        for (int t = 0; t < 4; ++t){
+            std::shared_ptr<PPUtils::PooledPtr<Counted> > held(
+                        new PPUtils::PooledPtr<Counted>(pool.acquire()));
+            threads.push_back(std::thread([held, &go]()
+            {
+                while (!go){
+                    std::this_thread::yield();
+                }
+                held->reset();
+            }));
+        }
+        go = true;
+    }
+    for (std::thread& t : threads){
+        t.join();
+    }
+    QCOMPARE(Counted::live.load(), 0);
+}
+
+
+void ConcurrentUniformObjectPoolTest::pooledPtrResetTest()
+{
+    typedef PPUtils::ConcurrentUniformObjectPool<
+            Buffer, std::function<Buffer*()>, PPUtils::EagerReset<SlowReset> > Pool;
+    std::atomic<int> active(0);
+    std::atomic<int> peak(0);
+    std::atomic<bool> dirty_seen(false);
+    Pool pool(Pool::DEFAULT_BUILDER, 0,
+              PPUtils::EagerReset<SlowReset>(SlowReset(&active, &peak)));
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t){
+        threads.push_back(std::thread([&pool, &dirty_seen]()
+        {
+            for (int i = 0; i < 20; ++i){
+                PPUtils::PooledPtr<Buffer> b = pool.acquire();
+                if (b->used != 0){
+                    dirty_seen = true;
+                }
+                b->used = i + 1;
+            }
+        }));
+    }
+    for (std::thread& t : threads){
+        t.join();
+    }
+    QVERIFY(!dirty_seen);
+    QCOMPARE(active.load(), 0);
+    QVERIFY(peak.load() > 1);
+}
+
+
+void ConcurrentUniformObjectPoolTest::limitsTest()
+{
+    Counted::live = 0;
+    {
+        PPUtils::ConcurrentUniformObjectPool<Counted> pool;
+        pool.setMaxIdle(4);
+        pool.setMaxIdleTime(std::chrono::milliseconds(1));
+        std::atomic<bool> done(false);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t){
+            threads.push_back(std::thread([&pool]()
+            {
+                for (int i = 0; i < 2000; ++i){
+                    std::unique_ptr<Counted> a = pool.reserve();
+                    std::unique_ptr<Counted> b = pool.reserve();
+                    pool.release(std::move(a));
+                    pool.release(std::move(b));
+                }
+            }));
+        }
+        std::thread trimmer([&pool, &done]()
+        {
+            while (!done){
+                pool.trim(2);
+                pool.evictIdle();
+                std::this_thread::yield();
+            }
+        });
+        for (std::thread& t : threads){
+            t.join();
+        }
+        done = true;
+        trimmer.join();
+        QVERIFY(pool.size() <= 4u);
+        QCOMPARE(Counted::live.load(), int(pool.size()));
+    }
+    QCOMPARE(Counted::live.load(), 0);
+}
+
+
+void ConcurrentUniformObjectPoolTest::evictorTest()
+{
+    Counted::live = 0;
+    PPUtils::ConcurrentUniformObjectPool<Counted> pool;
+    pool.setMaxIdleTime(std::chrono::milliseconds(20));
+    {
+        PPUtils::PoolEvictor<PPUtils::ConcurrentUniformObjectPool<Counted> >
+                evictor(pool, std::chrono::milliseconds(10));
+        evictor.start();
+        for (int i = 0; i < 5; ++i){
+            pool.release(std::unique_ptr<Counted>(new Counted()));
+        }
+        QCOMPARE(Counted::live.load(), 5);
+        
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (Counted::live.load() > 0 && std::chrono::steady_clock::now() < deadline){
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        QCOMPARE(Counted::live.load(), 0);
+        QCOMPARE(evictor.evicted(), 5ul);
+    }
+    // Evictor has stopped: objects stay.
+    QCOMPARE(pool.size(), 0u);
+    pool.release(std::unique_ptr<Counted>(new Counted()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    QCOMPARE(pool.size(), 1u);
+}
+
+
+void ConcurrentUniformObjectPoolTest::prewarmTest()
+{
+    Counted::live = 0;
+    {
+        PPUtils::ConcurrentUniformObjectPool<Counted> pool(
+                    PPUtils::ConcurrentUniformObjectPool<Counted>::DEFAULT_BUILDER, 10);
+        std::atomic<bool> done(false);
+        std::thread user([&pool, &done]()
+        {
+            while (!done){
+                pool.release(pool.reserve());
+            }
+        });
+        pool.prewarm(1000, 4);
+        done = true;
+        user.join();
+        QVERIFY(pool.size() >= 1010u);
+        QCOMPARE(Counted::live.load(), int(pool.size()));
+    }
+    QCOMPARE(Counted::live.load(), 0);
+}
+
+
+void ConcurrentUniformObjectPoolTest::cleanerTest()
+{
+    typedef PPUtils::ConcurrentUniformObjectPool<
+            Buffer, std::function<Buffer*()>, PPUtils::BackgroundReset<BufferReset> > Pool;
+    std::atomic<int> calls(0);
+    Pool pool(Pool::DEFAULT_BUILDER, 0,
+              PPUtils::BackgroundReset<BufferReset>(BufferReset(&calls)));
+    std::atomic<bool> dirty_seen(false);
+    {
+        PPUtils::PoolCleaner<Pool> cleaner(pool);
+        cleaner.start();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t){
+            threads.push_back(std::thread([&pool, &dirty_seen]()
+            {
+                for (int i = 0; i < 2000; ++i){
+                    std::unique_ptr<Buffer> b = pool.reserve();
+                    if (b->used != 0){
+                        dirty_seen = true;
+                    }
+                    b->used = i + 1;
+                    pool.release(std::move(b));
+                }
+            }));
+        }
+        for (std::thread& t : threads){
+            t.join();
+        }
+        
+        // Last released objects are reset by the cleaner.
+        pool.release(std::unique_ptr<Buffer>(new Buffer()));
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (cleaner.cleaned() == 0 && std::chrono::steady_clock::now() < deadline){
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        QVERIFY(cleaner.cleaned() > 0);
+    }
+    QVERIFY(!dirty_seen);
+    // Resets were done by the cleaner or by reserve.
+    QVERIFY(calls.load() >= int(8000 - pool.size()));
+}
+
+
+void ConcurrentUniformObjectPoolTest::statisticsTest()
+{
+    PPUtils::ConcurrentUniformObjectPool<Counted> pool;
+    pool.enableStatistics();
+    std::atomic<bool> done(false);
+    std::thread reader([&pool, &done]()
+    {
+        while (!done){
+            PPUtils::PoolStatistics stats = pool.statistics();
+            if (stats.hits > stats.reserves){
+                break;
+            }
+            std::this_thread::yield();
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t){
+        threads.push_back(std::thread([&pool]()
+        {
+            for (int i = 0; i < 2000; ++i){
+                std::unique_ptr<Counted> a = pool.reserve();
+                std::unique_ptr<Counted> b = pool.reserve();
+                pool.release(std::move(a));
+                pool.release(std::move(b));
+            }
+        }));
+    }
+    for (std::thread& t : threads){
+        t.join();
+    }
+    done = true;
+    reader.join();
+    
+    PPUtils::PoolStatistics stats = pool.statistics();
+    QCOMPARE(stats.reserves, std::uint64_t(16000));
+    QCOMPARE(stats.releases, std::uint64_t(16000));
+    QCOMPARE(stats.hits + stats.misses, stats.reserves);
+    // Every built object is in the pool.
+    QCOMPARE(stats.misses, std::uint64_t(pool.size()));
+    QCOMPARE(stats.idle, std::uint64_t(pool.size()));
+    QCOMPARE(stats.outstanding, std::uint64_t(0));
+    QVERIFY(stats.outstanding_high_water >= 2 && stats.outstanding_high_water <= 8);
+    QVERIFY(stats.idle_high_water >= stats.idle && stats.idle_high_water <= 8);
+    std::uint64_t builds = 0;
+    for (std::uint64_t count : stats.builder_latency){
+        builds += count;
+    }
+    QCOMPARE(builds, stats.misses);
+    
+    // Objects rejected by the validator are not left outstanding.
+    pool.setValidator([](Counted&){return false;});
+    std::unique_ptr<Counted> c = pool.reserve();
+    stats = pool.statistics();
+    QCOMPARE(stats.outstanding, std::uint64_t(1));
+    QCOMPARE(stats.idle, std::uint64_t(0));
+    pool.release(std::move(c));
+    QCOMPARE(pool.statistics().outstanding, std::uint64_t(0));
+}
+
 QTEST_APPLESS_MAIN(ConcurrentUniformObjectPoolTest)
 
 #include "tst_concurrentuniformobjectpooltest.moc"
@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Unit tests for PPUtils::ExternalSorter.
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_externalsorttest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += tst_externalsorttest.cc \
+           ../../source/PPUtils/parallel.cc
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+HEADERS += \
+    ../../source/PPUtils/externalsort.hh \
+    ../../source/PPUtils/externalsort_impl.hh \
+    ../../source/PPUtils/algo.hh \
+    ../../source/PPUtils/algo_impl.hh \
+    ../../source/PPUtils/parallel.hh \
+    ../../source/PPUtils/parallel_impl.hh
+
+INCLUDEPATH += ../../source/PPUtils
@@ -0,0 +1,192 @@
+#include <QString>
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QDir>
+#include <vector>
+#include <random>
+#include <iterator>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+
+#include "externalsort.hh"
+
+
+// Test record. Only key takes part in comparisons.
+struct Record
+{
+    std::uint32_t key;
+    std::uint32_t position;
+};
+
+struct RecordLess
+{
+    bool operator()(const Record& a, const Record& b) const
+    {
+        return a.key < b.key;
+    }
+};
+
+
+class ExternalSortTest : public QObject
+{
+    Q_OBJECT
+    
+public:
+    ExternalSortTest();
+    
+private Q_SLOTS:
+    
+    /*!
+     * \brief Test sorting an iterator range.
+     *  - Act: Sort records with different memory budgets.
+     *  - Expected behaviour: Output equals std::stable_sort result, and no 
+     *    temporary files are left behind.
+     */
+    void iteratorSortTest();
+    void iteratorSortTest_data();
+    
+    /*!
+     * \brief Test sorting a file with several merge passes.
+     *  - Act: Write a file, sort it with externalSort and a small budget.
+     *  - Expected behaviour: Output file has the input records in order.
+     */
+    void fileSortTest();
+    
+    /*!
+     * \brief Test that a missing input file is reported.
+     *  - Expected behaviour: std::runtime_error is thrown.
+     */
+    void missingFileTest();
+    
+    /*!
+     * \brief Test that chunks do not grow beyond their record limit.
+     *  - Act: Fill a chunk from a source with more records than the limit.
+     *  - Expected behaviour: Chunk holds limit records, and its capacity does
+     *    not exceed the limit.
+     */
+    void chunkCapacityTest();
+    
+    
+private:
+    
+    QTemporaryDir dir_;
+};
+
+
+ExternalSortTest::ExternalSortTest() : dir_()
+{
+}
+
+
+void ExternalSortTest::iteratorSortTest()
+{
+    QFETCH(int, width);
+    QFETCH(int, budget);
+    
+    std::vector<Record> expected;
+    std::default_random_engine gen(width);
+    for (int i=0; i<width; ++i){
+        Record r = {std::uint32_t(gen() % 1000), std::uint32_t(i)};
+        expected.push_back(r);
+    }
+    
+    PPUtils::ExternalSorter<Record, RecordLess> sorter(budget, 
+                                                       dir_.path().toStdString(),
+                                                       4);
+    std::vector<Record> result;
+    sorter.sort(expected.begin(), expected.end(), std::back_inserter(result));
+    std::stable_sort(expected.begin(), expected.end(), RecordLess());
+    
+    QCOMPARE(result.size(), expected.size());
+    for (unsigned i=0; i<result.size(); ++i){
+        QCOMPARE(result[i].position, expected[i].position);
+    }
+    QVERIFY(QDir(dir_.path()).entryList(QDir::Files).isEmpty());
+}
+
+
+void ExternalSortTest::iteratorSortTest_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("budget");
+    
+    QTest::newRow("empty") << 0 << (1 << 20);
+    QTest::newRow("fits into memory") << 10000 << (1 << 20);
+    QTest::newRow("one merge pass") << 200000 << (1 << 20);
+    QTest::newRow("several merge passes") << 200000 << (64 << 10);
+}
+
+
+void ExternalSortTest::fileSortTest()
+{
+    std::vector<std::uint64_t> data(1000000);
+    std::mt19937_64 gen;
+    for (std::uint64_t& d : data){
+        d = gen();
+    }
+    std::string input = dir_.filePath("input.bin").toStdString();
+    std::string output = dir_.filePath("output.bin").toStdString();
+    std::FILE* f = std::fopen(input.c_str(), "wb");
+    QVERIFY(f != nullptr);
+    QCOMPARE(std::fwrite(data.data(), 8, data.size(), f), data.size());
+    std::fclose(f);
+    
+    std::string temp = dir_.filePath("runs").toStdString();
+    QVERIFY(QDir(dir_.path()).mkdir("runs"));
+    PPUtils::externalSort<std::uint64_t>(input, output, 1 << 20, temp);
+    
+    std::vector<std::uint64_t> result(data.size() + 1);
+    f = std::fopen(output.c_str(), "rb");
+    QVERIFY(f != nullptr);
+    result.resize(std::fread(result.data(), 8, result.size(), f));
+    std::fclose(f);
+    
+    std::sort(data.begin(), data.end());
+    QVERIFY(result == data);
+    QVERIFY(QDir(dir_.filePath("runs")).entryList(QDir::Files).isEmpty());
+}
+
+
+void ExternalSortTest::missingFileTest()
+{
+    std::string input = dir_.filePath("missing.bin").toStdString();
+    std::string output = dir_.filePath("missing_out.bin").toStdString();
+    QVERIFY_EXCEPTION_THROWN(PPUtils::externalSort<int>(input, output),
+                             std::runtime_error);
+}
+
+
+void ExternalSortTest::chunkCapacityTest()
+{
+    // Source of consecutive integers.
+    struct Counter
+    {
+        int next;
+        std::size_t read(int* data, std::size_t n)
+        {
+            for (std::size_t i=0; i<n; ++i){
+                data[i] = next++;
+            }
+            return n;
+        }
+    };
+    
+    const std::size_t limit = 100000;
+    Counter source = {0};
+    std::vector<int> chunk;
+    PPUtils::detail::fillChunk(source, chunk, limit);
+    QCOMPARE(chunk.size(), limit);
+    QVERIFY(chunk.capacity() <= limit);
+    QCOMPARE(chunk.back(), int(limit) - 1);
+    
+    // Reused chunk stays within the limit.
+    PPUtils::detail::fillChunk(source, chunk, limit);
+    QVERIFY(chunk.capacity() <= limit);
+    QCOMPARE(chunk.front(), int(limit));
+}
+
+
+QTEST_APPLESS_MAIN(ExternalSortTest)
+
+#include "tst_externalsorttest.moc"
@@ -0,0 +1,34 @@
+#-------------------------------------------------
+#
+# Unit tests for PPUtils::MappedArena and PPUtils::ArenaObject.
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_mappedarenatest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += tst_mappedarenatest.cc \
+           ../../source/PPUtils/mappedarena.cc
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+HEADERS += \
+    ../../source/PPUtils/mappedarena.hh \
+    ../../source/PPUtils/mappedarena_impl.hh \
+    ../../source/PPUtils/uniformobjectpool.hh \
+    ../../source/PPUtils/uniformobjectpool_impl.hh \
+    ../../source/PPUtils/objectpool.hh \
+    ../../source/PPUtils/objectpool_impl.hh \
+    ../../source/PPUtils/pooledptr.hh \
+    ../../source/PPUtils/pooledptr_impl.hh \
+    ../../source/PPUtils/resetpolicy.hh \
+    ../../source/PPUtils/poolstatistics.hh
+
+INCLUDEPATH += ../../source/PPUtils
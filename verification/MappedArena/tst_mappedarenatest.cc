@@ -0,0 +1,285 @@
+#include <QString>
+#include <QtTest>
+#include <vector>
+#include <set>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#include "mappedarena.hh"
+#include "uniformobjectpool.hh"
+#include "objectpool.hh"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+// Object placed in an arena.
+struct Node : PPUtils::ArenaObject<Node>
+{
+    Node() : key(0) {}
+    virtual ~Node() {}
+    int key;
+    char data[52];
+};
+
+// Subclass of a different size.
+struct WideNode : Node
+{
+    char more[64];
+};
+
+struct NodeBuilder
+{
+    Node* operator()(int key) const
+    {
+        Node* node = new Node();
+        node->key = key;
+        return node;
+    }
+};
+
+struct NodeSelector
+{
+    int operator()(const Node* node) const {return node->key;}
+    int operator()(int key) const {return key;}
+};
+
+
+#ifdef __linux__
+// Returns number of resident pages in [data, data + bytes).
+std::size_t residentPages(const char* data, std::size_t bytes)
+{
+    const std::size_t page = sysconf(_SC_PAGESIZE);
+    std::vector<unsigned char> pages((bytes + page - 1) / page);
+    if (mincore(const_cast<char*>(data), bytes, pages.data()) != 0){
+        return 0;
+    }
+    return std::count_if(pages.begin(), pages.end(),
+                         [](unsigned char p){return (p & 1) != 0;});
+}
+#endif
+
+
+class MappedArenaTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    MappedArenaTest();
+
+private Q_SLOTS:
+
+    /*!
+     * \brief Test mapping arenas on each kind of pages.
+     *  - Expected behaviour: The arena gets the requested pages or a weaker
+     *    kind, is large enough and writable, and huge page arenas are aligned
+     *    to the huge page size.
+     */
+    void mappingTest();
+
+    /*!
+     * \brief Test allocating from an arena, also from several threads.
+     *  - Expected behaviour: Allocations are aligned and do not overlap, and
+     *    std::bad_alloc is thrown when the arena is full.
+     */
+    void allocateTest();
+
+    /*!
+     * \brief Test prefaulting an arena with populate.
+     *  - Expected behaviour: All pages are resident after construction, and
+     *    none without populate.
+     */
+    void populateTest();
+
+    /*!
+     * \brief Test ArenaObject with UniformObjectPool and ObjectPool.
+     *  - Expected behaviour: Pooled objects are placed in the arena, memory
+     *    of destroyed objects is reused, and objects are allocated from the
+     *    heap when there is no arena, the arena is full, or for subclasses.
+     */
+    void arenaObjectTest();
+};
+
+
+MappedArenaTest::MappedArenaTest()
+{
+}
+
+
+void MappedArenaTest::mappingTest()
+{
+    for (PPUtils::ArenaPages pages : {PPUtils::ARENA_PAGES_NORMAL,
+                                      PPUtils::ARENA_PAGES_TRANSPARENT,
+                                      PPUtils::ARENA_PAGES_HUGETLB}){
+        PPUtils::MappedArenaOptions options;
+        options.bytes = (5 << 20) + 1;
+        options.pages = pages;
+        PPUtils::MappedArena arena(options);
+        QVERIFY(arena.pages() <= pages);
+        QVERIFY(arena.size() >= options.bytes);
+        QCOMPARE(arena.used(), std::size_t(0));
+
+        char* data = static_cast<char*>(arena.allocate(arena.size(), 1));
+        std::memset(data, 1, arena.size());
+        QCOMPARE(int(data[arena.size() - 1]), 1);
+        if (arena.pages() != PPUtils::ARENA_PAGES_NORMAL){
+            QCOMPARE(reinterpret_cast<std::uintptr_t>(data) % options.huge_page_size,
+                     std::uintptr_t(0));
+            QCOMPARE(arena.size(), std::size_t(6 << 20));
+        }
+    }
+}
+
+
+void MappedArenaTest::allocateTest()
+{
+    PPUtils::MappedArenaOptions options;
+    options.bytes = 1 << 20;
+    options.pages = PPUtils::ARENA_PAGES_NORMAL;
+    PPUtils::MappedArena arena(options);
+
+    char* a = static_cast<char*>(arena.allocate(3, 1));
+    char* b = static_cast<char*>(arena.allocate(8, 64));
+    QCOMPARE(reinterpret_cast<std::uintptr_t>(b) % 64, std::uintptr_t(0));
+    QVERIFY(b >= a + 3);
+    QVERIFY(arena.contains(a));
+    QVERIFY(arena.contains(b + 7));
+    int local = 0;
+    QVERIFY(!arena.contains(&local));
+
+    bool thrown = false;
+    try {
+        arena.allocate(arena.size(), 1);
+    }
+    catch (const std::bad_alloc&){
+        thrown = true;
+    }
+    QVERIFY(thrown);
+    QVERIFY(arena.used() <= 128);
+
+    // Concurrent allocations do not overlap.
+    std::vector<std::vector<char*> > blocks(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t){
+        threads.push_back(std::thread([&arena, &blocks, t]()
+        {
+            for (int i = 0; i < 1000; ++i){
+                char* p = static_cast<char*>(arena.allocate(48, 16));
+                std::memset(p, t, 48);
+                blocks[t].push_back(p);
+            }
+        }));
+    }
+    for (std::thread& t : threads){
+        t.join();
+    }
+    std::set<char*> all;
+    for (int t = 0; t < 4; ++t){
+        for (char* p : blocks[t]){
+            QCOMPARE(reinterpret_cast<std::uintptr_t>(p) % 16, std::uintptr_t(0));
+            QCOMPARE(int(p[47]), t);
+            all.insert(p);
+        }
+    }
+    QCOMPARE(all.size(), std::size_t(4000));
+    char* previous = nullptr;
+    for (char* p : all){
+        QVERIFY(previous == nullptr || p >= previous + 48);
+        previous = p;
+    }
+}
+
+
+void MappedArenaTest::populateTest()
+{
+#ifdef __linux__
+    PPUtils::MappedArenaOptions options;
+    options.bytes = 4 << 20;
+    options.pages = PPUtils::ARENA_PAGES_NORMAL;
+    PPUtils::MappedArena lazy(options);
+    const char* data = static_cast<const char*>(lazy.allocate(lazy.size(), 1));
+    QCOMPARE(residentPages(data, lazy.size()), std::size_t(0));
+
+    const std::size_t page = sysconf(_SC_PAGESIZE);
+    for (PPUtils::ArenaPages pages : {PPUtils::ARENA_PAGES_NORMAL,
+                                      PPUtils::ARENA_PAGES_TRANSPARENT}){
+        options.pages = pages;
+        options.populate = true;
+        PPUtils::MappedArena populated(options);
+        data = static_cast<const char*>(populated.allocate(populated.size(), 1));
+        QCOMPARE(residentPages(data, populated.size()), populated.size() / page);
+    }
+#endif
+}
+
+
+void MappedArenaTest::arenaObjectTest()
+{
+    // No arena: heap.
+    Node* heap = new Node();
+    QVERIFY(PPUtils::ArenaObject<Node>::arena() == nullptr);
+
+    PPUtils::MappedArenaOptions options;
+    options.bytes = 1 << 20;
+    PPUtils::MappedArena arena(options);
+    PPUtils::ArenaObject<Node>::setArena(&arena);
+    QVERIFY(!arena.contains(heap));
+    delete heap;
+
+    {
+        PPUtils::UniformObjectPool<Node> pool;
+        std::vector<std::unique_ptr<Node> > reserved;
+        for (int i = 0; i < 1000; ++i){
+            reserved.push_back(pool.reserve());
+            QVERIFY(arena.contains(reserved.back().get()));
+        }
+        Node* first = reserved.front().get();
+        for (std::unique_ptr<Node>& node : reserved){
+            pool.release(std::move(node));
+        }
+        pool.clear();
+
+        // Memory of destroyed objects is reused before the arena grows.
+        const std::size_t used = arena.used();
+        std::set<Node*> nodes;
+        for (int i = 0; i < 1000; ++i){
+            reserved[i] = pool.reserve();
+            nodes.insert(reserved[i].get());
+        }
+        QCOMPARE(arena.used(), used);
+        QVERIFY(nodes.count(first) == 1);
+    }
+
+    {
+        PPUtils::ObjectPool<Node, NodeBuilder, int, NodeSelector> pool;
+        std::unique_ptr<Node> node = pool.reserve(7);
+        QCOMPARE(node->key, 7);
+        QVERIFY(arena.contains(node.get()));
+        pool.release(std::move(node));
+    }
+
+    // Subclasses of another size use the heap.
+    std::unique_ptr<Node> wide(new WideNode());
+    QVERIFY(!arena.contains(wide.get()));
+    wide.reset();
+
+    // Full arena: heap.
+    std::vector<std::unique_ptr<Node> > nodes;
+    do {
+        nodes.push_back(std::unique_ptr<Node>(new Node()));
+    } while (arena.contains(nodes.back().get()));
+    QVERIFY(nodes.size() >= arena.size() / sizeof(Node) - 1);
+    QVERIFY(arena.size() - arena.used() < sizeof(Node));
+    nodes.clear();
+
+    PPUtils::ArenaObject<Node>::setArena(nullptr);
+}
+
+
+QTEST_APPLESS_MAIN(MappedArenaTest)
+
+#include "tst_mappedarenatest.moc"
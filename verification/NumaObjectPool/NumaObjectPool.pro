@@ -0,0 +1,28 @@
+#-------------------------------------------------
+#
+# Unit tests for PPUtils::NumaUniformObjectPool and PPUtils::NumaTopology.
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_numaobjectpooltest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += tst_numaobjectpooltest.cc \
+           ../../source/PPUtils/numatopology.cc
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+HEADERS += \
+    ../../source/PPUtils/numaobjectpool.hh \
+    ../../source/PPUtils/numaobjectpool_impl.hh \
+    ../../source/PPUtils/numatopology.hh \
+    ../../source/PPUtils/poolstatistics.hh
+
+INCLUDEPATH += ../../source/PPUtils
@@ -0,0 +1,317 @@
+#include <QString>
+#include <QtTest>
+#include <vector>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+#include "numaobjectpool.hh"
+
+
+// Node of the calling thread in the simulated topologies.
+thread_local unsigned simulated_node = 0;
+
+unsigned simulatedNode()
+{
+    return simulated_node;
+}
+
+
+struct Item
+{
+    Item() : home(simulated_node), value(0) {}
+    unsigned home;      // Node that built the item.
+    int value;
+};
+
+typedef PPUtils::NumaUniformObjectPool<Item> Pool;
+
+
+class NumaObjectPoolTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    NumaObjectPoolTest();
+
+private Q_SLOTS:
+
+    /*!
+     * \brief Test system and simulated topologies, and NumaBinding.
+     *  - Expected behaviour: The system topology has at least one node and
+     *    the current node is within range. Simulated topologies report the
+     *    given nodes and distances, and do not bind memory.
+     */
+    void topologyTest();
+
+    /*!
+     * \brief Test reserving and releasing on two simulated nodes.
+     *  - Expected behaviour: Objects are built on the reserving thread's
+     *    node, return to their home node also when released on another node,
+     *    and are reused on their home node.
+     */
+    void localityTest();
+
+    /*!
+     * \brief Test destroying reserved objects instead of releasing them.
+     *  - Act: Destroy an object reserved on node 1, reserve on node 0, which
+     *    may reuse the address, and release that object on node 1.
+     *  - Expected behaviour: Object returns to node 0, which built it.
+     */
+    void destroyedObjectTest();
+
+    /*!
+     * \brief Test taking objects of other nodes.
+     *  - Expected behaviour: Other nodes are used only when the local list
+     *    is empty, nearest node first, and not at all if stealing is off.
+     */
+    void stealTest();
+
+    /*!
+     * \brief Test per-node statistics and prewarm.
+     *  - Expected behaviour: Hits and misses are counted on the reserving
+     *    node, idle and outstanding objects on the home node.
+     */
+    void statisticsTest();
+
+    /*!
+     * \brief Test threads of two simulated nodes sharing objects.
+     *  - Expected behaviour: No object is reserved twice, and every object
+     *    ends up on the free list of its home node.
+     */
+    void concurrentTest();
+};
+
+
+NumaObjectPoolTest::NumaObjectPoolTest()
+{
+}
+
+
+void NumaObjectPoolTest::topologyTest()
+{
+    const PPUtils::NumaTopology& system = PPUtils::NumaTopology::system();
+    QVERIFY(system.nodeCount() >= 1);
+    QVERIFY(!system.simulated());
+    QVERIFY(system.currentNode() < system.nodeCount());
+    QCOMPARE(system.distance(0, 0), 10u);
+    {
+        // May or may not bind, but memory stays usable.
+        PPUtils::NumaBinding binding(system, system.currentNode());
+        std::unique_ptr<char[]> memory(new char[1 << 20]);
+        memory[(1 << 20) - 1] = 1;
+        QCOMPARE(int(memory[(1 << 20) - 1]), 1);
+    }
+
+    PPUtils::NumaTopology simulated(3, &simulatedNode, 30);
+    QVERIFY(simulated.simulated());
+    QCOMPARE(simulated.nodeCount(), 3u);
+    QCOMPARE(simulated.distance(1, 1), 10u);
+    QCOMPARE(simulated.distance(1, 2), 30u);
+    simulated_node = 2;
+    QCOMPARE(simulated.currentNode(), 2u);
+    PPUtils::NumaBinding binding(simulated, 1);
+    QVERIFY(!binding.bound());
+    simulated_node = 0;
+}
+
+
+void NumaObjectPoolTest::localityTest()
+{
+    Pool pool(Pool::DEFAULT_BUILDER, PPUtils::NumaTopology(2, &simulatedNode));
+
+    simulated_node = 0;
+    Pool::Pointer a = pool.reserve();
+    simulated_node = 1;
+    Pool::Pointer b = pool.reserve();
+    QCOMPARE(a->home, 0u);
+    QCOMPARE(b->home, 1u);
+    Item* a_address = a.get();
+
+    // Released on node 1, but returns to node 0.
+    pool.release(std::move(a));
+    QCOMPARE(pool.size(0), std::size_t(1));
+    QCOMPARE(pool.size(1), std::size_t(0));
+    pool.release(std::move(b));
+    QCOMPARE(pool.size(1), std::size_t(1));
+    QCOMPARE(pool.size(), std::size_t(2));
+
+    simulated_node = 0;
+    a = pool.reserve();
+    QVERIFY(a.get() == a_address);
+    QCOMPARE(pool.size(0), std::size_t(0));
+
+    // Objects not built by the pool are adopted by the releasing node.
+    simulated_node = 1;
+    pool.release(std::unique_ptr<Item>(new Item()));
+    QCOMPARE(pool.size(1), std::size_t(2));
+
+    pool.release(std::move(a));
+    pool.clear();
+    QCOMPARE(pool.size(), std::size_t(0));
+    simulated_node = 0;
+}
+
+
+void NumaObjectPoolTest::destroyedObjectTest()
+{
+    Pool pool(Pool::DEFAULT_BUILDER, PPUtils::NumaTopology(2, &simulatedNode));
+
+    simulated_node = 1;
+    Pool::Pointer destroyed = pool.reserve();
+    QCOMPARE(destroyed.get_deleter().node(), 1u);
+    destroyed.reset();
+
+    simulated_node = 0;
+    Pool::Pointer object = pool.reserve();
+    QCOMPARE(object.get_deleter().node(), 0u);
+    simulated_node = 1;
+    pool.release(std::move(object));
+    QCOMPARE(pool.size(0), std::size_t(1));
+    QCOMPARE(pool.size(1), std::size_t(0));
+
+    // Pointers without a home node are adopted by the releasing node.
+    pool.release(Pool::Pointer(new Item()));
+    QCOMPARE(pool.size(1), std::size_t(1));
+    simulated_node = 0;
+}
+
+
+void NumaObjectPoolTest::stealTest()
+{
+    Pool pool(Pool::DEFAULT_BUILDER, PPUtils::NumaTopology(3, &simulatedNode));
+    pool.prewarm(1, 1);
+    pool.prewarm(2, 1);
+    QCOMPARE(pool.size(), std::size_t(2));
+
+    // Local list is empty: take from another node.
+    simulated_node = 0;
+    Pool::Pointer first = pool.reserve();
+    QCOMPARE(pool.size(1), std::size_t(0));
+    pool.release(std::move(first));
+    QCOMPARE(pool.size(1), std::size_t(1));
+
+    // Node 0 has an object of its own: it is preferred.
+    pool.release(std::unique_ptr<Item>(new Item()));
+    Pool::Pointer own = pool.reserve();
+    QCOMPARE(own->home, 0u);
+    QCOMPARE(pool.size(1), std::size_t(1));
+    QCOMPARE(pool.size(2), std::size_t(1));
+
+    pool.setStealing(false);
+    Pool::Pointer built = pool.reserve();
+    QCOMPARE(built->home, 0u);
+    QCOMPARE(pool.size(), std::size_t(2));
+
+    pool.setStealing(true);
+    Pool::Pointer second = pool.reserve();
+    QCOMPARE(pool.size(0), std::size_t(0));
+    QCOMPARE(pool.size(1) + pool.size(2), std::size_t(1));
+
+    std::vector<PPUtils::NumaNodeStatistics> stats = pool.nodeStatistics();
+    QCOMPARE(stats.size(), std::size_t(3));
+    QCOMPARE(stats[0].steals, std::uint64_t(2));
+    QCOMPARE(stats[0].stolen, std::uint64_t(0));
+    QCOMPARE(stats[1].stolen + stats[2].stolen, std::uint64_t(2));
+    QCOMPARE(stats[1].steals + stats[2].steals, std::uint64_t(0));
+
+    // Stolen objects return to their home nodes.
+    pool.release(std::move(second));
+    QCOMPARE(pool.size(1), std::size_t(1));
+    QCOMPARE(pool.size(2), std::size_t(1));
+    pool.release(std::move(own));
+    pool.release(std::move(built));
+    QCOMPARE(pool.size(0), std::size_t(2));
+}
+
+
+void NumaObjectPoolTest::statisticsTest()
+{
+    Pool pool(Pool::DEFAULT_BUILDER, PPUtils::NumaTopology(2, &simulatedNode));
+    pool.prewarm(1, 1);
+    pool.enableStatistics();
+
+    simulated_node = 0;
+    Pool::Pointer stolen = pool.reserve();
+    Pool::Pointer built = pool.reserve();
+    simulated_node = 1;
+    pool.release(std::move(built));
+
+    std::vector<PPUtils::NumaNodeStatistics> stats = pool.nodeStatistics();
+    QCOMPARE(stats[0].pool.reserves, std::uint64_t(2));
+    QCOMPARE(stats[0].pool.hits, std::uint64_t(1));
+    QCOMPARE(stats[0].pool.misses, std::uint64_t(1));
+    QCOMPARE(stats[0].pool.releases, std::uint64_t(1));
+    QCOMPARE(stats[0].pool.idle, std::uint64_t(1));
+    QCOMPARE(stats[0].pool.outstanding, std::uint64_t(0));
+    QCOMPARE(stats[1].pool.reserves, std::uint64_t(0));
+    QCOMPARE(stats[1].pool.outstanding, std::uint64_t(1));
+    QCOMPARE(stats[1].pool.idle_high_water, std::uint64_t(1));
+    QCOMPARE(stats[1].stolen, std::uint64_t(1));
+
+    pool.release(std::move(stolen));
+    pool.enableStatistics(false);
+    stats = pool.nodeStatistics();
+    QCOMPARE(stats[1].pool.reserves, std::uint64_t(0));
+    QCOMPARE(stats[1].stolen, std::uint64_t(1));
+    simulated_node = 0;
+}
+
+
+void NumaObjectPoolTest::concurrentTest()
+{
+    Pool pool(Pool::DEFAULT_BUILDER, PPUtils::NumaTopology(2, &simulatedNode));
+    pool.enableStatistics();
+    std::atomic<bool> shared_object(false);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; ++t){
+        threads.push_back(std::thread([&pool, &shared_object, t]()
+        {
+            simulated_node = t % 2;
+            std::vector<Pool::Pointer> held;
+            for (int i = 0; i < 5000; ++i){
+                held.push_back(pool.reserve());
+                if (held.back()->value == -1){
+                    shared_object = true;
+                }
+                held.back()->value = -1;
+                if (i % 3 != 0){
+                    held.back()->value = 0;
+                    pool.release(std::move(held.back()));
+                    held.pop_back();
+                }
+            }
+            for (Pool::Pointer& item : held){
+                item->value = 0;
+                pool.release(std::move(item));
+            }
+        }));
+    }
+    for (std::thread& t : threads){
+        t.join();
+    }
+    QVERIFY(!shared_object);
+
+    std::vector<PPUtils::NumaNodeStatistics> stats = pool.nodeStatistics();
+    QCOMPARE(stats[0].pool.outstanding + stats[1].pool.outstanding, std::uint64_t(0));
+    QCOMPARE(stats[0].pool.reserves + stats[1].pool.reserves, std::uint64_t(20000));
+    QCOMPARE(pool.size(), std::size_t(stats[0].pool.misses + stats[1].pool.misses));
+
+    // Every object is on the list of its home node.
+    for (unsigned node = 0; node < 2; ++node){
+        simulated_node = node;
+        pool.setStealing(false);
+        while (pool.size(node) > 0){
+            Pool::Pointer item = pool.reserve();
+            QCOMPARE(item->home, node);
+        }
+    }
+    simulated_node = 0;
+}
+
+
+QTEST_APPLESS_MAIN(NumaObjectPoolTest)
+
+#include "tst_numaobjectpooltest.moc"
@@ -20,6 +20,9 @@ DEFINES += SRCDIR=\\\"$$PWD/\\\"
 
 HEADERS += \
     ../../source/PPUtils/objectpool.hh \
-    ../../source/PPUtils/objectpool_impl.hh
+    ../../source/PPUtils/objectpool_impl.hh \
+    ../../source/PPUtils/pooledptr.hh \
+    ../../source/PPUtils/pooledptr_impl.hh \
+    ../../source/PPUtils/poolstatistics.hh
 
 INCLUDEPATH += ../../source/PPUtils
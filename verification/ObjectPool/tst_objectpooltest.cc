@@ -1,5 +1,6 @@
 #include <QString>
 #include <QtTest>
+#include <cstdint>
 
 #include "objectpool.hh"
 
@@ -121,6 +122,12 @@ private Q_SLOTS:
     void moveConstructorTest();
     
     void moveAssignmentTest();
+    
+    // Test acquiring objects as PooledPtrs, that return to their segment.
+    void acquireTest();
+    
+    // Test statistics of the whole pool and of each segment.
+    void statisticsTest();
 };
 
 ObjectPoolTest::ObjectPoolTest()
@@ -356,6 +363,89 @@ void ObjectPoolTest::moveAssignmentTest()
 }
 
 
+void ObjectPoolTest::acquireTest()
+{
+    typedef PPUtils::ObjectPool<Base, BaseFactoryWrapper, const char*, Selector> BasePool;
+    PPUtils::PooledPtr<Base> orphan;
+    {
+        BasePool pool;
+        Base* p = nullptr;
+        {
+            PPUtils::PooledPtr<Base> a = pool.acquire(QString("DerivA"));
+            PPUtils::PooledPtr<Base> b = pool.acquire(QString("DerivB"));
+            QCOMPARE(a->name(), QString("DerivA"));
+            QCOMPARE(b->name(), QString("DerivB"));
+            QCOMPARE(pool.size(), 0u);
+            p = a.get();
+        }
+        QCOMPARE(pool.size(), 2u);
+        QCOMPARE(pool.size("DerivA"), 1u);
+        QCOMPARE(pool.size("DerivB"), 1u);
+        
+        PPUtils::PooledPtr<Base> a = pool.acquire(QString("DerivA"));
+        QVERIFY(a.get() == p);
+        
+        // Handles follow a moved pool.
+        BasePool pool2(std::move(pool));
+        a.reset();
+        QCOMPARE(pool2.size("DerivA"), 1u);
+        
+        orphan = pool2.acquire(QString("DerivB"));
+    }
+    // Pool is gone: the handle destroys its object.
+    QCOMPARE(orphan->name(), QString("DerivB"));
+    orphan.reset();
+    QVERIFY(orphan == nullptr);
+}
+
+
+
+void ObjectPoolTest::statisticsTest()
+{
+    typedef PPUtils::ObjectPool<Base, BaseFactoryWrapper, const char*, Selector> BasePool;
+    BasePool pool;
+    pool.enableStatistics();
+    std::unique_ptr<Base> a1 = pool.reserve(QString("DerivA"));
+    std::unique_ptr<Base> a2 = pool.reserve(QString("DerivA"));
+    std::unique_ptr<Base> b = pool.reserve(QString("DerivB"));
+    pool.release(std::move(a1));
+    pool.release(std::move(a2));
+    a1 = pool.reserve(QString("DerivA"));
+    
+    PPUtils::PoolStatistics stats = pool.statistics();
+    QCOMPARE(stats.reserves, std::uint64_t(4));
+    QCOMPARE(stats.hits, std::uint64_t(1));
+    QCOMPARE(stats.misses, std::uint64_t(3));
+    QCOMPARE(stats.releases, std::uint64_t(2));
+    QCOMPARE(stats.idle, std::uint64_t(1));
+    QCOMPARE(stats.idle_high_water, std::uint64_t(2));
+    QCOMPARE(stats.outstanding, std::uint64_t(2));
+    QCOMPARE(stats.outstanding_high_water, std::uint64_t(3));
+    
+    std::unordered_map<const char*, PPUtils::PoolStatistics> keys = pool.keyStatistics();
+    QCOMPARE(keys.size(), std::size_t(2));
+    for (const auto& key : keys){
+        if (QString(key.first) == "DerivA"){
+            QCOMPARE(key.second.reserves, std::uint64_t(3));
+            QCOMPARE(key.second.hits, std::uint64_t(1));
+            QCOMPARE(key.second.releases, std::uint64_t(2));
+            QCOMPARE(key.second.idle, std::uint64_t(1));
+            QCOMPARE(key.second.outstanding_high_water, std::uint64_t(2));
+        }
+        else {
+            QCOMPARE(QString(key.first), QString("DerivB"));
+            QCOMPARE(key.second.reserves, std::uint64_t(1));
+            QCOMPARE(key.second.misses, std::uint64_t(1));
+            QCOMPARE(key.second.outstanding, std::uint64_t(1));
+        }
+    }
+    
+    pool.enableStatistics(false);
+    QCOMPARE(pool.statistics().reserves, std::uint64_t(0));
+    QVERIFY(pool.keyStatistics().empty());
+}
+
+
 QTEST_APPLESS_MAIN(ObjectPoolTest)
 
 #include "tst_objectpooltest.moc"
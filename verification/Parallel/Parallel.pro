@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Unit tests for PPUtils::WorkerPool and the parallel algorithms.
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_paralleltest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += tst_paralleltest.cc \
+           ../../source/PPUtils/parallel.cc
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+HEADERS += \
+    ../../source/PPUtils/parallel.hh \
+    ../../source/PPUtils/parallel_impl.hh
+
+INCLUDEPATH += ../../source/PPUtils
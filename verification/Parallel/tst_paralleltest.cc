@@ -0,0 +1,252 @@
+#include <QString>
+#include <QtTest>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <cstring>
+#include <cmath>
+#include <thread>
+
+#include "parallel.hh"
+
+
+class ParallelTest : public QObject
+{
+    Q_OBJECT
+    
+public:
+    ParallelTest();
+    
+private Q_SLOTS:
+    
+    /*!
+     * \brief Test running task batches in a WorkerPool.
+     *  - Act: Run batches from several threads, with nested batches.
+     *  - Expected behaviour: Each task is run exactly once.
+     */
+    void workerPoolTest();
+    
+    /*!
+     * \brief Test exception propagation.
+     *  - Act: Run a batch where one task throws.
+     *  - Expected behaviour: Exception is rethrown, other tasks are run.
+     */
+    void workerPoolTest_exception();
+    
+    /*!
+     * \brief Test parallelFor with different grains and thread counts.
+     *  - Expected behaviour: Function is called once for each index.
+     */
+    void parallelForTest();
+    void parallelForTest_data();
+    
+    /*!
+     * \brief Test that parallelTransformReduce gives bitwise same floating
+     *  point result with any thread count.
+     */
+    void transformReduceTest();
+    void transformReduceTest_data();
+    
+    /*!
+     * \brief Test inclusiveScan out of place and in place.
+     *  - Expected behaviour: Result equals std::partial_sum.
+     */
+    void inclusiveScanTest();
+    void inclusiveScanTest_data();
+    
+    /*!
+     * \brief Test parallelPartition.
+     *  - Expected behaviour: Result equals std::stable_partition.
+     */
+    void parallelPartitionTest();
+    void parallelPartitionTest_data();
+};
+
+
+ParallelTest::ParallelTest()
+{
+}
+
+
+void ParallelTest::workerPoolTest()
+{
+    PPUtils::WorkerPool pool(4);
+    QCOMPARE(pool.threads(), 4u);
+    
+    std::atomic<int> count(0);
+    std::vector<std::function<void()> > inner(100, [&count](){++count;});
+    std::vector<std::function<void()> > outer(10, [&pool, &inner]()
+    {
+        pool.run(inner);
+    });
+    
+    std::vector<std::thread> callers;
+    for (int i=0; i<3; ++i){
+        callers.push_back(std::thread([&pool, &outer](){pool.run(outer);}));
+    }
+    for (std::thread& t : callers){
+        t.join();
+    }
+    QCOMPARE(count.load(), 3 * 10 * 100);
+    
+    pool.run(inner, 8);
+    QCOMPARE(pool.threads(), 8u);
+}
+
+
+void ParallelTest::workerPoolTest_exception()
+{
+    PPUtils::WorkerPool pool(4);
+    std::atomic<int> count(0);
+    std::vector<std::function<void()> > tasks;
+    for (int i=0; i<100; ++i){
+        tasks.push_back([i, &count]()
+        {
+            ++count;
+            if (i == 50){
+                throw std::runtime_error("Task failed.");
+            }
+        });
+    }
+    QVERIFY_EXCEPTION_THROWN(pool.run(tasks), std::runtime_error);
+    QCOMPARE(count.load(), 100);
+}
+
+
+void ParallelTest::parallelForTest()
+{
+    QFETCH(int, grain);
+    QFETCH(unsigned, threads);
+    
+    std::vector<std::atomic<int> > calls(10000);
+    for (std::atomic<int>& c : calls){
+        c = 0;
+    }
+    PPUtils::parallelFor(0, 10000, [&calls](int i){++calls[i];}, grain, threads);
+    for (std::atomic<int>& c : calls){
+        QCOMPARE(c.load(), 1);
+    }
+}
+
+
+void ParallelTest::parallelForTest_data()
+{
+    QTest::addColumn<int>("grain");
+    QTest::addColumn<unsigned>("threads");
+    
+    QTest::newRow("grain 1, 1 thread") << 1 << 1u;
+    QTest::newRow("grain 1, 4 threads") << 1 << 4u;
+    QTest::newRow("grain 333, 4 threads") << 333 << 4u;
+    QTest::newRow("default grain") << 0 << 0u;
+}
+
+
+void ParallelTest::transformReduceTest()
+{
+    QFETCH(int, width);
+    
+    std::vector<double> v(width);
+    std::mt19937 gen(width);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    for (double& d : v){
+        d = dist(gen);
+    }
+    auto square = [](double d){return d * d;};
+    
+    double single = PPUtils::parallelTransformReduce(v.begin(), v.end(), 1.0,
+                                                     std::plus<double>(), square,
+                                                     1000, 1);
+    for (unsigned threads : {2u, 3u, 8u}){
+        double result = PPUtils::parallelTransformReduce(v.begin(), v.end(), 1.0,
+                                                         std::plus<double>(), square,
+                                                         1000, threads);
+        QVERIFY(std::memcmp(&result, &single, sizeof(double)) == 0);
+    }
+    double expected = std::accumulate(v.begin(), v.end(), 1.0, 
+                                      [](double a, double d){return a + d * d;});
+    QVERIFY(std::abs(single - expected) <= 1e-9 * std::abs(expected));
+}
+
+
+void ParallelTest::transformReduceTest_data()
+{
+    QTest::addColumn<int>("width");
+    
+    QTest::newRow("empty") << 0;
+    QTest::newRow("one chunk") << 999;
+    QTest::newRow("many chunks") << 1000001;
+}
+
+
+void ParallelTest::inclusiveScanTest()
+{
+    QFETCH(int, width);
+    QFETCH(int, grain);
+    
+    std::vector<long long> v(width);
+    std::mt19937 gen(width);
+    for (long long& i : v){
+        i = gen() % 1000;
+    }
+    std::vector<long long> expected(width);
+    std::partial_sum(v.begin(), v.end(), expected.begin());
+    
+    std::vector<long long> result(width);
+    QVERIFY(PPUtils::inclusiveScan(v.begin(), v.end(), result.begin(),
+                                   std::plus<long long>(), grain, 4) == result.end());
+    QCOMPARE(result, expected);
+    
+    PPUtils::inclusiveScan(v.begin(), v.end(), v.begin(), 
+                           std::plus<long long>(), grain, 4);
+    QCOMPARE(v, expected);
+}
+
+
+void ParallelTest::inclusiveScanTest_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("grain");
+    
+    QTest::newRow("empty") << 0 << 0;
+    QTest::newRow("one chunk") << 100 << 0;
+    QTest::newRow("grain 1") << 1000 << 1;
+    QTest::newRow("partial last chunk") << 100001 << 1000;
+}
+
+
+void ParallelTest::parallelPartitionTest()
+{
+    QFETCH(int, width);
+    QFETCH(int, grain);
+    
+    std::vector<int> v(width);
+    std::iota(v.begin(), v.end(), 0);
+    std::shuffle(v.begin(), v.end(), std::mt19937(width));
+    std::vector<int> expected(v);
+    auto pred = [](int i){return i % 3 == 0;};
+    auto expected_cut = std::stable_partition(expected.begin(), expected.end(), pred);
+    
+    auto cut = PPUtils::parallelPartition(v.begin(), v.end(), pred, grain, 4);
+    QCOMPARE(v, expected);
+    QCOMPARE(cut - v.begin(), expected_cut - expected.begin());
+}
+
+
+void ParallelTest::parallelPartitionTest_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("grain");
+    
+    QTest::newRow("empty") << 0 << 0;
+    QTest::newRow("one chunk") << 100 << 0;
+    QTest::newRow("many chunks") << 100001 << 1000;
+}
+
+
+QTEST_APPLESS_MAIN(ParallelTest)
+
+#include "tst_paralleltest.moc"
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Unit tests for PPUtils::PoolAllocator.
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_poolallocatortest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += tst_poolallocatortest.cc
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+HEADERS += \
+    ../../source/PPUtils/poolallocator.hh \
+    ../../source/PPUtils/poolallocator_impl.hh
+
+INCLUDEPATH += ../../source/PPUtils
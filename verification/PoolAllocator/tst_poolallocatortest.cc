@@ -0,0 +1,205 @@
+#include <QString>
+#include <QtTest>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+#include "poolallocator.hh"
+
+
+// Over-aligned object.
+struct alignas(32) Wide
+{
+    char data[40];
+};
+
+// Object of a size used by no other test, so that its pool is not shared.
+struct Payload
+{
+    char data[200];
+};
+
+
+class PoolAllocatorTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    PoolAllocatorTest();
+
+private Q_SLOTS:
+
+    /*!
+     * \brief Test allocate and deallocate with and without thread cache.
+     *  - Expected behaviour: Deallocated blocks are reused, blocks are
+     *    aligned for T, and arrays are supported.
+     */
+    void reuseTest();
+
+    /*!
+     * \brief Test PoolAllocator in std::list, std::map and
+     *  std::unordered_map.
+     *  - Expected behaviour: Containers rebind the allocator to their node
+     *    types and work as with std::allocator.
+     */
+    void containerTest();
+
+    /*!
+     * \brief Test allocating in one thread and deallocating in another.
+     *  - Expected behaviour: Every block returns to the shared pool when the
+     *    threads exit.
+     */
+    void threadCacheTest();
+};
+
+
+PoolAllocatorTest::PoolAllocatorTest()
+{
+}
+
+
+void PoolAllocatorTest::reuseTest()
+{
+    PPUtils::PoolAllocator<long, false> shared;
+    long* p = shared.allocate(1);
+    shared.deallocate(p, 1);
+    QVERIFY(shared.allocate(1) == p);
+    shared.deallocate(p, 1);
+
+    PPUtils::PoolAllocator<long> cached;
+    p = cached.allocate(1);
+    cached.deallocate(p, 1);
+    QVERIFY(cached.allocate(1) == p);
+    cached.deallocate(p, 1);
+
+    QCOMPARE(PPUtils::PoolAllocator<Wide>::BLOCK_SIZE, std::size_t(64));
+    QCOMPARE(PPUtils::PoolAllocator<Wide>::BLOCK_ALIGN, std::size_t(32));
+    PPUtils::PoolAllocator<Wide> wide;
+    std::set<Wide*> blocks;
+    for (int i = 0; i < 3000; ++i){
+        Wide* w = wide.allocate(1);
+        QCOMPARE(reinterpret_cast<std::uintptr_t>(w) % 32, std::uintptr_t(0));
+        blocks.insert(w);
+    }
+    QCOMPARE(blocks.size(), std::size_t(3000));
+    for (Wide* w : blocks){
+        wide.deallocate(w, 1);
+    }
+
+    long* array = cached.allocate(100);
+    array[99] = 1;
+    cached.deallocate(array, 100);
+
+    // Stateless: any two allocators are equal, also when rebound.
+    PPUtils::PoolAllocator<int> ints;
+    PPUtils::PoolAllocator<double> doubles(ints);
+    QVERIFY(ints == doubles);
+    QVERIFY(!(ints != doubles));
+}
+
+
+void PoolAllocatorTest::containerTest()
+{
+    std::list<int, PPUtils::PoolAllocator<int> > list;
+    for (int i = 0; i < 10000; ++i){
+        list.push_back(i);
+    }
+    list.remove_if([](int i){return i % 2 == 0;});
+    QCOMPARE(list.size(), std::size_t(5000));
+    QCOMPARE(list.front(), 1);
+    std::list<int, PPUtils::PoolAllocator<int> > copy(list);
+    list.clear();
+    QCOMPARE(copy.back(), 9999);
+
+    typedef std::pair<const int, std::string> Entry;
+    std::map<int, std::string, std::less<int>, PPUtils::PoolAllocator<Entry> > map;
+    std::unordered_map<int, std::string, std::hash<int>, std::equal_to<int>,
+            PPUtils::PoolAllocator<Entry, false> > hash;
+    for (int i = 0; i < 5000; ++i){
+        map[i] = std::to_string(i);
+        hash[i] = std::to_string(i);
+    }
+    for (int i = 0; i < 5000; i += 3){
+        map.erase(i);
+        hash.erase(i);
+    }
+    QCOMPARE(map.size(), hash.size());
+    for (const Entry& entry : map){
+        QCOMPARE(hash.at(entry.first), entry.second);
+    }
+
+    std::map<int, std::string, std::less<int>, PPUtils::PoolAllocator<Entry> > other;
+    other.swap(map);
+    QVERIFY(map.empty());
+    QCOMPARE(other.at(4999), std::string("4999"));
+}
+
+
+void PoolAllocatorTest::threadCacheTest()
+{
+    typedef PPUtils::PoolAllocator<Payload> Allocator;
+    typedef PPUtils::PoolAllocator<Payload, false> SharedAllocator;
+    std::vector<std::vector<Payload*> > blocks(4);
+    std::atomic<bool> overwritten(false);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t){
+        threads.push_back(std::thread([&blocks, t]()
+        {
+            Allocator cached;
+            SharedAllocator shared;
+            for (int i = 0; i < 3000; ++i){
+                Payload* p = i % 2 == 0 ? cached.allocate(1) : shared.allocate(1);
+                p->data[0] = char(t);
+                blocks[t].push_back(p);
+            }
+        }));
+    }
+    for (std::thread& t : threads){
+        t.join();
+    }
+    threads.clear();
+
+    // Deallocate each block in another thread.
+    for (int t = 0; t < 4; ++t){
+        threads.push_back(std::thread([&blocks, &overwritten, t]()
+        {
+            Allocator cached;
+            SharedAllocator shared;
+            const int other = (t + 1) % 4;
+            for (std::size_t i = 0; i < blocks[other].size(); ++i){
+                Payload* p = blocks[other][i];
+                if (p->data[0] != char(other)){
+                    overwritten = true;
+                }
+                if (i % 3 == 0){
+                    shared.deallocate(p, 1);
+                }
+                else {
+                    cached.deallocate(p, 1);
+                }
+            }
+        }));
+    }
+    for (std::thread& t : threads){
+        t.join();
+    }
+    QVERIFY(!overwritten);
+
+    // Exited threads gave their cached blocks back.
+    Allocator::Pool& pool = Allocator::Pool::instance();
+    QVERIFY(pool.capacity() >= 12000u);
+    QCOMPARE(pool.available(), pool.capacity());
+}
+
+
+QTEST_APPLESS_MAIN(PoolAllocatorTest)
+
+#include "tst_poolallocatortest.moc"
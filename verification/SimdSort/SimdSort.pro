@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Unit tests for PPUtils::simdSort.
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_simdsorttest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += tst_simdsorttest.cc \
+           ../../source/PPUtils/simdsort.cc
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+HEADERS += ../../source/PPUtils/simdsort.hh
+
+INCLUDEPATH += ../../source/PPUtils
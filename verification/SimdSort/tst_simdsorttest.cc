@@ -0,0 +1,183 @@
+#include <QString>
+#include <QtTest>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+
+#include "simdsort.hh"
+
+
+namespace
+{
+
+// Sorts random keys with simdSort at level and compares to std::sort.
+template <class T, class Gen>
+bool sortsLikeStdSort(Gen gen, int width, PPUtils::SimdLevel level)
+{
+    std::vector<T> v(width);
+    for (T& t : v){
+        t = static_cast<T>(gen());
+    }
+    std::vector<T> expected(v);
+    std::sort(expected.begin(), expected.end());
+    PPUtils::simdSort(v.data(), v.data() + v.size(), level);
+    return v == expected;
+}
+
+} // Anonymous namespace
+
+
+class SimdSortTest : public QObject
+{
+    Q_OBJECT
+    
+public:
+    SimdSortTest();
+    
+private Q_SLOTS:
+    
+    /*!
+     * \brief Test sorting all key types with all supported SimdLevels.
+     *  - Act: Sort random keys with simdSort.
+     *  - Expected behaviour: Result equals std::sort result.
+     */
+    void simdSortTest();
+    void simdSortTest_data();
+    
+    /*!
+     * \brief Test sorting extreme values.
+     *  - Act: Sort minimum, maximum, zero and negative zero values.
+     *  - Expected behaviour: Values are in order, and padding does not show.
+     */
+    void simdSortTest_extremes();
+    
+    /*!
+     * \brief Test sorting keys with payload.
+     *  - Act: Sort keys with many duplicates and their indices as payload.
+     *  - Expected behaviour: Result equals std::stable_sort result.
+     */
+    void simdSortByKeyTest();
+    void simdSortByKeyTest_data();
+};
+
+
+SimdSortTest::SimdSortTest()
+{
+}
+
+
+void SimdSortTest::simdSortTest()
+{
+    QFETCH(int, width);
+    
+    std::mt19937_64 gen(width);
+    auto small = [&gen]() {return std::int64_t(gen() % 20001) - 10000;};
+    auto real = [&gen]() {return double(std::int64_t(gen() % 20001) - 10000) / 7;};
+    
+    for (int l = PPUtils::SIMD_SCALAR; l <= PPUtils::simdSortSupportedLevel(); ++l){
+        PPUtils::SimdLevel level = static_cast<PPUtils::SimdLevel>(l);
+        QVERIFY(sortsLikeStdSort<std::int32_t>(std::ref(gen), width, level));
+        QVERIFY(sortsLikeStdSort<std::int32_t>(small, width, level));
+        QVERIFY(sortsLikeStdSort<std::uint32_t>(std::ref(gen), width, level));
+        QVERIFY(sortsLikeStdSort<float>(real, width, level));
+        QVERIFY(sortsLikeStdSort<std::int64_t>(std::ref(gen), width, level));
+        QVERIFY(sortsLikeStdSort<std::int64_t>(small, width, level));
+        QVERIFY(sortsLikeStdSort<std::uint64_t>(std::ref(gen), width, level));
+        QVERIFY(sortsLikeStdSort<double>(real, width, level));
+    }
+}
+
+
+void SimdSortTest::simdSortTest_data()
+{
+    QTest::addColumn<int>("width");
+    
+    QTest::newRow("empty") << 0;
+    QTest::newRow("one") << 1;
+    QTest::newRow("scalar sized") << 100;
+    QTest::newRow("two blocks") << 128;
+    QTest::newRow("padded") << 1001;
+    QTest::newRow("large") << 100000;
+}
+
+
+void SimdSortTest::simdSortTest_extremes()
+{
+    for (int l = PPUtils::SIMD_SCALAR; l <= PPUtils::simdSortSupportedLevel(); ++l){
+        PPUtils::SimdLevel level = static_cast<PPUtils::SimdLevel>(l);
+        
+        std::vector<std::int32_t> ints(300, 5);
+        ints[0] = INT32_MAX;
+        ints[1] = INT32_MIN;
+        ints[2] = -1;
+        ints[3] = 0;
+        std::vector<std::int32_t> expected(ints);
+        std::sort(expected.begin(), expected.end());
+        PPUtils::simdSort(ints.data(), ints.data() + ints.size(), level);
+        QVERIFY(ints == expected);
+        
+        std::vector<double> reals(300, 1.0);
+        reals[0] = 0.0;
+        reals[1] = -0.0;
+        reals[2] = -1e300;
+        reals[3] = 1e300;
+        PPUtils::simdSort(reals.data(), reals.data() + reals.size(), level);
+        QCOMPARE(reals[0], -1e300);
+        QVERIFY(std::signbit(reals[1]));
+        QVERIFY(!std::signbit(reals[2]));
+        QCOMPARE(reals[3], 1.0);
+        QCOMPARE(reals.back(), 1e300);
+    }
+}
+
+
+void SimdSortTest::simdSortByKeyTest()
+{
+    QFETCH(int, width);
+    
+    for (int l = PPUtils::SIMD_SCALAR; l <= PPUtils::simdSortSupportedLevel(); ++l){
+        PPUtils::SimdLevel level = static_cast<PPUtils::SimdLevel>(l);
+        std::default_random_engine gen(width);
+        std::vector<float> keys(width);
+        std::vector<std::uint32_t> payload(width);
+        std::vector<std::pair<float, std::uint32_t> > expected;
+        for (int i=0; i<width; ++i){
+            keys[i] = float(int(gen() % 21) - 10) / 4;
+            payload[i] = i;
+            expected.push_back(std::make_pair(keys[i], payload[i]));
+        }
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](const std::pair<float, std::uint32_t>& a,
+                            const std::pair<float, std::uint32_t>& b)
+        {
+            return a.first < b.first;
+        });
+        
+        PPUtils::simdSortByKey(keys.data(), keys.data() + keys.size(),
+                               payload.data(), level);
+        for (int i=0; i<width; ++i){
+            QCOMPARE(keys[i], expected[i].first);
+            QCOMPARE(payload[i], expected[i].second);
+        }
+    }
+}
+
+
+void SimdSortTest::simdSortByKeyTest_data()
+{
+    QTest::addColumn<int>("width");
+    
+    QTest::newRow("empty") << 0;
+    QTest::newRow("scalar sized") << 20;
+    QTest::newRow("padded") << 1001;
+    QTest::newRow("large") << 100000;
+}
+
+
+QTEST_APPLESS_MAIN(SimdSortTest)
+
+#include "tst_simdsorttest.moc"
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Unit tests for PPUtils::SlabObjectPool.
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_slabobjectpooltest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += tst_slabobjectpooltest.cc
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+HEADERS += \
+    ../../source/PPUtils/slabobjectpool.hh \
+    ../../source/PPUtils/slabobjectpool_impl.hh
+
+INCLUDEPATH += ../../source/PPUtils
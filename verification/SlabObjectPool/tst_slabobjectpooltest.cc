@@ -0,0 +1,298 @@
+#include <QString>
+#include <QtTest>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <cstdint>
+
+#include "slabobjectpool.hh"
+
+
+// Counts live instances.
+class Counted
+{
+public:
+    static int live;
+    int value;
+
+    explicit Counted(int v = 0) : value(v) {++live;}
+    ~Counted() {--live;}
+    Counted(const Counted&) = delete;
+    Counted& operator = (const Counted&) = delete;
+};
+
+int Counted::live = 0;
+
+typedef PPUtils::SlabObjectPool<Counted, std::function<Counted*(void*)> > CountedPool;
+
+
+// Type that needs more than the default alignment.
+struct alignas(128) OverAligned
+{
+    char data[40];
+};
+
+
+class SlabObjectPoolTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SlabObjectPoolTest();
+
+private Q_SLOTS:
+
+    /*!
+     * \brief Test reserve and release.
+     *  - Act: Reserve objects, release them and reserve again.
+     *  - Expected behaviour: Released objects are reused in LIFO order, size
+     *    and outstanding follow, and the builder is called only on misses.
+     */
+    void reuseTest();
+
+    /*!
+     * \brief Test that objects of one slab are contiguous.
+     *  - Act: Reserve all objects of the first slab.
+     *  - Expected behaviour: Objects are in one range of slab_bytes bytes.
+     *    Reserving one more allocates a new slab.
+     */
+    void contiguityTest();
+
+    /*!
+     * \brief Test alignment of over-aligned types.
+     */
+    void alignmentTest();
+
+    /*!
+     * \brief Test object lifetimes.
+     *  - Expected behaviour: clear() destroys idle objects and their slots
+     *    are reused without new slabs. Destructor destroys idle objects.
+     */
+    void lifetimeTest();
+
+    /*!
+     * \brief Test throwing builder.
+     *  - Expected behaviour: Exception propagates and the slot is reused by
+     *    the next reserve.
+     */
+    void builderExceptionTest();
+
+    /*!
+     * \brief Test releasing by destroying the pointer.
+     *  - Act: Let reserved pointers go out of scope and reset them.
+     *  - Expected behaviour: Objects are returned to the pool, not destroyed.
+     */
+    void pointerTest();
+
+    /*!
+     * \brief Test move-construction and move-assignment.
+     *  - Expected behaviour: Outstanding objects can be released to the new
+     *    pool. Moved-from pool is empty.
+     */
+    void moveTest();
+};
+
+
+SlabObjectPoolTest::SlabObjectPoolTest()
+{
+}
+
+
+void SlabObjectPoolTest::reuseTest()
+{
+    int built = 0;
+    auto builder = [&built](void* p){return new (p) Counted(++built);};
+    CountedPool pool(builder);
+    QCOMPARE(pool.size(), 0u);
+    QCOMPARE(pool.capacity(), std::size_t(0));
+
+    std::vector<CountedPool::Pointer> objects;
+    std::vector<Counted*> addresses;
+    for (int i = 0; i < 10; ++i){
+        objects.push_back(pool.reserve());
+        addresses.push_back(objects.back().get());
+        QCOMPARE(objects.back()->value, i + 1);
+    }
+    QCOMPARE(pool.outstanding(), std::size_t(10));
+    QCOMPARE(built, 10);
+
+    for (CountedPool::Pointer& c : objects){
+        pool.release(std::move(c));
+    }
+    QCOMPARE(pool.size(), 10u);
+    QCOMPARE(pool.outstanding(), std::size_t(0));
+
+    // Last released is reserved first.
+    for (int i = 9; i >= 0; --i){
+        objects[i] = pool.reserve();
+        QCOMPARE(objects[i].get(), addresses[i]);
+    }
+    QCOMPARE(built, 10);
+    QCOMPARE(pool.size(), 0u);
+    objects.clear();
+    QCOMPARE(pool.size(), 10u);
+}
+
+
+void SlabObjectPoolTest::contiguityTest()
+{
+    const std::size_t slab_bytes = 4096;
+    PPUtils::SlabObjectPool<Counted> pool(PPUtils::SlabObjectPool<Counted>::DEFAULT_BUILDER,
+                                          slab_bytes);
+
+    std::vector<PPUtils::SlabObjectPool<Counted>::Pointer> objects;
+    objects.push_back(pool.reserve());
+    const std::size_t per_slab = pool.capacity();
+    QVERIFY(per_slab > 1);
+    QVERIFY(per_slab * sizeof(Counted) <= slab_bytes);
+    while (objects.size() < per_slab){
+        objects.push_back(pool.reserve());
+    }
+    QCOMPARE(pool.capacity(), per_slab);
+
+    std::vector<const char*> addresses;
+    for (const PPUtils::SlabObjectPool<Counted>::Pointer& c : objects){
+        addresses.push_back(reinterpret_cast<const char*>(c.get()));
+    }
+    auto minmax = std::minmax_element(addresses.begin(), addresses.end());
+    QVERIFY(std::size_t(*minmax.second - *minmax.first) < slab_bytes);
+    QVERIFY(reinterpret_cast<std::uintptr_t>(addresses.front()) %
+            PPUtils::SLAB_ALIGNMENT < 2 * sizeof(void*));
+
+    objects.push_back(pool.reserve());
+    QCOMPARE(pool.capacity(), 2 * per_slab);
+}
+
+
+void SlabObjectPoolTest::alignmentTest()
+{
+    PPUtils::SlabObjectPool<OverAligned> pool(
+                PPUtils::SlabObjectPool<OverAligned>::DEFAULT_BUILDER, 1000);
+    std::vector<PPUtils::SlabObjectPool<OverAligned>::Pointer> objects;
+    for (int i = 0; i < 100; ++i){
+        objects.push_back(pool.reserve());
+        QCOMPARE(reinterpret_cast<std::uintptr_t>(objects.back().get()) % 128,
+                 std::uintptr_t(0));
+    }
+}
+
+
+void SlabObjectPoolTest::lifetimeTest()
+{
+    Counted::live = 0;
+    {
+        PPUtils::SlabObjectPool<Counted> pool;
+        std::vector<PPUtils::SlabObjectPool<Counted>::Pointer> objects;
+        for (int i = 0; i < 100; ++i){
+            objects.push_back(pool.reserve());
+        }
+        QCOMPARE(Counted::live, 100);
+        const std::size_t capacity = pool.capacity();
+
+        for (PPUtils::SlabObjectPool<Counted>::Pointer& c : objects){
+            pool.release(std::move(c));
+        }
+        QCOMPARE(Counted::live, 100);
+        pool.clear();
+        QCOMPARE(pool.size(), 0u);
+        QCOMPARE(Counted::live, 0);
+
+        // Destroyed objects' slots are reused.
+        for (int i = 0; i < 100; ++i){
+            objects[i] = pool.reserve();
+        }
+        QCOMPARE(pool.capacity(), capacity);
+        QCOMPARE(Counted::live, 100);
+        objects.clear();
+    }
+    QCOMPARE(Counted::live, 0);
+}
+
+
+void SlabObjectPoolTest::builderExceptionTest()
+{
+    bool fail = true;
+    auto builder = [&fail](void* p) -> Counted*
+    {
+        if (fail){
+            throw std::runtime_error("builder failed");
+        }
+        return new (p) Counted(1);
+    };
+    CountedPool pool(builder);
+
+    QVERIFY_EXCEPTION_THROWN(pool.reserve(), std::runtime_error);
+    QCOMPARE(pool.outstanding(), std::size_t(0));
+    const std::size_t capacity = pool.capacity();
+
+    fail = false;
+    CountedPool::Pointer c = pool.reserve();
+    QCOMPARE(c->value, 1);
+    QCOMPARE(pool.capacity(), capacity);
+}
+
+
+void SlabObjectPoolTest::moveTest()
+{
+    Counted::live = 0;
+    {
+        PPUtils::SlabObjectPool<Counted> a;
+        PPUtils::SlabObjectPool<Counted>::Pointer kept = a.reserve();
+        a.release(a.reserve());
+
+        PPUtils::SlabObjectPool<Counted> b(std::move(a));
+        QCOMPARE(a.size(), 0u);
+        QCOMPARE(a.capacity(), std::size_t(0));
+        QCOMPARE(b.size(), 1u);
+        QCOMPARE(b.outstanding(), std::size_t(1));
+        kept.reset();
+        QCOMPARE(b.outstanding(), std::size_t(0));
+
+        PPUtils::SlabObjectPool<Counted> c;
+        c.release(c.reserve());
+        c = std::move(b);
+        QCOMPARE(c.size(), 2u);
+        QCOMPARE(Counted::live, 2);
+    }
+    QCOMPARE(Counted::live, 0);
+}
+
+
+void SlabObjectPoolTest::pointerTest()
+{
+    Counted::live = 0;
+    int built = 0;
+    auto builder = [&built](void* p){return new (p) Counted(++built);};
+    {
+        CountedPool pool(builder);
+        Counted* address = nullptr;
+        {
+            CountedPool::Pointer c = pool.reserve();
+            address = c.get();
+            c->value = 42;
+            QCOMPARE(pool.outstanding(), std::size_t(1));
+        }
+        QCOMPARE(pool.outstanding(), std::size_t(0));
+        QCOMPARE(pool.size(), 1u);
+        QCOMPARE(Counted::live, 1);
+
+        // Object was kept in its state.
+        CountedPool::Pointer c = pool.reserve();
+        QCOMPARE(c.get(), address);
+        QCOMPARE(c->value, 42);
+        QCOMPARE(built, 1);
+
+        CountedPool::Pointer moved(std::move(c));
+        moved.reset();
+        QCOMPARE(pool.size(), 1u);
+        QCOMPARE(Counted::live, 1);
+    }
+    QCOMPARE(Counted::live, 0);
+}
+
+
+QTEST_APPLESS_MAIN(SlabObjectPoolTest)
+
+#include "tst_slabobjectpooltest.moc"
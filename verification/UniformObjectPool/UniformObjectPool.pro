@@ -20,6 +20,10 @@ DEFINES += SRCDIR=\\\"$$PWD/\\\"
 
 HEADERS += \
     ../../source/PPUtils/uniformobjectpool.hh \
-    ../../source/PPUtils/uniformobjectpool_impl.hh
+    ../../source/PPUtils/uniformobjectpool_impl.hh \
+    ../../source/PPUtils/resetpolicy.hh \
+    ../../source/PPUtils/pooledptr.hh \
+    ../../source/PPUtils/pooledptr_impl.hh \
+    ../../source/PPUtils/poolstatistics.hh
 
 INCLUDEPATH += ../../source/PPUtils
@@ -2,6 +2,13 @@
 #include <QtTest>
 #include <functional>
 #include <type_traits>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <stdexcept>
+#include <sstream>
+#include <cstdint>
 #include "uniformobjectpool.hh"
 
 
@@ -40,6 +47,41 @@ public:
 };   
 
 
+// Class that counts its live instances.
+class Counted
+{
+public:
+    static int live;
+    Counted() {++live;}
+    ~Counted() {--live;}
+};
+
+int Counted::live = 0;
+
+
+// Object with state that must be reset before reuse.
+class Connection
+{
+public:
+    int dirt;
+    bool broken;
+    Connection() : dirt(0), broken(false) {}
+};
+
+// Reset functor counting its calls.
+class ConnectionReset
+{
+public:
+    int* calls;
+    explicit ConnectionReset(int* c = nullptr) : calls(c) {}
+    void operator () (Connection& c) const
+    {
+        c.dirt = 0;
+        ++*calls;
+    }
+};
+
+
 // Qt-test unit test class. 
 class UniformObjectPoolTest : public QObject
 {
@@ -61,6 +103,43 @@ private Q_SLOTS:
     // Test storing non-copyable object inherited from an abstract class.
     void noCopyableObjectTest();
     
+    // Test that PooledPtr returns its object to the pool on destruction and
+    // reset, and that detach takes the object out of the pool.
+    void pooledPtrTest();
+    
+    // Test that PooledPtr destroys its object, if the pool is destroyed
+    // first, and that it follows a moved pool.
+    void pooledPtrLifetimeTest();
+    
+    // Test that objects released to a full pool are destroyed, and that
+    // lowering the limit destroys the oldest objects.
+    void maxIdleTest();
+    
+    // Test that trim destroys the oldest objects down to the target size.
+    void trimTest();
+    
+    // Test that objects idle longer than the time limit are destroyed lazily
+    // and by evictIdle.
+    void maxIdleTimeTest();
+    
+    // Test that prewarm builds the objects with several threads, respects
+    // the idle limit and stores objects built before a builder exception,
+    // and that the constructor builds the initial objects.
+    void prewarmTest();
+    
+    // Test that EagerReset resets objects in release, LazyReset in reserve
+    // and BackgroundReset in resetDirty, or in reserve if resetDirty has not
+    // been called.
+    void resetPolicyTest();
+    
+    // Test that reserve destroys idle objects rejected by the validator and
+    // tries the next one.
+    void validatorTest();
+    
+    // Test that statistics count hits, misses, releases, builds and
+    // high-water marks, and that they can be written out.
+    void statisticsTest();
+    
 };
 
 UniformObjectPoolTest::UniformObjectPoolTest()
@@ -71,7 +150,9 @@ UniformObjectPoolTest::UniformObjectPoolTest()
 void UniformObjectPoolTest::pointerConstructorTest()
 {
     QFETCH(std::function<int*()>, builder);
-    PPUtils::UniformObjectPool<int, std::function<int*()>> pool(&builder);
+    // The pool takes ownership of the builder.
+    PPUtils::UniformObjectPool<int, std::function<int*()>> pool(
+                new std::function<int*()>(builder));
     QCOMPARE(pool.size(), 0u);
     
     // create 10 ints using the pool.
@@ -181,9 +262,8 @@ void UniformObjectPoolTest::noCopyableObjectTest()
     
     // Pointer constructor
     {
-        // Create pool
-        MyBuilder b(2);
-        PPUtils::UniformObjectPool<MyBaseClass, MyBuilder> pool(&b);
+        // Create pool. The pool takes ownership of the builder.
+        PPUtils::UniformObjectPool<MyBaseClass, MyBuilder> pool(new MyBuilder(2));
         QVERIFY(pool.reserve() != nullptr);
         QCOMPARE(pool.size(), 0u);
         
@@ -198,6 +278,438 @@ void UniformObjectPoolTest::noCopyableObjectTest()
     }
 }
 
+void UniformObjectPoolTest::pooledPtrTest()
+{
+    PPUtils::UniformObjectPool<int> pool;
+    int* address = nullptr;
+    {
+        PPUtils::PooledPtr<int> p = pool.acquire();
+        QVERIFY(p != nullptr);
+        address = p.get();
+        *p = 5;
+        QCOMPARE(pool.size(), 0u);
+    }
+    QCOMPARE(pool.size(), 1u);
+    
+    // Same object is reused in its current state.
+    PPUtils::PooledPtr<int> p = pool.acquire();
+    QCOMPARE(p.get(), address);
+    QCOMPARE(*p, 5);
+    QCOMPARE(pool.size(), 0u);
+    
+    // Move-assignment releases the old object.
+    PPUtils::PooledPtr<int> q = pool.acquire();
+    q = std::move(p);
+    QVERIFY(p == nullptr);
+    QCOMPARE(q.get(), address);
+    QCOMPARE(pool.size(), 1u);
+    
+    q.reset();
+    QVERIFY(!q);
+    QCOMPARE(pool.size(), 2u);
+    
+    // Detached object is not returned.
+    PPUtils::PooledPtr<int> r = pool.acquire();
+    std::unique_ptr<int> owned = r.detach();
+    QVERIFY(owned != nullptr);
+    QVERIFY(r == nullptr);
+    QCOMPARE(pool.size(), 1u);
+}
+
+
+void UniformObjectPoolTest::pooledPtrLifetimeTest()
+{
+    Counted::live = 0;
+    PPUtils::PooledPtr<Counted> orphan;
+    {
+        PPUtils::UniformObjectPool<Counted> pool;
+        orphan = pool.acquire();
+        pool.acquire();
+        QCOMPARE(pool.size(), 1u);
+        QCOMPARE(Counted::live, 2);
+    }
+    // Pool destroyed its stored object, orphan still owns its own.
+    QCOMPARE(Counted::live, 1);
+    orphan.reset();
+    QCOMPARE(Counted::live, 0);
+    
+    // PooledPtr returns its object to the pool its old pool was moved to.
+    PPUtils::PooledPtr<Counted> p;
+    PPUtils::UniformObjectPool<Counted> a;
+    p = a.acquire();
+    PPUtils::UniformObjectPool<Counted> b(std::move(a));
+    p.reset();
+    QCOMPARE(b.size(), 1u);
+    QCOMPARE(a.size(), 0u);
+    
+    PPUtils::UniformObjectPool<Counted> c;
+    p = b.acquire();
+    c = std::move(b);
+    p.reset();
+    QCOMPARE(c.size(), 1u);
+}
+
+
+void UniformObjectPoolTest::maxIdleTest()
+{
+    Counted::live = 0;
+    PPUtils::UniformObjectPool<Counted> pool;
+    QCOMPARE(pool.maxIdle(), PPUtils::POOL_UNLIMITED_IDLE);
+    pool.setMaxIdle(3);
+    QCOMPARE(pool.maxIdle(), 3u);
+    
+    std::vector<std::unique_ptr<Counted> > objects;
+    for (int i = 0; i < 5; ++i){
+        objects.push_back(pool.reserve());
+    }
+    std::vector<Counted*> raw;
+    for (auto& object : objects){
+        raw.push_back(object.get());
+        pool.release(std::move(object));
+    }
+    QCOMPARE(pool.size(), 3u);
+    QCOMPARE(Counted::live, 3);
+    
+    // Lowering the limit keeps the most recently released objects.
+    pool.setMaxIdle(1);
+    QCOMPARE(pool.size(), 1u);
+    QCOMPARE(Counted::live, 1);
+    QCOMPARE(pool.reserve().get(), raw[2]);
+    
+    pool.setMaxIdle(0);
+    pool.release(pool.reserve());
+    QCOMPARE(pool.size(), 0u);
+    QCOMPARE(Counted::live, 0);
+    
+    pool.setMaxIdle(PPUtils::POOL_UNLIMITED_IDLE);
+    pool.release(pool.reserve());
+    QCOMPARE(pool.size(), 1u);
+}
+
+
+void UniformObjectPoolTest::trimTest()
+{
+    Counted::live = 0;
+    PPUtils::UniformObjectPool<Counted> pool;
+    std::vector<std::unique_ptr<Counted> > objects;
+    for (int i = 0; i < 10; ++i){
+        objects.push_back(pool.reserve());
+    }
+    Counted* newest = objects.back().get();
+    for (auto& object : objects){
+        pool.release(std::move(object));
+    }
+    
+    pool.trim(20);
+    QCOMPARE(pool.size(), 10u);
+    pool.trim(4);
+    QCOMPARE(pool.size(), 4u);
+    QCOMPARE(Counted::live, 4);
+    QCOMPARE(pool.maxIdle(), PPUtils::POOL_UNLIMITED_IDLE);
+    
+    std::unique_ptr<Counted> first = pool.reserve();
+    QCOMPARE(first.get(), newest);
+    pool.release(std::move(first));
+    pool.trim(0);
+    QCOMPARE(pool.size(), 0u);
+    QCOMPARE(Counted::live, 0);
+}
+
+
+void UniformObjectPoolTest::maxIdleTimeTest()
+{
+    Counted::live = 0;
+    PPUtils::UniformObjectPool<Counted> pool;
+    QVERIFY(pool.maxIdleTime() == std::chrono::steady_clock::duration::zero());
+    QCOMPARE(pool.evictIdle(), 0u);
+    
+    // Objects stored before the limit are considered released when it is set.
+    pool.release(std::unique_ptr<Counted>(new Counted()));
+    pool.setMaxIdleTime(std::chrono::milliseconds(50));
+    QCOMPARE(pool.evictIdle(), 0u);
+    QCOMPARE(pool.size(), 1u);
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    pool.release(std::unique_ptr<Counted>(new Counted()));
+    // Lazy eviction in release destroyed the first object.
+    QCOMPARE(pool.size(), 1u);
+    QCOMPARE(Counted::live, 1);
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    QCOMPARE(pool.evictIdle(), 1u);
+    QCOMPARE(Counted::live, 0);
+    
+    // Expired objects are not reserved: reserve builds a new one.
+    pool.release(std::unique_ptr<Counted>(new Counted()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    std::unique_ptr<Counted> fresh = pool.reserve();
+    QCOMPARE(Counted::live, 1);
+    QCOMPARE(pool.size(), 0u);
+    
+    pool.setMaxIdleTime(std::chrono::steady_clock::duration::zero());
+    pool.release(std::move(fresh));
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    QCOMPARE(pool.evictIdle(), 0u);
+    QCOMPARE(pool.size(), 1u);
+}
+
+
+void UniformObjectPoolTest::prewarmTest()
+{
+    Counted::live = 0;
+    // Builder must be thread safe for parallel prewarm.
+    std::mutex mx;
+    int built = 0;
+    std::function<Counted*()> builder = [&built, &mx]()
+    {
+        std::lock_guard<std::mutex> lock(mx);
+        ++built;
+        return new Counted();
+    };
+    {
+        PPUtils::UniformObjectPool<Counted> pool(builder, 5);
+        QCOMPARE(pool.size(), 5u);
+        QCOMPARE(built, 5);
+        
+        std::chrono::steady_clock::duration took = pool.prewarm(100, 4);
+        QVERIFY(took >= std::chrono::steady_clock::duration::zero());
+        QCOMPARE(pool.size(), 105u);
+        QCOMPARE(built, 105);
+        QCOMPARE(Counted::live, 105);
+        
+        // Reserves are hits now.
+        std::unique_ptr<Counted> object = pool.reserve();
+        QCOMPARE(built, 105);
+        pool.release(std::move(object));
+        
+        // Only as many objects are built as fit under the limit.
+        pool.setMaxIdle(110);
+        pool.prewarm(100, 3);
+        QCOMPARE(pool.size(), 110u);
+        QCOMPARE(built, 110);
+        pool.prewarm(1);
+        QCOMPARE(built, 110);
+        
+        // More threads than objects.
+        pool.clear();
+        pool.prewarm(2, 8);
+        QCOMPARE(pool.size(), 2u);
+    }
+    QCOMPARE(Counted::live, 0);
+    
+    // Builder fails after 10 objects.
+    built = 0;
+    std::function<Counted*()> failing = [&built, &mx]() -> Counted*
+    {
+        std::lock_guard<std::mutex> lock(mx);
+        if (++built > 10){
+            throw std::runtime_error("builder failed");
+        }
+        return new Counted();
+    };
+    PPUtils::UniformObjectPool<Counted> pool(failing);
+    QVERIFY_EXCEPTION_THROWN(pool.prewarm(20, 2), std::runtime_error);
+    QCOMPARE(pool.size(), 10u);
+    QCOMPARE(Counted::live, 10);
+}
+
+
+void UniformObjectPoolTest::resetPolicyTest()
+{
+    typedef std::function<Connection*()> B;
+    int calls = 0;
+    
+    PPUtils::UniformObjectPool<Connection, B, PPUtils::EagerReset<ConnectionReset> >
+            eager(PPUtils::UniformObjectPool<Connection>::DEFAULT_BUILDER, 0,
+                  PPUtils::EagerReset<ConnectionReset>(ConnectionReset(&calls)));
+    std::unique_ptr<Connection> c = eager.reserve();
+    c->dirt = 5;
+    Connection* raw = c.get();
+    eager.release(std::move(c));
+    QCOMPARE(calls, 1);
+    QCOMPARE(raw->dirt, 0);
+    c = eager.reserve();
+    QCOMPARE(calls, 1);
+    QCOMPARE(c.get(), raw);
+    
+    calls = 0;
+    PPUtils::UniformObjectPool<Connection, B, PPUtils::LazyReset<ConnectionReset> >
+            lazy(PPUtils::UniformObjectPool<Connection>::DEFAULT_BUILDER, 2,
+                 PPUtils::LazyReset<ConnectionReset>(ConnectionReset(&calls)));
+    c = lazy.reserve();
+    c->dirt = 5;
+    raw = c.get();
+    lazy.release(std::move(c));
+    QCOMPARE(calls, 0);
+    QCOMPARE(raw->dirt, 5);
+    c = lazy.reserve();
+    QCOMPARE(calls, 1);
+    QCOMPARE(c->dirt, 0);
+    
+    calls = 0;
+    PPUtils::UniformObjectPool<Connection, B, PPUtils::BackgroundReset<ConnectionReset> >
+            background(PPUtils::UniformObjectPool<Connection>::DEFAULT_BUILDER, 1,
+                       PPUtils::BackgroundReset<ConnectionReset>(ConnectionReset(&calls)));
+    Connection* fresh = nullptr;
+    {
+        std::unique_ptr<Connection> a = background.reserve();
+        std::unique_ptr<Connection> b = background.reserve();
+        a->dirt = 1;
+        b->dirt = 2;
+        fresh = b.get();
+        background.release(std::move(a));
+        background.release(std::move(b));
+    }
+    QCOMPARE(calls, 0);
+    QCOMPARE(background.size(), 2u);
+    QCOMPARE(background.resetDirty(), 2u);
+    QCOMPARE(calls, 2);
+    QCOMPARE(background.size(), 2u);
+    QCOMPARE(background.resetDirty(), 0u);
+    c = background.reserve();
+    QCOMPARE(calls, 2);
+    QCOMPARE(c->dirt, 0);
+    
+    // Clean objects are reserved before dirty ones, and a dirty one is reset
+    // in reserve if no clean one is left.
+    c->dirt = 3;
+    background.release(std::move(c));
+    c = background.reserve();
+    QCOMPARE(calls, 2);
+    std::unique_ptr<Connection> d = background.reserve();
+    QCOMPARE(calls, 3);
+    QCOMPARE(d->dirt, 0);
+    QVERIFY(c.get() == fresh || d.get() == fresh);
+    
+    // Limits count objects waiting for reset.
+    background.release(std::move(c));
+    background.release(std::move(d));
+    background.setMaxIdle(1);
+    QCOMPARE(background.size(), 1u);
+    background.trim(0);
+    QCOMPARE(background.size(), 0u);
+}
+
+
+void UniformObjectPoolTest::validatorTest()
+{
+    int built = 0;
+    std::function<Connection*()> builder = [&built]()
+    {
+        ++built;
+        return new Connection();
+    };
+    PPUtils::UniformObjectPool<Connection> pool(builder, 3);
+    QCOMPARE(built, 3);
+    int checked = 0;
+    pool.setValidator([&checked](Connection& c)
+    {
+        ++checked;
+        return !c.broken;
+    });
+    
+    std::vector<std::unique_ptr<Connection> > objects;
+    for (int i = 0; i < 3; ++i){
+        objects.push_back(pool.reserve());
+    }
+    QCOMPARE(checked, 3);
+    objects[0]->broken = true;
+    objects[2]->broken = true;
+    for (auto& object : objects){
+        pool.release(std::move(object));
+    }
+    
+    // Broken objects are skipped: the one good object is reused.
+    std::unique_ptr<Connection> good = pool.reserve();
+    QVERIFY(!good->broken);
+    QCOMPARE(built, 3);
+    QCOMPARE(pool.size(), 1u);
+    std::unique_ptr<Connection> next = pool.reserve();
+    QCOMPARE(pool.size(), 0u);
+    QCOMPARE(built, 4);
+    QCOMPARE(checked, 6);
+    
+    pool.setValidator(std::function<bool(Connection&)>());
+    next->broken = true;
+    pool.release(std::move(next));
+    QVERIFY(pool.reserve()->broken);
+}
+
+
+
+void UniformObjectPoolTest::statisticsTest()
+{
+    PPUtils::UniformObjectPool<Connection> pool;
+    QCOMPARE(pool.statistics().reserves, std::uint64_t(0));
+    pool.enableStatistics();
+    pool.setValidator([](Connection& c){return !c.broken;});
+    
+    std::vector<std::unique_ptr<Connection> > objects;
+    for (int i = 0; i < 3; ++i){
+        objects.push_back(pool.reserve());
+    }
+    objects[0]->broken = true;
+    for (auto& object : objects){
+        pool.release(std::move(object));
+    }
+    // Two hits, then the broken object is rejected and a new one built.
+    for (int i = 0; i < 3; ++i){
+        objects[i] = pool.reserve();
+    }
+    pool.release(std::move(objects[0]));
+    
+    PPUtils::PoolStatistics stats = pool.statistics();
+    QCOMPARE(stats.reserves, std::uint64_t(6));
+    QCOMPARE(stats.hits, std::uint64_t(2));
+    QCOMPARE(stats.misses, std::uint64_t(4));
+    QCOMPARE(stats.releases, std::uint64_t(4));
+    QCOMPARE(stats.idle, std::uint64_t(1));
+    QCOMPARE(stats.idle_high_water, std::uint64_t(3));
+    QCOMPARE(stats.outstanding, std::uint64_t(2));
+    QCOMPARE(stats.outstanding_high_water, std::uint64_t(3));
+    QCOMPARE(stats.hitRate(), 2.0 / 6.0);
+    std::uint64_t builds = 0;
+    for (std::uint64_t count : stats.builder_latency){
+        builds += count;
+    }
+    QCOMPARE(builds, std::uint64_t(4));
+    
+    std::ostringstream out;
+    stats.write(out, "pool");
+    QVERIFY(out.str().find("pool_hits 2\n") != std::string::npos);
+    QVERIFY(out.str().find("pool_outstanding_high_water 3\n") != std::string::npos);
+    QVERIFY(out.str().find("# TYPE pool_hits counter\n") != std::string::npos);
+    QVERIFY(out.str().find("# TYPE pool_builder_latency_ns histogram\n")
+            != std::string::npos);
+    QVERIFY(out.str().find("pool_builder_latency_ns_bucket{le=\"+Inf\"} 4\n")
+            != std::string::npos);
+    QVERIFY(out.str().find("pool_builder_latency_ns_count 4\n") != std::string::npos);
+    QVERIFY(out.str().find("pool_builder_latency_ns_sum " +
+                           std::to_string(stats.builder_latency_sum_ns) + "\n")
+            != std::string::npos);
+    
+    // Bucket limits are inclusive, as le in Prometheus.
+    PPUtils::detail::PoolCounters counters(1);
+    counters.built(std::chrono::nanoseconds(1024));
+    counters.built(std::chrono::nanoseconds(1025));
+    PPUtils::PoolStatistics edges = counters.snapshot(0);
+    QCOMPARE(edges.builder_latency[9], std::uint64_t(1));
+    QCOMPARE(edges.builder_latency[10], std::uint64_t(1));
+    QCOMPARE(edges.builder_latency_sum_ns, std::uint64_t(2049));
+    out.str("");
+    edges.write(out, "edges");
+    QVERIFY(out.str().find("edges_builder_latency_ns_bucket{le=\"1024\"} 1\n")
+            != std::string::npos);
+    QVERIFY(out.str().find("edges_builder_latency_ns_bucket{le=\"2048\"} 2\n")
+            != std::string::npos);
+    
+    pool.enableStatistics(false);
+    QCOMPARE(pool.statistics().reserves, std::uint64_t(0));
+    pool.reserve();
+    QCOMPARE(pool.statistics().reserves, std::uint64_t(0));
+}
+
+
 QTEST_APPLESS_MAIN(UniformObjectPoolTest)
 
 #include "tst_uniformobjectpooltest.moc"